@@ -0,0 +1,60 @@
+// AllocStats.h - 堆分配计数、进程内存占用与CPU时间
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace melotts {
+
+// 堆分配次数和字节数
+struct AllocCounters {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+// 是否以 MELOTTS_ALLOC_STATS 编译（替换了全局 operator new）；未启用时计数恒为0
+bool AllocStatsEnabled();
+
+// 当前线程累计的堆分配（经 operator new）。按线程计数，并发请求之间互不干扰；
+// ONNX Runtime 线程池中的分配不计入，由其内存池统计（InferenceBackend::ArenaBytes）反映
+AllocCounters ThreadAllocCounters();
+
+// 进程的峰值 RSS 和当前 RSS（KB），读取失败时为0
+size_t PeakRssKb();
+size_t CurrentRssKb();
+
+// 当前线程和整个进程（含 ONNX Runtime 线程池等所有线程）已消耗的CPU时间（毫秒），读取失败时为0
+double ThreadCpuMs();
+double ProcessCpuMs();
+
+// 统计一段代码中当前线程的堆分配
+class AllocScope {
+public:
+    AllocScope() : start_(ThreadAllocCounters()) {}
+
+    AllocCounters Delta() const {
+        AllocCounters now = ThreadAllocCounters();
+        AllocCounters delta;
+        delta.count = now.count - start_.count;
+        delta.bytes = now.bytes - start_.bytes;
+        return delta;
+    }
+
+private:
+    AllocCounters start_;
+};
+
+// 统计一段代码消耗的CPU时间：当前线程的，以及同期整个进程的
+class CpuScope {
+public:
+    CpuScope() : thread_start_(ThreadCpuMs()), process_start_(ProcessCpuMs()) {}
+
+    double ThreadMs() const { return ThreadCpuMs() - thread_start_; }
+    double ProcessMs() const { return ProcessCpuMs() - process_start_; }
+
+private:
+    double thread_start_;
+    double process_start_;
+};
+
+} // namespace melotts
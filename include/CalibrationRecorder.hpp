@@ -0,0 +1,98 @@
+// CalibrationRecorder.hpp - 量化校准数据采集
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdint>
+#include <cerrno>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// 把模型推理时的真实输入保存为 .npy 文件，供 scripts/export_onnx.py 做量化校准
+// 目录结构: <dir>/<模型名>/<样本序号>/<输入名>.npy
+class CalibrationRecorder {
+public:
+    explicit CalibrationRecorder(const std::string& dir) : m_dir(dir) {
+        makeDir(m_dir);
+    }
+
+    // 新建一个样本目录，序号接在已有样本之后，便于多次运行累积数据
+    std::string NewSample(const std::string& model) {
+        std::string model_dir = m_dir + "/" + model;
+        makeDir(model_dir);
+
+        int& next = model == "encoder" ? m_next_encoder : m_next_decoder;
+        std::string sample_dir;
+        do {
+            std::ostringstream oss;
+            oss << model_dir << "/" << std::setw(6) << std::setfill('0') << next++;
+            sample_dir = oss.str();
+        } while (exists(sample_dir));
+
+        makeDir(sample_dir);
+        return sample_dir;
+    }
+
+    static void SaveNpy(const std::string& path, const float* data, const std::vector<int64_t>& shape) {
+        writeNpy(path, "<f4", data, sizeof(float), shape);
+    }
+
+    static void SaveNpy(const std::string& path, const int32_t* data, const std::vector<int64_t>& shape) {
+        writeNpy(path, "<i4", data, sizeof(int32_t), shape);
+    }
+
+    static void SaveNpy(const std::string& path, const int64_t* data, const std::vector<int64_t>& shape) {
+        writeNpy(path, "<i8", data, sizeof(int64_t), shape);
+    }
+
+private:
+    static bool exists(const std::string& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0;
+    }
+
+    static void makeDir(const std::string& path) {
+        if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            throw std::runtime_error("无法创建校准数据目录: " + path);
+        }
+    }
+
+    // NPY 1.0 格式：魔数、版本、头长度、头字典（按64字节对齐），之后是小端原始数据
+    static void writeNpy(const std::string& path, const char* descr, const void* data,
+                         size_t elem_size, const std::vector<int64_t>& shape) {
+        size_t count = 1;
+        std::ostringstream shape_str;
+        shape_str << "(";
+        for (size_t i = 0; i < shape.size(); i++) {
+            count *= static_cast<size_t>(shape[i]);
+            shape_str << shape[i] << (shape.size() == 1 || i + 1 < shape.size() ? ", " : "");
+        }
+        shape_str << ")";
+
+        std::string header = std::string("{'descr': '") + descr + "', 'fortran_order': False, 'shape': " +
+                             shape_str.str() + ", }";
+        size_t total = 10 + header.size() + 1;
+        header.append((64 - total % 64) % 64, ' ');
+        header.push_back('\n');
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("无法写入校准数据: " + path);
+        }
+        const char magic[] = "\x93NUMPY\x01\x00";
+        out.write(magic, 8);
+        uint16_t header_len = static_cast<uint16_t>(header.size());
+        char len_bytes[2] = {static_cast<char>(header_len & 0xff), static_cast<char>(header_len >> 8)};
+        out.write(len_bytes, 2);
+        out.write(header.data(), header.size());
+        out.write(static_cast<const char*>(data), count * elem_size);
+    }
+
+    std::string m_dir;
+    int m_next_encoder = 0;
+    int m_next_decoder = 0;
+};
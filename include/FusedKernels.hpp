@@ -0,0 +1,568 @@
+// FusedKernels.hpp - 声码器融合CPU算子
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+
+// x86 上 AVX2/FMA 内核用 target 属性单独编译，运行时按 CPU 选择，其余代码不需要 -mavx2；
+// 定义 MELOTTS_NO_AVX2 时只有标量实现
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(MELOTTS_NO_AVX2)
+#include <immintrin.h>
+#define MELOTTS_KERNELS_AVX2 1
+#define MELOTTS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+// HiFi-GAN 声码器上采样块与残差块的融合实现：
+//   LeakyReLU -> ConvTranspose1d          (上采样)
+//   LeakyReLU -> Conv1d (-> + residual)   (残差块中的空洞卷积)
+// 激活只计算一次写入带零填充的工作区，偏置与残差在初始化输出时一并加上，
+// 避免原图中激活、卷积、加法之间的中间张量读写。
+// 张量布局均为 [C, T]（单个batch），CPU支持AVX2/FMA时使用SIMD，否则使用标量实现。
+// 文件末尾另有原生引擎执行声学模型所用的矩阵乘、Softmax、LayerNorm 和逐元素指数类内核。
+namespace melotts {
+namespace kernels {
+
+// 当前CPU能否运行AVX2/FMA内核（只读取启动时探测好的CPU特性位）
+inline bool HasAvx2() {
+#ifdef MELOTTS_KERNELS_AVX2
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+// 是否使用了SIMD实现
+inline const char* SimdLevel() {
+    return HasAvx2() ? "avx2" : "scalar";
+}
+
+#ifdef MELOTTS_KERNELS_AVX2
+// 以下 *Avx2 函数处理能按8路向量处理的前缀，返回已处理的元素数，剩余部分由调用方的标量循环完成
+MELOTTS_TARGET_AVX2 inline int AxpyAvx2(float* y, const float* x, float a, int n) {
+    int i = 0;
+    __m256 va = _mm256_set1_ps(a);
+    for (; i + 16 <= n; i += 16) {
+        __m256 y0 = _mm256_loadu_ps(y + i);
+        __m256 y1 = _mm256_loadu_ps(y + i + 8);
+        y0 = _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), y0);
+        y1 = _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i + 8), y1);
+        _mm256_storeu_ps(y + i, y0);
+        _mm256_storeu_ps(y + i + 8, y1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    return i;
+}
+
+MELOTTS_TARGET_AVX2 inline int LeakyReluAvx2(float* dst, const float* src, float alpha, int n) {
+    int i = 0;
+    __m256 va = _mm256_set1_ps(alpha);
+    __m256 zero = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(src + i);
+        __m256 pos = _mm256_max_ps(v, zero);
+        __m256 neg = _mm256_min_ps(v, zero);
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(va, neg, pos));
+    }
+    return i;
+}
+#endif
+
+// y[i] += a * x[i]
+inline void Axpy(float* y, const float* x, float a, int n) {
+    int i = 0;
+#ifdef MELOTTS_KERNELS_AVX2
+    if (HasAvx2()) i = AxpyAvx2(y, x, a, n);
+#endif
+    for (; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+// dst[i] = leaky_relu(src[i])，alpha为1时即复制
+inline void LeakyRelu(float* dst, const float* src, float alpha, int n) {
+    int i = 0;
+#ifdef MELOTTS_KERNELS_AVX2
+    if (HasAvx2()) i = LeakyReluAvx2(dst, src, alpha, n);
+#endif
+    for (; i < n; i++) {
+        dst[i] = src[i] > 0.0f ? src[i] : alpha * src[i];
+    }
+}
+
+// 残差输入：形状为 [M, T_out] 或 [M, 1]（按时间轴广播），data为空表示没有残差
+struct Residual {
+    const float* data = nullptr;
+    int time = 0;
+};
+
+// 输出初始化为 bias (+ residual)
+inline void InitOutput(float* y, int m, int out_len, const float* bias, const Residual& res) {
+    float b = bias ? bias[m] : 0.0f;
+    if (!res.data) {
+        std::fill(y, y + out_len, b);
+    } else if (res.time == 1) {
+        std::fill(y, y + out_len, b + res.data[m]);
+    } else {
+        const float* r = res.data + static_cast<size_t>(m) * out_len;
+        for (int t = 0; t < out_len; t++) {
+            y[t] = r[t] + b;
+        }
+    }
+}
+
+// 把激活后的输入写入工作区，每个通道左右补零
+inline void ActivatePadded(const float* x, int channels, int len, float alpha,
+                           int pad_left, int pad_right, std::vector<float>& work) {
+    int row = pad_left + len + pad_right;
+    work.assign(static_cast<size_t>(channels) * row, 0.0f);
+    for (int c = 0; c < channels; c++) {
+        LeakyRelu(work.data() + static_cast<size_t>(c) * row + pad_left,
+                  x + static_cast<size_t>(c) * len, alpha, len);
+    }
+}
+
+// 卷积输出长度（stride为1）
+inline int ConvOutputLength(int len, int kernel, int dilation, int pad_left, int pad_right) {
+    return len + pad_left + pad_right - dilation * (kernel - 1);
+}
+
+// 转置卷积输出长度
+inline int ConvTransposeOutputLength(int len, int kernel, int stride, int pad_left, int pad_right,
+                                     int output_padding) {
+    return (len - 1) * stride + kernel - pad_left - pad_right + output_padding;
+}
+
+// 卷积的权重抽头描述：输出通道m、输入通道c的第i个抽头
+//   权重 w[m * m_stride + c * c_stride + i * tap_stride]，对应输入偏移 i * x_step
+struct ConvTaps {
+    const float* w = nullptr;
+    int m_stride = 0;
+    int c_stride = 0;
+    int tap_stride = 1;
+    int taps = 0;
+    int x_step = 1;
+};
+
+// ConvAccumulate 的通用部分：输出通道 [m_begin, m_end)、时间 [t_begin, t_end)
+// 行较长时逐抽头做向量化的 y += w * x；行很短时（如长度为1的条件向量）逐点累加，避免大量短调用
+inline void ConvAccumulateRows(float* y, int y_row, int m_begin, int m_end, int t_begin, int t_end,
+                               const float* x, int x_row, int in_channels, const ConvTaps& taps) {
+    int n = t_end - t_begin;
+    if (n <= 0) return;
+    int m = m_begin;
+    if (n < 16) {
+        // 4个输出通道同时累加，拆开单条累加链的依赖
+        for (; m + 4 <= m_end; m += 4) {
+            const float* w0 = taps.w + static_cast<size_t>(m) * taps.m_stride;
+            for (int t = t_begin; t < t_end; t++) {
+                float acc[4];
+                for (int j = 0; j < 4; j++) acc[j] = y[static_cast<size_t>(m + j) * y_row + t];
+                for (int c = 0; c < in_channels; c++) {
+                    const float* xc = x + static_cast<size_t>(c) * x_row + t;
+                    const float* wc = w0 + static_cast<size_t>(c) * taps.c_stride;
+                    for (int i = 0; i < taps.taps; i++) {
+                        float xv = xc[i * taps.x_step];
+                        const float* wi = wc + i * taps.tap_stride;
+                        for (int j = 0; j < 4; j++) acc[j] += wi[j * taps.m_stride] * xv;
+                    }
+                }
+                for (int j = 0; j < 4; j++) y[static_cast<size_t>(m + j) * y_row + t] = acc[j];
+            }
+        }
+    }
+    for (; m < m_end; m++) {
+        float* ym = y + static_cast<size_t>(m) * y_row;
+        const float* wm = taps.w + static_cast<size_t>(m) * taps.m_stride;
+        if (n >= 16) {
+            for (int c = 0; c < in_channels; c++) {
+                const float* xc = x + static_cast<size_t>(c) * x_row + t_begin;
+                const float* wc = wm + static_cast<size_t>(c) * taps.c_stride;
+                for (int i = 0; i < taps.taps; i++) {
+                    Axpy(ym + t_begin, xc + i * taps.x_step, wc[i * taps.tap_stride], n);
+                }
+            }
+            continue;
+        }
+        for (int t = t_begin; t < t_end; t++) {
+            float acc = ym[t];
+            for (int c = 0; c < in_channels; c++) {
+                const float* xc = x + static_cast<size_t>(c) * x_row + t;
+                const float* wc = wm + static_cast<size_t>(c) * taps.c_stride;
+                for (int i = 0; i < taps.taps; i++) {
+                    acc += wc[i * taps.tap_stride] * xc[i * taps.x_step];
+                }
+            }
+            ym[t] = acc;
+        }
+    }
+}
+
+#ifdef MELOTTS_KERNELS_AVX2
+// 4个输出通道 x (8*V)个时间点的寄存器分块
+template <int V>
+MELOTTS_TARGET_AVX2 inline void ConvAccumulateTile(float* y0, int y_row, int t0, const float* x, int x_row, int in_channels,
+                               const float* w0, const ConvTaps& taps) {
+    __m256 acc[4][V];
+    for (int j = 0; j < 4; j++) {
+        for (int v = 0; v < V; v++) {
+            acc[j][v] = _mm256_loadu_ps(y0 + static_cast<size_t>(j) * y_row + t0 + 8 * v);
+        }
+    }
+    for (int c = 0; c < in_channels; c++) {
+        const float* xc = x + static_cast<size_t>(c) * x_row + t0;
+        const float* wc = w0 + static_cast<size_t>(c) * taps.c_stride;
+        for (int i = 0; i < taps.taps; i++) {
+            const float* xp = xc + i * taps.x_step;
+            __m256 xv[V];
+            for (int v = 0; v < V; v++) {
+                xv[v] = _mm256_loadu_ps(xp + 8 * v);
+            }
+            const float* wi = wc + i * taps.tap_stride;
+            for (int j = 0; j < 4; j++) {
+                __m256 wv = _mm256_broadcast_ss(wi + j * taps.m_stride);
+                for (int v = 0; v < V; v++) {
+                    acc[j][v] = _mm256_fmadd_ps(wv, xv[v], acc[j][v]);
+                }
+            }
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        for (int v = 0; v < V; v++) {
+            _mm256_storeu_ps(y0 + static_cast<size_t>(j) * y_row + t0 + 8 * v, acc[j][v]);
+        }
+    }
+}
+
+// ConvAccumulate 中按4个输出通道分块的部分，返回已处理的输出通道数
+MELOTTS_TARGET_AVX2 inline int ConvAccumulateAvx2(float* y, int y_row, int out_channels, int out_len,
+                                                  const float* x, int x_row, int in_channels, const ConvTaps& taps) {
+    int m0 = 0;
+    for (; m0 + 4 <= out_channels; m0 += 4) {
+        float* y0 = y + static_cast<size_t>(m0) * y_row;
+        const float* w0 = taps.w + static_cast<size_t>(m0) * taps.m_stride;
+        int t0 = 0;
+        for (; t0 + 16 <= out_len; t0 += 16) {
+            ConvAccumulateTile<2>(y0, y_row, t0, x, x_row, in_channels, w0, taps);
+        }
+        for (; t0 + 8 <= out_len; t0 += 8) {
+            ConvAccumulateTile<1>(y0, y_row, t0, x, x_row, in_channels, w0, taps);
+        }
+        // 时间轴尾部
+        ConvAccumulateRows(y, y_row, m0, m0 + 4, t0, out_len, x, x_row, in_channels, taps);
+    }
+    return m0;
+}
+#endif
+
+// y[m, t] += sum_c sum_i w(m, c, i) * x[c, t + i * x_step]
+// x每行长度x_row，y每行长度y_row，y需事先初始化。
+// AVX2下按 4个输出通道 x 16个时间点 分块（尾部8个一块），累加器常驻寄存器，
+// 每次读入的输入被4个输出通道复用；时间轴按块推进，单个块涉及的输入行片段可留在缓存中。
+inline void ConvAccumulate(float* y, int y_row, int out_channels, int out_len,
+                           const float* x, int x_row, int in_channels, const ConvTaps& taps) {
+    int m0 = 0;
+#ifdef MELOTTS_KERNELS_AVX2
+    if (HasAvx2()) m0 = ConvAccumulateAvx2(y, y_row, out_channels, out_len, x, x_row, in_channels, taps);
+#endif
+    // 剩余输出通道（标量实现时为全部通道）
+    ConvAccumulateRows(y, y_row, m0, out_channels, 0, out_len, x, x_row, in_channels, taps);
+}
+
+// y = conv1d(leaky_relu(x), w, bias) + residual
+// x: [C, T]，w: [M, C/group, K]，y: [M, T_out]
+inline void LeakyReluConv1d(const float* x, int in_channels, int len,
+                            const float* w, int out_channels, int kernel,
+                            const float* bias, const Residual& res,
+                            float alpha, int dilation, int pad_left, int pad_right,
+                            float* y, std::vector<float>& work, int group = 1) {
+    int out_len = ConvOutputLength(len, kernel, dilation, pad_left, pad_right);
+    if (out_len <= 0 || group <= 0 || in_channels % group != 0 || out_channels % group != 0) {
+        throw std::invalid_argument("卷积参数无效");
+    }
+
+    ActivatePadded(x, in_channels, len, alpha, pad_left, pad_right, work);
+    int row = pad_left + len + pad_right;
+
+    for (int m = 0; m < out_channels; m++) {
+        InitOutput(y + static_cast<size_t>(m) * out_len, m, out_len, bias, res);
+    }
+
+    int group_in = in_channels / group;
+    int group_out = out_channels / group;
+    for (int g = 0; g < group; g++) {
+        ConvTaps taps;
+        taps.w = w + static_cast<size_t>(g) * group_out * group_in * kernel;
+        taps.m_stride = group_in * kernel;
+        taps.c_stride = kernel;
+        taps.tap_stride = 1;
+        taps.taps = kernel;
+        taps.x_step = dilation;
+        ConvAccumulate(y + static_cast<size_t>(g) * group_out * out_len, out_len, group_out, out_len,
+                       work.data() + static_cast<size_t>(g) * group_in * row, row, group_in, taps);
+    }
+}
+
+// y = conv_transpose1d(leaky_relu(x), w, bias) + residual
+// x: [C, T]，w: [C, M, K]，y: [M, T_out]
+// 按输出相位分解：输出位置 q*stride+r 只与 k ≡ r (mod stride) 的权重有关，
+// 每个相位退化为对输入的普通卷积 (抽头沿输入反向)，计算后交错写回输出。
+inline void LeakyReluConvTranspose1d(const float* x, int in_channels, int len,
+                                     const float* w, int out_channels, int kernel,
+                                     const float* bias, const Residual& res,
+                                     float alpha, int stride, int pad_left, int pad_right,
+                                     int output_padding, float* y,
+                                     std::vector<float>& work, std::vector<float>& phase) {
+    int out_len = ConvTransposeOutputLength(len, kernel, stride, pad_left, pad_right, output_padding);
+    if (out_len <= 0 || stride <= 0) {
+        throw std::invalid_argument("转置卷积输出长度无效");
+    }
+
+    int full_len = (len - 1) * stride + kernel;
+    int max_taps = (kernel + stride - 1) / stride;
+    int left = max_taps - 1;
+    ActivatePadded(x, in_channels, len, alpha, left, max_taps, work);
+    int row = left + len + max_taps;
+
+    for (int m = 0; m < out_channels; m++) {
+        InitOutput(y + static_cast<size_t>(m) * out_len, m, out_len, bias, res);
+    }
+
+    int max_q = (full_len + stride - 1) / stride;
+    phase.resize(static_cast<size_t>(out_channels) * max_q);
+    for (int r = 0; r < stride && r < full_len; r++) {
+        int q_len = (full_len - r + stride - 1) / stride;
+        std::fill(phase.begin(), phase.begin() + static_cast<size_t>(out_channels) * q_len, 0.0f);
+
+        // phase[m, q] = sum_c sum_j w[c, m, r + j*stride] * x[c, q - j]
+        ConvTaps taps;
+        taps.w = w + r;
+        taps.m_stride = kernel;
+        taps.c_stride = out_channels * kernel;
+        taps.tap_stride = stride;
+        taps.taps = (kernel - r + stride - 1) / stride;
+        taps.x_step = -1;
+        ConvAccumulate(phase.data(), q_len, out_channels, q_len, work.data() + left, row, in_channels, taps);
+
+        // 去掉padding后写回输出
+        for (int m = 0; m < out_channels; m++) {
+            const float* pm = phase.data() + static_cast<size_t>(m) * q_len;
+            float* ym = y + static_cast<size_t>(m) * out_len;
+            for (int q = 0; q < q_len; q++) {
+                int o = q * stride + r - pad_left;
+                if (o >= 0 && o < out_len) {
+                    ym[o] += pm[q];
+                }
+            }
+        }
+    }
+}
+
+// ==================== 声学模型内核 ====================
+
+#ifdef MELOTTS_KERNELS_AVX2
+// 8路exp，多项式逼近 (Cephes expf)，相对误差约1e-7
+MELOTTS_TARGET_AVX2 inline __m256 Exp8(__m256 x) {
+    x = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647949f));
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.3365447504f));
+
+    // exp(x) = 2^n * exp(r)，n = round(x / ln2)
+    __m256 fx = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(0.693359375f), x);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(-2.12194440e-4f), x);
+
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+    __m256i n = _mm256_add_epi32(_mm256_cvtps_epi32(fx), _mm256_set1_epi32(127));
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+}
+
+MELOTTS_TARGET_AVX2 inline float HorizontalSum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+MELOTTS_TARGET_AVX2 inline float HorizontalMax(__m256 v) {
+    __m128 s = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_max_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+MELOTTS_TARGET_AVX2 inline int ExpAvx2(float* dst, const float* src, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, Exp8(_mm256_loadu_ps(src + i)));
+    }
+    return i;
+}
+
+MELOTTS_TARGET_AVX2 inline int SigmoidAvx2(float* dst, const float* src, int n) {
+    int i = 0;
+    __m256 one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 e = Exp8(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_div_ps(one, _mm256_add_ps(one, e)));
+    }
+    return i;
+}
+
+MELOTTS_TARGET_AVX2 inline int TanhAvx2(float* dst, const float* src, int n) {
+    int i = 0;
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 two = _mm256_set1_ps(2.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 e = Exp8(_mm256_mul_ps(two, _mm256_loadu_ps(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(one, _mm256_div_ps(two, _mm256_add_ps(e, one))));
+    }
+    return i;
+}
+
+// Softmax 的两遍：求行最大值（n 不足8时不处理），以及 y = exp(x - max_v) 并求和（sum 为8路部分和之和）
+MELOTTS_TARGET_AVX2 inline int RowMaxAvx2(const float* x, int n, float& max_v) {
+    int i = 0;
+    if (n >= 8) {
+        __m256 vmax = _mm256_set1_ps(-INFINITY);
+        for (; i + 8 <= n; i += 8) {
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(x + i));
+        }
+        max_v = HorizontalMax(vmax);
+    }
+    return i;
+}
+
+MELOTTS_TARGET_AVX2 inline int ExpShiftSumAvx2(float* y, const float* x, int n, float max_v, float& sum) {
+    int i = 0;
+    __m256 vsum = _mm256_setzero_ps();
+    __m256 vmax = _mm256_set1_ps(max_v);
+    for (; i + 8 <= n; i += 8) {
+        __m256 e = Exp8(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmax));
+        _mm256_storeu_ps(y + i, e);
+        vsum = _mm256_add_ps(vsum, e);
+    }
+    sum = HorizontalSum(vsum);
+    return i;
+}
+#endif
+
+// dst[i] = exp(src[i])
+inline void Exp(float* dst, const float* src, int n) {
+    int i = 0;
+#ifdef MELOTTS_KERNELS_AVX2
+    if (HasAvx2()) i = ExpAvx2(dst, src, n);
+#endif
+    for (; i < n; i++) {
+        dst[i] = std::exp(src[i]);
+    }
+}
+
+// dst[i] = 1 / (1 + exp(-src[i]))
+inline void Sigmoid(float* dst, const float* src, int n) {
+    int i = 0;
+#ifdef MELOTTS_KERNELS_AVX2
+    if (HasAvx2()) i = SigmoidAvx2(dst, src, n);
+#endif
+    for (; i < n; i++) {
+        dst[i] = 1.0f / (1.0f + std::exp(-src[i]));
+    }
+}
+
+// dst[i] = tanh(src[i]) = 1 - 2 / (exp(2x) + 1)
+inline void Tanh(float* dst, const float* src, int n) {
+    int i = 0;
+#ifdef MELOTTS_KERNELS_AVX2
+    if (HasAvx2()) i = TanhAvx2(dst, src, n);
+#endif
+    for (; i < n; i++) {
+        dst[i] = std::tanh(src[i]);
+    }
+}
+
+// 行主序矩阵乘 c[M, N] = a[M, K] * b[K, N]，ld* 为各矩阵的行长度
+// 与卷积共用分块累加内核：相当于只有一个抽头的一维卷积，输出通道即 a 的行
+inline void Gemm(float* c, int ldc, const float* a, int lda, const float* b, int ldb,
+                 int m, int n, int k) {
+    for (int i = 0; i < m; i++) {
+        std::fill(c + static_cast<size_t>(i) * ldc, c + static_cast<size_t>(i) * ldc + n, 0.0f);
+    }
+    ConvTaps taps;
+    taps.w = a;
+    taps.m_stride = lda;
+    taps.c_stride = 1;
+    taps.tap_stride = 1;
+    taps.taps = 1;
+    taps.x_step = 0;
+    ConvAccumulate(c, ldc, m, n, b, ldb, k, taps);
+}
+
+// 按行softmax：一次遍历求最大值，一次求exp与和，最后归一化
+inline void SoftmaxRows(float* y, const float* x, int rows, int n) {
+#ifdef MELOTTS_KERNELS_AVX2
+    bool avx2 = HasAvx2();
+#endif
+    for (int r = 0; r < rows; r++) {
+        const float* xr = x + static_cast<size_t>(r) * n;
+        float* yr = y + static_cast<size_t>(r) * n;
+        int i = 0;
+        float max_v = -INFINITY;
+#ifdef MELOTTS_KERNELS_AVX2
+        if (avx2) i = RowMaxAvx2(xr, n, max_v);
+#endif
+        for (; i < n; i++) {
+            max_v = std::max(max_v, xr[i]);
+        }
+
+        i = 0;
+        float sum = 0.0f;
+#ifdef MELOTTS_KERNELS_AVX2
+        if (avx2) i = ExpShiftSumAvx2(yr, xr, n, max_v, sum);
+#endif
+        for (; i < n; i++) {
+            yr[i] = std::exp(xr[i] - max_v);
+            sum += yr[i];
+        }
+
+        float inv = 1.0f / sum;
+        for (i = 0; i < n; i++) {
+            yr[i] *= inv;
+        }
+    }
+}
+
+// 按行LayerNorm：y = (x - mean) / sqrt(var + eps) * gamma + beta，gamma/beta长度为n，可为空
+inline void LayerNormRows(float* y, const float* x, int rows, int n,
+                          const float* gamma, const float* beta, float eps) {
+    for (int r = 0; r < rows; r++) {
+        const float* xr = x + static_cast<size_t>(r) * n;
+        float* yr = y + static_cast<size_t>(r) * n;
+        float mean = 0.0f;
+        for (int i = 0; i < n; i++) mean += xr[i];
+        mean /= n;
+        float var = 0.0f;
+        for (int i = 0; i < n; i++) var += (xr[i] - mean) * (xr[i] - mean);
+        var /= n;
+        float inv = 1.0f / std::sqrt(var + eps);
+        for (int i = 0; i < n; i++) {
+            float v = (xr[i] - mean) * inv;
+            if (gamma) v *= gamma[i];
+            if (beta) v += beta[i];
+            yr[i] = v;
+        }
+    }
+}
+
+} // namespace kernels
+} // namespace melotts
@@ -0,0 +1,181 @@
+// InferenceBackend.h - 推理后端统一接口
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace melotts {
+
+// 张量数据类型，取值与 ONNX TensorProto 编号一致
+enum class DataType : int {
+    Float = 1,
+    Int32 = 6,
+    Int64 = 7,
+    Bool = 9,
+};
+
+const char* DataTypeName(DataType type);
+size_t DataTypeSize(DataType type);
+
+template <typename T> struct DataTypeOf;
+template <> struct DataTypeOf<float> { static constexpr DataType value = DataType::Float; };
+template <> struct DataTypeOf<int32_t> { static constexpr DataType value = DataType::Int32; };
+template <> struct DataTypeOf<int64_t> { static constexpr DataType value = DataType::Int64; };
+template <> struct DataTypeOf<bool> { static constexpr DataType value = DataType::Bool; };
+
+// 模型元数据中的输入/输出描述，动态维度为-1
+struct TensorInfo {
+    std::string name;
+    DataType type = DataType::Float;
+    std::vector<int64_t> shape;
+
+    bool IsDynamic() const;
+};
+
+// 不持有数据的张量视图，形状存放在定长数组中，构造和传递都不申请内存
+class TensorView {
+public:
+    static constexpr size_t kMaxRank = 8;
+
+    TensorView() = default;
+
+    template <typename T>
+    TensorView(const T* data, std::initializer_list<int64_t> shape)
+        : data_(data), type_(DataTypeOf<T>::value) {
+        SetShape(shape.begin(), shape.size());
+    }
+
+    template <typename T>
+    TensorView(const T* data, const std::vector<int64_t>& shape)
+        : data_(data), type_(DataTypeOf<T>::value) {
+        SetShape(shape.data(), shape.size());
+    }
+
+    // 按运行时确定的类型构造（用于转发其他后端的输出）
+    TensorView(const void* data, DataType type, const int64_t* dims, size_t rank)
+        : data_(data), type_(type) {
+        SetShape(dims, rank);
+    }
+
+    DataType type() const { return type_; }
+    const void* raw() const { return data_; }
+    size_t rank() const { return rank_; }
+    int64_t dim(size_t i) const { return dims_[i]; }
+    const int64_t* dims() const { return dims_; }
+    std::vector<int64_t> shape() const { return std::vector<int64_t>(dims_, dims_ + rank_); }
+    size_t count() const;
+    size_t bytes() const { return count() * DataTypeSize(type_); }
+
+    // 按类型取数据，类型不符时抛出异常
+    template <typename T>
+    const T* data() const {
+        CheckType(DataTypeOf<T>::value);
+        return static_cast<const T*>(data_);
+    }
+
+private:
+    void SetShape(const int64_t* dims, size_t rank);
+    void CheckType(DataType expected) const;
+
+    const void* data_ = nullptr;
+    DataType type_ = DataType::Float;
+    int64_t dims_[kMaxRank] = {};
+    size_t rank_ = 0;
+};
+
+struct BackendOptions {
+    int intra_op_threads = 4;            // ONNX Runtime 算子内线程数
+    std::string custom_ops_library;      // ONNX Runtime 自定义算子库，非空时在建会话前注册
+    std::string graph_optimization = "all";  // ONNX Runtime 图优化级别: disable/basic/extended/all
+    bool shared_thread_pool = false;     // 使用进程级共享线程池（见 EnableSharedThreadPool），此时 intra_op_threads 不生效
+    bool share_weights = true;           // 同一模型文件的 ONNX Runtime 会话共用初始化器和预打包权重（见 SharedWeightsReport）
+};
+
+// 让进程内的 ONNX Runtime 会话共用一个全局线程池（intra_op_threads 个线程），
+// 只对以 BackendOptions::shared_thread_pool 创建的会话生效，原生引擎不受影响。
+// 须在创建第一个 ONNX Runtime 会话之前调用；之后调用时仅当线程数与已生效的设置一致才返回 true
+bool EnableSharedThreadPool(int intra_op_threads);
+
+// 共享线程池的线程数，未启用时为0
+int SharedThreadPoolThreads();
+
+// 同一模型文件的多个会话共用的一份权重
+struct SharedWeightsStats {
+    std::string model_file;
+    std::string backend;        // onnxruntime 或 native
+    size_t sessions = 0;        // 当前共用这份权重的会话（原生引擎）数
+    size_t weight_bytes = 0;    // 共用的权重字节数
+    size_t saved_bytes = 0;     // 相比每个会话各持一份节省的字节数
+};
+
+// 当前各模型文件的权重共用情况。ONNX Runtime 会话共用的是较大的 float 初始化器，
+// 预打包权重（GEMM/卷积按内核格式重排的权重）也只保留一份，但其大小无法从 ONNX Runtime 查询，不计入
+std::vector<SharedWeightsStats> SharedWeightsReport();
+
+// 预先读取模型文件中供 ONNX Runtime 会话共用的权重，返回的句柄持有期间之后创建的会话直接使用。
+// 只读取文件、不创建会话和线程，可在 fork 前的父进程中调用，子进程写时复制共用这份权重
+std::shared_ptr<const void> PreloadSharedWeights(const std::string& model_file);
+
+// 推理后端：加载时从模型元数据读取输入输出的名称、类型和形状，
+// Run 前按元数据校验输入的数据类型、维数和静态维度，不符时抛出 std::invalid_argument。
+// 名称数组和输入/输出容器在加载时准备好，输入的数据指针和形状不变时 Run 不在调用方一侧申请内存；
+// Output 返回的视图在下一次 Run 之前有效。
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    InferenceBackend(const InferenceBackend&) = delete;
+    InferenceBackend& operator=(const InferenceBackend&) = delete;
+
+    // 后端名称（onnxruntime 或 native）
+    virtual const char* Name() const = 0;
+
+    const std::vector<TensorInfo>& Inputs() const { return inputs_; }
+    const std::vector<TensorInfo>& Outputs() const { return outputs_; }
+    // 按名称查找输入/输出下标，不存在时返回-1
+    int FindInput(const std::string& name) const;
+    int FindOutput(const std::string& name) const;
+
+    // 运行推理，inputs 按模型输入顺序给出，数量须与模型输入一致；失败时抛出 std::runtime_error
+    void Run(const TensorView* inputs, size_t count);
+    void Run(const std::vector<TensorView>& inputs) { Run(inputs.data(), inputs.size()); }
+
+    size_t OutputCount() const { return outputs_.size(); }
+    virtual TensorView Output(size_t idx) const = 0;
+
+    // 复制输出并转为float（整数输出按数值转换），返回元素数；dst 可使用自定义分配器
+    template <typename FloatVector>
+    size_t CopyOutput(size_t idx, FloatVector& dst) const {
+        dst.resize(Output(idx).count());
+        return CopyOutput(idx, dst.data());
+    }
+    // 同上，写入调用方提供的缓冲区（至少 Output(idx).count() 个元素）
+    size_t CopyOutput(size_t idx, float* dst) const;
+
+    // 模型元数据中的自定义字段，不存在时返回空串
+    virtual std::string GetCustomMetadata(const std::string& key) const = 0;
+
+    // 后端自身管理的激活内存（原生引擎的内存池、ONNX Runtime 会话内存池），不可统计时为0
+    virtual size_t ArenaBytes() const { return 0; }
+
+protected:
+    InferenceBackend() = default;
+
+    virtual void RunImpl(const TensorView* inputs) = 0;
+
+    std::vector<TensorInfo> inputs_;
+    std::vector<TensorInfo> outputs_;
+
+private:
+    void Validate(const TensorView* inputs, size_t count) const;
+};
+
+// 创建后端：kind 为 "onnxruntime" 或 "native"，加载失败（含原生引擎不支持的算子）时抛出 std::runtime_error
+std::unique_ptr<InferenceBackend> CreateInferenceBackend(const std::string& kind, const std::string& model_file,
+                                                         const BackendOptions& options = BackendOptions());
+
+} // namespace melotts
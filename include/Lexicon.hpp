@@ -15,7 +15,9 @@
 
 class Lexicon {
 public:
-    Lexicon(const std::string& lexicon_file, const std::string& token_file, bool verbose = true) 
+    // english_only 时只加载英文词条（只合成英文的进程不必持有中文词典）
+    Lexicon(const std::string& lexicon_file, const std::string& token_file, bool verbose = true,
+            bool english_only = false) 
         : m_verbose(verbose) {
         // 添加状态日志
 	m_verbose = true;
@@ -23,16 +25,32 @@ public:
                   << (m_verbose ? "enabled" : "disabled") << std::endl;
 
         loadTokens(token_file);    // 先加载音素表
-        loadLexicon(lexicon_file); // 再加载词典
         initializePunctuations();  // 初始化标点符号集
+        loadLexicon(lexicon_file, english_only); // 再加载词典
         buildToneVariants();       // 构建带声调的音素变体
         createPhoneticMappings();  // 创建音素映射关系
     }
     
+    // 分词结果中单个词对应的音素区间（插入空白之前的下标）
+    struct WordSpan {
+        std::string word;
+        size_t phone_start;
+        size_t phone_count;
+    };
+    
     // 将文本转换为音素ID和声调ID
     void convert(const std::string& text, std::vector<int>& phones, std::vector<int>& tones) {
+        convert(text, phones, tones, nullptr);
+    }
+    
+    // 将文本转换为音素ID和声调ID，同时输出每个词覆盖的音素区间
+    void convert(const std::string& text, std::vector<int>& phones, std::vector<int>& tones,
+                 std::vector<WordSpan>* word_spans) {
         phones.clear();
         tones.clear();
+        if (word_spans) {
+            word_spans->clear();
+        }
         
         std::cout << "[Lexicon] convert - Verbose logging is " 
                   << (m_verbose ? "enabled" : "disabled") << std::endl;
@@ -75,15 +93,13 @@ public:
                 
                 if (word.empty()) continue;
                 
+                size_t phone_start = phones.size();
+                
                 // 处理英文单词
                 if (isEnglishWord(word)) {
                     processEnglishWord(word, phones, tones);
-                    continue;
-                }
-                
-                // 处理中文单词或标点
-                if (m_word2phonemes.find(word) != m_word2phonemes.end()) {
-                    // 词典中存在该词
+                } else if (m_word2phonemes.find(word) != m_word2phonemes.end()) {
+                    // 处理中文单词或标点：词典中存在该词
                     const auto& phonemes = m_word2phonemes[word];
                     
                     if (m_verbose) {
@@ -100,6 +116,11 @@ public:
                     // 单字符处理
                     processCharByChar(word, phones, tones);
                 }
+                
+                // 记录该词产生的音素区间
+                if (word_spans && phones.size() > phone_start) {
+                    word_spans->push_back({word, phone_start, phones.size() - phone_start});
+                }
             }
         }
         
@@ -121,6 +142,23 @@ public:
         
         // 优化：确保音素和声调序列具有合理的长度和有效性
         validateSequences(phones, tones);
+        
+        // 序列被截断时同步裁剪词区间
+        if (word_spans) {
+            while (!word_spans->empty() && word_spans->back().phone_start >= phones.size()) {
+                word_spans->pop_back();
+            }
+            if (!word_spans->empty()) {
+                WordSpan& last = word_spans->back();
+                last.phone_count = std::min(last.phone_count, phones.size() - last.phone_start);
+            }
+        }
+    }
+    
+    // 音素ID转音素符号，未知ID返回"UNK"
+    std::string getToken(int id) const {
+        auto it = m_id2token.find(id);
+        return it != m_id2token.end() ? it->second : "UNK";
     }
     
     // 生成交错音素序列（在每个音素之间插入blank）
@@ -290,6 +328,9 @@ private:
         }
     }
     
+public:
+    // 以下文本处理步骤由 convert 依次调用，公开以便单独测量
+    
     // 文本规范化
     std::string normalizeText(const std::string& text) {
         // 去除多余空格
@@ -443,6 +484,7 @@ private:
         return tokens;
     }
     
+private:
     // 预处理合并词组（简化版的tone_sandhi.py中的premergeForModify函数）
     std::vector<std::pair<std::string, std::string>> premergeForModify(
             const std::vector<std::pair<std::string, std::string>>& tokens) {
@@ -610,7 +652,7 @@ private:
     }
     
     // 加载词典
-    void loadLexicon(const std::string& lexicon_file) {
+    void loadLexicon(const std::string& lexicon_file, bool english_only) {
         std::ifstream file(lexicon_file);
         if (!file.is_open()) {
             throw std::runtime_error("无法打开词典文件: " + lexicon_file);
@@ -630,6 +672,10 @@ private:
                 phonemes.push_back(phoneme);
             }
             
+            if (english_only && !isEnglishWord(word) && !isPunctuation(word)) {
+                continue;
+            }
+            
             if (!word.empty() && !phonemes.empty()) {
                 m_word2phonemes[word] = phonemes;
                 
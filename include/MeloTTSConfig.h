@@ -2,8 +2,10 @@
 // MeloTTSConfig.h - 配置管理
 #pragma once
 
+#include <set>
 #include <string>
 #include <iostream>
+#include <stdexcept>
 
 namespace melotts {
 
@@ -50,9 +52,69 @@ struct MeloTTSConfig {
     int batch_size = 1;            // 批处理大小
     int segment_size = 32;         // 分段大小（用于长音频处理）
     
+    // 声码器分段设置（仅对时间轴为动态维度的decoder.onnx生效）
+    // 首段较短以降低首包延迟，之后逐段翻倍直到上限，最后一段按实际帧数解码
+    int dec_first_slice_frames = 32;   // 首段帧数
+    int dec_max_slice_frames = 256;    // 单段最大帧数
+    
+    // 模型精度（fp32 或 int8）
+    // int8 时加载 export_onnx.py --quantize 生成的 encoder.int8.onnx / decoder.int8.onnx，
+    // 文件不存在时回退到 fp32 模型
+    std::string encoder_precision = "fp32";
+    std::string decoder_precision = "fp32";
+    
+    // 融合算子库路径（libmelotts_ops.so），非空时为声码器注册其中的自定义算子，
+    // 配合 export_onnx.py --fuse_decoder 改写后的声码器使用
+    std::string custom_ops_library;
+    
+    // 声码器后端（onnxruntime 或 native）
+    // native 使用内置的原生引擎直接执行 decoder.onnx，模型含不支持的算子时回退到 ONNX Runtime
+    std::string decoder_backend = "onnxruntime";
+    
+    // 声学模型后端（onnxruntime 或 native），native 时同样在模型含不支持的算子时回退
+    // enc_max_phonemes 为原生引擎预热时的音素数，内存池按该长度一次分配，更长的输入运行时再扩充
+    std::string encoder_backend = "onnxruntime";
+    int enc_max_phonemes = 256;
+    
+    // 模型变体清单（相对 model_dir，格式见 ModelVariants.hpp），文件不存在时只使用上面配置的模型。
+    // 清单存在时按 model_variant 指定变体，或按延迟预算（实测首包延迟，毫秒，0 为不限）和质量等级选择；
+    // 三项都未设置时使用默认模型，运行中可通过 MeloTTS::select_variant 按请求切换
+    std::string variant_manifest = "variants.txt";
+    std::string model_variant;
+    double latency_budget_ms = 0.0;
+    std::string quality_tier;
+    
+    // 调优配置文件（相对 model_dir，melotts_autotune 生成），存在且与当前主机匹配时
+    // 为后端、线程数和声码器分段中调用方未设置的项提供取值（见 TuningProfile::ApplyTo）；为空时不读取
+    std::string tuning_profile = "tuning_profile.txt";
+    
+    // 经 set() 显式设置过的字段名。直接赋值的字段取值与默认值相同时无法区分，可用 mark_set 记录
+    std::set<std::string> explicit_keys;
+    
+    // 按需加载：lazy_lexicon 时词典在某种语言首次合成时才加载，且按语言只加载所需部分
+    // （en 只含英文词条；zh 为完整词典，也用于中文里夹杂的英文，已加载时英文合成直接复用）；
+    // defer_decoder 时声码器在首次合成时才创建。对首包延迟敏感的服务可在启动后调用 MeloTTS::preload
+    bool lazy_lexicon = false;
+    bool defer_decoder = false;
+    
+    // prefork：只加载 fork 安全的状态（词典、说话人嵌入、原生引擎及其预热、ONNX Runtime 会话共用的权重），
+    // ONNX Runtime 会话及其线程池推迟到子进程首次合成或调用 MeloTTS::preload 时创建（见 RunPrefork）
+    bool prefork = false;
+    
+    // 慢请求阈值（毫秒，合成耗时加调用方告知的排队时间）：超出的请求连同分阶段明细记入进程级慢请求日志
+    // （GlobalSlowRequestLog），0 表示不记录
+    double slow_request_ms = 0.0;
+    
+    // 量化校准数据目录，非空时把每次推理的声学模型输入和声码器分段输入保存为 .npy
+    std::string calibration_dir;
+    
     // ONNX Runtime 相关设置
-    int intra_op_num_threads = 1;           // 内部并行线程数
+    int intra_op_num_threads = 4;           // 内部并行线程数
+    int encoder_threads = 0;                // 声学模型/声码器各自的内部并行线程数，0 表示使用 intra_op_num_threads
+    int decoder_threads = 0;
     int inter_op_num_threads = 1;           // 外部并行线程数
+    bool shared_thread_pool = false;        // 使用进程级共享线程池（EnableSharedThreadPool），多个模型集共用，线程数设置不生效
+    bool share_weights = true;              // 同一模型文件的多个会话（多个 MeloTTS 实例）共用一份权重
     bool use_deterministic_compute = false; // 是否使用确定性计算
     
     // 添加音频增强开关
@@ -71,6 +133,37 @@ struct MeloTTSConfig {
             return false;
         }
         
+        // 检查声码器分段设置
+        if (dec_first_slice_frames <= 0 || dec_max_slice_frames < dec_first_slice_frames) {
+            return false;
+        }
+        
+        // 检查模型精度
+        if ((encoder_precision != "fp32" && encoder_precision != "int8") ||
+            (decoder_precision != "fp32" && decoder_precision != "int8")) {
+            return false;
+        }
+        
+        // 检查声码器后端
+        if (decoder_backend != "onnxruntime" && decoder_backend != "native") {
+            return false;
+        }
+        
+        // 检查声学模型后端
+        if ((encoder_backend != "onnxruntime" && encoder_backend != "native") || enc_max_phonemes <= 0) {
+            return false;
+        }
+        
+        // 检查线程数
+        if (intra_op_num_threads <= 0 || encoder_threads < 0 || decoder_threads < 0) {
+            return false;
+        }
+        
+        // 检查延迟预算和慢请求阈值
+        if (latency_budget_ms < 0.0 || slow_request_ms < 0.0) {
+            return false;
+        }
+        
         // 检查采样率有效性
         if (sample_rate <= 0) {
             return false;
@@ -84,6 +177,65 @@ struct MeloTTSConfig {
         return true;
     }
     
+    // 按名称设置一项配置（名称与字段名相同），用于命令行工具的 键=值 参数。
+    // 名称未知或数值无法解析时返回 false，不检查取值范围（由 validate 负责）
+    bool set(const std::string& key, const std::string& value) {
+        try {
+            size_t pos = 0;
+            auto to_int = [&](int& field) { field = std::stoi(value, &pos); };
+            auto to_float = [&](float& field) { field = std::stof(value, &pos); };
+            auto to_bool = [&](bool& field) {
+                if (value != "0" && value != "1" && value != "false" && value != "true") {
+                    throw std::invalid_argument(key);
+                }
+                field = value == "1" || value == "true";
+            };
+            pos = value.size();
+            if (key == "speed") to_float(speed);
+            else if (key == "speaker_id") to_int(speaker_id);
+            else if (key == "noise_scale") to_float(noise_scale);
+            else if (key == "noise_scale_w") to_float(noise_scale_w);
+            else if (key == "sdp_ratio") to_float(sdp_ratio);
+            else if (key == "sample_rate") to_int(sample_rate);
+            else if (key == "language") language = value;
+            else if (key == "model_dir") model_dir = value;
+            else if (key == "dec_first_slice_frames") to_int(dec_first_slice_frames);
+            else if (key == "dec_max_slice_frames") to_int(dec_max_slice_frames);
+            else if (key == "encoder_precision") encoder_precision = value;
+            else if (key == "decoder_precision") decoder_precision = value;
+            else if (key == "custom_ops_library") custom_ops_library = value;
+            else if (key == "encoder_backend") encoder_backend = value;
+            else if (key == "decoder_backend") decoder_backend = value;
+            else if (key == "enc_max_phonemes") to_int(enc_max_phonemes);
+            else if (key == "variant_manifest") variant_manifest = value;
+            else if (key == "model_variant") model_variant = value;
+            else if (key == "latency_budget_ms") latency_budget_ms = std::stod(value, &pos);
+            else if (key == "quality_tier") quality_tier = value;
+            else if (key == "tuning_profile") tuning_profile = value;
+            else if (key == "intra_op_num_threads") to_int(intra_op_num_threads);
+            else if (key == "encoder_threads") to_int(encoder_threads);
+            else if (key == "decoder_threads") to_int(decoder_threads);
+            else if (key == "shared_thread_pool") to_bool(shared_thread_pool);
+            else if (key == "share_weights") to_bool(share_weights);
+            else if (key == "lazy_lexicon") to_bool(lazy_lexicon);
+            else if (key == "defer_decoder") to_bool(defer_decoder);
+            else if (key == "prefork") to_bool(prefork);
+            else if (key == "slow_request_ms") slow_request_ms = std::stod(value, &pos);
+            else if (key == "enhance_audio") to_bool(enhance_audio);
+            else return false;
+            if (pos != value.size()) {
+                return false;
+            }
+            explicit_keys.insert(key);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    
+    void mark_set(const std::string& key) { explicit_keys.insert(key); }
+    bool is_set(const std::string& key) const { return explicit_keys.count(key) > 0; }
+    
     // 打印配置信息
     void print() const {
         std::cout << "MeloTTS 配置:" << std::endl;
@@ -96,6 +248,36 @@ struct MeloTTSConfig {
         std::cout << " - 语言: " << language << std::endl;
         std::cout << " - 设备: " << device << std::endl;
         std::cout << " - 模型目录: " << model_dir << std::endl;
+        std::cout << " - 模型精度: 声学模型 " << encoder_precision << ", 声码器 " << decoder_precision << std::endl;
+        std::cout << " - 声学模型后端: " << encoder_backend << std::endl;
+        std::cout << " - 声码器后端: " << decoder_backend << std::endl;
+        if (shared_thread_pool) {
+            std::cout << " - 线程数: 进程共享线程池" << std::endl;
+        } else {
+            std::cout << " - 线程数: 声学模型 " << (encoder_threads > 0 ? encoder_threads : intra_op_num_threads)
+                      << ", 声码器 " << (decoder_threads > 0 ? decoder_threads : intra_op_num_threads) << std::endl;
+        }
+        std::cout << " - 声码器分段: 首段 " << dec_first_slice_frames << " 帧, 最大 " << dec_max_slice_frames << " 帧" << std::endl;
+        if (!custom_ops_library.empty()) {
+            std::cout << " - 融合算子库: " << custom_ops_library << std::endl;
+        }
+        if (!model_variant.empty() || latency_budget_ms > 0.0 || !quality_tier.empty()) {
+            std::cout << " - 模型变体: " << (model_variant.empty() ? "自动" : model_variant)
+                      << ", 延迟预算 " << latency_budget_ms << " ms"
+                      << (quality_tier.empty() ? "" : ", 质量等级 " + quality_tier) << std::endl;
+        }
+        if (lazy_lexicon || defer_decoder) {
+            std::cout << " - 按需加载:" << (lazy_lexicon ? " 词典" : "") << (defer_decoder ? " 声码器" : "") << std::endl;
+        }
+        if (prefork) {
+            std::cout << " - prefork: ONNX Runtime 会话在子进程中创建" << std::endl;
+        }
+        if (slow_request_ms > 0.0) {
+            std::cout << " - 慢请求阈值: " << slow_request_ms << " ms" << std::endl;
+        }
+        if (!calibration_dir.empty()) {
+            std::cout << " - 校准数据目录: " << calibration_dir << std::endl;
+        }
     }
 };
 
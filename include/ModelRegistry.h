@@ -0,0 +1,114 @@
+// ModelRegistry.h - 单进程托管多个模型集（按需加载、按内存预算卸载最久未用的模型集）
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MeloTTSConfig.h"
+#include "melotts.h"
+
+namespace melotts {
+
+struct ModelRegistryOptions {
+    size_t memory_budget_kb = 0;   // 已加载模型集的内存预算（KB），0 表示不限
+    int shared_threads = 0;        // ONNX Runtime 共享线程池的线程数，0 表示各模型集使用自己的线程设置
+};
+
+// 模型集的使用情况
+struct ModelSetInfo {
+    std::string name;
+    std::string model_dir;
+    bool loaded = false;
+    bool in_use = false;
+    uint64_t uses = 0;             // Acquire 次数
+    double idle_seconds = 0.0;     // 距上次使用的时间，未使用过时为0
+    double load_ms = 0.0;          // 最近一次加载的耗时
+    size_t resident_kb = 0;        // 内存占用（注册时给定，或按加载前后的RSS差估算）
+};
+
+// 模型注册表：一个进程内托管多个模型集（不同 model_dir 的音色/语言），
+// 共用同一个 ONNX Runtime 环境，可选共用一个线程池。模型集在首次 Acquire 时加载，
+// 已加载模型集的内存总和超过预算时卸载最久未使用且未被占用的模型集，UnloadIdle 卸载空闲过久的模型集。
+// 各方法可在多个线程中并发调用；同一模型集同一时刻只有一个 Handle（MeloTTS 实例不支持并发合成），
+// 不同模型集之间互不阻塞。Handle 须在注册表析构前释放
+class ModelRegistry {
+    struct Entry;
+
+public:
+    // 占用一个已加载的模型集，持有期间不会被卸载
+    class Handle {
+    public:
+        Handle(Handle&& other);
+        ~Handle();
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        Handle& operator=(Handle&&) = delete;
+
+        MeloTTS& operator*() const { return *tts_; }
+        MeloTTS* operator->() const { return tts_.get(); }
+
+    private:
+        friend class ModelRegistry;
+        Handle(ModelRegistry* registry, std::shared_ptr<Entry> entry, std::shared_ptr<MeloTTS> tts);
+
+        ModelRegistry* registry_;
+        std::shared_ptr<Entry> entry_;
+        std::shared_ptr<MeloTTS> tts_;
+        std::unique_lock<std::mutex> use_lock_;
+    };
+
+    // shared_threads > 0 时启用共享线程池，须在进程创建第一个 ONNX Runtime 会话之前构造
+    explicit ModelRegistry(const ModelRegistryOptions& options = ModelRegistryOptions());
+    ~ModelRegistry();
+
+    ModelRegistry(const ModelRegistry&) = delete;
+    ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+    // 注册模型集，此时不加载；resident_kb 为已知的内存占用，0 表示加载时估算。
+    // 名称重复或配置无效时抛出 std::runtime_error
+    void Register(const std::string& name, const MeloTTSConfig& config, size_t resident_kb = 0);
+
+    bool Contains(const std::string& name) const;
+
+    // 占用模型集，未加载时先加载（同一模型集只加载一次，其他请求等待）；
+    // 同一模型集已被占用时等待其释放。未注册或加载失败时抛出 std::runtime_error
+    Handle Acquire(const std::string& name);
+
+    // 卸载模型集，未加载或正被占用时返回 false
+    bool Unload(const std::string& name);
+
+    // 卸载空闲超过 idle_seconds 秒的模型集，返回卸载的数量
+    size_t UnloadIdle(double idle_seconds);
+
+    std::vector<ModelSetInfo> List() const;
+
+    // 已加载模型集的内存占用之和（KB）
+    size_t ResidentKb() const;
+
+    // 共享线程池是否生效
+    bool SharedThreadPool() const { return shared_thread_pool_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Release(Entry& entry);
+    // 超出预算时按最久未使用的顺序摘下空闲模型集（keep 除外），由调用方在锁外析构
+    void EvictLocked(const Entry* keep, std::vector<std::shared_ptr<MeloTTS>>& evicted);
+    size_t ResidentKbLocked() const;
+
+    ModelRegistryOptions options_;
+    bool shared_thread_pool_ = false;
+    mutable std::mutex mutex_;
+    std::condition_variable loaded_cv_;
+    std::map<std::string, std::shared_ptr<Entry>> entries_;
+};
+
+} // namespace melotts
@@ -0,0 +1,224 @@
+// ModelVariants.hpp - 模型变体清单
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace melotts {
+
+// 一个预先导出的模型变体：模型文件、后端和分段设置，以及在部署机器上实测的延迟和质量
+struct ModelVariant {
+    std::string name;
+    std::string encoder_file;          // 声学模型文件，空表示沿用默认声学模型
+    std::string decoder_file;          // 声码器文件，空表示沿用默认声码器
+    std::string encoder_backend;       // onnxruntime 或 native，空表示沿用配置
+    std::string decoder_backend;
+    std::string optimization = "all";  // ONNX Runtime 图优化级别: disable/basic/extended/all
+    int first_slice_frames = 0;        // 声码器分段设置，0 表示沿用配置
+    int max_slice_frames = 0;
+    double latency_ms = 0.0;           // 实测首包延迟（毫秒）
+    double rtf = 0.0;                  // 实测实时率（合成耗时/音频时长）
+    double quality = 0.0;              // 质量分，越高越好（如 MOS 或相对 fp32 的 SNR）
+    std::string tier;                  // 质量等级名（如 draft/standard/high）
+    bool available = true;             // 模型文件齐全且加载未失败
+};
+
+// 变体清单，从 <model_dir>/variants.txt 读取。每行一个变体，格式为
+//   <名称> <键>=<值> ...
+// 键为 encoder、decoder（相对 model_dir 的文件名）、encoder_backend、decoder_backend、optimization、
+// first_slice、max_slice、latency_ms、rtf、quality、tier；# 开头为注释。
+// 模型文件不存在的变体标记为不可用，选择时自动跳过。
+class ModelVariants {
+public:
+    ModelVariants() = default;
+
+    // 读取清单，文件不存在时返回空清单；格式错误的行给出警告后跳过
+    static ModelVariants Load(const std::string& manifest_file, const std::string& model_dir, bool verbose) {
+        ModelVariants variants;
+        std::ifstream file(manifest_file);
+        if (!file.is_open()) {
+            return variants;
+        }
+
+        std::string line;
+        int line_no = 0;
+        while (std::getline(file, line)) {
+            line_no++;
+            line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+            size_t hash = line.find('#');
+            if (hash != std::string::npos) {
+                line.erase(hash);
+            }
+
+            std::istringstream iss(line);
+            ModelVariant v;
+            if (!(iss >> v.name)) {
+                continue;
+            }
+            try {
+                std::string field;
+                while (iss >> field) {
+                    size_t eq = field.find('=');
+                    if (eq == std::string::npos || eq == 0) {
+                        throw std::invalid_argument("缺少'=': " + field);
+                    }
+                    SetField(v, field.substr(0, eq), field.substr(eq + 1));
+                }
+                if (variants.Find(v.name)) {
+                    throw std::invalid_argument("变体名称重复");
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "警告: 变体清单 " << manifest_file << " 第" << line_no << "行无效，已跳过 ("
+                          << e.what() << ")" << std::endl;
+                continue;
+            }
+
+            for (std::string* f : {&v.encoder_file, &v.decoder_file}) {
+                if (f->empty()) continue;
+                *f = model_dir + "/" + *f;
+                if (!std::ifstream(*f).good()) {
+                    std::cerr << "警告: 变体 " << v.name << " 的模型文件不存在: " << *f << std::endl;
+                    v.available = false;
+                }
+            }
+            variants.variants_.push_back(v);
+        }
+
+        if (verbose) {
+            std::cout << "加载变体清单 " << manifest_file << "，变体数: " << variants.variants_.size() << std::endl;
+            for (const auto& v : variants.variants_) {
+                std::cout << "  - " << v.name << ": 延迟 " << v.latency_ms << " ms, 质量 " << v.quality
+                          << (v.tier.empty() ? "" : ", 等级 " + v.tier) << (v.available ? "" : " [不可用]") << std::endl;
+            }
+        }
+        return variants;
+    }
+
+    bool empty() const { return variants_.empty(); }
+    const std::vector<ModelVariant>& all() const { return variants_; }
+
+    const ModelVariant* Find(const std::string& name) const {
+        for (const auto& v : variants_) {
+            if (v.name == name) return &v;
+        }
+        return nullptr;
+    }
+
+    // 加载失败的变体不再参与选择
+    void MarkUnavailable(const std::string& name) {
+        for (auto& v : variants_) {
+            if (v.name == name) v.available = false;
+        }
+    }
+
+    // 选择变体：
+    //  1. name 非空且可用时直接返回
+    //  2. tier 非空时只在该等级中选择，没有可用的同等级变体时忽略等级
+    //  3. latency_budget_ms > 0 时选预算内质量最高的变体，都超出预算时选延迟最低的；
+    //     不限预算时选质量最高的（质量相同取延迟低的）
+    // 没有可用变体时返回 nullptr
+    const ModelVariant* Select(const std::string& name, const std::string& tier, double latency_budget_ms) const {
+        if (!name.empty()) {
+            const ModelVariant* v = Find(name);
+            if (v && v->available) {
+                return v;
+            }
+            std::cerr << "警告: 变体 " << name << (v ? " 不可用" : " 不存在") << "，按延迟预算和质量等级选择" << std::endl;
+        }
+
+        std::vector<const ModelVariant*> candidates;
+        for (const auto& v : variants_) {
+            if (v.available && (tier.empty() || v.tier == tier)) candidates.push_back(&v);
+        }
+        if (candidates.empty() && !tier.empty()) {
+            std::cerr << "警告: 没有可用的 " << tier << " 等级变体，忽略质量等级" << std::endl;
+            for (const auto& v : variants_) {
+                if (v.available) candidates.push_back(&v);
+            }
+        }
+        if (candidates.empty()) {
+            return nullptr;
+        }
+
+        auto better_quality = [](const ModelVariant* a, const ModelVariant* b) {
+            return a->quality != b->quality ? a->quality > b->quality : a->latency_ms < b->latency_ms;
+        };
+        const ModelVariant* best = nullptr;
+        if (latency_budget_ms > 0.0) {
+            for (const ModelVariant* v : candidates) {
+                if (v->latency_ms <= latency_budget_ms && (!best || better_quality(v, best))) best = v;
+            }
+            if (best) {
+                return best;
+            }
+            for (const ModelVariant* v : candidates) {
+                if (!best || v->latency_ms < best->latency_ms) best = v;
+            }
+            return best;
+        }
+        for (const ModelVariant* v : candidates) {
+            if (!best || better_quality(v, best)) best = v;
+        }
+        return best;
+    }
+
+private:
+    static double ToNumber(const std::string& key, const std::string& value) {
+        size_t pos = 0;
+        double number = 0.0;
+        try {
+            number = std::stod(value, &pos);
+        } catch (const std::exception&) {
+            pos = 0;
+        }
+        if (pos == 0 || pos != value.size()) {
+            throw std::invalid_argument("数值无效: " + key + "=" + value);
+        }
+        return number;
+    }
+
+    static void SetField(ModelVariant& v, const std::string& key, const std::string& value) {
+        if (key == "encoder") {
+            v.encoder_file = value;
+        } else if (key == "decoder") {
+            v.decoder_file = value;
+        } else if (key == "encoder_backend" || key == "decoder_backend") {
+            if (value != "onnxruntime" && value != "native") {
+                throw std::invalid_argument("未知后端: " + value);
+            }
+            (key == "encoder_backend" ? v.encoder_backend : v.decoder_backend) = value;
+        } else if (key == "optimization") {
+            if (value != "disable" && value != "basic" && value != "extended" && value != "all") {
+                throw std::invalid_argument("未知优化级别: " + value);
+            }
+            v.optimization = value;
+        } else if (key == "first_slice") {
+            v.first_slice_frames = static_cast<int>(ToNumber(key, value));
+        } else if (key == "max_slice") {
+            v.max_slice_frames = static_cast<int>(ToNumber(key, value));
+        } else if (key == "latency_ms") {
+            v.latency_ms = ToNumber(key, value);
+        } else if (key == "rtf") {
+            v.rtf = ToNumber(key, value);
+        } else if (key == "quality") {
+            v.quality = ToNumber(key, value);
+        } else if (key == "tier") {
+            v.tier = value;
+        } else {
+            throw std::invalid_argument("未知字段: " + key);
+        }
+        if (v.first_slice_frames < 0 || v.max_slice_frames < 0 ||
+            (v.first_slice_frames > 0 && v.max_slice_frames > 0 && v.max_slice_frames < v.first_slice_frames)) {
+            throw std::invalid_argument("分段设置无效");
+        }
+    }
+
+    std::vector<ModelVariant> variants_;
+};
+
+} // namespace melotts
@@ -0,0 +1,79 @@
+// NativeEngine.h - 不依赖 ONNX Runtime 的原生推理引擎
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace melotts {
+
+class NativeEngineImpl;
+
+// 同一模型文件的多个引擎共用一份解析后的模型和权重
+struct NativeSharedModel {
+    std::string model_file;
+    size_t engines = 0;         // 当前共用的引擎数
+    size_t weight_bytes = 0;    // 权重（初始化器与常量节点）字节数
+};
+
+// 当前已加载的模型文件及其共用情况
+std::vector<NativeSharedModel> NativeSharedModels();
+
+// 直接读取 ONNX 模型 (图结构与初始化器中的权重)，按节点顺序解释执行。
+// 只实现声学模型和声码器用到的算子子集：一维卷积/转置卷积与矩阵乘 (AVX2 分块内核)、
+// Softmax/LayerNorm、逐元素运算、激活函数、归约以及导出图中常见的形状计算；
+// 加载时遇到不支持的算子返回失败，调用方可回退到 ONNX Runtime。
+// 加载时把 MatMul 后的常量缩放、卷积/矩阵乘后的 ReLU 并入前一个节点。
+// 同一模型文件的引擎共用一份权重（见 NativeSharedModels）。
+// 激活张量（float 与 int64）从内存池分配，按最后一次使用的位置及时归还；形状等元数据为定长数组（最多8维），
+// 预热后同样形状的推理不再申请内存。
+// 接口与 OnnxWrapper 保持一致，可直接替换后端。
+class NativeEngine {
+public:
+    NativeEngine();
+    ~NativeEngine();
+
+    NativeEngine(const NativeEngine&) = delete;
+    NativeEngine& operator=(const NativeEngine&) = delete;
+
+    // 加载模型，0为成功；模型含不支持的算子时返回-1
+    int Init(const std::string& model_file);
+
+    size_t GetInputCount() const;
+    size_t GetOutputCount() const;
+    const std::string& GetInputName(int input_idx) const;
+    const std::string& GetOutputName(int output_idx) const;
+    const std::vector<int64_t>& GetInputShape(int input_idx) const;
+    size_t GetInputSize(int input_idx) const;   // 字节数，动态维度按1计
+    bool IsInputDynamic(int input_idx) const;
+    // 模型声明的数据类型（ONNX TensorProto 编号：1 float、6 int32、7 int64、9 bool）
+    int GetInputType(int input_idx) const;
+    int GetOutputType(int output_idx) const;
+    std::string GetCustomMetadata(const std::string& key) const;
+
+    // 设置输入数据（类型与模型声明一致），动态维度的输入需要指定本次运行的形状
+    void SetInput(const void* data, int input_idx);
+    void SetInput(const void* data, int input_idx, const std::vector<int64_t>& shape);
+    const void* GetInputData(int input_idx) const;
+    const std::vector<int64_t>& GetInputRunShape(int input_idx) const;
+
+    // 同步运行推理，0为成功
+    int RunSync();
+
+    size_t GetOutputElementCount(int output_idx) const;
+    const std::vector<int64_t>& GetOutputShape(int output_idx) const;
+    // 按模型声明的输出类型写出（未声明时为float）
+    void GetOutput(void* dst, int output_idx);
+
+    // 按各输入当前设置的形状运行一次全零输入，使内存池达到该形状所需的容量
+    int Warmup();
+
+    // 内存池当前占用的字节数
+    size_t GetArenaBytes() const;
+
+private:
+    std::unique_ptr<NativeEngineImpl> impl_;
+};
+
+} // namespace melotts
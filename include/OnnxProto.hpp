@@ -0,0 +1,421 @@
+// OnnxProto.hpp - 不依赖 protobuf 库的 ONNX 模型读取器
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+// 只解析原生推理引擎需要的字段：图结构、节点属性、初始化器 (权重)、输入输出和模型元数据。
+// 字段编号见 onnx/onnx.proto；外部数据 (external data) 不支持。
+namespace onnx_proto {
+
+// TensorProto.DataType
+enum DataType {
+    kUndefined = 0,
+    kFloat = 1,
+    kInt32 = 6,
+    kInt64 = 7,
+    kBool = 9,
+};
+
+struct Tensor {
+    std::string name;
+    std::vector<int64_t> dims;
+    int data_type = kUndefined;
+    std::vector<float> float_data;    // kFloat
+    std::vector<int64_t> int64_data;  // kInt64 / kInt32 / kBool，统一转为int64
+
+    size_t ElementCount() const {
+        size_t count = 1;
+        for (auto d : dims) count *= static_cast<size_t>(d);
+        return count;
+    }
+};
+
+struct Attribute {
+    std::string name;
+    float f = 0.0f;
+    int64_t i = 0;
+    std::string s;
+    std::vector<float> floats;
+    std::vector<int64_t> ints;
+    std::shared_ptr<Tensor> t;
+};
+
+struct Node {
+    std::string name;
+    std::string op_type;
+    std::string domain;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    std::vector<Attribute> attributes;
+
+    const Attribute* Find(const std::string& attr_name) const {
+        for (const auto& a : attributes) {
+            if (a.name == attr_name) return &a;
+        }
+        return nullptr;
+    }
+    int64_t GetInt(const std::string& attr_name, int64_t def) const {
+        const Attribute* a = Find(attr_name);
+        return a ? a->i : def;
+    }
+    float GetFloat(const std::string& attr_name, float def) const {
+        const Attribute* a = Find(attr_name);
+        return a ? a->f : def;
+    }
+    std::vector<int64_t> GetInts(const std::string& attr_name, const std::vector<int64_t>& def = {}) const {
+        const Attribute* a = Find(attr_name);
+        return a ? a->ints : def;
+    }
+    std::string GetString(const std::string& attr_name, const std::string& def = "") const {
+        const Attribute* a = Find(attr_name);
+        return a ? a->s : def;
+    }
+};
+
+// 图的输入输出，动态维度记为-1
+struct ValueInfo {
+    std::string name;
+    int elem_type = kUndefined;
+    std::vector<int64_t> dims;
+};
+
+struct Model {
+    int64_t ir_version = 0;
+    std::map<std::string, int64_t> opsets;   // 算子域 -> 版本
+    std::vector<Node> nodes;
+    std::vector<Tensor> initializers;
+    std::vector<ValueInfo> inputs;           // 不含初始化器
+    std::vector<ValueInfo> outputs;
+    std::map<std::string, std::string> metadata;
+};
+
+// protobuf 线格式读取
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    bool AtEnd() const { return m_pos >= m_end; }
+
+    uint64_t ReadVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_pos >= m_end) throw std::runtime_error("ONNX模型解析失败: varint越界");
+            uint8_t byte = *m_pos++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("ONNX模型解析失败: varint过长");
+    }
+
+    // 返回 (字段号, 线类型)
+    void ReadTag(int& field, int& wire_type) {
+        uint64_t tag = ReadVarint();
+        field = static_cast<int>(tag >> 3);
+        wire_type = static_cast<int>(tag & 7);
+    }
+
+    Reader ReadBytes() {
+        uint64_t len = ReadVarint();
+        if (len > static_cast<uint64_t>(m_end - m_pos)) {
+            throw std::runtime_error("ONNX模型解析失败: 长度越界");
+        }
+        Reader sub(m_pos, static_cast<size_t>(len));
+        m_pos += len;
+        return sub;
+    }
+
+    std::string ReadString() {
+        Reader sub = ReadBytes();
+        return std::string(reinterpret_cast<const char*>(sub.m_pos), sub.m_end - sub.m_pos);
+    }
+
+    float ReadFixed32Float() {
+        if (m_end - m_pos < 4) throw std::runtime_error("ONNX模型解析失败: fixed32越界");
+        float v;
+        std::memcpy(&v, m_pos, 4);
+        m_pos += 4;
+        return v;
+    }
+
+    void Skip(int wire_type) {
+        switch (wire_type) {
+            case 0: ReadVarint(); break;
+            case 1: Advance(8); break;
+            case 2: ReadBytes(); break;
+            case 5: Advance(4); break;
+            default: throw std::runtime_error("ONNX模型解析失败: 未知线类型 " + std::to_string(wire_type));
+        }
+    }
+
+    // repeated int64：兼容打包与非打包两种编码
+    void ReadInt64s(int wire_type, std::vector<int64_t>& out) {
+        if (wire_type == 2) {
+            Reader sub = ReadBytes();
+            while (!sub.AtEnd()) out.push_back(static_cast<int64_t>(sub.ReadVarint()));
+        } else {
+            out.push_back(static_cast<int64_t>(ReadVarint()));
+        }
+    }
+
+    void ReadFloats(int wire_type, std::vector<float>& out) {
+        if (wire_type == 2) {
+            Reader sub = ReadBytes();
+            while (!sub.AtEnd()) out.push_back(sub.ReadFixed32Float());
+        } else {
+            out.push_back(ReadFixed32Float());
+        }
+    }
+
+    const uint8_t* Data() const { return m_pos; }
+    size_t Size() const { return static_cast<size_t>(m_end - m_pos); }
+
+private:
+    void Advance(size_t n) {
+        if (static_cast<size_t>(m_end - m_pos) < n) throw std::runtime_error("ONNX模型解析失败: 越界");
+        m_pos += n;
+    }
+
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+};
+
+inline Tensor ParseTensor(Reader r) {
+    Tensor t;
+    std::string raw;
+    bool has_raw = false;
+    std::vector<int64_t> int_values;
+    while (!r.AtEnd()) {
+        int field, wire;
+        r.ReadTag(field, wire);
+        switch (field) {
+            case 1: r.ReadInt64s(wire, t.dims); break;
+            case 2: t.data_type = static_cast<int>(r.ReadVarint()); break;
+            case 4: r.ReadFloats(wire, t.float_data); break;
+            case 5: r.ReadInt64s(wire, int_values); break;   // int32_data (含bool)
+            case 7: r.ReadInt64s(wire, int_values); break;   // int64_data
+            case 8: t.name = r.ReadString(); break;
+            case 9: raw = r.ReadString(); has_raw = true; break;
+            case 14:
+                if (r.ReadVarint() == 1) {
+                    throw std::runtime_error("不支持外部数据存储的张量: " + t.name);
+                }
+                break;
+            default: r.Skip(wire); break;
+        }
+    }
+
+    size_t count = t.ElementCount();
+    switch (t.data_type) {
+        case kFloat:
+            if (has_raw) {
+                if (raw.size() != count * sizeof(float)) throw std::runtime_error("张量数据长度不符: " + t.name);
+                t.float_data.resize(count);
+                std::memcpy(t.float_data.data(), raw.data(), raw.size());
+            }
+            break;
+        case kInt64:
+            if (has_raw) {
+                if (raw.size() != count * sizeof(int64_t)) throw std::runtime_error("张量数据长度不符: " + t.name);
+                t.int64_data.resize(count);
+                std::memcpy(t.int64_data.data(), raw.data(), raw.size());
+            } else {
+                t.int64_data = int_values;
+            }
+            break;
+        case kInt32:
+            if (has_raw) {
+                if (raw.size() != count * sizeof(int32_t)) throw std::runtime_error("张量数据长度不符: " + t.name);
+                t.int64_data.resize(count);
+                for (size_t i = 0; i < count; i++) {
+                    int32_t v;
+                    std::memcpy(&v, raw.data() + i * sizeof(int32_t), sizeof(int32_t));
+                    t.int64_data[i] = v;
+                }
+            } else {
+                t.int64_data = int_values;
+            }
+            break;
+        case kBool:
+            if (has_raw) {
+                t.int64_data.assign(raw.begin(), raw.end());
+            } else {
+                t.int64_data = int_values;
+            }
+            break;
+        default:
+            // 其他类型保留形状，由使用方决定是否报错
+            break;
+    }
+    return t;
+}
+
+inline Attribute ParseAttribute(Reader r) {
+    Attribute a;
+    while (!r.AtEnd()) {
+        int field, wire;
+        r.ReadTag(field, wire);
+        switch (field) {
+            case 1: a.name = r.ReadString(); break;
+            case 2: a.f = r.ReadFixed32Float(); break;
+            case 3: a.i = static_cast<int64_t>(r.ReadVarint()); break;
+            case 4: a.s = r.ReadString(); break;
+            case 5: a.t = std::make_shared<Tensor>(ParseTensor(r.ReadBytes())); break;
+            case 7: r.ReadFloats(wire, a.floats); break;
+            case 8: r.ReadInt64s(wire, a.ints); break;
+            default: r.Skip(wire); break;
+        }
+    }
+    return a;
+}
+
+inline Node ParseNode(Reader r) {
+    Node n;
+    while (!r.AtEnd()) {
+        int field, wire;
+        r.ReadTag(field, wire);
+        switch (field) {
+            case 1: n.inputs.push_back(r.ReadString()); break;
+            case 2: n.outputs.push_back(r.ReadString()); break;
+            case 3: n.name = r.ReadString(); break;
+            case 4: n.op_type = r.ReadString(); break;
+            case 5: n.attributes.push_back(ParseAttribute(r.ReadBytes())); break;
+            case 7: n.domain = r.ReadString(); break;
+            default: r.Skip(wire); break;
+        }
+    }
+    return n;
+}
+
+// TensorShapeProto.Dimension
+inline int64_t ParseDim(Reader r) {
+    int64_t value = -1;
+    while (!r.AtEnd()) {
+        int field, wire;
+        r.ReadTag(field, wire);
+        if (field == 1) {
+            value = static_cast<int64_t>(r.ReadVarint());
+        } else {
+            r.Skip(wire);
+        }
+    }
+    return value;
+}
+
+inline ValueInfo ParseValueInfo(Reader r) {
+    ValueInfo v;
+    while (!r.AtEnd()) {
+        int field, wire;
+        r.ReadTag(field, wire);
+        if (field == 1) {
+            v.name = r.ReadString();
+        } else if (field == 2) {
+            // TypeProto.tensor_type(1) -> elem_type(1), shape(2) -> dim(1)
+            Reader type = r.ReadBytes();
+            while (!type.AtEnd()) {
+                int tf, tw;
+                type.ReadTag(tf, tw);
+                if (tf != 1) { type.Skip(tw); continue; }
+                Reader tensor = type.ReadBytes();
+                while (!tensor.AtEnd()) {
+                    int f, w;
+                    tensor.ReadTag(f, w);
+                    if (f == 1) {
+                        v.elem_type = static_cast<int>(tensor.ReadVarint());
+                    } else if (f == 2) {
+                        Reader shape = tensor.ReadBytes();
+                        while (!shape.AtEnd()) {
+                            int sf, sw;
+                            shape.ReadTag(sf, sw);
+                            if (sf == 1) {
+                                v.dims.push_back(ParseDim(shape.ReadBytes()));
+                            } else {
+                                shape.Skip(sw);
+                            }
+                        }
+                    } else {
+                        tensor.Skip(w);
+                    }
+                }
+            }
+        } else {
+            r.Skip(wire);
+        }
+    }
+    return v;
+}
+
+inline void ParseGraph(Reader r, Model& model) {
+    std::vector<ValueInfo> inputs;
+    while (!r.AtEnd()) {
+        int field, wire;
+        r.ReadTag(field, wire);
+        switch (field) {
+            case 1: model.nodes.push_back(ParseNode(r.ReadBytes())); break;
+            case 5: model.initializers.push_back(ParseTensor(r.ReadBytes())); break;
+            case 11: inputs.push_back(ParseValueInfo(r.ReadBytes())); break;
+            case 12: model.outputs.push_back(ParseValueInfo(r.ReadBytes())); break;
+            default: r.Skip(wire); break;
+        }
+    }
+
+    // 旧版导出会把初始化器也列为图输入，这里去掉
+    for (auto& in : inputs) {
+        bool is_initializer = false;
+        for (const auto& init : model.initializers) {
+            if (init.name == in.name) { is_initializer = true; break; }
+        }
+        if (!is_initializer) model.inputs.push_back(std::move(in));
+    }
+}
+
+inline Model ParseModel(const uint8_t* data, size_t size) {
+    Model model;
+    Reader r(data, size);
+    while (!r.AtEnd()) {
+        int field, wire;
+        r.ReadTag(field, wire);
+        if (field == 1) {
+            model.ir_version = static_cast<int64_t>(r.ReadVarint());
+        } else if (field == 7) {
+            ParseGraph(r.ReadBytes(), model);
+        } else if (field == 8 || field == 14) {
+            // opset_import: domain(1), version(2)；metadata_props: key(1), value(2)
+            Reader sub = r.ReadBytes();
+            std::string key, str_value;
+            int64_t version = 0;
+            while (!sub.AtEnd()) {
+                int f, w;
+                sub.ReadTag(f, w);
+                if (f == 1) key = sub.ReadString();
+                else if (f == 2 && field == 8) version = static_cast<int64_t>(sub.ReadVarint());
+                else if (f == 2) str_value = sub.ReadString();
+                else sub.Skip(w);
+            }
+            if (field == 8) model.opsets[key] = version;
+            else model.metadata[key] = str_value;
+        } else {
+            r.Skip(wire);
+        }
+    }
+    return model;
+}
+
+inline Model LoadModel(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("无法打开模型文件: " + path);
+    }
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return ParseModel(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+}
+
+} // namespace onnx_proto
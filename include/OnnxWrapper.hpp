@@ -1,368 +1,248 @@
 // OnnxWrapper.hpp - 通用ONNX包装器
+// 保留原有的按索引设置输入、取输出的接口，推理统一经 InferenceBackend（默认 ONNX Runtime 后端，
+// 与 MeloTTS 共用进程级环境和权重缓存）；输入输出的数据类型和形状取自模型元数据
 
 #pragma once
 
-// 标准库头文件
-#include <vector>
-#include <string>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <memory>
-#include <algorithm>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
-// 确保ONNX RuntimeAPI正确引入
-#ifdef _WIN32
-#include <Windows.h>
-#endif
-
-// 引入ONNX Runtime
-#include <onnxruntime_cxx_api.h>
+#include "InferenceBackend.h"
 
 class OnnxWrapper {
 public:
     OnnxWrapper() = default;
-    ~OnnxWrapper() {
-        if (m_session) {
-            delete m_session;
-            m_session = nullptr;
-        }
-    }
+    ~OnnxWrapper() = default;
 
     // 禁用拷贝
     OnnxWrapper(const OnnxWrapper&) = delete;
     OnnxWrapper& operator=(const OnnxWrapper&) = delete;
 
-    // 初始化模型
-    int Init(const std::string& model_file) {
+    // 初始化模型，custom_ops_library非空时先注册其中的自定义算子，backend 为 onnxruntime 或 native
+    int Init(const std::string& model_file, const std::string& custom_ops_library = "",
+             const std::string& backend = "onnxruntime") {
         try {
-            // 创建ONNX Runtime环境
-            m_ort_env = Ort::Env(ORT_LOGGING_LEVEL_WARNING, "OnnxWrapper");
-            
-            // 会话选项
-            Ort::SessionOptions session_options;
-            session_options.SetIntraOpNumThreads(4);
-            session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-            
-            // 创建会话
-            m_session = new Ort::Session(m_ort_env, model_file.c_str(), session_options);
-            
-            // 获取模型信息
-            Ort::AllocatorWithDefaultOptions allocator;
-            
-            // 设置输入输出名称
-            m_input_num = m_session->GetInputCount();
-            std::cout << "模型有 " << m_input_num << " 个输入" << std::endl;
-            
-            m_input_names.clear();
-            m_input_shapes.clear();
+            melotts::BackendOptions options;
+            options.custom_ops_library = custom_ops_library;
+            m_backend = melotts::CreateInferenceBackend(backend, model_file, options);
+
+            // 动态维度按1计算大小
             m_input_sizes.clear();
-            
-            for (size_t i = 0; i < m_input_num; i++) {
-                auto input_name = m_session->GetInputNameAllocated(i, allocator);
-                std::string name = input_name.get();
-                m_input_names.push_back(name);
-                std::cout << "输入 #" << i << ": " << name << std::endl;
-                
-                // 获取输入形状
-                auto type_info = m_session->GetInputTypeInfo(i);
-                auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
-                m_input_shapes.push_back(tensor_info.GetShape());
-                
-                // 打印形状信息
-                auto shape = tensor_info.GetShape();
-                std::cout << "  形状: [";
-                for (size_t j = 0; j < shape.size(); j++) {
-                    std::cout << shape[j];
-                    if (j < shape.size() - 1) std::cout << ", ";
-                }
-                std::cout << "]" << std::endl;
-                
-                // 计算输入大小
-                size_t elem_size = sizeof(float); // 假设输入是float类型
-                size_t total_size = elem_size;
-                for (auto& dim : m_input_shapes.back()) {
-                    if (dim > 0) {
-                        total_size *= static_cast<size_t>(dim);
-                    }
-                }
-                m_input_sizes.push_back(total_size);
+            for (const auto& info : m_backend->Inputs()) {
+                m_input_sizes.push_back(StaticBytes(info));
             }
-            
-            m_output_num = m_session->GetOutputCount();
-            std::cout << "模型有 " << m_output_num << " 个输出" << std::endl;
-            
-            m_output_names.clear();
-            m_output_shapes.clear();
             m_output_sizes.clear();
-            
-            for (size_t i = 0; i < m_output_num; i++) {
-                auto output_name = m_session->GetOutputNameAllocated(i, allocator);
-                std::string name = output_name.get();
-                m_output_names.push_back(name);
-                std::cout << "输出 #" << i << ": " << name << std::endl;
-                
-                // 获取输出形状
-                auto type_info = m_session->GetOutputTypeInfo(i);
-                auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
-                m_output_shapes.push_back(tensor_info.GetShape());
-                
-                // 打印形状信息
-                auto shape = tensor_info.GetShape();
-                std::cout << "  形状: [";
-                for (size_t j = 0; j < shape.size(); j++) {
-                    std::cout << shape[j];
-                    if (j < shape.size() - 1) std::cout << ", ";
-                }
-                std::cout << "]" << std::endl;
-                
-                // 计算输出大小
-                size_t elem_size = sizeof(float); // 假设输出是float类型
-                size_t total_size = elem_size;
-                for (auto& dim : m_output_shapes.back()) {
-                    if (dim > 0) {
-                        total_size *= static_cast<size_t>(dim);
-                    }
-                }
-                m_output_sizes.push_back(total_size);
+            for (const auto& info : m_backend->Outputs()) {
+                m_output_sizes.push_back(StaticBytes(info));
             }
-            
-            // 初始化输入数据存储
-            m_input_data.resize(m_input_num, nullptr);
-            
+
+            size_t input_num = m_backend->Inputs().size();
+            m_input_data.assign(input_num, nullptr);
+            m_input_run_shapes.clear();
+            for (const auto& info : m_backend->Inputs()) {
+                m_input_run_shapes.push_back(info.shape);
+            }
+            m_inputs.resize(input_num);
             return 0;
-        } catch (const Ort::Exception& e) {
-            std::cerr << "ONNX Runtime Error: " << e.what() << std::endl;
-            return -1;
         } catch (const std::exception& e) {
             std::cerr << "Error: " << e.what() << std::endl;
             return -1;
         }
     }
 
-    // 推理函数 - 为MeloTTS设计的接口，使用副本避免const_cast
-    std::vector<Ort::Value> Run(const std::vector<int>& phone, 
-                               const std::vector<int>& tones,
-                               const std::vector<int>& langids,
-                               std::vector<float>& g,
-                               float noise_scale,
-                               float noise_scale_w,
-                               float length_scale,
-                               float sdp_ratio) {
+    // 推理函数 - 为MeloTTS设计的接口，输入依次为音素、声调、语言ID、说话人嵌入和4个标量参数，
+    // 整数序列按模型声明的类型（int32 或 int64）传入，结果通过 GetOutput 读取
+    int Run(const std::vector<int>& phone,
+            const std::vector<int>& tones,
+            const std::vector<int>& langids,
+            const std::vector<float>& g,
+            float noise_scale,
+            float noise_scale_w,
+            float length_scale,
+            float sdp_ratio) {
         try {
-            // 创建可修改的副本
-            std::vector<int> phone_copy = phone;
-            std::vector<int> tones_copy = tones;
-            std::vector<int> langids_copy = langids;
-            
-            int64_t phonelen = phone_copy.size();
-            int64_t toneslen = tones_copy.size();
-            int64_t langidslen = langids_copy.size();
-            
-            // 打印诊断信息
-            std::cout << "输入形状 - phone: " << phonelen 
-                    << ", tones: " << toneslen 
-                    << ", langids: " << langidslen << std::endl;
-            
-            // 修改为1维张量，匹配模型期望的维度
-            std::array<int64_t, 1> phone_dims{phonelen};
-            std::array<int64_t, 3> g_dims{1, 256, 1};
-            std::array<int64_t, 1> tones_dims{toneslen};
-            std::array<int64_t, 1> langids_dims{langidslen};
-            std::array<int64_t, 1> noise_scale_dims{1};
-            std::array<int64_t, 1> length_scale_dims{1};
-            std::array<int64_t, 1> noise_scale_w_dims{1};
-            std::array<int64_t, 1> sdp_scale_dims{1};
-
-            // 确保输入名称与模型匹配
-            if (m_input_names.size() < 8) {
-                throw std::runtime_error("需要至少8个输入名称，但只有" + 
-                                        std::to_string(m_input_names.size()));
+            if (!m_backend) {
+                throw std::runtime_error("模型未初始化");
             }
-            
-            // 使用从模型获取的实际输入名称
-            std::vector<const char*> input_names;
-            for (const auto& name : m_input_names) {
-                input_names.push_back(name.c_str());
-            }
-            
-            // 使用从模型获取的实际输出名称
-            std::vector<const char*> output_names;
-            for (const auto& name : m_output_names) {
-                output_names.push_back(name.c_str());
+            const auto& infos = m_backend->Inputs();
+            if (infos.size() != 8) {
+                throw std::runtime_error("需要8个输入，实际为" + std::to_string(infos.size()));
             }
 
-            Ort::MemoryInfo memory_info_handler = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-            std::vector<Ort::Value> input_vals;
-            
-            // 使用非const副本，避免const_cast
-            input_vals.emplace_back(Ort::Value::CreateTensor<int>(
-                memory_info_handler, phone_copy.data(), phone_copy.size(), 
-                phone_dims.data(), phone_dims.size()));
-                
-            input_vals.emplace_back(Ort::Value::CreateTensor<int>(
-                memory_info_handler, tones_copy.data(), tones_copy.size(), 
-                tones_dims.data(), tones_dims.size()));
-                
-            input_vals.emplace_back(Ort::Value::CreateTensor<int>(
-                memory_info_handler, langids_copy.data(), langids_copy.size(), 
-                langids_dims.data(), langids_dims.size()));
-                
-            input_vals.emplace_back(Ort::Value::CreateTensor<float>(
-                memory_info_handler, g.data(), g.size(), 
-                g_dims.data(), g_dims.size()));
-                
-            input_vals.emplace_back(Ort::Value::CreateTensor<float>(
-                memory_info_handler, &noise_scale, 1, 
-                noise_scale_dims.data(), noise_scale_dims.size()));
-                
-            input_vals.emplace_back(Ort::Value::CreateTensor<float>(
-                memory_info_handler, &noise_scale_w, 1, 
-                noise_scale_w_dims.data(), noise_scale_w_dims.size()));
-                
-            input_vals.emplace_back(Ort::Value::CreateTensor<float>(
-                memory_info_handler, &length_scale, 1, 
-                length_scale_dims.data(), length_scale_dims.size()));
-                
-            input_vals.emplace_back(Ort::Value::CreateTensor<float>(
-                memory_info_handler, &sdp_ratio, 1, 
-                sdp_scale_dims.data(), sdp_scale_dims.size()));
-
-            // 直接返回结果，不存储成员变量中
-            return m_session->Run(
-                Ort::RunOptions{nullptr}, 
-                input_names.data(), 
-                input_vals.data(), 
-                input_vals.size(), 
-                output_names.data(), 
-                output_names.size()
-            );
-        } catch (const Ort::Exception& e) {
-            std::cerr << "ONNX Runtime Error in Run: " << e.what() << std::endl;
-            throw;
+            int64_t n = static_cast<int64_t>(phone.size());
+            const std::vector<int>* seqs[3] = {&phone, &tones, &langids};
+            for (int k = 0; k < 3; k++) {
+                if (infos[k].type == melotts::DataType::Int64) {
+                    m_seq_buffers[k].assign(seqs[k]->begin(), seqs[k]->end());
+                    m_inputs[k] = melotts::TensorView(m_seq_buffers[k].data(), {n});
+                } else {
+                    m_inputs[k] = melotts::TensorView(reinterpret_cast<const int32_t*>(seqs[k]->data()), {n});
+                }
+            }
+            m_inputs[3] = melotts::TensorView(g.data(), {1, static_cast<int64_t>(g.size()), 1});
+            m_scalars[0] = noise_scale;
+            m_scalars[1] = noise_scale_w;
+            m_scalars[2] = length_scale;
+            m_scalars[3] = sdp_ratio;
+            static const int64_t kOnes[melotts::TensorView::kMaxRank] = {1, 1, 1, 1, 1, 1, 1, 1};
+            for (int k = 0; k < 4; k++) {
+                m_inputs[4 + k] = melotts::TensorView(&m_scalars[k], melotts::DataType::Float, kOnes,
+                                                      infos[4 + k].shape.size());
+            }
+            m_backend->Run(m_inputs);
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error in Run: " << e.what() << std::endl;
+            return -1;
         }
     }
 
     // 获取输入输出数量
-    size_t GetInputCount() const { return m_input_num; }
-    size_t GetOutputCount() const { return m_output_num; }
-    
-    // 获取输入形状
+    size_t GetInputCount() const { return m_backend ? m_backend->Inputs().size() : 0; }
+    size_t GetOutputCount() const { return m_backend ? m_backend->Outputs().size() : 0; }
+
+    // 获取输入输出名称
+    const std::string& GetInputName(int input_idx) const {
+        return InputInfo(input_idx).name;
+    }
+
+    const std::string& GetOutputName(int output_idx) const {
+        return OutputInfo(output_idx).name;
+    }
+
+    // 读取模型自定义元数据，不存在时返回空字符串
+    std::string GetCustomMetadata(const std::string& key) const {
+        return m_backend ? m_backend->GetCustomMetadata(key) : std::string();
+    }
+
+    // 获取输入形状（动态维度为-1）
     const std::vector<int64_t>& GetInputShape(int input_idx) const {
-        if (input_idx < 0 || input_idx >= static_cast<int>(m_input_shapes.size())) {
-            throw std::out_of_range("输入索引超出范围");
-        }
-        return m_input_shapes[input_idx];
+        return InputInfo(input_idx).shape;
     }
-    
+
     // 获取输入大小
     size_t GetInputSize(int input_idx) const {
-        if (input_idx < 0 || input_idx >= static_cast<int>(m_input_sizes.size())) {
-            throw std::out_of_range("输入索引超出范围");
-        }
+        InputInfo(input_idx);
         return m_input_sizes[input_idx];
     }
-    
+
+    // 输入是否包含动态维度
+    bool IsInputDynamic(int input_idx) const {
+        return InputInfo(input_idx).IsDynamic();
+    }
+
     // 获取输出大小
     size_t GetOutputSize(int output_idx) const {
-        if (output_idx < 0 || output_idx >= static_cast<int>(m_output_sizes.size())) {
-            throw std::out_of_range("输出索引超出范围");
-        }
+        OutputInfo(output_idx);
         return m_output_sizes[output_idx];
     }
-    
-    // 设置输入数据
+
+    // 设置输入数据（类型与模型声明一致）
     void SetInput(const void* data, int input_idx) {
-        if (input_idx < 0 || input_idx >= static_cast<int>(m_input_num)) {
-            throw std::out_of_range("输入索引超出范围");
-        }
+        InputInfo(input_idx);
         m_input_data[input_idx] = data;
     }
-    
+
+    // 设置输入数据并指定本次运行的形状（用于动态维度的输入）
+    void SetInput(const void* data, int input_idx, const std::vector<int64_t>& shape) {
+        SetInput(data, input_idx);
+        m_input_run_shapes[input_idx] = shape;
+    }
+
+    // 获取已设置的输入数据及本次运行的形状
+    const void* GetInputData(int input_idx) const {
+        InputInfo(input_idx);
+        return m_input_data[input_idx];
+    }
+
+    const std::vector<int64_t>& GetInputRunShape(int input_idx) const {
+        InputInfo(input_idx);
+        return m_input_run_shapes[input_idx];
+    }
+
     // 同步运行推理
     int RunSync() {
         try {
-            // 准备内存信息
-            Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-            
-            // 准备输入张量
-            std::vector<Ort::Value> input_tensors;
-            for (size_t i = 0; i < m_input_num; i++) {
-                const void* data = m_input_data[i];
-                if (!data) {
+            if (!m_backend) {
+                throw std::runtime_error("模型未初始化");
+            }
+            const auto& infos = m_backend->Inputs();
+            for (size_t i = 0; i < infos.size(); i++) {
+                if (!m_input_data[i]) {
                     throw std::runtime_error("输入数据未设置: " + std::to_string(i));
                 }
-                
-                input_tensors.emplace_back(Ort::Value::CreateTensor<float>(
-                    memory_info, 
-                    const_cast<float*>(static_cast<const float*>(data)), 
-                    m_input_sizes[i] / sizeof(float), 
-                    m_input_shapes[i].data(), 
-                    m_input_shapes[i].size()
-                ));
-            }
-            
-            // 准备输入输出名称
-            std::vector<const char*> input_names;
-            for (const auto& name : m_input_names) {
-                input_names.push_back(name.c_str());
-            }
-            
-            std::vector<const char*> output_names;
-            for (const auto& name : m_output_names) {
-                output_names.push_back(name.c_str());
+                const auto& shape = m_input_run_shapes[i];
+                if (std::any_of(shape.begin(), shape.end(), [](int64_t dim) { return dim <= 0; })) {
+                    throw std::runtime_error("输入 #" + std::to_string(i) + " 含动态维度，需通过SetInput指定形状");
+                }
+                m_inputs[i] = melotts::TensorView(m_input_data[i], infos[i].type, shape.data(), shape.size());
             }
-            
-            // 运行推理
-            m_output_tensors = m_session->Run(
-                Ort::RunOptions{nullptr}, 
-                input_names.data(), 
-                input_tensors.data(), 
-                input_tensors.size(), 
-                output_names.data(), 
-                output_names.size()
-            );
-            
+            m_backend->Run(m_inputs);
             return 0;
-        } catch (const Ort::Exception& e) {
-            std::cerr << "ONNX Runtime Error in RunSync: " << e.what() << std::endl;
-            return -1;
         } catch (const std::exception& e) {
             std::cerr << "Error in RunSync: " << e.what() << std::endl;
             return -1;
         }
     }
-    
-    // 获取输出数据
+
+    // 获取最近一次推理实际输出的元素数量（动态输出时与GetOutputSize不同）
+    size_t GetOutputElementCount(int output_idx) const {
+        return OutputTensor(output_idx).count();
+    }
+
+    // 获取输出数据（按实际输出类型复制）
     void GetOutput(void* dst, int output_idx) {
-        if (output_idx < 0 || output_idx >= static_cast<int>(m_output_num)) {
+        melotts::TensorView output = OutputTensor(output_idx);
+        memcpy(dst, output.raw(), output.bytes());
+    }
+
+private:
+    static size_t StaticBytes(const melotts::TensorInfo& info) {
+        size_t total_size = melotts::DataTypeSize(info.type);
+        for (auto dim : info.shape) {
+            total_size *= static_cast<size_t>(dim > 0 ? dim : 1);
+        }
+        return total_size;
+    }
+
+    const melotts::TensorInfo& InputInfo(int input_idx) const {
+        if (!m_backend || input_idx < 0 || input_idx >= static_cast<int>(m_backend->Inputs().size())) {
+            throw std::out_of_range("输入索引超出范围");
+        }
+        return m_backend->Inputs()[input_idx];
+    }
+
+    const melotts::TensorInfo& OutputInfo(int output_idx) const {
+        if (!m_backend || output_idx < 0 || output_idx >= static_cast<int>(m_backend->Outputs().size())) {
             throw std::out_of_range("输出索引超出范围");
         }
-        
-        if (m_output_tensors.size() <= static_cast<size_t>(output_idx)) {
+        return m_backend->Outputs()[output_idx];
+    }
+
+    melotts::TensorView OutputTensor(int output_idx) const {
+        OutputInfo(output_idx);
+        melotts::TensorView output = m_backend->Output(output_idx);
+        if (!output.raw()) {
             throw std::runtime_error("输出张量未生成");
         }
-        
-        // 复制输出数据
-        float* output_data = m_output_tensors[output_idx].GetTensorMutableData<float>();
-        auto tensor_info = m_output_tensors[output_idx].GetTensorTypeAndShapeInfo();
-        size_t output_size = tensor_info.GetElementCount() * sizeof(float);
-        
-        memcpy(dst, output_data, output_size);
+        return output;
     }
 
-private:
-    Ort::Env m_ort_env{nullptr};
-    Ort::Session* m_session{nullptr};
-    size_t m_input_num{0};
-    size_t m_output_num{0};
-    std::vector<std::string> m_input_names;
-    std::vector<std::string> m_output_names;
-    
-    // 模型形状和大小信息
-    std::vector<std::vector<int64_t>> m_input_shapes;
-    std::vector<std::vector<int64_t>> m_output_shapes;
+    std::unique_ptr<melotts::InferenceBackend> m_backend;
+
+    // 模型大小信息
     std::vector<size_t> m_input_sizes;
     std::vector<size_t> m_output_sizes;
+
+    // 运行时数据
     std::vector<const void*> m_input_data;
-    std::vector<Ort::Value> m_output_tensors;
-};
\ No newline at end of file
+    std::vector<std::vector<int64_t>> m_input_run_shapes;  // 本次运行的输入形状
+    std::vector<melotts::TensorView> m_inputs;
+    std::vector<int64_t> m_seq_buffers[3];                  // Run 中 int64 序列输入的转换缓冲
+    float m_scalars[4] = {};
+};
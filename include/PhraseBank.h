@@ -0,0 +1,81 @@
+// PhraseBank.h - IVR 提示音模板：预渲染固定片段，请求时只合成槽位
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "MeloTTSConfig.h"
+#include "melotts.h"
+
+namespace melotts {
+
+struct PhraseBankOptions {
+    std::string language = "zh";
+    double crossfade_ms = 10.0;        // 相邻片段之间的交叉淡化时长
+    double edge_pad_ms = 40.0;         // 裁掉片段首尾静音后保留的静音长度，片段之间的停顿约为两倍减去交叉淡化
+    bool match_level = true;           // 把槽位语音的电平对齐到模板片段
+    bool prerendered_numbers = false;  // 数字槽位用预渲染的数字和单位（零…九、十、百、千、万、亿、点、负）拼接，
+                                       // 不再合成；拼接处没有连读变调，适合金额、编号等短数字
+};
+
+// 模板中的一段：固定文本或槽位
+struct PhrasePart {
+    bool is_slot = false;
+    std::string text;                  // 固定文本，或槽位名
+};
+
+// 提示音模板库。模板形如 "您的余额是{amount}元"，花括号内为槽位名。
+// 固定片段在 Prerender 时（可在构建时离线完成，Save 后部署、启动时 Load）合成并裁去首尾静音，
+// 请求时只合成槽位的文本，各段按顺序交叉淡化拼接，典型提示音的延迟只有合成几个字的耗时。
+// 中文数字槽位（如 "128.50"、"-3"）按读法转换后合成，开启 prerendered_numbers 时直接拼接预渲染的数字和单位。
+// 与 MeloTTS 一样不支持并发调用
+class PhraseBank {
+public:
+    // tts 须以 config 创建，预渲染的片段按 config 的说话人、语速和采样率记录
+    PhraseBank(MeloTTS& tts, const MeloTTSConfig& config, const PhraseBankOptions& options = PhraseBankOptions());
+
+    // 添加模板，花括号不配对、槽位名为空或模板名重复时抛出 std::runtime_error
+    void AddTemplate(const std::string& name, const std::string& pattern);
+
+    bool HasTemplate(const std::string& name) const;
+    std::vector<std::string> TemplateNames() const;
+    const std::vector<PhrasePart>& Parts(const std::string& name) const;
+
+    // 合成所有模板中尚未渲染的固定片段（开启 prerendered_numbers 时包括数字和单位），返回新合成的片段数
+    size_t Prerender();
+
+    // 保存模板和已渲染的片段到目录（templates.txt、fragments.txt、fragments.f32），失败时抛出 std::runtime_error
+    void Save(const std::string& dir) const;
+
+    // 从目录加载模板和片段。片段的模型（变体及模型文件）、说话人、语速或采样率与当前不一致时抛出 std::runtime_error
+    void Load(const std::string& dir);
+
+    // 按模板和槽位值生成提示音。模板不存在或缺少槽位值时抛出 std::runtime_error；
+    // 未预渲染的固定片段在首次使用时合成并缓存
+    std::vector<float> Render(const std::string& name, const std::map<std::string, std::string>& slots);
+
+    // 已渲染的片段数
+    size_t FragmentCount() const { return fragments_.size(); }
+
+private:
+    const std::vector<float>& Fragment(const std::string& text);
+    void AddFragment(const std::string& text, std::vector<float> audio);
+    std::vector<float> RenderSlot(const std::string& value);
+    std::vector<float> Synthesize(const std::string& text);
+    std::string Fingerprint() const;
+
+    MeloTTS& tts_;
+    MeloTTSConfig config_;
+    PhraseBankOptions options_;
+    std::map<std::string, std::string> patterns_;                // 模板名 -> 原始模板
+    std::map<std::string, std::vector<PhrasePart>> templates_;   // 模板名 -> 解析后的各段
+    std::map<std::string, std::vector<float>> fragments_;        // 固定文本 -> 裁去首尾静音的音频
+    double rms_sum_ = 0.0;                                       // 各片段电平之和，平均值用于对齐槽位电平
+};
+
+// 中文数字读法："128.50" -> "一百二十八点五零"，"-3" -> "负三"。
+// 以0开头或超过12位的整数按位读（如电话号码、编号）；不是数字时返回空串
+std::string NumberToChinese(const std::string& number);
+
+} // namespace melotts
@@ -0,0 +1,142 @@
+// PipelineUtils.hpp - 合成流程中的序列与音频处理函数
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace melotts {
+
+// 在音素序列中插入空白，写入调用方提供的容器（可使用自定义分配器）
+template <typename In, typename Out>
+inline void intersperseInto(const In& lst, int item, Out& result) {
+    result.assign(lst.size() * 2 + 1, item);
+    for (size_t i = 1; i < result.size(); i += 2) {
+        result[i] = lst[i / 2];
+    }
+}
+
+// 在音素序列中插入空白
+inline std::vector<int> intersperse(const std::vector<int>& lst, int item) {
+    std::vector<int> result;
+    intersperseInto(lst, item, result);
+    return result;
+}
+
+// 特征重排序，写入调用方提供的 zp_channels * dec_len 个元素
+// 从start_frame开始截取dec_len帧，不足部分补零
+inline void reshapeFeaturesInto(const float* features, size_t feature_count,
+                                int feature_frames, int zp_channels, int dec_len,
+                                int start_frame, float* reshaped) {
+    std::fill(reshaped, reshaped + static_cast<size_t>(zp_channels) * dec_len, 0.0f);
+    
+    // 计算需要处理的帧数
+    int frames_to_process = std::min(dec_len, feature_frames - start_frame);
+    
+    // 重要：理解原始特征的内存布局
+    for (int c = 0; c < zp_channels; c++) {
+        for (int f = 0; f < frames_to_process; f++) {
+            // 源索引 - 通道优先布局
+            int src_idx = c * feature_frames + start_frame + f;
+            
+            // 目标索引 - [channels, frames]格式
+            int dst_idx = c * dec_len + f;
+            
+            if (src_idx < static_cast<int>(feature_count)) {
+                reshaped[dst_idx] = features[src_idx];
+            }
+        }
+    }
+}
+
+// 新增：特征重排序函数，正确处理特征维度转换
+// 从start_frame开始截取dec_len帧，不足部分补零
+inline std::vector<float> reshapeFeatures(const std::vector<float>& features, 
+                                         int feature_frames, int zp_channels, int dec_len,
+                                         int start_frame = 0) {
+    std::vector<float> reshaped(zp_channels * dec_len);
+    reshapeFeaturesInto(features.data(), features.size(), feature_frames, zp_channels, dec_len,
+                        start_frame, reshaped.data());
+    return reshaped;
+}
+
+// 就地增强音频：归一化、软削波和噪声门
+inline void enhanceAudio(float* begin, float* end) {
+    // 音频归一化 - 提高音量并减少失真
+    float max_amp = 0.0f;
+    for (const float* p = begin; p != end; ++p) {
+        max_amp = std::max(max_amp, std::abs(*p));
+    }
+    
+    // 避免除以零
+    if (max_amp > 0.001f) {
+        // 设置目标振幅为0.85（提高音量但避免削波）
+        float target_amp = 0.85f;
+        float scale = target_amp / max_amp;
+        
+        for (float* p = begin; p != end; ++p) {
+            float& sample = *p;
+            sample *= scale;
+            
+            // 软削波以避免失真
+            if (sample > 0.95f) {
+                sample = 0.95f + 0.05f * tanh((sample - 0.95f) / 0.05f);
+            } else if (sample < -0.95f) {
+                sample = -0.95f + 0.05f * tanh((sample + 0.95f) / 0.05f);
+            }
+        }
+    }
+    
+    // 简单去噪 - 移除低振幅噪声
+    const float noise_gate = 0.01f;
+    for (float* p = begin; p != end; ++p) {
+        if (std::abs(*p) < noise_gate) {
+            *p = 0.0f;
+        }
+    }
+}
+
+// 新增：音频后处理函数，提高音质和清晰度
+inline std::vector<float> postProcessAudio(const std::vector<float>& audio, int target_len, bool enhance = true) {
+    // 裁剪到目标长度
+    std::vector<float> result = audio;
+    if (result.size() > static_cast<size_t>(target_len)) {
+        result.resize(target_len);
+    } else if (result.size() < static_cast<size_t>(target_len)) {
+        result.resize(target_len, 0.0f);
+    }
+    
+    if (enhance) {
+        enhanceAudio(result.data(), result.data() + result.size());
+    }
+    return result;
+}
+
+// 规划动态长度声码器的分段：首段较短以尽快输出首包音频，之后逐段翻倍直到max_len，
+// 最后一段按剩余帧数解码，不再补零。剩余帧数少于首段时并入前一段，避免过短的尾段。
+template <typename Out>
+inline void planDecoderSlicesInto(int total_frames, int first_len, int max_len, Out& lens) {
+    lens.clear();
+    first_len = std::max(1, first_len);
+    max_len = std::max(first_len, max_len);
+    
+    int remaining = total_frames;
+    int next = first_len;
+    while (remaining > 0) {
+        int len = std::min(next, remaining);
+        if (remaining - len < first_len && remaining <= max_len) {
+            len = remaining;
+        }
+        lens.push_back(len);
+        remaining -= len;
+        next = std::min(next * 2, max_len);
+    }
+}
+
+inline std::vector<int> planDecoderSlices(int total_frames, int first_len, int max_len) {
+    std::vector<int> lens;
+    planDecoderSlicesInto(total_frames, first_len, max_len, lens);
+    return lens;
+}
+
+} // namespace melotts
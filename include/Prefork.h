@@ -0,0 +1,26 @@
+// Prefork.h - 父进程加载并预热后 fork 出多个工作进程
+#pragma once
+
+#include <functional>
+
+#include "MeloTTSConfig.h"
+#include "melotts.h"
+
+namespace melotts {
+
+struct PreforkOptions {
+    int workers = 2;                 // 工作进程数
+    bool restart_crashed = false;    // 工作进程被信号终止（崩溃）时重新 fork，保持进程数
+};
+
+// 工作进程入口：参数为继承自父进程的 MeloTTS 实例和进程序号（0..workers-1），返回值作为进程退出码
+using PreforkWorker = std::function<int(MeloTTS& tts, int worker_index)>;
+
+// prefork 模式：父进程按 config（开启 MeloTTSConfig::prefork，关闭按需加载）加载词典、说话人嵌入、
+// 原生引擎和 ONNX Runtime 会话共用的权重并预热，然后 fork 出 workers 个子进程。子进程写时复制地继承
+// 这些只读状态，在调用 worker 之前创建自己的 ONNX Runtime 会话和线程池（父进程不创建任何推理线程，fork 是安全的）。
+// 父进程等待全部子进程退出后返回：都以0退出时返回0，否则返回1（重新 fork 的进程以其最终结果计）。
+// 加载失败或 fork 失败时抛出 std::runtime_error。仅支持 POSIX 系统
+int RunPrefork(const MeloTTSConfig& config, const PreforkOptions& options, const PreforkWorker& worker);
+
+} // namespace melotts
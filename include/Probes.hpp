@@ -0,0 +1,43 @@
+// Probes.hpp - 合成流程的 USDT 静态探针
+//
+// 提供者为 melotts，可用 perf / bpftrace 挂载，例如：
+//   bpftrace -e 'usdt:./libmelotts.so:melotts:request_done { printf("%d %d\n", arg0, arg1); }'
+// 探针未被挂载时只是一条 nop 指令，参数都是已算好的整数，不额外计算。
+// 编译环境有 <sys/sdt.h>（systemtap-sdt-dev）时启用，没有该头文件或定义了 MELOTTS_NO_USDT 时展开为空。
+//
+// 探针及参数（request_id 为进程内递增的请求序号）：
+//   request_start(request_id, text_bytes)            request_done(request_id, samples)
+//   request_failed(request_id, decoded_slices)       合成抛出异常时代替 request_done
+//   lexicon_start(request_id, text_bytes)            lexicon_done(request_id, phone_count)
+//   encoder_start(request_id, phone_count)           encoder_done(request_id, audio_len)
+//   decoder_slice_start(request_id, slice, frames)   decoder_slice_done(request_id, slice, samples)
+//   postprocess_start(request_id, samples)           postprocess_done(request_id, samples)
+#pragma once
+
+#if !defined(MELOTTS_NO_USDT) && defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define MELOTTS_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef MELOTTS_HAVE_USDT
+#define MELOTTS_PROBE2(name, a, b) DTRACE_PROBE2(melotts, name, a, b)
+#define MELOTTS_PROBE3(name, a, b, c) DTRACE_PROBE3(melotts, name, a, b, c)
+#else
+#define MELOTTS_PROBE2(name, a, b) do {} while (0)
+#define MELOTTS_PROBE3(name, a, b, c) do {} while (0)
+#endif
+
+namespace melotts {
+
+// 是否编译进了 USDT 探针
+inline bool UsdtProbesEnabled() {
+#ifdef MELOTTS_HAVE_USDT
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace melotts
@@ -0,0 +1,143 @@
+// RequestArena.hpp - 单次合成请求的单调内存区
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace melotts {
+
+// 单调分配的内存区：只向前分配、不单独释放，请求结束时整体复位。
+// 复位时若本次用了多个内存块，合并为一块容量不小于本次用量的新块，
+// 之后同等规模的请求不再申请内存。
+class RequestArena {
+public:
+    explicit RequestArena(size_t initial_bytes = 256 * 1024) : next_block_bytes_(initial_bytes) {}
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    void* Allocate(size_t bytes, size_t align) {
+        if (!blocks_.empty()) {
+            void* p = TryAllocate(blocks_.back(), bytes, align);
+            if (p) return p;
+        }
+        blocks_.push_back(Block(std::max(next_block_bytes_, bytes + align)));
+        next_block_bytes_ = blocks_.back().size * 2;
+        void* p = TryAllocate(blocks_.back(), bytes, align);
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+
+    void Reset() {
+        size_t used = 0;
+        for (const auto& block : blocks_) used += block.used;
+        high_water_ = std::max(high_water_, used);
+        if (blocks_.size() > 1) {
+            blocks_.clear();
+            blocks_.push_back(Block(high_water_));
+            next_block_bytes_ = high_water_ * 2;
+        }
+        for (auto& block : blocks_) block.used = 0;
+    }
+
+    // 已持有的内存（字节）
+    size_t Capacity() const {
+        size_t total = 0;
+        for (const auto& block : blocks_) total += block.size;
+        return total;
+    }
+
+    // 历次请求的最大用量（字节），在 Reset 时更新
+    size_t HighWater() const { return high_water_; }
+
+private:
+    struct Block {
+        explicit Block(size_t bytes) : data(new char[bytes]), size(bytes) {}
+        std::unique_ptr<char[]> data;
+        size_t size;
+        size_t used = 0;
+    };
+
+    static void* TryAllocate(Block& block, size_t bytes, size_t align) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        uintptr_t start = (base + block.used + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        if (start + bytes > base + block.size) return nullptr;
+        block.used = start + bytes - base;
+        return reinterpret_cast<void*>(start);
+    }
+
+    std::vector<Block> blocks_;
+    size_t next_block_bytes_;
+    size_t high_water_ = 0;
+};
+
+// 从 RequestArena 分配的标准库分配器，deallocate 不做任何事
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(RequestArena* arena) : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    RequestArena* arena() const { return arena_; }
+
+private:
+    RequestArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() == b.arena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena() != b.arena(); }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// 从当前线程的内存区池中借出一个内存区，析构时复位并归还。
+// 每个线程保留各自的内存区，嵌套请求（如诊断中调用合成）借出不同的内存区。
+class ArenaLease {
+public:
+    ArenaLease() {
+        auto& pool = Pool();
+        if (pool.empty()) {
+            arena_.reset(new RequestArena());
+        } else {
+            arena_ = std::move(pool.back());
+            pool.pop_back();
+        }
+    }
+
+    ~ArenaLease() {
+        arena_->Reset();
+        Pool().push_back(std::move(arena_));
+    }
+
+    ArenaLease(const ArenaLease&) = delete;
+    ArenaLease& operator=(const ArenaLease&) = delete;
+
+    RequestArena& arena() { return *arena_; }
+
+    template <typename T>
+    ArenaVector<T> Vector(size_t n = 0, const T& value = T()) {
+        return ArenaVector<T>(n, value, ArenaAllocator<T>(arena_.get()));
+    }
+
+private:
+    static std::vector<std::unique_ptr<RequestArena>>& Pool() {
+        static thread_local std::vector<std::unique_ptr<RequestArena>> pool;
+        return pool;
+    }
+
+    std::unique_ptr<RequestArena> arena_;
+};
+
+} // namespace melotts
@@ -0,0 +1,82 @@
+// SlowRequestLog.h - 慢请求记录：超出延迟阈值的请求及其分阶段明细
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace melotts {
+
+// 慢请求中的一个阶段（名称与 StageStats::name 相同，超长时截断）
+struct SlowRequestStage {
+    char name[16] = {};
+    double ms = 0.0;
+    double cpu_ms = 0.0;
+};
+
+// 一条慢请求记录，固定大小，可在环形缓冲区中按字节复制
+struct SlowRequestRecord {
+    static constexpr size_t kMaxStages = 6;
+
+    uint64_t sequence = 0;          // 写入日志的序号（由 SlowRequestLog 填写）
+    uint64_t request_id = 0;        // 进程内的请求序号，与 USDT 探针一致
+    double finished_at = 0.0;       // 完成时刻（Unix 时间，秒）
+    double total_ms = 0.0;          // 合成耗时，不含排队
+    double queue_wait_ms = 0.0;     // 调用方经 MeloTTS::set_queue_wait 告知的排队时间
+    bool failed = false;            // 合成抛出异常；stages 只含已完成的阶段，samples 为0
+    uint32_t text_bytes = 0;
+    uint32_t text_chars = 0;        // UTF-8 字符数
+    uint32_t phone_count = 0;       // 插入空白后的音素数（声学模型的输入长度）
+    uint32_t slice_count = 0;       // 声码器实际运行的分段数
+    uint32_t samples = 0;           // 输出采样点数
+    int32_t encoder_threads = 0;    // 声学模型/声码器的内部并行线程数，0 表示使用进程共享线程池
+    int32_t decoder_threads = 0;
+    char language[8] = {};
+    char encoder_backend[16] = {};
+    char decoder_backend[16] = {};
+    uint32_t stage_count = 0;
+    SlowRequestStage stages[kMaxStages];
+};
+
+// 固定容量的环形缓冲区，写满后覆盖最旧的记录。记录和读取都不加锁：
+// 每个槽位带版本号（seqlock），读取时跳过正在被改写的槽位，不阻塞合成线程
+class SlowRequestLog {
+public:
+    explicit SlowRequestLog(size_t capacity = 256);
+    ~SlowRequestLog();
+
+    SlowRequestLog(const SlowRequestLog&) = delete;
+    SlowRequestLog& operator=(const SlowRequestLog&) = delete;
+
+    // 追加一条记录（sequence 由此处分配）
+    void Record(const SlowRequestRecord& record);
+
+    // 当前保留的记录，按写入顺序排列（最旧的在前）
+    std::vector<SlowRequestRecord> Snapshot() const;
+
+    // 累计写入的记录数（包括已被覆盖的）
+    uint64_t Recorded() const { return next_.load(std::memory_order_relaxed); }
+    size_t Capacity() const { return capacity_; }
+
+    // 以制表符分隔的文本输出当前保留的记录，第一行为表头
+    void Dump(std::ostream& out) const;
+
+private:
+    struct Slot;
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_;
+    std::atomic<uint64_t> next_;
+};
+
+// 进程级慢请求日志，所有 MeloTTS 实例写入同一份（阈值见 MeloTTSConfig::slow_request_ms）
+SlowRequestLog& GlobalSlowRequestLog();
+
+// 收到信号 signo（如 SIGUSR2）时把进程级慢请求日志输出到 path（追加写入），path 为空时输出到标准错误。
+// 信号处理函数只向管道写一个字节，由后台线程完成输出。每个进程只能安装一次，失败或重复安装时返回 false
+bool InstallSlowRequestDumpSignal(int signo, const std::string& path = "");
+
+} // namespace melotts
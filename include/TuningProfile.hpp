@@ -0,0 +1,244 @@
+// TuningProfile.hpp - 主机信息探测与调优配置文件
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MeloTTSConfig.h"
+
+namespace melotts {
+
+// 主机信息：CPU型号、核数、SIMD指令集和各级缓存大小
+struct HostInfo {
+    std::string cpu_model;
+    int logical_cores = 1;
+    int physical_cores = 1;
+    std::vector<std::string> simd;     // 支持的SIMD指令集，如 avx2、fma
+    size_t l1d_bytes = 0;
+    size_t l2_bytes = 0;
+    size_t l3_bytes = 0;
+
+    // 从 /proc/cpuinfo 和 /sys/devices/system/cpu 读取，读不到的项保持默认值
+    static HostInfo Probe() {
+        HostInfo host;
+        host.logical_cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::set<std::pair<std::string, std::string>> cores;
+        std::string line, physical_id;
+        while (std::getline(cpuinfo, line)) {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string key = Trim(line.substr(0, colon));
+            std::string value = Trim(line.substr(colon + 1));
+            if (key == "model name" && host.cpu_model.empty()) {
+                host.cpu_model = value;
+            } else if (key == "physical id") {
+                physical_id = value;
+            } else if (key == "core id") {
+                cores.insert(std::make_pair(physical_id, value));
+            }
+        }
+        host.physical_cores = cores.empty() ? host.logical_cores : static_cast<int>(cores.size());
+        if (host.cpu_model.empty()) host.cpu_model = "unknown";
+
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) host.simd.push_back("sse4.2");
+        if (__builtin_cpu_supports("avx")) host.simd.push_back("avx");
+        if (__builtin_cpu_supports("avx2")) host.simd.push_back("avx2");
+        if (__builtin_cpu_supports("fma")) host.simd.push_back("fma");
+        if (__builtin_cpu_supports("avx512f")) host.simd.push_back("avx512f");
+#elif defined(__aarch64__)
+        host.simd.push_back("neon");
+#endif
+
+        for (int index = 0; index < 8; index++) {
+            std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index);
+            std::string level = ReadLine(dir + "/level");
+            if (level.empty()) break;
+            std::string type = ReadLine(dir + "/type");
+            size_t size = ParseCacheSize(ReadLine(dir + "/size"));
+            if (level == "1" && type == "Data") host.l1d_bytes = size;
+            else if (level == "2") host.l2_bytes = size;
+            else if (level == "3") host.l3_bytes = size;
+        }
+        return host;
+    }
+
+    std::string SimdString() const {
+        std::string s;
+        for (const auto& f : simd) s += (s.empty() ? "" : ",") + f;
+        return s.empty() ? "none" : s;
+    }
+
+    void Print() const {
+        std::cout << "主机信息:" << std::endl;
+        std::cout << " - CPU: " << cpu_model << std::endl;
+        std::cout << " - 核数: " << physical_cores << " 物理 / " << logical_cores << " 逻辑" << std::endl;
+        std::cout << " - SIMD: " << SimdString() << std::endl;
+        std::cout << " - 缓存: L1d " << l1d_bytes / 1024 << " KB, L2 " << l2_bytes / 1024 << " KB, L3 "
+                  << l3_bytes / 1024 << " KB" << std::endl;
+    }
+
+private:
+    static std::string Trim(const std::string& s) {
+        size_t begin = s.find_first_not_of(" \t");
+        size_t end = s.find_last_not_of(" \t\r\n");
+        return begin == std::string::npos ? "" : s.substr(begin, end - begin + 1);
+    }
+
+    static std::string ReadLine(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return Trim(line);
+    }
+
+    // 形如 "32K"、"1024K"、"16M"
+    static size_t ParseCacheSize(const std::string& text) {
+        if (text.empty()) return 0;
+        size_t value = 0;
+        size_t i = 0;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+            value = value * 10 + static_cast<size_t>(text[i] - '0');
+            i++;
+        }
+        if (i < text.size() && (text[i] == 'K' || text[i] == 'k')) value *= 1024;
+        else if (i < text.size() && (text[i] == 'M' || text[i] == 'm')) value *= 1024 * 1024;
+        return value;
+    }
+};
+
+// 调优配置：melotts_autotune 在部署机器上实测后写出，MeloTTS 启动时读取并覆盖配置中的对应项。
+// 文件为 <键>=<值> 的文本，记录生成时的 CPU 型号和逻辑核数，与当前主机不一致时不使用
+struct TuningProfile {
+    std::string host_cpu;
+    int host_cores = 0;
+    std::string encoder_backend = "onnxruntime";
+    std::string decoder_backend = "onnxruntime";
+    int encoder_threads = 0;
+    int decoder_threads = 0;
+    int dec_first_slice_frames = 32;
+    int dec_max_slice_frames = 256;
+
+    // 由配置生成（记录当前主机）
+    static TuningProfile FromConfig(const MeloTTSConfig& config, const HostInfo& host) {
+        TuningProfile profile;
+        profile.host_cpu = host.cpu_model;
+        profile.host_cores = host.logical_cores;
+        profile.encoder_backend = config.encoder_backend;
+        profile.decoder_backend = config.decoder_backend;
+        profile.encoder_threads = config.encoder_threads;
+        profile.decoder_threads = config.decoder_threads;
+        profile.dec_first_slice_frames = config.dec_first_slice_frames;
+        profile.dec_max_slice_frames = config.dec_max_slice_frames;
+        return profile;
+    }
+
+    // 读取调优配置，文件不存在时返回 false，内容无效时抛出 std::runtime_error
+    static bool Load(const std::string& path, TuningProfile& profile) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        TuningProfile loaded;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            size_t eq = line.find('=');
+            if (eq == std::string::npos) {
+                throw std::runtime_error("调优配置格式错误: " + line);
+            }
+            std::string key = line.substr(0, eq);
+            std::string value = line.substr(eq + 1);
+            try {
+                if (key == "host_cpu") loaded.host_cpu = value;
+                else if (key == "host_cores") loaded.host_cores = std::stoi(value);
+                else if (key == "encoder_backend") loaded.encoder_backend = value;
+                else if (key == "decoder_backend") loaded.decoder_backend = value;
+                else if (key == "encoder_threads") loaded.encoder_threads = std::stoi(value);
+                else if (key == "decoder_threads") loaded.decoder_threads = std::stoi(value);
+                else if (key == "dec_first_slice_frames") loaded.dec_first_slice_frames = std::stoi(value);
+                else if (key == "dec_max_slice_frames") loaded.dec_max_slice_frames = std::stoi(value);
+                // 其余键（主机描述、实测结果）仅供查看
+            } catch (const std::exception&) {
+                throw std::runtime_error("调优配置数值无效: " + line);
+            }
+        }
+        profile = loaded;
+        return true;
+    }
+
+    // 写出调优配置，extra 为附加的说明行（实测结果等）
+    void Save(const std::string& path, const HostInfo& host, const std::vector<std::string>& extra) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("无法写入调优配置: " + path);
+        }
+        file << "# MeloTTS 调优配置，由 melotts_autotune 生成" << std::endl;
+        for (const auto& line : extra) {
+            file << "# " << line << std::endl;
+        }
+        file << "host_cpu=" << host_cpu << std::endl;
+        file << "host_cores=" << host_cores << std::endl;
+        file << "host_physical_cores=" << host.physical_cores << std::endl;
+        file << "host_simd=" << host.SimdString() << std::endl;
+        file << "host_cache_kb=" << host.l1d_bytes / 1024 << "," << host.l2_bytes / 1024 << ","
+             << host.l3_bytes / 1024 << std::endl;
+        file << "encoder_backend=" << encoder_backend << std::endl;
+        file << "decoder_backend=" << decoder_backend << std::endl;
+        file << "encoder_threads=" << encoder_threads << std::endl;
+        file << "decoder_threads=" << decoder_threads << std::endl;
+        file << "dec_first_slice_frames=" << dec_first_slice_frames << std::endl;
+        file << "dec_max_slice_frames=" << dec_max_slice_frames << std::endl;
+        if (!file) {
+            throw std::runtime_error("写入调优配置失败: " + path);
+        }
+    }
+
+    // 是否在当前主机上生成
+    bool MatchesHost(const HostInfo& host) const {
+        return host_cpu == host.cpu_model && host_cores == host.logical_cores;
+    }
+
+    // 只填充调用方未设置的项：字段经 MeloTTSConfig::set 显式设置过，或取值已不同于默认值时保留配置值，
+    // 且与调优值不同时把 "字段名=配置值 (调优值)" 追加到 kept。填充后配置无效时不修改配置并返回 false
+    bool ApplyTo(MeloTTSConfig& config, std::vector<std::string>* kept = nullptr) const {
+        const MeloTTSConfig defaults;
+        MeloTTSConfig tuned = config;
+        auto fill = [&](const char* key, auto& field, const auto& default_value, const auto& value) {
+            if (!config.is_set(key) && field == default_value) {
+                field = value;
+            } else if (field != value && kept) {
+                std::ostringstream note;
+                note << key << "=" << field << " (" << value << ")";
+                kept->push_back(note.str());
+            }
+        };
+        fill("encoder_backend", tuned.encoder_backend, defaults.encoder_backend, encoder_backend);
+        fill("decoder_backend", tuned.decoder_backend, defaults.decoder_backend, decoder_backend);
+        fill("encoder_threads", tuned.encoder_threads, defaults.encoder_threads, encoder_threads);
+        fill("decoder_threads", tuned.decoder_threads, defaults.decoder_threads, decoder_threads);
+        fill("dec_first_slice_frames", tuned.dec_first_slice_frames, defaults.dec_first_slice_frames, dec_first_slice_frames);
+        fill("dec_max_slice_frames", tuned.dec_max_slice_frames, defaults.dec_max_slice_frames, dec_max_slice_frames);
+        if (!tuned.validate()) {
+            if (kept) kept->clear();
+            return false;
+        }
+        config = tuned;
+        return true;
+    }
+};
+
+} // namespace melotts
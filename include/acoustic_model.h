@@ -1,27 +1,36 @@
-#pragma once
-
-#include <string>
-#include <vector>
-#include <map>
-
-namespace melotts {
-
-class AcousticModel {
-public:
-    AcousticModel(const std::string& model_path);
-    ~AcousticModel();
-
-    std::vector<float> forward(
-        const std::vector<std::string>& phonemes,
-        float speed,
-        int speaker_id);
-
-private:
-    void* env_;    // Ort::Env*
-    void* session_;  // Ort::Session*
-    std::vector<std::string> input_names_;
-    std::vector<std::string> output_names_;
-    std::map<std::string, int> phoneme_to_id_;
-};
-
-} // namespace melotts
\ No newline at end of file
+// acoustic_model.h - 声学模型接口
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "InferenceBackend.h"
+
+namespace melotts {
+
+// 输入依次为音素ID [1, N]、说话人ID [1]、语速 [1]，整数输入按模型声明的类型传入
+class AcousticModel {
+public:
+    explicit AcousticModel(const std::string& model_path, const std::string& backend = "onnxruntime");
+    ~AcousticModel();
+
+    // 禁用拷贝
+    AcousticModel(const AcousticModel&) = delete;
+    AcousticModel& operator=(const AcousticModel&) = delete;
+
+    // 前向推理, 输入音素序列, 输出声学特征
+    std::vector<float> forward(
+        const std::vector<std::string>& phonemes,
+        float speed = 1.0f,
+        int speaker_id = 0);
+
+private:
+    std::unique_ptr<InferenceBackend> backend_;
+    std::map<std::string, int> phoneme_to_id_;
+    std::vector<int64_t> ids64_;
+    std::vector<int32_t> ids32_;
+};
+
+} // namespace melotts
@@ -2,9 +2,12 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
 
 namespace melotts {
 
@@ -12,18 +15,86 @@ namespace melotts {
 struct MeloTTSConfig;
 class MeloTTSImpl;
 
+// 音素级时间戳（单位：秒），由声学模型输出的音素时长换算得到
+struct PhonemeTimestamp {
+    int phone_id = 0;       // 音素ID（插入的空白为0）
+    std::string phoneme;    // 音素符号
+    int word_index = -1;    // 所属词在words中的下标，不属于任何词时为-1
+    float start = 0.0f;
+    float end = 0.0f;
+};
+
+// 词级时间戳（单位：秒）
+struct WordTimestamp {
+    std::string word;
+    float start = 0.0f;
+    float end = 0.0f;
+};
+
+// 一次合成中单个阶段的耗时、CPU时间与内存统计（堆分配计数需以 MELOTTS_ALLOC_STATS 编译，否则为0）
+struct StageStats {
+    std::string name;
+    double ms = 0.0;
+    double cpu_ms = 0.0;          // 本阶段调用线程消耗的CPU时间
+    double process_cpu_ms = 0.0;  // 本阶段期间整个进程消耗的CPU时间，包括 ONNX Runtime 线程池；
+                                  // 同一进程中有其他请求并发时也包括它们的消耗
+    uint64_t allocs = 0;        // 本阶段调用线程上的堆分配次数
+    uint64_t alloc_bytes = 0;   // 本阶段调用线程上的堆分配字节数
+    size_t peak_rss_kb = 0;     // 阶段结束时进程的峰值RSS
+    size_t arena_bytes = 0;     // 阶段结束时推理后端内存池的占用
+    uint64_t count = 1;         // 统计覆盖的次数：单次为1，累计统计中为合成请求数
+};
+
+// 带时间戳的合成结果
+struct SynthesisResult {
+    std::vector<float> audio;
+    std::vector<PhonemeTimestamp> phonemes;
+    std::vector<WordTimestamp> words;
+    std::vector<StageStats> stages;   // 本次合成各阶段的统计，同 MeloTTS::last_stage_stats()
+};
+
+// 流式合成输出的音频块
+struct AudioChunk {
+    std::vector<float> audio;
+    size_t offset = 0;      // 本块首个采样点在整段音频中的位置
+    bool is_last = false;
+    std::vector<PhonemeTimestamp> phonemes;  // 起始时间落在本块内的音素
+    std::vector<WordTimestamp> words;        // 起始时间落在本块内的词
+};
+
+// 模型变体选择请求（变体清单见 MeloTTSConfig::variant_manifest）
+struct VariantRequest {
+    std::string variant;              // 直接指定变体名，空表示按下面两项自动选择
+    double latency_budget_ms = 0.0;   // 首包延迟预算（毫秒），0 表示不限
+    std::string quality_tier;         // 质量等级，空表示不限
+};
+
+// 流式合成回调
+using ChunkCallback = std::function<void(const AudioChunk&)>;
+
 // MeloTTS主类
 class MeloTTS {
 public:
     // 构造函数，需要指定模型目录
     MeloTTS(const std::string& model_dir);
     
+    // 构造函数，按完整配置加载模型（可选择量化模型、开启校准数据采集）
+    explicit MeloTTS(const MeloTTSConfig& config);
+    
     // 析构函数
     ~MeloTTS();
     
     // 合成语音，返回音频波形数据
     std::vector<float> synthesize(const std::string& text, const std::string& language = "zh");
     
+    // 合成语音，同时返回音素级和词级时间戳
+    SynthesisResult synthesize_with_timestamps(const std::string& text, const std::string& language = "zh");
+    
+    // 流式合成：每解码完一段即回调一次，时间戳随音频块一起输出
+    // 注意：流式输出的音频块不做整段归一化增强
+    void synthesize_stream(const std::string& text, const ChunkCallback& on_chunk,
+                           const std::string& language = "zh");
+    
     // 保存为WAV文件
     bool save_wav(const std::vector<float>& audio, const std::string& output_path, int sample_rate = 0);
     
@@ -42,6 +113,33 @@ public:
     // 设置完整配置
     void set_config(const MeloTTSConfig& config);
     
+    // 切换模型变体，之后的合成使用所选变体；已加载过的变体直接复用，变体缺失或加载失败时自动选择其他变体。
+    // 返回实际使用的变体名，没有清单或没有可用变体时返回空串（使用默认模型）
+    std::string select_variant(const VariantRequest& request);
+    
+    // 上一次合成各阶段（文本处理、声学模型、声码器、输出）的统计
+    std::vector<StageStats> last_stage_stats() const;
+    
+    // 本实例创建以来全部合成请求按阶段累计的统计：耗时、CPU时间和分配为总和，峰值RSS和内存池占用取最大值，
+    // count 为请求数。用于按实际CPU消耗做容量规划和计费
+    std::vector<StageStats> total_stage_stats() const;
+    
+    // 告知下一次合成请求在调用方队列中等待的时间（毫秒），用于慢请求日志（MeloTTSConfig::slow_request_ms），
+    // 合成后清零
+    void set_queue_wait(double ms);
+    
+    // 初始化各组件（词典、说话人嵌入、声学模型、声码器及原生引擎预热）的统计，最后一项为总耗时。
+    // 组件并行加载，各项耗时之和大于总耗时；之后切换到未加载过的模型变体时追加相应组件
+    std::vector<StageStats> init_stats() const;
+    
+    // 当前模型的标识：模型变体名，以及声学模型、声码器和说话人嵌入文件的文件名、大小和抽样内容摘要。
+    // 与模型所在目录无关，用于判断离线生成的缓存（如 PhraseBank 的预渲染片段）是否出自同一套模型
+    std::string model_identity() const;
+    
+    // 提前加载按需加载的组件（MeloTTSConfig::lazy_lexicon / defer_decoder）：
+    // 所列语言的词典模块和声码器，之后的首次合成不再承担加载耗时；组件已加载时不做任何事
+    void preload(const std::vector<std::string>& languages = {"zh", "en"});
+    
     // 模型诊断功能
     void diagnoseModels();
     
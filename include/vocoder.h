@@ -1,25 +1,30 @@
-// vocoder.h
-#pragma once
-#include <string>
-#include <vector>
-#include <onnxruntime_cxx_api.h>
-
-namespace melotts {
-
-class Vocoder {
-public:
-    Vocoder(const std::string& model_path);
-    ~Vocoder();
-    
-    std::vector<float> forward(const std::vector<float>& acoustic_features);
-    
-private:
-    Ort::Env m_ort_env;
-    Ort::Session* m_session = nullptr;
-    std::vector<std::string> m_input_names;
-    std::vector<std::string> m_output_names;
-    size_t m_input_count = 0;
-    size_t m_output_count = 0;
-};
-
-} // namespace melotts
\ No newline at end of file
+// vocoder.h - 声码器接口
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "InferenceBackend.h"
+
+namespace melotts {
+
+// 输入为声学特征 [1, 通道数, 帧数]，通道数取自模型元数据
+class Vocoder {
+public:
+    explicit Vocoder(const std::string& model_path, const std::string& backend = "onnxruntime");
+    ~Vocoder();
+
+    // 禁用拷贝
+    Vocoder(const Vocoder&) = delete;
+    Vocoder& operator=(const Vocoder&) = delete;
+
+    // 将声学特征转换为波形
+    std::vector<float> forward(const std::vector<float>& acoustic_features);
+
+private:
+    std::unique_ptr<InferenceBackend> backend_;
+    int64_t channels_ = 0;
+};
+
+} // namespace melotts
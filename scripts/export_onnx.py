@@ -4,16 +4,37 @@
 import os
 import sys
 import argparse
-import torch
-import torch.onnx
 import numpy as np
 import shutil
 
+# 只对已有 ONNX 模型做后处理时不需要 PyTorch
+try:
+    import torch
+    import torch.onnx
+except ImportError:
+    torch = None
+
 def parse_args():
     parser = argparse.ArgumentParser(description="导出 MeloTTS 模型到 ONNX 格式")
-    parser.add_argument("--input_dir", type=str, required=True, help="原始模型目录")
+    parser.add_argument("--input_dir", type=str, default=None,
+                        help="原始模型目录 (省略时只对 output_dir 中已有的 ONNX 模型做后处理)")
     parser.add_argument("--output_dir", type=str, required=True, help="ONNX 模型输出目录")
     parser.add_argument("--device", type=str, default="cpu", help="导出设备 (cpu 或 cuda)")
+    parser.add_argument("--dec_len", type=int, default=128, help="固定长度声码器的输入帧数")
+    parser.add_argument("--dynamic_decoder", action="store_true",
+                        help="导出时间轴为动态维度的声码器 (运行时按需选择每段长度，无需补零)")
+    parser.add_argument("--streaming_decoder", action="store_true",
+                        help="将 decoder.onnx 转换为带卷积缓存的有状态流式声码器 (需要动态时间轴)")
+    parser.add_argument("--fuse_decoder", action="store_true",
+                        help="将声码器中的 LeakyRelu+卷积(+残差)替换为融合算子 (运行时需加载 libmelotts_ops.so)")
+    parser.add_argument("--quantize", action="store_true",
+                        help="生成 int8 量化模型 encoder.int8.onnx / decoder.int8.onnx")
+    parser.add_argument("--calib_dir", type=str, default=None,
+                        help="校准数据目录 (melotts_cli --calib-dir 采集)，声码器静态量化及量化评估需要")
+    parser.add_argument("--calib_max_samples", type=int, default=200,
+                        help="每个模型最多使用的校准样本数")
+    parser.add_argument("--check_calib", action="store_true",
+                        help="校验 --calib_dir 中的样本能按模型声明的类型和形状送入 output_dir 中的模型")
     return parser.parse_args()
 
 def export_acoustic_model(model, output_path, device="cpu"):
@@ -91,11 +112,726 @@ def export_vocoder(model, output_path, device="cpu"):
     )
     print("声码器导出成功")
 
-def export_models(args):
-    """导出所有模型到 ONNX 格式"""
-    # 确保输出目录存在
-    os.makedirs(args.output_dir, exist_ok=True)
+def export_decoder(model, output_path, dec_len=128, dynamic=False, device="cpu"):
+    """导出声码器 (z_p, g -> audio) 到 ONNX 格式
+
+    输入输出与 C++ 运行时 features_to_waveform 一致：
+      z_p:   [1, 192, dec_len]  声学特征
+      g:     [1, 256, 1]        说话人嵌入
+      audio: [1, 1, samples]    波形
+    dynamic=True 时 z_p 的时间轴和 audio 的长度为动态维度。
+    """
+    print(f"导出声码器到 {output_path} ({'动态长度' if dynamic else f'固定长度 {dec_len} 帧'})...")
+    
+    model.eval()
+    
+    z_p = torch.zeros(1, 192, dec_len).to(device)
+    g = torch.zeros(1, 256, 1).to(device)
     
+    input_names = ["z_p", "g"]
+    output_names = ["audio"]
+    
+    dynamic_axes = None
+    if dynamic:
+        dynamic_axes = {
+            "z_p": {2: "frames"},
+            "audio": {2: "samples"}
+        }
+    
+    torch.onnx.export(
+        model,
+        (z_p, g),
+        output_path,
+        input_names=input_names,
+        output_names=output_names,
+        dynamic_axes=dynamic_axes,
+        opset_version=13,
+        verbose=False
+    )
+    print("声码器导出成功")
+
+# ==================== 有状态流式声码器 ====================
+#
+# 将声码器中沿时间轴的卷积改写为"左侧缓存 + 无padding卷积"：
+#   Conv:          Concat(cache_in, x) -> Conv(pads=0)，cache_out 为拼接结果的最后 (k-1)*d 帧
+#   ConvTranspose: 去掉 padding 与 bias 后做重叠相加，上一段的重叠尾部作为缓存
+# 对称 padding 的卷积因此变为因果卷积，输出相对原模型整体延迟若干采样点；
+# 并行分支 (残差、多核 ResBlock) 的延迟不同时插入延迟线对齐。
+# 所有缓存形状固定为 [1, C, D]，运行时在段间传递，初始为零 (等价于原模型的零填充)。
+# 运行时在末尾追加零帧把延迟部分冲刷出来；新增输入 stream_valid [1, 1, T] 标记每帧是否为真实输入
+# (冲刷帧为0)，按各张量的速率和延迟展开后在每个跨时间的卷积之前相乘，使两端都等价于原模型的零填充。
+# 输出延迟和每帧采样点数写入模型元数据 stream_delay_samples / stream_hop。
+#
+# 约定：随时间变化的张量布局为 [N, C, T]，时间轴为 2；不随时间变化的张量 (说话人嵌入 g
+# 及其派生量、常量) 不做处理。遇到会沿时间轴混合数据的其它算子时报错。
+
+STREAM_TIME_AXIS = 2
+STREAM_VALID_INPUT = "stream_valid"
+STREAM_INT_MAX = np.iinfo(np.int64).max
+
+# 逐点/逐元素算子：输出延迟取各输入的最大值
+STREAM_POINTWISE_OPS = {
+    "Add", "Sub", "Mul", "Div", "Pow", "Max", "Min", "Sum", "Mean", "Where",
+    "LeakyRelu", "Relu", "Tanh", "Sigmoid", "Exp", "Log", "Sqrt", "Neg", "Abs",
+    "Erf", "Softplus", "Elu", "Gelu", "Clip", "Cast", "Identity", "Sin", "Cos",
+    "Reciprocal", "Floor", "Ceil", "Round", "Sign",
+}
+
+def _stream_attr(node, name, default=None):
+    import onnx
+    for attr in node.attribute:
+        if attr.name == name:
+            return onnx.helper.get_attribute_value(attr)
+    return default
+
+class _StreamingRewriter:
+    """按拓扑顺序重写计算图，记录每个随时间变化张量的延迟 (采样点) 和速率 (每帧采样点数)"""
+
+    def __init__(self, model):
+        import onnx
+        from onnx import helper, numpy_helper, shape_inference
+        self.onnx = onnx
+        self.helper = helper
+        self.numpy_helper = numpy_helper
+
+        self.model = model
+        self.graph = model.graph
+        self.initializers = {init.name: init for init in self.graph.initializer}
+        self.constants = {}
+        for node in self.graph.node:
+            if node.op_type == "Constant":
+                self.constants[node.output[0]] = numpy_helper.to_array(_stream_attr(node, "value"))
+
+        # 推断通道数，用于确定缓存形状
+        self.channels = {}
+        inferred = shape_inference.infer_shapes(model)
+        for vi in list(inferred.graph.value_info) + list(inferred.graph.input) + list(inferred.graph.output):
+            dims = vi.type.tensor_type.shape.dim
+            if len(dims) == 3 and dims[1].HasField("dim_value"):
+                self.channels[vi.name] = dims[1].dim_value
+
+        self.delay = {}   # 张量名 -> 延迟 (以该张量自身的帧为单位)
+        self.rate = {}    # 张量名 -> 每个输入帧对应的帧数
+        self.nodes = []
+        self.new_inputs = []
+        self.new_outputs = []
+        self.new_initializers = []
+        self.delay_lines = {}
+        self.masked = {}
+        self.valid_by_rate = {}
+        self.time_input = None
+        self.cache_count = 0
+        self.name_count = 0
+
+    def _name(self, base):
+        self.name_count += 1
+        return f"{base}__stream{self.name_count}"
+
+    def _const_i64(self, values):
+        name = self._name("const")
+        self.new_initializers.append(
+            self.numpy_helper.from_array(np.array(values, dtype=np.int64), name))
+        return name
+
+    def _slice(self, x, start, end, axis=STREAM_TIME_AXIS):
+        out = self._name(x + "_slice")
+        self.nodes.append(self.helper.make_node(
+            "Slice", [x, self._const_i64([start]), self._const_i64([end]),
+                      self._const_i64([axis])], [out]))
+        return out
+
+    def _concat(self, a, b):
+        out = self._name(b + "_cat")
+        self.nodes.append(self.helper.make_node("Concat", [a, b], [out], axis=STREAM_TIME_AXIS))
+        return out
+
+    def _new_cache(self, channels, length):
+        """新增一对缓存输入/输出，形状 [1, C, D]"""
+        idx = self.cache_count
+        self.cache_count += 1
+        cache_in, cache_out = f"cache_in_{idx}", f"cache_out_{idx}"
+        tp = self.onnx.TensorProto.FLOAT
+        self.new_inputs.append(self.helper.make_tensor_value_info(cache_in, tp, [1, channels, length]))
+        self.new_outputs.append(self.helper.make_tensor_value_info(cache_out, tp, [1, channels, length]))
+        return cache_in, cache_out
+
+    def _channels_of(self, name):
+        if name not in self.channels:
+            raise RuntimeError(f"无法推断张量 {name} 的通道数，不能创建缓存")
+        return self.channels[name]
+
+    def _delay_line(self, x, frames):
+        """将张量 x 延迟 frames 帧，同一张量的相同延迟只创建一次"""
+        key = (x, frames)
+        if key in self.delay_lines:
+            return self.delay_lines[key]
+        channels = self._channels_of(x)
+        cache_in, cache_out = self._new_cache(channels, frames)
+        joined = self._concat(cache_in, x)
+        self.nodes.append(self.helper.make_node(
+            "Identity", [self._slice(joined, -frames, STREAM_INT_MAX)], [cache_out]))
+        out = self._slice(joined, 0, -frames)
+        self.channels[out] = channels
+        self.delay[out] = self.delay[x] + frames
+        self.rate[out] = self.rate[x]
+        self.delay_lines[key] = out
+        return out
+
+    def _valid_at_rate(self, rate):
+        """stream_valid 按速率展开 (每帧重复 rate 次)，同一速率只创建一次"""
+        if rate in self.valid_by_rate:
+            return self.valid_by_rate[rate]
+        column = self._name(STREAM_VALID_INPUT + "_col")
+        tiled = self._name(STREAM_VALID_INPUT + "_tiled")
+        out = self._name(STREAM_VALID_INPUT + f"_x{rate}")
+        self.nodes.append(self.helper.make_node(
+            "Reshape", [STREAM_VALID_INPUT, self._const_i64([1, 1, -1, 1])], [column]))
+        self.nodes.append(self.helper.make_node("Expand", [column, self._const_i64([1, 1, 1, rate])], [tiled]))
+        self.nodes.append(self.helper.make_node("Reshape", [tiled, self._const_i64([1, 1, -1])], [out]))
+        self.channels[out] = 1
+        self.delay[out] = 0
+        self.rate[out] = rate
+        self.valid_by_rate[rate] = out
+        return out
+
+    def _mask_edges(self, x):
+        """将 x 中对应原模型零填充位置的帧置零
+
+        原模型的每个卷积都对输入两端做零填充；流式模型中延迟 D 帧的张量，其前 D 帧对应原模型的
+        负时刻，末尾冲刷帧之后的部分对应原模型输入结束之后，数值都不为零 (例如偏置、说话人条件)。
+        将 stream_valid 按 x 的速率展开、经同样的延迟线得到掩码，在跨时间的卷积之前相乘，
+        使流式输出 (含冲刷出的末尾) 与原模型逐点一致。
+        """
+        if x == self.time_input:
+            return x   # 冲刷帧本身为零
+        if x in self.masked:
+            return self.masked[x]
+
+        mask = self._valid_at_rate(self.rate[x])
+        if self.delay[x] > 0:
+            mask = self._delay_line(mask, self.delay[x])
+
+        out = self._name(x + "_masked")
+        self.nodes.append(self.helper.make_node("Mul", [x, mask], [out]))
+        self.channels[out] = self.channels.get(x)
+        self.delay[out] = self.delay[x]
+        self.rate[out] = self.rate[x]
+        self.masked[x] = out
+        return out
+
+    def _is_time_varying(self, name):
+        return name in self.delay
+
+    def _conv(self, node):
+        x, w = node.input[0], node.input[1]
+        if w not in self.initializers:
+            raise RuntimeError(f"Conv {node.name} 的权重不是常量")
+        weight = self.numpy_helper.to_array(self.initializers[w])
+        if weight.ndim != 3:
+            raise RuntimeError(f"Conv {node.name} 不是一维卷积")
+        if _stream_attr(node, "auto_pad", b"NOTSET") not in (b"NOTSET", "NOTSET"):
+            raise RuntimeError(f"Conv {node.name} 使用了 auto_pad")
+        if list(_stream_attr(node, "strides", [1])) != [1]:
+            raise RuntimeError(f"Conv {node.name} 的步长不为1")
+
+        kernel = weight.shape[2]
+        dilation = list(_stream_attr(node, "dilations", [1]))[0]
+        pad_left = list(_stream_attr(node, "pads", [0, 0]))[0]
+        group = _stream_attr(node, "group", 1)
+        context = (kernel - 1) * dilation
+
+        if context == 0:
+            self.nodes.append(node)
+            self.delay[node.output[0]] = self.delay[x]
+            self.rate[node.output[0]] = self.rate[x]
+            return
+
+        cache_in, cache_out = self._new_cache(weight.shape[1] * group, context)
+        joined = self._concat(cache_in, self._mask_edges(x))
+        self.nodes.append(self.helper.make_node(
+            "Identity", [self._slice(joined, -context, STREAM_INT_MAX)], [cache_out]))
+
+        attrs = {a.name: self.helper.get_attribute_value(a) for a in node.attribute}
+        attrs["pads"] = [0, 0]
+        self.nodes.append(self.helper.make_node(
+            "Conv", [joined] + list(node.input[1:]), list(node.output), name=node.name, **attrs))
+        self.channels.setdefault(node.output[0], weight.shape[0])
+        self.delay[node.output[0]] = self.delay[x] + (context - pad_left)
+        self.rate[node.output[0]] = self.rate[x]
+
+    def _conv_transpose(self, node):
+        x, w = node.input[0], node.input[1]
+        if w not in self.initializers:
+            raise RuntimeError(f"ConvTranspose {node.name} 的权重不是常量")
+        weight = self.numpy_helper.to_array(self.initializers[w])
+        if weight.ndim != 3:
+            raise RuntimeError(f"ConvTranspose {node.name} 不是一维反卷积")
+        if list(_stream_attr(node, "dilations", [1])) != [1] or _stream_attr(node, "output_shape") \
+                or any(_stream_attr(node, "output_padding", [0])):
+            raise RuntimeError(f"ConvTranspose {node.name} 使用了不支持的属性")
+
+        group = _stream_attr(node, "group", 1)
+        stride = list(_stream_attr(node, "strides", [1]))[0]
+        kernel = weight.shape[2]
+        pad_left = list(_stream_attr(node, "pads", [0, 0]))[0]
+        overlap = kernel - stride
+        channels = weight.shape[1] * group
+        if overlap < 0 or overlap > stride:
+            raise RuntimeError(f"ConvTranspose {node.name} 的卷积核长度需在 [stride, 2*stride] 之间")
+
+        # 不带 padding 和 bias 的完整反卷积，长度 (T-1)*stride + kernel
+        full = self._name(node.output[0] + "_full")
+        self.nodes.append(self.helper.make_node(
+            "ConvTranspose", [self._mask_edges(x), w], [full], name=node.name,
+            strides=[stride], pads=[0, 0], group=group, kernel_shape=[kernel]))
+
+        emit = full
+        if overlap > 0:
+            cache_in, cache_out = self._new_cache(channels, overlap)
+            head = self._slice(full, 0, overlap)
+            rest = self._slice(full, overlap, STREAM_INT_MAX)
+            head_sum = self._name(node.output[0] + "_overlap")
+            self.nodes.append(self.helper.make_node("Add", [head, cache_in], [head_sum]))
+            joined = self._concat(head_sum, rest)
+            self.nodes.append(self.helper.make_node(
+                "Identity", [self._slice(joined, -overlap, STREAM_INT_MAX)], [cache_out]))
+            emit = self._slice(joined, 0, -overlap)
+
+        # 偏置在重叠相加之后只加一次
+        if len(node.input) > 2 and node.input[2]:
+            bias = self.numpy_helper.to_array(self.initializers[node.input[2]]).reshape(1, -1, 1)
+            bias_name = self._name(node.input[2])
+            self.new_initializers.append(self.numpy_helper.from_array(bias.astype(np.float32), bias_name))
+            self.nodes.append(self.helper.make_node("Add", [emit, bias_name], [node.output[0]]))
+        else:
+            self.nodes.append(self.helper.make_node("Identity", [emit], [node.output[0]]))
+
+        self.channels.setdefault(node.output[0], channels)
+        self.delay[node.output[0]] = self.delay[x] * stride + pad_left
+        self.rate[node.output[0]] = self.rate[x] * stride
+
+    def _check_axis(self, node, axis, rank=3):
+        if axis is not None and axis % rank == STREAM_TIME_AXIS:
+            raise RuntimeError(f"{node.op_type} {node.name} 沿时间轴操作，无法转换为流式")
+
+    def _channel_op(self, node, varying):
+        """沿通道轴的 Concat/Split/Slice/Softmax 等算子"""
+        op = node.op_type
+        if op in ("Concat", "Split", "Softmax", "LogSoftmax", "Gather"):
+            self._check_axis(node, _stream_attr(node, "axis", 1 if op != "Softmax" else -1))
+        elif op == "Slice":
+            if len(node.input) < 4:
+                raise RuntimeError(f"Slice {node.name} 未指定 axes")
+            axes_name = node.input[3]
+            axes = self.constants.get(axes_name)
+            if axes is None and axes_name in self.initializers:
+                axes = self.numpy_helper.to_array(self.initializers[axes_name])
+            if axes is None:
+                raise RuntimeError(f"Slice {node.name} 的 axes 不是常量")
+            for axis in np.atleast_1d(axes):
+                self._check_axis(node, int(axis))
+        elif op in ("ReduceMean", "ReduceSum", "ReduceMax"):
+            axes = _stream_attr(node, "axes")
+            if axes is None:
+                raise RuntimeError(f"{op} {node.name} 未指定 axes")
+            for axis in axes:
+                self._check_axis(node, axis)
+        else:
+            raise RuntimeError(f"不支持流式转换的算子: {op} ({node.name})")
+        self._align_and_append(node, varying)
+
+    def _align_and_append(self, node, varying):
+        """对齐各随时间变化输入的延迟后追加节点"""
+        rates = {self.rate[name] for name in varying}
+        if len(rates) > 1:
+            raise RuntimeError(f"{node.op_type} {node.name} 的输入时间分辨率不一致")
+        target = max(self.delay[name] for name in varying)
+        inputs = list(node.input)
+        for i, name in enumerate(inputs):
+            if name in varying and self.delay[name] < target:
+                inputs[i] = self._delay_line(name, target - self.delay[name])
+        del node.input[:]
+        node.input.extend(inputs)
+        self.nodes.append(node)
+        for out in node.output:
+            self.delay[out] = target
+            self.rate[out] = self.rate[varying[0]]
+
+    def run(self, time_input):
+        self.time_input = time_input
+        self.delay[time_input] = 0
+        self.rate[time_input] = 1
+        # stream_valid 的时间轴与 time_input 使用同一个动态维度
+        valid = self.helper.make_tensor_value_info(STREAM_VALID_INPUT, self.onnx.TensorProto.FLOAT, [1, 1, 1])
+        valid.type.tensor_type.shape.dim[STREAM_TIME_AXIS].CopyFrom(
+            next(vi for vi in self.graph.input if vi.name == time_input).type.tensor_type.shape.dim[STREAM_TIME_AXIS])
+        self.new_inputs.append(valid)
+
+        for original in self.graph.node:
+            node = self.onnx.NodeProto()
+            node.CopyFrom(original)
+            varying = [name for name in node.input if self._is_time_varying(name)]
+            if not varying:
+                self.nodes.append(node)
+                continue
+            if node.op_type == "Conv" and node.input[0] in self.delay:
+                self._conv(node)
+            elif node.op_type == "ConvTranspose" and node.input[0] in self.delay:
+                self._conv_transpose(node)
+            elif node.op_type in STREAM_POINTWISE_OPS:
+                self._align_and_append(node, varying)
+            else:
+                self._channel_op(node, varying)
+
+        del self.graph.node[:]
+        self.graph.node.extend(self.nodes)
+        self.graph.initializer.extend(self.new_initializers)
+        self.graph.input.extend(self.new_inputs)
+        self.graph.output.extend(self.new_outputs)
+        del self.graph.value_info[:]
+
+def make_streaming_decoder(input_path, output_path):
+    """将 decoder.onnx 转换为有状态流式声码器"""
+    import onnx
+    print(f"转换有状态流式声码器: {input_path} -> {output_path}")
+
+    model = onnx.load(input_path)
+    time_input = model.graph.input[0].name
+    audio_output = model.graph.output[0].name
+
+    # 时间轴需为动态维度
+    for vi in (model.graph.input[0], model.graph.output[0]):
+        dim = vi.type.tensor_type.shape.dim[STREAM_TIME_AXIS]
+        if dim.HasField("dim_value"):
+            raise RuntimeError(f"{vi.name} 的时间轴为固定长度，请先用 --dynamic_decoder 导出")
+
+    rewriter = _StreamingRewriter(model)
+    rewriter.run(time_input)
+
+    delay = int(rewriter.delay[audio_output])
+    hop = int(rewriter.rate[audio_output])
+    onnx.helper.set_model_props(model, {
+        "stream_delay_samples": str(delay),
+        "stream_hop": str(hop),
+    })
+    onnx.checker.check_model(model)
+    onnx.save(model, output_path)
+    print(f"流式声码器转换成功: {rewriter.cache_count} 个缓存, 延迟 {delay} 采样点, 每帧 {hop} 采样点")
+    return delay, hop
+
+# ==================== 融合算子 ====================
+#
+# HiFi-GAN 声码器的上采样块为 LeakyRelu -> ConvTranspose，残差块为 LeakyRelu -> Conv (-> Add 残差)。
+# 将其替换为 libmelotts_ops.so (src/melotts_ops.cpp) 中的融合算子，省去中间张量和逐节点调度开销：
+#   LeakyReluConv(X, W, B[, R])          属性 alpha, dilation, pads
+#   LeakyReluConvTranspose(X, W, B[, R]) 属性 alpha, stride, pads, output_padding
+# 只改写一维、group 为 1、padding 显式给出的卷积；其余节点保持不变。
+# 流式声码器和量化声码器的卷积前分别有缓存拼接和反量化节点，不会被匹配。
+
+FUSED_OPS_DOMAIN = "melotts.ops"
+
+def fuse_decoder(input_path, output_path):
+    """将声码器中的 LeakyRelu + 卷积 (+ 残差 Add) 替换为融合算子，返回替换的节点数"""
+    import onnx
+    from onnx import helper, numpy_helper
+    print(f"融合声码器算子: {input_path} -> {output_path}")
+
+    model = onnx.load(input_path)
+    graph = model.graph
+    initializers = {init.name: init for init in graph.initializer}
+    graph_outputs = {o.name for o in graph.output}
+
+    producers = {}
+    consumers = {}
+    for node in graph.node:
+        for out in node.output:
+            producers[out] = node
+        for inp in node.input:
+            consumers.setdefault(inp, []).append(node)
+
+    def attr(node, name, default=None):
+        return _stream_attr(node, name, default)
+
+    replaced = {}   # 被替换节点的 id -> 新节点 (None 表示删除)
+    fused = 0
+    for node in graph.node:
+        if node.op_type not in ("Conv", "ConvTranspose") or id(node) in replaced:
+            continue
+        act = producers.get(node.input[0])
+        weight = initializers.get(node.input[1])
+        if act is None or act.op_type != "LeakyRelu" or weight is None or len(weight.dims) != 3:
+            continue
+        if attr(node, "group", 1) != 1 or attr(node, "auto_pad", b"NOTSET") not in (b"NOTSET", "NOTSET"):
+            continue
+        pads = list(attr(node, "pads", [0, 0]))
+        strides = list(attr(node, "strides", [1]))
+        dilations = list(attr(node, "dilations", [1]))
+
+        attrs = {"alpha": float(attr(act, "alpha", 0.01)), "pads": pads}
+        if node.op_type == "Conv":
+            if strides != [1]:
+                continue
+            op_type = "LeakyReluConv"
+            attrs["dilation"] = dilations[0]
+            out_channels = weight.dims[0]
+        else:
+            if dilations != [1] or attr(node, "output_shape") is not None:
+                continue
+            op_type = "LeakyReluConvTranspose"
+            attrs["stride"] = strides[0]
+            attrs["output_padding"] = list(attr(node, "output_padding", [0]))[0]
+            out_channels = weight.dims[1]
+
+        # 偏置为必需输入，原节点没有时补零
+        if len(node.input) > 2 and node.input[2]:
+            bias = node.input[2]
+        else:
+            bias = node.name + "_zero_bias"
+            graph.initializer.append(numpy_helper.from_array(np.zeros(out_channels, dtype=np.float32), bias))
+
+        # 卷积输出只被一个 Add 使用时，把另一个加数作为残差融合进来
+        inputs = [act.input[0], node.input[1], bias]
+        output = node.output[0]
+        anchor = node
+        users = consumers.get(output, [])
+        if len(users) == 1 and users[0].op_type == "Add" and output not in graph_outputs:
+            add = users[0]
+            inputs.append(add.input[1] if add.input[0] == output else add.input[0])
+            output = add.output[0]
+            replaced[id(node)] = None
+            anchor = add
+
+        fused_node = helper.make_node(op_type, inputs, [output], name=node.name + "_fused",
+                                      domain=FUSED_OPS_DOMAIN, **attrs)
+        replaced[id(anchor)] = fused_node
+        if anchor is not node:
+            replaced[id(node)] = None
+
+        # LeakyRelu 不再被其他节点使用时删除
+        consumers[act.output[0]] = [c for c in consumers[act.output[0]] if c is not node]
+        if not consumers[act.output[0]] and act.output[0] not in graph_outputs:
+            replaced[id(act)] = None
+        fused += 1
+
+    # 新节点放在被替换节点的位置 (残差融合时为 Add 的位置)，保持拓扑序
+    nodes = []
+    for node in graph.node:
+        if id(node) not in replaced:
+            nodes.append(node)
+        elif replaced[id(node)] is not None:
+            nodes.append(replaced[id(node)])
+    del graph.node[:]
+    graph.node.extend(nodes)
+
+    if not any(op.domain == FUSED_OPS_DOMAIN for op in model.opset_import):
+        model.opset_import.append(helper.make_opsetid(FUSED_OPS_DOMAIN, 1))
+    onnx.save(model, output_path)
+    print(f"融合完成: 替换 {fused} 个卷积")
+    return fused
+
+# ==================== 量化 ====================
+#
+# 声学模型以 MatMul/Gather 为主，做动态量化：权重 int8，激活在运行时按实际范围量化，不需要校准数据。
+# 声码器以卷积为主，做静态量化 (QDQ 格式，激活 uint8、权重按通道 int8)：激活的量化参数由校准数据确定。
+# 校准数据由 C++ 引擎在真实文本上采集：
+#   melotts_cli -m models --calib-dir calib -tf texts.txt
+# 目录结构为 calib/<encoder|decoder>/<样本序号>/<输入名>.npy，声码器样本即运行时的每一段输入
+# (含流式缓存)。量化后用同一批样本对比 fp32 与 int8 模型的输出，报告信噪比和推理耗时。
+
+# 声学模型中噪声比例输入的位置 (模型声明的输入顺序，推理后端按此顺序接收输入)，评估时置零以去除随机性
+ENCODER_NOISE_INPUTS = (4, 5)
+
+def load_calibration_samples(calib_dir, model, max_samples=None):
+    """读取某个模型的校准样本，每个样本为 {输入名: 数组}"""
+    model_dir = os.path.join(calib_dir, model)
+    if not os.path.isdir(model_dir):
+        return []
+
+    samples = []
+    for name in sorted(os.listdir(model_dir)):
+        sample_dir = os.path.join(model_dir, name)
+        if not os.path.isdir(sample_dir):
+            continue
+        samples.append({os.path.splitext(f)[0]: np.load(os.path.join(sample_dir, f))
+                        for f in os.listdir(sample_dir) if f.endswith(".npy")})
+        if max_samples and len(samples) >= max_samples:
+            break
+    return samples
+
+def _model_inputs(model_path):
+    """模型声明的输入 [(名称, numpy类型, 形状)]，动态维度为 None"""
+    import onnx
+    from onnx import helper
+    graph = onnx.load(model_path, load_external_data=False).graph
+    initializers = {init.name for init in graph.initializer}
+    inputs = []
+    for value in graph.input:
+        if value.name in initializers:
+            continue
+        tensor_type = value.type.tensor_type
+        shape = [d.dim_value if d.HasField("dim_value") else None for d in tensor_type.shape.dim]
+        inputs.append((value.name, np.dtype(helper.tensor_dtype_to_np_dtype(tensor_type.elem_type)), shape))
+    return inputs
+
+def _check_samples(samples, model_path):
+    """校准样本须包含模型的全部输入，且类型、维数和固定维度与模型声明一致；返回输入名列表"""
+    inputs = _model_inputs(model_path)
+    for i, sample in enumerate(samples):
+        missing = [name for name, _, _ in inputs if name not in sample]
+        if missing:
+            raise RuntimeError(f"校准样本 #{i} 缺少 {model_path} 的输入: {', '.join(missing)}")
+        for name, dtype, shape in inputs:
+            array = sample[name]
+            if array.dtype != dtype:
+                raise RuntimeError(f"校准样本 #{i} 的输入 {name} 类型为 {array.dtype}，{model_path} 声明为 {dtype}")
+            if array.ndim != len(shape) or any(d is not None and d != a for d, a in zip(shape, array.shape)):
+                declared = "[" + ", ".join("?" if d is None else str(d) for d in shape) + "]"
+                raise RuntimeError(f"校准样本 #{i} 的输入 {name} 形状为 {list(array.shape)}，"
+                                   f"{model_path} 声明为 {declared}")
+    return [name for name, _, _ in inputs]
+
+def _snr_db(ref, test):
+    noise = float(np.sum((ref.astype(np.float64) - test) ** 2))
+    signal = float(np.sum(ref.astype(np.float64) ** 2))
+    return 10.0 * np.log10(max(signal, 1e-20) / max(noise, 1e-20))
+
+def evaluate_quantized(fp32_path, int8_path, samples, zero_inputs=()):
+    """用校准样本对比 fp32 与 int8 模型的主输出，返回 (平均SNR, 最小SNR, 加速比)"""
+    import time
+    import onnxruntime as ort
+
+    opts = ort.SessionOptions()
+    opts.intra_op_num_threads = 1
+    ref_sess = ort.InferenceSession(fp32_path, opts, providers=["CPUExecutionProvider"])
+    q_sess = ort.InferenceSession(int8_path, opts, providers=["CPUExecutionProvider"])
+
+    input_names = _check_samples(samples, fp32_path)
+    # 主输出：第一个非缓存输出
+    output_name = next(o.name for o in ref_sess.get_outputs() if not o.name.startswith("cache_out_"))
+
+    snrs = []
+    mismatched = 0
+    ref_time = q_time = 0.0
+    for sample in samples:
+        feeds = {n: sample[n] for n in input_names}
+        for idx in zero_inputs:
+            if idx < len(input_names):
+                feeds[input_names[idx]] = np.zeros_like(feeds[input_names[idx]])
+
+        t0 = time.perf_counter()
+        ref = ref_sess.run([output_name], feeds)[0]
+        t1 = time.perf_counter()
+        out = q_sess.run([output_name], feeds)[0]
+        t2 = time.perf_counter()
+        ref_time += t1 - t0
+        q_time += t2 - t1
+
+        if ref.shape != out.shape:
+            mismatched += 1
+            continue
+        snrs.append(_snr_db(ref, out))
+
+    if mismatched:
+        print(f"  {mismatched} 个样本的输出形状不一致 (量化改变了音素时长)")
+    if not snrs:
+        return None, None, ref_time / max(q_time, 1e-9)
+    return float(np.mean(snrs)), float(np.min(snrs)), ref_time / max(q_time, 1e-9)
+
+def _report(name, result, num_samples):
+    mean_snr, min_snr, speedup = result
+    if mean_snr is None:
+        print(f"{name} 量化评估: 无可比较的样本, 加速比 {speedup:.2f}x")
+    else:
+        print(f"{name} 量化评估 ({num_samples} 个样本): 平均 SNR {mean_snr:.1f} dB, "
+              f"最低 {min_snr:.1f} dB, 加速比 {speedup:.2f}x")
+
+def quantize_encoder(input_path, output_path, samples=None):
+    """动态量化声学模型"""
+    from onnxruntime.quantization import quantize_dynamic, QuantType
+    print(f"动态量化声学模型: {input_path} -> {output_path}")
+
+    quantize_dynamic(input_path, output_path, weight_type=QuantType.QInt8)
+    if samples:
+        _report("声学模型", evaluate_quantized(input_path, output_path, samples, ENCODER_NOISE_INPUTS), len(samples))
+
+def quantize_decoder(input_path, output_path, samples):
+    """按校准数据静态量化声码器"""
+    from onnxruntime.quantization import (quantize_static, CalibrationDataReader,
+                                          CalibrationMethod, QuantFormat, QuantType)
+    print(f"静态量化声码器: {input_path} -> {output_path} ({len(samples)} 个校准样本)")
+
+    input_names = _check_samples(samples, input_path)
+
+    class _Reader(CalibrationDataReader):
+        def __init__(self):
+            self.rewind()
+
+        def get_next(self):
+            sample = next(self.samples, None)
+            return None if sample is None else {n: sample[n] for n in input_names}
+
+        def rewind(self):
+            self.samples = iter(samples)
+
+    quantize_static(input_path, output_path, _Reader(),
+                    quant_format=QuantFormat.QDQ,
+                    per_channel=True,
+                    activation_type=QuantType.QUInt8,
+                    weight_type=QuantType.QInt8,
+                    calibrate_method=CalibrationMethod.MinMax)
+    _report("声码器", evaluate_quantized(input_path, output_path, samples), len(samples))
+
+def quantize_models(args):
+    """生成 int8 模型，运行时以 encoder_precision / decoder_precision = "int8" 选用"""
+    encoder_path = os.path.join(args.output_dir, "encoder.onnx")
+    decoder_path = os.path.join(args.output_dir, "decoder.onnx")
+
+    encoder_samples, decoder_samples = [], []
+    if args.calib_dir:
+        encoder_samples = load_calibration_samples(args.calib_dir, "encoder", args.calib_max_samples)
+        decoder_samples = load_calibration_samples(args.calib_dir, "decoder", args.calib_max_samples)
+
+    if os.path.exists(encoder_path):
+        quantize_encoder(encoder_path, os.path.join(args.output_dir, "encoder.int8.onnx"), encoder_samples)
+    else:
+        print(f"警告: 声学模型未找到: {encoder_path}")
+
+    if not os.path.exists(decoder_path):
+        print(f"警告: 声码器模型未找到: {decoder_path}")
+    elif not decoder_samples:
+        print("警告: 没有声码器校准数据 (--calib_dir)，跳过声码器量化")
+    else:
+        quantize_decoder(decoder_path, os.path.join(args.output_dir, "decoder.int8.onnx"), decoder_samples)
+
+def check_calibration(args):
+    """校验校准数据能原样送入 output_dir 中的模型：逐个样本检查输入类型和形状，并用 onnxruntime 运行一遍"""
+    import onnxruntime as ort
+    if not args.calib_dir:
+        raise RuntimeError("--check_calib 需要 --calib_dir")
+
+    checked = 0
+    for model in ("encoder", "decoder"):
+        model_path = os.path.join(args.output_dir, model + ".onnx")
+        samples = load_calibration_samples(args.calib_dir, model, args.calib_max_samples)
+        if not samples:
+            continue
+        if not os.path.exists(model_path):
+            raise RuntimeError(f"有 {model} 校准数据但模型未找到: {model_path}")
+        input_names = _check_samples(samples, model_path)
+        sess = ort.InferenceSession(model_path, providers=["CPUExecutionProvider"])
+        for sample in samples:
+            sess.run(None, {n: sample[n] for n in input_names})
+        print(f"{model} 校准数据: {len(samples)} 个样本与 {model_path} 一致")
+        checked += len(samples)
+    if not checked:
+        raise RuntimeError(f"校准数据目录中没有样本: {args.calib_dir}")
+
+def export_torch_models(args):
+    """从 PyTorch 模型导出所有 ONNX 模型"""
+    if torch is None:
+        print("错误: 导出 PyTorch 模型需要安装 torch")
+        return False
+
     # 将原始代码目录添加到系统路径
     sys.path.append(os.path.abspath(args.input_dir))
     
@@ -139,6 +875,25 @@ def export_models(args):
         else:
             print(f"警告: 声码器模型未找到: {vocoder_path}")
         
+        # 加载 z_p -> 波形 的声码器 (运行时使用的 decoder.onnx)
+        decoder_path = os.path.join(args.input_dir, "decoder.pt")
+        if os.path.exists(decoder_path):
+            try:
+                from models.decoder import Decoder
+            except ImportError:
+                from decoder import Decoder
+            decoder = Decoder.from_pretrained(decoder_path)
+            decoder.to(device)
+            export_decoder(
+                decoder,
+                os.path.join(args.output_dir, "decoder.onnx"),
+                args.dec_len,
+                args.dynamic_decoder,
+                device
+            )
+        else:
+            print(f"警告: 声码器模型未找到: {decoder_path}")
+        
         # 复制其他必要文件
         for file_name in ["lexicon.txt", "phonemes.txt"]:
             src_path = os.path.join(args.input_dir, file_name)
@@ -156,6 +911,54 @@ def export_models(args):
     
     return True
 
+def export_models(args):
+    """导出所有模型到 ONNX 格式"""
+    # 确保输出目录存在
+    os.makedirs(args.output_dir, exist_ok=True)
+
+    if args.input_dir is not None and not export_torch_models(args):
+        return False
+
+    if args.streaming_decoder:
+        decoder_path = os.path.join(args.output_dir, "decoder.onnx")
+        if not os.path.exists(decoder_path):
+            print(f"错误: 声码器模型未找到: {decoder_path}")
+            return False
+        try:
+            make_streaming_decoder(decoder_path, decoder_path)
+        except Exception as e:
+            print(f"转换流式声码器时出错: {str(e)}")
+            return False
+
+    if args.check_calib:
+        try:
+            check_calibration(args)
+        except Exception as e:
+            print(f"校验校准数据时出错: {str(e)}")
+            return False
+
+    # 量化放在流式转换之后，int8 模型保留缓存输入输出
+    if args.quantize:
+        try:
+            quantize_models(args)
+        except Exception as e:
+            print(f"量化模型时出错: {str(e)}")
+            return False
+
+    # 融合放在量化之后：量化需要用 onnxruntime 运行原始声码器做校准
+    if args.fuse_decoder:
+        decoder_path = os.path.join(args.output_dir, "decoder.onnx")
+        if not os.path.exists(decoder_path):
+            print(f"错误: 声码器模型未找到: {decoder_path}")
+            return False
+        try:
+            fuse_decoder(decoder_path, decoder_path)
+        except Exception as e:
+            print(f"融合声码器算子时出错: {str(e)}")
+            return False
+
+    return True
+
 if __name__ == "__main__":
     args = parse_args()
     if export_models(args):
@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+# 生成合成的小模型集 (encoder.onnx / decoder.onnx / lexicon.txt / tokens.txt / g.bin)
+#
+# 模型结构仿照 MeloTTS (VITS)，输入输出与 C++ 运行时完全一致，但权重为固定种子的随机数、尺寸只有几百KB，
+# 输出的"语音"没有意义。用于在没有真实模型的机器上运行完整流程、基准测试和并发测试：
+#   encoder.onnx  phone/tone/language int32 [N] (--int64_inputs 时为 int64), g [1,256,1], noise_scale/noise_scale_w/length_scale/sdp_ratio [1]
+#                 -> z_p [1,192,T], pronoun_lens int64 [N], audio_len int32 [1]
+#   decoder.onnx  z_p [1,192,frames], g [1,256,1] -> audio [1,1,frames*512]  (时间轴为动态维度)
+# 声学模型中的"噪声"由位置确定的低差异序列代替，同一输入在任何机器、任何后端上的输出都相同。
+# 生成的 decoder.onnx 可继续用 export_onnx.py --streaming_decoder / --fuse_decoder / --quantize 处理。
+
+import os
+import sys
+import argparse
+import numpy as np
+
+try:
+    import onnx
+    from onnx import helper, numpy_helper, TensorProto
+except ImportError:
+    print("需要安装 onnx: pip install onnx")
+    sys.exit(1)
+
+ZH_INITIALS = ["b", "p", "m", "f", "d", "t", "n", "l", "g", "k", "h",
+               "j", "q", "x", "zh", "ch", "sh", "r", "z", "c", "s", "y", "w"]
+ZH_FINALS = ["a", "o", "e", "i", "u", "v", "ai", "ei", "ao", "ou", "an", "en", "ang", "eng", "ong",
+             "ia", "ie", "iao", "iu", "ian", "in", "iang", "ing", "iong", "ua", "uo", "uai", "ui", "uan", "un"]
+PUNCTUATIONS = [",", ".", "!", "?", "…", "'", "-"]
+EN_WORDS = [
+    "a", "an", "and", "are", "as", "at", "be", "by", "call", "calling", "can", "customer", "day", "do", "for",
+    "from", "good", "have", "hello", "help", "how", "i", "in", "is", "it", "me", "morning", "my", "no", "not",
+    "of", "on", "one", "or", "please", "press", "service", "thank", "that", "the", "this", "to", "today", "two",
+    "we", "weather", "welcome", "what", "will", "with", "yes", "you", "your", "zero",
+]
+
+NUM_TONES = 16
+NUM_LANGUAGES = 8
+SPEAKER_DIM = 256
+HOP = 512
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="生成用于测试和基准的合成 MeloTTS 小模型集")
+    parser.add_argument("--output_dir", type=str, required=True, help="输出目录")
+    parser.add_argument("--seed", type=int, default=0, help="权重随机数种子")
+    parser.add_argument("--hidden", type=int, default=32, help="声学模型隐层通道数")
+    parser.add_argument("--layers", type=int, default=2, help="声学模型注意力层数")
+    parser.add_argument("--channels", type=int, default=192, help="声学特征 z_p 的通道数")
+    parser.add_argument("--decoder_channels", type=int, default=32, help="声码器首层通道数 (每次上采样减半)")
+    parser.add_argument("--speakers", type=int, default=4, help="g.bin 中的说话人数")
+    parser.add_argument("--int64_inputs", action="store_true",
+                        help="声学模型的音素/声调/语言ID输入声明为 int64 (默认 int32)")
+    return parser.parse_args()
+
+
+class GraphBuilder:
+    """按顺序追加节点和权重的简单图构建器，权重按 1/sqrt(fan_in) 缩放"""
+
+    def __init__(self, seed):
+        self.nodes = []
+        self.initializers = []
+        self.count = 0
+        self.rng = np.random.default_rng(seed)
+
+    def name(self, prefix):
+        self.count += 1
+        return f"{prefix}_{self.count}"
+
+    def const(self, value, dtype):
+        name = self.name("c")
+        self.initializers.append(numpy_helper.from_array(np.asarray(value, dtype=dtype), name))
+        return name
+
+    def i64(self, value):
+        return self.const(value, np.int64)
+
+    def f32(self, value):
+        return self.const(value, np.float32)
+
+    def weight(self, *shape, scale=None):
+        fan_in = int(np.prod(shape[1:])) if len(shape) > 1 else shape[0]
+        s = scale if scale is not None else 1.0 / np.sqrt(fan_in)
+        return self.f32(self.rng.standard_normal(shape) * s)
+
+    def op(self, op_type, inputs, n_out=1, output=None, **attrs):
+        outputs = [output] if output else [self.name(op_type) for _ in range(n_out)]
+        self.nodes.append(helper.make_node(op_type, inputs, outputs, **attrs))
+        return outputs[0] if n_out == 1 else outputs
+
+    def conv(self, x, cin, cout, k=1, dilation=1):
+        pad = dilation * (k - 1) // 2
+        return self.op("Conv", [x, self.weight(cout, cin, k), self.weight(cout, scale=0.1)],
+                       pads=[pad, pad], dilations=[dilation])
+
+    def conv_transpose(self, x, cin, cout, stride):
+        k = stride * 2
+        return self.op("ConvTranspose", [x, self.weight(cin, cout, k), self.weight(cout, scale=0.1)],
+                       strides=[stride], pads=[stride // 2, stride // 2])
+
+    def layer_norm(self, x, channels):
+        xt = self.op("Transpose", [x], perm=[0, 2, 1])
+        gamma = self.f32(1.0 + 0.1 * self.rng.standard_normal(channels))
+        beta = self.f32(0.1 * self.rng.standard_normal(channels))
+        y = self.op("LayerNormalization", [xt, gamma, beta], axis=-1, epsilon=1e-5)
+        return self.op("Transpose", [y], perm=[0, 2, 1])
+
+    def pseudo_noise(self, channels, length):
+        """形状为 [1,channels,length] 的确定性伪噪声 (length 为 int64 标量)，均值0、方差约1。
+        取 R2 低差异序列 frac(t*a + c*b) 映射到 [-sqrt(3), sqrt(3)]"""
+        t = self.op("Cast", [self.op("Range", [self.i64(0), length, self.i64(1)])], to=TensorProto.FLOAT)
+        c = self.f32((np.arange(channels, dtype=np.float32) * 0.5698403).reshape(1, channels, 1))
+        x = self.op("Add", [self.op("Mul", [t, self.f32(0.7548777)]), c])
+        frac = self.op("Sub", [x, self.op("Floor", [x])])
+        return self.op("Mul", [self.op("Sub", [frac, self.f32(0.5)]), self.f32(2.0 * np.sqrt(3.0))])
+
+    def save(self, path, graph_name, inputs, outputs):
+        graph = helper.make_graph(self.nodes, graph_name, inputs, outputs, self.initializers)
+        model = helper.make_model(graph, opset_imports=[helper.make_opsetid("", 17)])
+        model.ir_version = 9
+        onnx.checker.check_model(model)
+        onnx.save(model, path)
+        return os.path.getsize(path)
+
+
+def attention(b, x, hidden, heads, n, window=4):
+    """带相对位置编码的多头自注意力 (VITS 文本编码器结构)，x: [1,hidden,N]，n: [1] int64"""
+    dk = hidden // heads
+
+    def split_heads(t):
+        t = b.op("Reshape", [t, b.op("Concat", [b.i64([1, heads, dk]), n], axis=0)])
+        return b.op("Transpose", [t], perm=[0, 1, 3, 2])   # [1,h,N,dk]
+
+    q = split_heads(b.conv(x, hidden, hidden))
+    k = split_heads(b.conv(x, hidden, hidden))
+    v = split_heads(b.conv(x, hidden, hidden))
+    q = b.op("Div", [q, b.f32(np.sqrt(dk))])
+    scores = b.op("MatMul", [q, b.op("Transpose", [k], perm=[0, 1, 3, 2])])
+
+    # 相对位置键向量 [1, 2w+1, dk] 补零/截取为 [1, 2N-1, dk]
+    emb = b.weight(1, 2 * window + 1, dk, scale=0.3)
+    n_s = b.op("Squeeze", [n, b.i64([0])])
+    pad_len = b.op("Max", [b.op("Sub", [n_s, b.i64(window + 1)]), b.i64(0)])
+    start = b.op("Max", [b.op("Sub", [b.i64(window + 1), n_s]), b.i64(0)])
+    end = b.op("Add", [start, b.op("Sub", [b.op("Mul", [n_s, b.i64(2)]), b.i64(1)])])
+    pl = b.op("Unsqueeze", [pad_len, b.i64([0])])
+    emb = b.op("Pad", [emb, b.op("Concat", [b.i64([0]), pl, b.i64([0, 0]), pl, b.i64([0])], axis=0)])
+    rel = b.op("Slice", [emb, b.op("Unsqueeze", [start, b.i64([0])]), b.op("Unsqueeze", [end, b.i64([0])]),
+                         b.i64([1])])
+    rel = b.op("Unsqueeze", [b.op("Transpose", [rel], perm=[0, 2, 1]), b.i64([0])])
+    rel_logits = b.op("MatMul", [q, rel])                                          # [1,h,N,2N-1]
+
+    # 相对位置 -> 绝对位置
+    x1 = b.op("Pad", [rel_logits, b.i64([0, 0, 0, 0, 0, 0, 0, 1])])
+    two_n = b.op("Mul", [n, b.i64([2])])
+    flat = b.op("Reshape", [x1, b.op("Concat", [b.i64([1, heads]), b.op("Mul", [n, two_n])], axis=0)])
+    nm1 = b.op("Sub", [n, b.i64([1])])
+    flat = b.op("Pad", [flat, b.op("Concat", [b.i64([0, 0, 0, 0, 0]), nm1], axis=0)])
+    full = b.op("Reshape", [flat, b.op("Concat", [b.i64([1, heads]), b.op("Add", [n, b.i64([1])]),
+                                                  b.op("Sub", [two_n, b.i64([1])])], axis=0)])
+    rel_abs = b.op("Slice", [full, b.op("Concat", [b.i64([0]), nm1], axis=0),
+                             b.op("Concat", [n, b.op("Add", [nm1, n])], axis=0), b.i64([2, 3])])
+
+    p = b.op("Softmax", [b.op("Add", [scores, rel_abs])], axis=-1)
+    o = b.op("Transpose", [b.op("MatMul", [p, v])], perm=[0, 1, 3, 2])          # [1,h,dk,N]
+    o = b.op("Reshape", [o, b.op("Concat", [b.i64([1, hidden]), n], axis=0)])
+    return b.conv(o, hidden, hidden)
+
+
+def build_encoder(path, vocab, seed, hidden, layers, channels, heads=2, seq_type=TensorProto.INT32):
+    b = GraphBuilder(seed)
+    inputs = [helper.make_tensor_value_info(name, seq_type, ["phoneme_length"])
+              for name in ("phone", "tone", "language")]
+    inputs.append(helper.make_tensor_value_info("g", TensorProto.FLOAT, [1, SPEAKER_DIM, 1]))
+    for name in ("noise_scale", "noise_scale_w", "length_scale", "sdp_ratio"):
+        inputs.append(helper.make_tensor_value_info(name, TensorProto.FLOAT, [1]))
+
+    # 文本编码器：音素/声调/语言嵌入相加，若干层自注意力 + 前馈
+    x = b.op("Gather", [b.weight(vocab, hidden, scale=0.5), b.op("Cast", ["phone"], to=TensorProto.INT64)], axis=0)
+    x = b.op("Add", [x, b.op("Gather", [b.weight(NUM_TONES, hidden, scale=0.5), "tone"], axis=0)])
+    x = b.op("Add", [x, b.op("Gather", [b.weight(NUM_LANGUAGES, hidden, scale=0.5), "language"], axis=0)])
+    x = b.op("Mul", [x, b.f32(np.sqrt(hidden))])
+    x = b.op("Transpose", [b.op("Unsqueeze", [x, b.i64([0])])], perm=[0, 2, 1])          # [1,H,N]
+    n = b.op("Slice", [b.op("Shape", [x]), b.i64([2]), b.i64([3])])                        # [1]
+    for _ in range(layers):
+        x = b.layer_norm(b.op("Add", [x, attention(b, x, hidden, heads, n)]), hidden)
+        y = b.op("Relu", [b.conv(x, hidden, hidden * 2, k=3)])
+        x = b.layer_norm(b.op("Add", [x, b.conv(y, hidden * 2, hidden, k=3)]), hidden)
+    m_p, logs_p = b.op("Split", [b.conv(x, hidden, channels * 2), b.i64([channels, channels])], n_out=2, axis=1)
+    logs_p = b.op("Mul", [logs_p, b.f32(0.2)])
+
+    # 时长预测：确定性预测器和随机预测器按 sdp_ratio 混合 (每个音素约10帧)
+    xd = b.op("Add", [x, b.conv("g", SPEAKER_DIM, hidden)])
+    logw_dp = b.op("Add", [b.conv(b.op("Relu", [b.conv(xd, hidden, hidden, k=3)]), hidden, 1), b.f32(1.5)])
+    noise_w = b.op("Mul", [b.pseudo_noise(2, b.op("Squeeze", [n, b.i64([0])])), "noise_scale_w"])
+    s = b.conv(b.op("Concat", [xd, noise_w], axis=1), hidden + 2, hidden, k=3, dilation=2)
+    s = b.op("Mul", [b.op("Tanh", [s]), b.op("Sigmoid", [b.conv(xd, hidden, hidden)])])
+    logw_sdp = b.op("Add", [b.conv(s, hidden, 1), b.f32(1.5)])
+    logw = b.op("Add", [b.op("Mul", [logw_sdp, "sdp_ratio"]),
+                        b.op("Mul", [logw_dp, b.op("Sub", [b.f32(1.0), "sdp_ratio"])])])
+    w_ceil = b.op("Ceil", [b.op("Mul", [b.op("Exp", [logw]), "length_scale"])])           # [1,1,N]
+    y_len = b.op("Clip", [b.op("ReduceSum", [w_ceil], keepdims=0), b.f32(1.0)])
+    y_len_i = b.op("Cast", [y_len], to=TensorProto.INT64)
+
+    # 按时长展开为帧 (对齐矩阵 [1,N,T])
+    cum = b.op("Transpose", [b.op("CumSum", [w_ceil, b.i64(2)])], perm=[0, 2, 1])
+    prev = b.op("Sub", [cum, b.op("Transpose", [w_ceil], perm=[0, 2, 1])])
+    t = b.op("Cast", [b.op("Range", [b.i64(0), y_len_i, b.i64(1)])], to=TensorProto.FLOAT)
+    attn = b.op("Cast", [b.op("And", [b.op("Less", [t, cum]), b.op("Not", [b.op("Less", [t, prev])])])],
+                to=TensorProto.FLOAT)
+    m = b.op("MatMul", [m_p, attn])
+    logs = b.op("MatMul", [logs_p, attn])
+    noise = b.op("Mul", [b.op("Mul", [b.pseudo_noise(channels, y_len_i), b.op("Exp", [logs])]), "noise_scale"])
+    z = b.op("Add", [m, noise])
+
+    # 一层反向仿射耦合 + 通道翻转 (flow)
+    half = channels // 2
+    z0, z1 = b.op("Split", [z, b.i64([half, half])], n_out=2, axis=1)
+    h = b.op("Add", [b.conv(z0, half, hidden), b.conv("g", SPEAKER_DIM, hidden)])
+    h = b.op("Mul", [b.op("Tanh", [b.conv(h, hidden, hidden, k=5)]), b.op("Sigmoid", [b.conv(h, hidden, hidden, k=5)])])
+    z = b.op("Concat", [z0, b.op("Sub", [z1, b.conv(h, hidden, half)])], axis=1)
+    b.op("Slice", [z, b.i64([-1]), b.i64([-(2 ** 62)]), b.i64([1]), b.i64([-1])], output="z_p")
+
+    b.op("Cast", [b.op("Squeeze", [w_ceil, b.i64([0, 1])])], output="pronoun_lens", to=TensorProto.INT64)
+    b.op("Cast", [b.op("Unsqueeze", [b.op("Mul", [y_len, b.f32(HOP)]), b.i64([0])])],
+         output="audio_len", to=TensorProto.INT32)
+
+    outputs = [helper.make_tensor_value_info("z_p", TensorProto.FLOAT, [1, channels, "output_length"]),
+               helper.make_tensor_value_info("pronoun_lens", TensorProto.INT64, ["phoneme_length"]),
+               helper.make_tensor_value_info("audio_len", TensorProto.INT32, [1])]
+    return b.save(path, "encoder", inputs, outputs)
+
+
+def build_decoder(path, seed, channels, base_channels):
+    """HiFi-GAN 结构的声码器：3次8倍上采样 (每帧512个采样点)，每次上采样后接一个空洞卷积残差块"""
+    b = GraphBuilder(seed + 1)
+    inputs = [helper.make_tensor_value_info("z_p", TensorProto.FLOAT, [1, channels, "frames"]),
+              helper.make_tensor_value_info("g", TensorProto.FLOAT, [1, SPEAKER_DIM, 1])]
+
+    x = b.op("Add", [b.conv("z_p", channels, base_channels, k=7), b.conv("g", SPEAKER_DIM, base_channels)])
+    c = base_channels
+    for _ in range(3):
+        x = b.conv_transpose(b.op("LeakyRelu", [x], alpha=0.1), c, c // 2, 8)
+        c //= 2
+        for dilation in (1, 3):
+            y = b.conv(b.op("LeakyRelu", [x], alpha=0.1), c, c, k=3, dilation=dilation)
+            x = b.op("Add", [x, y])
+    x = b.conv(b.op("LeakyRelu", [x], alpha=0.01), c, 1, k=7)
+    b.op("Tanh", [x], output="audio")
+
+    outputs = [helper.make_tensor_value_info("audio", TensorProto.FLOAT, [1, 1, "samples"])]
+    return b.save(path, "decoder", inputs, outputs)
+
+
+def common_hanzi():
+    """GB2312 一级汉字 (3755个常用字)"""
+    chars = []
+    for hi in range(0xB0, 0xD8):
+        for lo in range(0xA1, 0xFF):
+            if hi == 0xD7 and lo > 0xF9:
+                break
+            chars.append(bytes([hi, lo]).decode("gb2312"))
+    return chars
+
+
+def write_lexicon(output_dir):
+    """音素表和词典：汉字按序号分配声母+韵母+声调，英文单词按字母拼读。返回音素数"""
+    tokens = ["_", "UNK"]
+    for t in ZH_INITIALS + ZH_FINALS + PUNCTUATIONS + [chr(c) for c in range(ord("a"), ord("z") + 1)]:
+        if t not in tokens:
+            tokens.append(t)
+    with open(os.path.join(output_dir, "tokens.txt"), "w", encoding="utf-8") as f:
+        for i, t in enumerate(tokens):
+            f.write(f"{t} {i}\n")
+
+    hanzi = common_hanzi()
+    with open(os.path.join(output_dir, "lexicon.txt"), "w", encoding="utf-8") as f:
+        for k, ch in enumerate(hanzi):
+            initial = ZH_INITIALS[k % len(ZH_INITIALS)]
+            final = ZH_FINALS[(k // len(ZH_INITIALS)) % len(ZH_FINALS)]
+            f.write(f"{ch} {initial} {final}{k % 5 + 1}\n")
+        for word in EN_WORDS:
+            f.write(word + "".join(" " + c for c in word) + "\n")
+    print(f"词典: {len(hanzi)} 个汉字, {len(EN_WORDS)} 个英文单词; 音素表: {len(tokens)} 个音素")
+    return len(tokens)
+
+
+def write_speakers(path, speakers, seed):
+    rng = np.random.default_rng(seed + 2)
+    g = (rng.standard_normal((speakers, SPEAKER_DIM)) * 0.1).astype(np.float32)
+    g.tofile(path)
+
+
+def generate(args):
+    os.makedirs(args.output_dir, exist_ok=True)
+    vocab = write_lexicon(args.output_dir)
+    write_speakers(os.path.join(args.output_dir, "g.bin"), args.speakers, args.seed)
+    print(f"说话人嵌入: {args.speakers} 个")
+
+    size = build_encoder(os.path.join(args.output_dir, "encoder.onnx"), vocab, args.seed,
+                         args.hidden, args.layers, args.channels,
+                         seq_type=TensorProto.INT64 if args.int64_inputs else TensorProto.INT32)
+    print(f"声学模型: encoder.onnx ({size // 1024} KB{', int64 输入' if args.int64_inputs else ''})")
+    size = build_decoder(os.path.join(args.output_dir, "decoder.onnx"), args.seed,
+                         args.channels, args.decoder_channels)
+    print(f"声码器: decoder.onnx ({size // 1024} KB, 每帧 {HOP} 个采样点)")
+
+
+if __name__ == "__main__":
+    args = parse_args()
+    if args.hidden % 2 or args.channels % 2 or args.decoder_channels % 8:
+        print("错误: hidden 和 channels 须为偶数，decoder_channels 须为8的倍数")
+        sys.exit(1)
+    generate(args)
+    print(f"\n合成模型已保存到: {args.output_dir}")
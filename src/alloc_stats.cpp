@@ -0,0 +1,112 @@
+// alloc_stats.cpp - 堆分配计数钩子、RSS 与 CPU 时间读取
+//
+// 以 MELOTTS_ALLOC_STATS 编译时替换全局 operator new / delete，按线程累计分配次数和字节数；
+// 替换对整个进程生效（包括 ONNX Runtime 中经 operator new 的分配）。未定义时只提供 RSS 读取，计数恒为0。
+
+#include "AllocStats.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace melotts {
+
+#ifdef MELOTTS_ALLOC_STATS
+namespace {
+thread_local uint64_t t_alloc_count = 0;
+thread_local uint64_t t_alloc_bytes = 0;
+
+void* CountedAlloc(size_t size) noexcept {
+    t_alloc_count++;
+    t_alloc_bytes += size;
+    return std::malloc(size ? size : 1);
+}
+} // namespace
+#endif
+
+bool AllocStatsEnabled() {
+#ifdef MELOTTS_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocCounters ThreadAllocCounters() {
+    AllocCounters counters;
+#ifdef MELOTTS_ALLOC_STATS
+    counters.count = t_alloc_count;
+    counters.bytes = t_alloc_bytes;
+#endif
+    return counters;
+}
+
+size_t PeakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(usage.ru_maxrss);   // Linux 上单位为KB
+}
+
+size_t CurrentRssKb() {
+    FILE* fp = std::fopen("/proc/self/statm", "r");
+    if (!fp) {
+        return 0;
+    }
+    unsigned long size = 0, resident = 0;
+    int n = std::fscanf(fp, "%lu %lu", &size, &resident);
+    std::fclose(fp);
+    if (n != 2) {
+        return 0;
+    }
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+static double ReadCpuClockMs(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return 0.0;
+    }
+    return static_cast<double>(ts.tv_sec) * 1000.0 + static_cast<double>(ts.tv_nsec) / 1.0e6;
+}
+
+double ThreadCpuMs() {
+    return ReadCpuClockMs(CLOCK_THREAD_CPUTIME_ID);
+}
+
+double ProcessCpuMs() {
+    return ReadCpuClockMs(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+} // namespace melotts
+
+#ifdef MELOTTS_ALLOC_STATS
+void* operator new(size_t size) {
+    if (void* p = melotts::CountedAlloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = melotts::CountedAlloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return melotts::CountedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return melotts::CountedAlloc(size); }
+
+// 不内联，否则 GCC 会把内联后的 free 与调用方的 new 配对误报 -Wmismatched-new-delete
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#endif
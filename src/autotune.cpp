@@ -0,0 +1,256 @@
+// autotune.cpp - 安装时调优工具
+//
+// 用法: melotts_autotune -m <模型目录> [-c 语料文件] [-l 语言] [-n 运行次数] [-o 输出文件]
+// 先探测主机（核数、SIMD指令集、缓存大小），再在语料上逐项调整后端、声学模型/声码器线程数和声码器分段长度：
+// 每次只改一项、其余取当前最优，新取值比当前最优快3%以上才采用，避免测量抖动带来的误选。
+// 首段长度按首包延迟比较，其余各项按语料的总合成耗时比较。
+// 结果写到 <模型目录>/tuning_profile.txt，MeloTTS 启动时自动读取。
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "melotts.h"
+#include "MeloTTSConfig.h"
+#include "TuningProfile.hpp"
+
+using melotts::HostInfo;
+using melotts::MeloTTSConfig;
+using melotts::TuningProfile;
+
+// 语料文件不存在时使用的内置语料，覆盖短句、中等长度和长句
+static const char* kDefaultCorpusZh[] = {
+    "你好。",
+    "今天天气不错，我们一起去公园散步吧。",
+    "欢迎致电客户服务中心，查询账户余额请按一，办理业务请按二，人工服务请按零。",
+    "语音合成系统把输入的文本转换为音素序列，再由声学模型预测每个音素的时长和声学特征，"
+    "最后由声码器生成波形，整个过程需要在很短的时间内完成，才能满足实时交互的要求。",
+};
+
+static const char* kDefaultCorpusEn[] = {
+    "Hello.",
+    "The weather is nice today, let us take a walk in the park.",
+    "Thank you for calling customer service, press one for your balance or zero for an operator.",
+    "A text to speech system converts the input text into phonemes, predicts their durations and acoustic "
+    "features, and finally generates the waveform with a vocoder in a fraction of real time.",
+};
+
+struct Measurement {
+    bool ok = false;
+    double total_ms = 0.0;        // 语料合成总耗时（各轮中位数）
+    double first_chunk_ms = 0.0;  // 平均首包延迟（各轮中位数）
+    double audio_sec = 0.0;       // 语料音频总时长
+};
+
+// 一项可调设置：候选取值、写入配置的方法，以及比较首包延迟还是总耗时
+struct Knob {
+    std::string name;
+    std::vector<int> values;
+    std::function<void(MeloTTSConfig&, int)> apply;
+    std::function<std::string(int)> label;
+    bool latency;
+};
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+// 按配置加载模型，预热一句后在语料上运行 runs 轮
+static Measurement measure(const MeloTTSConfig& config, const std::vector<std::string>& corpus, int runs) {
+    Measurement m;
+    try {
+        melotts::MeloTTS tts(config);
+        tts.synthesize(corpus[0], config.language);
+
+        std::vector<double> totals, firsts;
+        for (int r = 0; r < runs; r++) {
+            double total = 0.0, first_sum = 0.0;
+            size_t samples = 0;
+            for (const auto& text : corpus) {
+                auto start = std::chrono::steady_clock::now();
+                double first = -1.0;
+                tts.synthesize_stream(text, [&](const melotts::AudioChunk& chunk) {
+                    if (first < 0.0) {
+                        first = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    }
+                    samples += chunk.audio.size();
+                }, config.language);
+                total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                first_sum += std::max(0.0, first);
+            }
+            totals.push_back(total);
+            firsts.push_back(first_sum / corpus.size());
+            m.audio_sec = static_cast<double>(samples) / config.sample_rate;
+        }
+        m.total_ms = median(totals);
+        m.first_chunk_ms = median(firsts);
+        m.ok = true;
+    } catch (const std::exception& e) {
+        std::cerr << "  测量失败: " << e.what() << std::endl;
+    }
+    return m;
+}
+
+static void print_usage(const char* program_name) {
+    std::cout << "用法: " << program_name << " [选项]" << std::endl;
+    std::cout << "选项:" << std::endl;
+    std::cout << "  -m, --model-dir DIR    模型目录 (默认: ./models)" << std::endl;
+    std::cout << "  -c, --corpus FILE      调优语料，每行一句 (默认: 内置语料)" << std::endl;
+    std::cout << "  -l, --language LANG    语言代码: zh 或 en (默认: zh)" << std::endl;
+    std::cout << "  -n, --runs N           每个取值的运行轮数，取中位数 (默认: 3)" << std::endl;
+    std::cout << "  -o, --output FILE      调优配置输出路径 (默认: <模型目录>/tuning_profile.txt)" << std::endl;
+    std::cout << "  -h, --help             显示此帮助信息" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string model_dir = "./models";
+    std::string corpus_file;
+    std::string language = "zh";
+    std::string output_file;
+    int runs = 3;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-m" || arg == "--model-dir") {
+            if (i + 1 < argc) model_dir = argv[++i];
+        } else if (arg == "-c" || arg == "--corpus") {
+            if (i + 1 < argc) corpus_file = argv[++i];
+        } else if (arg == "-l" || arg == "--language") {
+            if (i + 1 < argc) language = argv[++i];
+        } else if (arg == "-n" || arg == "--runs") {
+            if (i + 1 < argc) runs = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "-o" || arg == "--output") {
+            if (i + 1 < argc) output_file = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "未知选项: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (output_file.empty()) {
+        output_file = model_dir + "/tuning_profile.txt";
+    }
+
+    std::vector<std::string> corpus;
+    if (!corpus_file.empty()) {
+        std::ifstream in(corpus_file);
+        if (!in) {
+            std::cerr << "无法打开语料文件: " << corpus_file << std::endl;
+            return 1;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty()) corpus.push_back(line);
+        }
+    } else if (language == "en") {
+        corpus.assign(std::begin(kDefaultCorpusEn), std::end(kDefaultCorpusEn));
+    } else {
+        corpus.assign(std::begin(kDefaultCorpusZh), std::end(kDefaultCorpusZh));
+    }
+    if (corpus.empty()) {
+        std::cerr << "语料为空" << std::endl;
+        return 1;
+    }
+
+    HostInfo host = HostInfo::Probe();
+    host.Print();
+
+    // 线程数候选: 1, 2, 4, ... 直到物理核数
+    std::vector<int> threads;
+    for (int t = 1; t < host.physical_cores; t *= 2) threads.push_back(t);
+    threads.push_back(host.physical_cores);
+
+    const char* backends[2] = {"onnxruntime", "native"};
+    auto backend_label = [&backends](int v) { return std::string(backends[v]); };
+    auto int_label = [](int v) { return std::to_string(v); };
+    std::vector<Knob> knobs = {
+        {"声学模型后端", {0, 1}, [&backends](MeloTTSConfig& c, int v) { c.encoder_backend = backends[v]; }, backend_label, false},
+        {"声码器后端", {0, 1}, [&backends](MeloTTSConfig& c, int v) { c.decoder_backend = backends[v]; }, backend_label, false},
+        {"声学模型线程数", threads, [](MeloTTSConfig& c, int v) { c.encoder_threads = v; }, int_label, false},
+        {"声码器线程数", threads, [](MeloTTSConfig& c, int v) { c.decoder_threads = v; }, int_label, false},
+        {"声码器最大分段帧数", {64, 128, 256, 512},
+         [](MeloTTSConfig& c, int v) {
+             c.dec_max_slice_frames = v;
+             c.dec_first_slice_frames = std::min(c.dec_first_slice_frames, v);
+         }, int_label, false},
+        {"声码器首段帧数", {8, 16, 32, 64},
+         [](MeloTTSConfig& c, int v) { c.dec_first_slice_frames = std::min(v, c.dec_max_slice_frames); }, int_label, true},
+    };
+
+    // 调优时不读取已有的调优配置和变体清单
+    MeloTTSConfig best;
+    best.model_dir = model_dir;
+    best.language = language;
+    best.verbose = false;
+    best.tuning_profile.clear();
+    best.variant_manifest.clear();
+    best.encoder_threads = threads.back();
+    best.decoder_threads = threads.back();
+
+    std::cout << "\n基准配置测量 (" << corpus.size() << " 句, " << runs << " 轮)..." << std::endl;
+    Measurement baseline = measure(best, corpus, runs);
+    if (!baseline.ok) {
+        std::cerr << "基准配置无法运行，请检查模型目录: " << model_dir << std::endl;
+        return 1;
+    }
+    Measurement current = baseline;
+    std::cout << "  总耗时 " << baseline.total_ms << " ms, 首包 " << baseline.first_chunk_ms << " ms" << std::endl;
+
+    std::vector<std::string> notes;
+    for (const auto& knob : knobs) {
+        std::cout << "\n调整" << knob.name << ":" << std::endl;
+        std::string chosen;
+        for (int value : knob.values) {
+            MeloTTSConfig candidate = best;
+            knob.apply(candidate, value);
+            if (!candidate.validate()) continue;
+
+            Measurement m = measure(candidate, corpus, runs);
+            if (!m.ok) continue;
+            std::cout << "  " << knob.label(value) << ": 总耗时 " << m.total_ms << " ms, 首包 "
+                      << m.first_chunk_ms << " ms" << std::endl;
+
+            double score = knob.latency ? m.first_chunk_ms : m.total_ms;
+            double best_score = knob.latency ? current.first_chunk_ms : current.total_ms;
+            if (score < best_score * 0.97) {
+                best = candidate;
+                current = m;
+                chosen = knob.label(value);
+            }
+        }
+        std::cout << "  -> " << (chosen.empty() ? "保持不变" : chosen) << std::endl;
+        if (!chosen.empty()) {
+            notes.push_back(knob.name + ": " + chosen);
+        }
+    }
+
+    std::ostringstream summary;
+    summary << "语料 " << corpus.size() << " 句, 音频 " << current.audio_sec << " 秒; 总耗时 "
+            << baseline.total_ms << " -> " << current.total_ms << " ms, 首包 " << baseline.first_chunk_ms
+            << " -> " << current.first_chunk_ms << " ms";
+    notes.insert(notes.begin(), summary.str());
+
+    try {
+        TuningProfile::FromConfig(best, host).Save(output_file, host, notes);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "\n" << summary.str() << std::endl;
+    if (current.audio_sec > 0.0) {
+        std::cout << "实时率: " << current.total_ms / 1000.0 / current.audio_sec << std::endl;
+    }
+    std::cout << "调优配置已保存到: " << output_file << std::endl;
+    return 0;
+}
@@ -0,0 +1,427 @@
+// equivalence.cpp - 优化路径的数值等价性回归检查
+//
+// 用法: melotts_equivalence -m <模型目录> [--ref 键=值 ...] [--cand 键=值 ...] [选项]
+// 用参考配置和候选配置分别合成同一组固定语料，逐句比较输出波形：最大绝对误差、信噪比（以参考为信号）、
+// 对数谱距离，以及两者的合成耗时和加速比。任一句超出阈值时返回2，可直接作为测试门禁。
+// 键=值 与 MeloTTSConfig 的字段同名，另有 stream=1 表示用 synthesize_stream 合成并拼接各块。
+// 默认把 noise_scale / noise_scale_w 置0，使声学模型的随机采样不影响结果；默认关闭音频增强（归一化和噪声门），
+// 比较的是声码器的原始输出，与流式合成拼接的结果可直接对比，需要覆盖后处理时设 enhance_audio=1。
+// 两种配置都不读取调优配置和变体清单。
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "melotts.h"
+#include "MeloTTSConfig.h"
+
+using melotts::MeloTTSConfig;
+
+// 固定语料：由短到长，覆盖单句、带标点的长句和多分句
+static const char* kCorpusZh[] = {
+    "你好。",
+    "今天天气不错，我们一起去公园散步吧。",
+    "欢迎致电客户服务中心，查询账户余额请按一，办理业务请按二，人工服务请按零。",
+    "您的订单已经发货，预计三天内送达，请保持电话畅通。",
+    "语音合成系统把输入的文本转换为音素序列，再由声学模型预测每个音素的时长和声学特征，"
+    "最后由声码器生成波形，整个过程需要在很短的时间内完成，才能满足实时交互的要求。",
+};
+
+static const char* kCorpusEn[] = {
+    "Hello.",
+    "The weather is nice today, let us take a walk in the park.",
+    "Thank you for calling customer service, press one for your balance or zero for an operator.",
+    "A text to speech system converts the input text into phonemes, predicts their durations and acoustic "
+    "features, and finally generates the waveform with a vocoder in a fraction of real time.",
+};
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// 合成期间屏蔽 std::cout（词典和模型加载的日志），表格照常输出
+class ScopedSilence {
+public:
+    ScopedSilence() : out_(std::cout.rdbuf(&null_)) {}
+    ~ScopedSilence() { std::cout.rdbuf(out_); }
+
+private:
+    NullBuffer null_;
+    std::streambuf* out_;
+};
+
+// 一种被比较的配置
+struct Side {
+    MeloTTSConfig config;
+    bool stream = false;
+    std::unique_ptr<melotts::MeloTTS> tts;
+};
+
+struct Thresholds {
+    double max_abs = 0.0;    // 0 表示不检查
+    double min_snr = 30.0;   // dB
+    double max_lsd = 1.0;    // dB
+};
+
+struct Metrics {
+    double max_abs = 0.0;
+    double snr = 0.0;        // 完全一致时为无穷大
+    double lsd = 0.0;
+    bool length_match = true;
+};
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+static std::string pad(const std::string& text, size_t width) {
+    size_t display = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if ((c & 0xC0) == 0x80) continue;
+        display += c >= 0xE0 ? 2 : 1;
+    }
+    return text + std::string(display < width ? width - display : 1, ' ');
+}
+
+static std::string format(double value, int precision) {
+    if (std::isinf(value)) return "inf";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision) << value;
+    return oss.str();
+}
+
+// 原地基2 FFT，长度须为2的幂
+static void fft(std::vector<std::complex<double>>& a) {
+    const size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const double angle = -2.0 * M_PI / static_cast<double>(len);
+        const std::complex<double> wlen(std::cos(angle), std::sin(angle));
+        for (size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1.0, 0.0);
+            for (size_t k = 0; k < len / 2; k++) {
+                std::complex<double> u = a[i + k];
+                std::complex<double> v = a[i + k + len / 2] * w;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+                w *= wlen;
+            }
+        }
+    }
+}
+
+// 各帧（Hann 窗，1024点，跳步256）的功率谱，单位 dB，下限 -100 dB
+static std::vector<std::vector<double>> log_power_spectrogram(const std::vector<float>& audio, size_t length) {
+    const size_t n_fft = 1024, hop = 256;
+    std::vector<double> window(n_fft);
+    for (size_t i = 0; i < n_fft; i++) {
+        window[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * static_cast<double>(i) / n_fft);
+    }
+
+    std::vector<std::vector<double>> frames;
+    std::vector<std::complex<double>> buf(n_fft);
+    for (size_t start = 0; start + n_fft <= std::max(length, n_fft); start += hop) {
+        for (size_t i = 0; i < n_fft; i++) {
+            double x = start + i < length ? audio[start + i] : 0.0;
+            buf[i] = std::complex<double>(x * window[i], 0.0);
+        }
+        fft(buf);
+        std::vector<double> power(n_fft / 2 + 1);
+        for (size_t k = 0; k < power.size(); k++) {
+            power[k] = 10.0 * std::log10(std::norm(buf[k]) + 1e-10);
+        }
+        frames.push_back(std::move(power));
+    }
+    return frames;
+}
+
+// 按两者的公共长度计算各项误差
+static Metrics compare(const std::vector<float>& ref, const std::vector<float>& cand) {
+    Metrics m;
+    const size_t n = std::min(ref.size(), cand.size());
+    m.length_match = ref.size() == cand.size();
+
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double d = static_cast<double>(cand[i]) - ref[i];
+        m.max_abs = std::max(m.max_abs, std::fabs(d));
+        signal += static_cast<double>(ref[i]) * ref[i];
+        noise += d * d;
+    }
+    m.snr = noise > 0.0 ? 10.0 * std::log10(std::max(signal, 1e-20) / noise) : std::numeric_limits<double>::infinity();
+
+    auto a = log_power_spectrogram(ref, n);
+    auto b = log_power_spectrogram(cand, n);
+    double sum = 0.0;
+    for (size_t f = 0; f < a.size(); f++) {
+        double sq = 0.0;
+        for (size_t k = 0; k < a[f].size(); k++) {
+            double d = a[f][k] - b[f][k];
+            sq += d * d;
+        }
+        sum += std::sqrt(sq / a[f].size());
+    }
+    m.lsd = a.empty() ? 0.0 : sum / a.size();
+    return m;
+}
+
+// 合成一句，返回耗时（毫秒）
+static double render(Side& side, const std::string& text, std::vector<float>& audio) {
+    ScopedSilence silence;
+    auto start = std::chrono::steady_clock::now();
+    if (side.stream) {
+        audio.clear();
+        side.tts->synthesize_stream(text, [&audio](const melotts::AudioChunk& chunk) {
+            audio.insert(audio.end(), chunk.audio.begin(), chunk.audio.end());
+        }, side.config.language);
+    } else {
+        audio = side.tts->synthesize(text, side.config.language);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool apply_override(Side& side, const std::string& arg) {
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos) {
+        return false;
+    }
+    std::string key = arg.substr(0, eq), value = arg.substr(eq + 1);
+    if (key == "stream") {
+        side.stream = value == "1" || value == "true";
+        return true;
+    }
+    return side.config.set(key, value);
+}
+
+static std::string describe(const Side& side) {
+    const MeloTTSConfig& c = side.config;
+    std::ostringstream oss;
+    oss << c.model_dir << " 声学模型 " << c.encoder_precision << "/" << c.encoder_backend
+        << ", 声码器 " << c.decoder_precision << "/" << c.decoder_backend
+        << ", 分段 " << c.dec_first_slice_frames << "/" << c.dec_max_slice_frames;
+    if (!c.custom_ops_library.empty()) oss << ", 融合算子";
+    if (!c.model_variant.empty()) oss << ", 变体 " << c.model_variant;
+    if (c.enhance_audio) oss << ", 音频增强";
+    if (side.stream) oss << ", 流式";
+    return oss.str();
+}
+
+static void print_usage(const char* program_name) {
+    std::cout << "用法: " << program_name << " [选项]" << std::endl;
+    std::cout << "选项:" << std::endl;
+    std::cout << "  -m, --model-dir DIR    模型目录 (默认: ./models)" << std::endl;
+    std::cout << "  --ref KEY=VALUE        参考配置项，可重复 (如 decoder_backend=onnxruntime)" << std::endl;
+    std::cout << "  --cand KEY=VALUE       候选配置项，可重复 (如 decoder_precision=int8、stream=1)" << std::endl;
+    std::cout << "  -c, --corpus FILE      语料文件，每行一句 (默认: 内置语料)" << std::endl;
+    std::cout << "  -l, --language LANG    语言代码: zh 或 en (默认: zh)" << std::endl;
+    std::cout << "  -n, --runs N           每句的计时轮数，取中位数 (默认: 3)" << std::endl;
+    std::cout << "  --max-abs X            最大绝对误差上限 (默认: 不检查)" << std::endl;
+    std::cout << "  --min-snr DB           信噪比下限 (默认: 30)" << std::endl;
+    std::cout << "  --max-lsd DB           对数谱距离上限 (默认: 1.0)" << std::endl;
+    std::cout << "  --keep-noise           保留配置中的噪声比例 (默认置0)" << std::endl;
+    std::cout << "  --dump DIR             把每句的参考和候选音频保存为 WAV" << std::endl;
+    std::cout << "  -h, --help             显示此帮助信息" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string model_dir = "./models";
+    std::string corpus_file;
+    std::string language = "zh";
+    std::string dump_dir;
+    std::vector<std::string> ref_args, cand_args;
+    Thresholds limits;
+    bool keep_noise = false;
+    int runs = 3;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "-m" || arg == "--model-dir") {
+                if (i + 1 < argc) model_dir = argv[++i];
+            } else if (arg == "--ref") {
+                if (i + 1 < argc) ref_args.push_back(argv[++i]);
+            } else if (arg == "--cand") {
+                if (i + 1 < argc) cand_args.push_back(argv[++i]);
+            } else if (arg == "-c" || arg == "--corpus") {
+                if (i + 1 < argc) corpus_file = argv[++i];
+            } else if (arg == "-l" || arg == "--language") {
+                if (i + 1 < argc) language = argv[++i];
+            } else if (arg == "-n" || arg == "--runs") {
+                if (i + 1 < argc) runs = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--max-abs") {
+                if (i + 1 < argc) limits.max_abs = std::stod(argv[++i]);
+            } else if (arg == "--min-snr") {
+                if (i + 1 < argc) limits.min_snr = std::stod(argv[++i]);
+            } else if (arg == "--max-lsd") {
+                if (i + 1 < argc) limits.max_lsd = std::stod(argv[++i]);
+            } else if (arg == "--keep-noise") {
+                keep_noise = true;
+            } else if (arg == "--dump") {
+                if (i + 1 < argc) dump_dir = argv[++i];
+            } else if (arg == "-h" || arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                std::cerr << "未知选项: " << arg << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "参数数值无效" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> corpus;
+    if (!corpus_file.empty()) {
+        std::ifstream in(corpus_file);
+        if (!in) {
+            std::cerr << "无法打开语料文件: " << corpus_file << std::endl;
+            return 1;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty()) corpus.push_back(line);
+        }
+    } else if (language == "en") {
+        corpus.assign(std::begin(kCorpusEn), std::end(kCorpusEn));
+    } else {
+        corpus.assign(std::begin(kCorpusZh), std::end(kCorpusZh));
+    }
+    if (corpus.empty()) {
+        std::cerr << "语料为空" << std::endl;
+        return 1;
+    }
+
+    MeloTTSConfig base;
+    base.model_dir = model_dir;
+    base.language = language;
+    base.verbose = false;
+    base.tuning_profile.clear();
+    base.variant_manifest.clear();
+    base.enhance_audio = false;
+    if (!keep_noise) {
+        base.noise_scale = 0.0f;
+        base.noise_scale_w = 0.0f;
+    }
+
+    Side sides[2];
+    const std::vector<std::string>* overrides[2] = {&ref_args, &cand_args};
+    const char* names[2] = {"参考", "候选"};
+    for (int s = 0; s < 2; s++) {
+        sides[s].config = base;
+        for (const auto& arg : *overrides[s]) {
+            if (!apply_override(sides[s], arg)) {
+                std::cerr << names[s] << "配置项无效: " << arg << std::endl;
+                return 1;
+            }
+        }
+        if (!sides[s].config.validate()) {
+            std::cerr << names[s] << "配置无效" << std::endl;
+            return 1;
+        }
+        try {
+            ScopedSilence silence;
+            sides[s].tts.reset(new melotts::MeloTTS(sides[s].config));
+        } catch (const std::exception& e) {
+            std::cerr << names[s] << "配置初始化失败: " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << names[s] << ": " << describe(sides[s]) << std::endl;
+    }
+
+    std::cout << "阈值: SNR >= " << limits.min_snr << " dB, LSD <= " << limits.max_lsd << " dB";
+    if (limits.max_abs > 0.0) std::cout << ", 最大绝对误差 <= " << limits.max_abs;
+    std::cout << "\n" << std::endl;
+
+    std::cout << pad("#", 4) << pad("采样点", 10) << pad("最大误差", 12) << pad("SNR(dB)", 10) << pad("LSD(dB)", 10)
+              << pad("参考(ms)", 11) << pad("候选(ms)", 11) << pad("加速比", 9) << "结果" << std::endl;
+    std::cout << std::string(84, '-') << std::endl;
+
+    int failures = 0;
+    bool nondeterministic = false;
+    double ref_total = 0.0, cand_total = 0.0;
+    double worst_abs = 0.0, worst_snr = std::numeric_limits<double>::infinity(), worst_lsd = 0.0;
+    try {
+        // 预热：首次推理包含内存池扩充等一次性开销
+        std::vector<float> warm;
+        render(sides[0], corpus[0], warm);
+        render(sides[1], corpus[0], warm);
+
+        for (size_t u = 0; u < corpus.size(); u++) {
+            std::vector<float> audio[2], first_ref;
+            std::vector<double> times[2];
+            for (int r = 0; r < runs; r++) {
+                for (int s = 0; s < 2; s++) {
+                    times[s].push_back(render(sides[s], corpus[u], audio[s]));
+                }
+                if (r == 0) first_ref = audio[0];
+            }
+            if (first_ref != audio[0]) {
+                nondeterministic = true;
+            }
+
+            Metrics m = compare(audio[0], audio[1]);
+            double ref_ms = median(times[0]), cand_ms = median(times[1]);
+            ref_total += ref_ms;
+            cand_total += cand_ms;
+            worst_abs = std::max(worst_abs, m.max_abs);
+            worst_snr = std::min(worst_snr, m.snr);
+            worst_lsd = std::max(worst_lsd, m.lsd);
+
+            std::string verdict = "通过";
+            if (!m.length_match) {
+                verdict = "长度不一致 (" + std::to_string(audio[0].size()) + " vs " + std::to_string(audio[1].size()) + ")";
+            } else if (m.snr < limits.min_snr || m.lsd > limits.max_lsd ||
+                       (limits.max_abs > 0.0 && m.max_abs > limits.max_abs)) {
+                verdict = "超出阈值";
+            }
+            if (verdict != "通过") failures++;
+
+            std::cout << pad(std::to_string(u + 1), 4) << pad(std::to_string(audio[0].size()), 10)
+                      << pad(format(m.max_abs, 6), 12) << pad(format(m.snr, 1), 10) << pad(format(m.lsd, 3), 10)
+                      << pad(format(ref_ms, 1), 11) << pad(format(cand_ms, 1), 11)
+                      << pad(format(cand_ms > 0.0 ? ref_ms / cand_ms : 0.0, 2) + "x", 9) << verdict << std::endl;
+
+            if (!dump_dir.empty()) {
+                for (int s = 0; s < 2; s++) {
+                    std::string path = dump_dir + "/" + std::to_string(u + 1) + (s == 0 ? "_ref.wav" : "_cand.wav");
+                    ScopedSilence silence;
+                    sides[s].tts->save_wav(audio[s], path, sides[s].config.sample_rate);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "合成失败: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << std::string(84, '-') << std::endl;
+    std::cout << "最差: 最大误差 " << format(worst_abs, 6) << ", SNR " << format(worst_snr, 1) << " dB, LSD "
+              << format(worst_lsd, 3) << " dB; 总加速比 " << format(cand_total > 0.0 ? ref_total / cand_total : 0.0, 2)
+              << "x" << std::endl;
+    if (nondeterministic) {
+        std::cout << "警告: 参考配置两次合成的输出不同，模型含未被置0的随机采样，误差中包含随机成分" << std::endl;
+    }
+    std::cout << (failures == 0 ? "全部通过" : std::to_string(failures) + " 句未通过") << std::endl;
+    return failures == 0 ? 0 : 2;
+}
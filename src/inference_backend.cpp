@@ -0,0 +1,598 @@
+// inference_backend.cpp - 推理后端实现（ONNX Runtime 与原生引擎）
+
+#include "InferenceBackend.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include <onnxruntime_cxx_api.h>
+
+#include "NativeEngine.h"
+#include "OnnxProto.hpp"
+
+namespace melotts {
+
+const char* DataTypeName(DataType type) {
+    switch (type) {
+        case DataType::Float: return "float";
+        case DataType::Int32: return "int32";
+        case DataType::Int64: return "int64";
+        case DataType::Bool: return "bool";
+    }
+    return "unknown";
+}
+
+size_t DataTypeSize(DataType type) {
+    switch (type) {
+        case DataType::Float: return sizeof(float);
+        case DataType::Int32: return sizeof(int32_t);
+        case DataType::Int64: return sizeof(int64_t);
+        case DataType::Bool: return sizeof(bool);
+    }
+    return 0;
+}
+
+// 模型声明的类型编号转为 DataType，不支持的类型抛出异常
+static DataType ToDataType(int onnx_type, const std::string& name) {
+    switch (onnx_type) {
+        case 1: return DataType::Float;
+        case 6: return DataType::Int32;
+        case 7: return DataType::Int64;
+        case 9: return DataType::Bool;
+        default:
+            throw std::runtime_error("张量 " + name + " 的数据类型不受支持: " + std::to_string(onnx_type));
+    }
+}
+
+static std::string ShapeString(const int64_t* dims, size_t rank) {
+    std::string s = "[";
+    for (size_t i = 0; i < rank; i++) {
+        if (i > 0) s += ", ";
+        s += std::to_string(dims[i]);
+    }
+    return s + "]";
+}
+
+bool TensorInfo::IsDynamic() const {
+    return std::any_of(shape.begin(), shape.end(), [](int64_t d) { return d <= 0; });
+}
+
+size_t TensorView::count() const {
+    size_t n = 1;
+    for (size_t i = 0; i < rank_; i++) {
+        n *= static_cast<size_t>(std::max<int64_t>(dims_[i], 0));
+    }
+    return n;
+}
+
+void TensorView::SetShape(const int64_t* dims, size_t rank) {
+    if (rank > kMaxRank) {
+        throw std::invalid_argument("张量维数超出上限: " + std::to_string(rank));
+    }
+    std::copy(dims, dims + rank, dims_);
+    rank_ = rank;
+}
+
+void TensorView::CheckType(DataType expected) const {
+    if (type_ != expected) {
+        throw std::invalid_argument(std::string("张量数据类型为 ") + DataTypeName(type_) +
+                                    "，按 " + DataTypeName(expected) + " 读取");
+    }
+}
+
+int InferenceBackend::FindInput(const std::string& name) const {
+    for (size_t i = 0; i < inputs_.size(); i++) {
+        if (inputs_[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int InferenceBackend::FindOutput(const std::string& name) const {
+    for (size_t i = 0; i < outputs_.size(); i++) {
+        if (outputs_[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void InferenceBackend::Validate(const TensorView* inputs, size_t count) const {
+    if (count != inputs_.size()) {
+        throw std::invalid_argument("模型需要 " + std::to_string(inputs_.size()) + " 个输入，实际传入 " +
+                                    std::to_string(count) + " 个");
+    }
+    for (size_t i = 0; i < count; i++) {
+        const TensorInfo& info = inputs_[i];
+        const TensorView& view = inputs[i];
+        if (!view.raw() && view.count() > 0) {
+            throw std::invalid_argument("输入数据未设置: " + info.name);
+        }
+        if (view.type() != info.type) {
+            throw std::invalid_argument("输入 " + info.name + " 的数据类型应为 " + DataTypeName(info.type) +
+                                        "，实际为 " + DataTypeName(view.type()));
+        }
+        bool match = view.rank() == info.shape.size();
+        for (size_t d = 0; match && d < view.rank(); d++) {
+            match = view.dim(d) >= 0 && (info.shape[d] <= 0 || info.shape[d] == view.dim(d));
+        }
+        if (!match) {
+            throw std::invalid_argument("输入 " + info.name + " 的形状 " + ShapeString(view.dims(), view.rank()) +
+                                        " 与模型声明 " + ShapeString(info.shape.data(), info.shape.size()) + " 不符");
+        }
+    }
+}
+
+void InferenceBackend::Run(const TensorView* inputs, size_t count) {
+    Validate(inputs, count);
+    RunImpl(inputs);
+}
+
+size_t InferenceBackend::CopyOutput(size_t idx, float* dst) const {
+    TensorView out = Output(idx);
+    size_t n = out.count();
+    switch (out.type()) {
+        case DataType::Float:
+            std::copy(out.data<float>(), out.data<float>() + n, dst);
+            break;
+        case DataType::Int32:
+            std::copy(out.data<int32_t>(), out.data<int32_t>() + n, dst);
+            break;
+        case DataType::Int64:
+            std::transform(out.data<int64_t>(), out.data<int64_t>() + n, dst,
+                           [](int64_t v) { return static_cast<float>(v); });
+            break;
+        case DataType::Bool:
+            std::copy(out.data<bool>(), out.data<bool>() + n, dst);
+            break;
+    }
+    return n;
+}
+
+namespace {
+
+// 共享环境的创建状态：环境创建后线程池设置不能再改
+struct SharedEnvState {
+    std::mutex mutex;
+    bool created = false;
+    int pool_threads = 0;
+};
+
+SharedEnvState& EnvState() {
+    static SharedEnvState state;
+    return state;
+}
+
+std::unique_ptr<Ort::Env> CreateSharedEnv() {
+    SharedEnvState& state = EnvState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.created = true;
+    if (state.pool_threads <= 0) {
+        return std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "MeloTTS");
+    }
+    Ort::ThreadingOptions threading;
+    threading.SetGlobalIntraOpNumThreads(state.pool_threads);
+    threading.SetGlobalInterOpNumThreads(1);
+    return std::make_unique<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "MeloTTS");
+}
+
+// 进程内所有 ONNX Runtime 会话共用一个环境
+Ort::Env& SharedOrtEnv() {
+    static std::unique_ptr<Ort::Env> env = CreateSharedEnv();
+    return *env;
+}
+
+// 同一模型文件的 ONNX Runtime 会话共用的权重：较大的 float 初始化器由这里持有，
+// 经 AddInitializer 交给各会话（不复制）；各会话的预打包权重放在同一个容器中
+struct SharedOrtWeights {
+    Ort::PrepackedWeightsContainer prepacked;
+    std::vector<onnx_proto::Tensor> tensors;
+    std::vector<Ort::Value> values;
+    size_t bytes = 0;
+};
+
+// 元素数少于此值的初始化器留在模型中（多为形状计算和标量常量）
+constexpr size_t kMinSharedElements = 256;
+
+struct SharedOrtWeightsCache {
+    std::mutex mutex;
+    std::map<std::string, std::weak_ptr<SharedOrtWeights>> weights;
+};
+
+SharedOrtWeightsCache& OrtWeightsCache() {
+    static SharedOrtWeightsCache cache;
+    return cache;
+}
+
+std::shared_ptr<SharedOrtWeights> AcquireSharedOrtWeights(const std::string& model_file) {
+    SharedOrtWeightsCache& cache = OrtWeightsCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.weights.find(model_file);
+        if (it != cache.weights.end()) {
+            if (auto weights = it->second.lock()) return weights;
+        }
+    }
+
+    auto loaded = std::make_shared<SharedOrtWeights>();
+    try {
+        onnx_proto::Model model = onnx_proto::LoadModel(model_file);
+        for (auto& init : model.initializers) {
+            if (init.data_type == onnx_proto::kFloat && init.float_data.size() >= kMinSharedElements &&
+                init.float_data.size() == init.ElementCount()) {
+                loaded->bytes += init.float_data.size() * sizeof(float);
+                loaded->tensors.push_back(std::move(init));
+            }
+        }
+    } catch (const std::exception& e) {
+        // 外部数据存储等读取器不支持的模型只共用预打包权重
+        std::cerr << "警告: 无法读取 " << model_file << " 的初始化器，只共用预打包权重 (" << e.what() << ")" << std::endl;
+        loaded->tensors.clear();
+        loaded->bytes = 0;
+    }
+    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    for (auto& tensor : loaded->tensors) {
+        loaded->values.push_back(Ort::Value::CreateTensor<float>(memory_info, tensor.float_data.data(),
+                                                                 tensor.float_data.size(), tensor.dims.data(),
+                                                                 tensor.dims.size()));
+    }
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    std::weak_ptr<SharedOrtWeights>& slot = cache.weights[model_file];
+    // 并发加载同一文件时用先完成的一份
+    if (auto existing = slot.lock()) return existing;
+    slot = loaded;
+    return loaded;
+}
+
+GraphOptimizationLevel ToOptimizationLevel(const std::string& level) {
+    if (level == "disable") return GraphOptimizationLevel::ORT_DISABLE_ALL;
+    if (level == "basic") return GraphOptimizationLevel::ORT_ENABLE_BASIC;
+    if (level == "extended") return GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+    return GraphOptimizationLevel::ORT_ENABLE_ALL;
+}
+
+// ONNX Runtime 后端：名称指针数组和输入/输出的 Ort::Value 容器在加载时建好。
+// 输入按数据指针、类型和形状缓存，不变时直接复用上一次包装的 Ort::Value；
+// 输入形状与上一次相同时把上一次的输出张量交给 ONNX Runtime 原地写入，输出的形状和视图也沿用。
+// 输出长度取决于输入数据的模型（如声学模型）若因复用的输出形状不符而运行失败，改用新分配的输出重跑一次，
+// 此后该会话不再复用输出。Session::Run 自身的分配（执行帧等）不在此列，microbench 以直接调用会话为基线对比
+class OrtBackend : public InferenceBackend {
+public:
+    OrtBackend(const std::string& model_file, const BackendOptions& options)
+        : memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
+        try {
+            Ort::Env& env = SharedOrtEnv();
+            Ort::SessionOptions session_options;
+            if (options.shared_thread_pool && SharedThreadPoolThreads() > 0) {
+                session_options.DisablePerSessionThreads();
+            } else {
+                session_options.SetIntraOpNumThreads(options.intra_op_threads);
+            }
+            session_options.SetGraphOptimizationLevel(ToOptimizationLevel(options.graph_optimization));
+            if (!options.custom_ops_library.empty()) {
+                session_options.RegisterCustomOpsLibrary(options.custom_ops_library.c_str());
+            }
+            if (options.share_weights) {
+                shared_weights_ = AcquireSharedOrtWeights(model_file);
+                for (size_t i = 0; i < shared_weights_->tensors.size(); i++) {
+                    session_options.AddInitializer(shared_weights_->tensors[i].name.c_str(),
+                                                   shared_weights_->values[i]);
+                }
+                session_ = std::make_unique<Ort::Session>(env, model_file.c_str(), session_options,
+                                                          shared_weights_->prepacked);
+            } else {
+                session_ = std::make_unique<Ort::Session>(env, model_file.c_str(), session_options);
+            }
+
+            Ort::AllocatorWithDefaultOptions allocator;
+            for (size_t i = 0; i < session_->GetInputCount(); i++) {
+                TensorInfo info;
+                info.name = session_->GetInputNameAllocated(i, allocator).get();
+                auto tensor_info = session_->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo();
+                info.type = ToDataType(static_cast<int>(tensor_info.GetElementType()), info.name);
+                info.shape = tensor_info.GetShape();
+                inputs_.push_back(std::move(info));
+            }
+            for (size_t i = 0; i < session_->GetOutputCount(); i++) {
+                TensorInfo info;
+                info.name = session_->GetOutputNameAllocated(i, allocator).get();
+                auto tensor_info = session_->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo();
+                info.type = ToDataType(static_cast<int>(tensor_info.GetElementType()), info.name);
+                info.shape = tensor_info.GetShape();
+                outputs_.push_back(std::move(info));
+            }
+        } catch (const Ort::Exception& e) {
+            throw std::runtime_error(std::string("ONNX Runtime 加载模型失败: ") + e.what());
+        }
+
+        for (const auto& info : inputs_) input_names_.push_back(info.name.c_str());
+        for (const auto& info : outputs_) output_names_.push_back(info.name.c_str());
+        for (size_t i = 0; i < inputs_.size(); i++) input_values_.emplace_back(nullptr);
+        for (size_t o = 0; o < outputs_.size(); o++) output_values_.emplace_back(nullptr);
+        bound_inputs_.resize(inputs_.size());
+        output_shapes_.resize(outputs_.size());
+        output_views_.resize(outputs_.size());
+    }
+
+    const char* Name() const override { return "onnxruntime"; }
+
+    TensorView Output(size_t idx) const override { return output_views_.at(idx); }
+
+    std::string GetCustomMetadata(const std::string& key) const override {
+        try {
+            Ort::AllocatorWithDefaultOptions allocator;
+            Ort::ModelMetadata metadata = session_->GetModelMetadata();
+            Ort::AllocatedStringPtr value = metadata.LookupCustomMetadataMapAllocated(key.c_str(), allocator);
+            return value ? std::string(value.get()) : std::string();
+        } catch (const Ort::Exception&) {
+            return "";
+        }
+    }
+
+    // 会话内存池向系统申请的总字节数（ONNX Runtime 1.23 起提供统计接口）
+    size_t ArenaBytes() const override {
+#if ORT_API_VERSION >= 23
+        try {
+            Ort::Allocator allocator(*session_, memory_info_);
+            Ort::KeyValuePairs stats = allocator.GetStats();
+            const char* total = stats.GetValue("TotalAllocated");
+            return total ? static_cast<size_t>(std::strtoull(total, nullptr, 10)) : 0;
+        } catch (const Ort::Exception&) {
+            return 0;
+        }
+#else
+        return 0;
+#endif
+    }
+
+protected:
+    void RunImpl(const TensorView* inputs) override {
+        bool same_shapes = bound_;
+        for (size_t i = 0; i < inputs_.size() && same_shapes; i++) {
+            same_shapes = SameShape(inputs[i], bound_inputs_[i]);
+        }
+        // 输入直接取自上一次的输出缓冲区时不能让 ONNX Runtime 原地覆盖
+        bool reuse = reuse_outputs_ && same_shapes && outputs_valid_ && !AliasesOutput(inputs);
+
+        try {
+            for (size_t i = 0; i < inputs_.size(); i++) {
+                if (!bound_ || inputs[i].raw() != bound_inputs_[i].raw() || !SameShape(inputs[i], bound_inputs_[i])) {
+                    input_values_[i] = Wrap(inputs[i]);
+                    bound_inputs_[i] = inputs[i];
+                }
+            }
+            bound_ = true;
+            if (!reuse) {
+                ResetOutputs();
+            }
+            session_->Run(Ort::RunOptions{nullptr}, input_names_.data(), input_values_.data(), input_values_.size(),
+                          output_names_.data(), output_values_.data(), output_values_.size());
+        } catch (const Ort::Exception& e) {
+            if (!reuse) {
+                ResetOutputs();
+                throw std::runtime_error(std::string("ONNX Runtime 推理失败: ") + e.what());
+            }
+            // 复用的输出形状与本次结果不符，说明输出长度取决于输入数据，此后每次由 ONNX Runtime 重新分配
+            reuse_outputs_ = false;
+            RunImpl(inputs);
+            return;
+        }
+
+        if (!reuse) {
+            for (size_t o = 0; o < output_values_.size(); o++) {
+                BindOutputView(o);
+            }
+            outputs_valid_ = true;
+        }
+    }
+
+private:
+    static bool SameShape(const TensorView& a, const TensorView& b) {
+        return a.type() == b.type() && a.rank() == b.rank() && std::equal(a.dims(), a.dims() + a.rank(), b.dims());
+    }
+
+    bool AliasesOutput(const TensorView* inputs) const {
+        for (size_t i = 0; i < inputs_.size(); i++) {
+            const char* begin = static_cast<const char*>(inputs[i].raw());
+            const char* end = begin + inputs[i].bytes();
+            for (const auto& out : output_views_) {
+                const char* out_begin = static_cast<const char*>(out.raw());
+                if (out_begin && begin < out_begin + out.bytes() && out_begin < end) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void ResetOutputs() {
+        outputs_valid_ = false;
+        for (auto& v : output_values_) v = Ort::Value(nullptr);
+        for (auto& view : output_views_) view = TensorView();
+    }
+
+    // 记录 ONNX Runtime 新分配的输出张量，形状写入保留的缓冲区
+    void BindOutputView(size_t o) {
+        Ort::Value& value = output_values_[o];
+        auto tensor_info = value.GetTensorTypeAndShapeInfo();
+        DataType type = ToDataType(static_cast<int>(tensor_info.GetElementType()), outputs_[o].name);
+        std::vector<int64_t>& shape = output_shapes_[o];
+        shape.resize(tensor_info.GetDimensionsCount());
+        tensor_info.GetDimensions(shape.data(), shape.size());
+        const void* data = nullptr;
+        switch (type) {
+            case DataType::Float: data = value.GetTensorMutableData<float>(); break;
+            case DataType::Int32: data = value.GetTensorMutableData<int32_t>(); break;
+            case DataType::Int64: data = value.GetTensorMutableData<int64_t>(); break;
+            case DataType::Bool: data = value.GetTensorMutableData<bool>(); break;
+        }
+        output_views_[o] = TensorView(data, type, shape.data(), shape.size());
+    }
+
+    Ort::Value Wrap(const TensorView& view) {
+        switch (view.type()) {
+            case DataType::Float:
+                return Ort::Value::CreateTensor<float>(memory_info_, const_cast<float*>(view.data<float>()),
+                                                       view.count(), view.dims(), view.rank());
+            case DataType::Int32:
+                return Ort::Value::CreateTensor<int32_t>(memory_info_, const_cast<int32_t*>(view.data<int32_t>()),
+                                                         view.count(), view.dims(), view.rank());
+            case DataType::Int64:
+                return Ort::Value::CreateTensor<int64_t>(memory_info_, const_cast<int64_t*>(view.data<int64_t>()),
+                                                         view.count(), view.dims(), view.rank());
+            case DataType::Bool:
+                return Ort::Value::CreateTensor<bool>(memory_info_, const_cast<bool*>(view.data<bool>()),
+                                                      view.count(), view.dims(), view.rank());
+        }
+        throw std::invalid_argument("不支持的输入数据类型");
+    }
+
+    Ort::MemoryInfo memory_info_;
+    std::shared_ptr<SharedOrtWeights> shared_weights_;   // 须比会话后析构
+    std::unique_ptr<Ort::Session> session_;
+
+    std::vector<const char*> input_names_;
+    std::vector<const char*> output_names_;
+    std::vector<Ort::Value> input_values_;
+    std::vector<TensorView> bound_inputs_;        // input_values_ 当前包装的数据和形状
+    std::vector<Ort::Value> output_values_;
+    std::vector<std::vector<int64_t>> output_shapes_;
+    std::vector<TensorView> output_views_;
+    bool bound_ = false;            // input_values_ 已包装过一次输入
+    bool outputs_valid_ = false;    // output_values_ 为上一次成功运行的结果
+    bool reuse_outputs_ = true;
+};
+
+// 原生引擎后端：输出复制到按最大尺寸保留的缓冲区，形状不变时不再申请内存
+class NativeBackend : public InferenceBackend {
+public:
+    explicit NativeBackend(const std::string& model_file) {
+        if (0 != engine_.Init(model_file)) {
+            throw std::runtime_error("原生引擎无法加载模型: " + model_file);
+        }
+        for (size_t i = 0; i < engine_.GetInputCount(); i++) {
+            TensorInfo info;
+            info.name = engine_.GetInputName(i);
+            info.type = ToDataType(engine_.GetInputType(i), info.name);
+            info.shape = engine_.GetInputShape(i);
+            inputs_.push_back(std::move(info));
+        }
+        for (size_t i = 0; i < engine_.GetOutputCount(); i++) {
+            TensorInfo info;
+            info.name = engine_.GetOutputName(i);
+            info.type = ToDataType(engine_.GetOutputType(i), info.name);
+            outputs_.push_back(std::move(info));
+        }
+        output_buffers_.resize(outputs_.size());
+        output_shapes_.resize(outputs_.size());
+        output_views_.resize(outputs_.size());
+    }
+
+    const char* Name() const override { return "native"; }
+
+    TensorView Output(size_t idx) const override { return output_views_.at(idx); }
+
+    std::string GetCustomMetadata(const std::string& key) const override { return engine_.GetCustomMetadata(key); }
+
+    size_t ArenaBytes() const override { return engine_.GetArenaBytes(); }
+
+protected:
+    void RunImpl(const TensorView* inputs) override {
+        for (size_t i = 0; i < inputs_.size(); i++) {
+            run_shape_.assign(inputs[i].dims(), inputs[i].dims() + inputs[i].rank());
+            engine_.SetInput(inputs[i].raw(), static_cast<int>(i), run_shape_);
+        }
+        if (0 != engine_.RunSync()) {
+            throw std::runtime_error("原生引擎推理失败");
+        }
+        for (size_t o = 0; o < outputs_.size(); o++) {
+            DataType type = outputs_[o].type;
+            output_buffers_[o].resize(engine_.GetOutputElementCount(o) * DataTypeSize(type));
+            engine_.GetOutput(output_buffers_[o].data(), o);
+            output_shapes_[o] = engine_.GetOutputShape(o);
+            output_views_[o] = TensorView(output_buffers_[o].data(), type, output_shapes_[o].data(),
+                                          output_shapes_[o].size());
+        }
+    }
+
+private:
+    NativeEngine engine_;
+    std::vector<int64_t> run_shape_;
+    std::vector<std::vector<unsigned char>> output_buffers_;
+    std::vector<std::vector<int64_t>> output_shapes_;
+    std::vector<TensorView> output_views_;
+};
+
+} // namespace
+
+bool EnableSharedThreadPool(int intra_op_threads) {
+    if (intra_op_threads <= 0) {
+        return false;
+    }
+    SharedEnvState& state = EnvState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.created) {
+        return state.pool_threads == intra_op_threads;
+    }
+    state.pool_threads = intra_op_threads;
+    return true;
+}
+
+int SharedThreadPoolThreads() {
+    SharedEnvState& state = EnvState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.pool_threads;
+}
+
+std::shared_ptr<const void> PreloadSharedWeights(const std::string& model_file) {
+    return AcquireSharedOrtWeights(model_file);
+}
+
+std::vector<SharedWeightsStats> SharedWeightsReport() {
+    std::vector<SharedWeightsStats> report;
+    {
+        SharedOrtWeightsCache& cache = OrtWeightsCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        for (auto it = cache.weights.begin(); it != cache.weights.end();) {
+            auto weights = it->second.lock();
+            if (!weights) {
+                it = cache.weights.erase(it);
+                continue;
+            }
+            SharedWeightsStats stats;
+            stats.backend = "onnxruntime";
+            stats.model_file = it->first;
+            stats.sessions = static_cast<size_t>(it->second.use_count()) - 1;   // 不计这里临时持有的一份
+            stats.weight_bytes = weights->bytes;
+            report.push_back(std::move(stats));
+            ++it;
+        }
+    }
+    for (const auto& model : NativeSharedModels()) {
+        SharedWeightsStats stats;
+        stats.backend = "native";
+        stats.model_file = model.model_file;
+        stats.sessions = model.engines;
+        stats.weight_bytes = model.weight_bytes;
+        report.push_back(std::move(stats));
+    }
+    for (auto& stats : report) {
+        stats.saved_bytes = stats.sessions > 1 ? (stats.sessions - 1) * stats.weight_bytes : 0;
+    }
+    return report;
+}
+
+std::unique_ptr<InferenceBackend> CreateInferenceBackend(const std::string& kind, const std::string& model_file,
+                                                         const BackendOptions& options) {
+    if (kind == "onnxruntime") {
+        return std::make_unique<OrtBackend>(model_file, options);
+    }
+    if (kind == "native") {
+        return std::make_unique<NativeBackend>(model_file);
+    }
+    throw std::invalid_argument("未知的推理后端: " + kind);
+}
+
+} // namespace melotts
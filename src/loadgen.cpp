@@ -0,0 +1,495 @@
+// loadgen.cpp - 负载测试工具
+//
+// 用法: melotts_loadgen -m <模型目录> [--arrival closed|poisson] [--levels 1,2,4] [--duration 秒]
+//                       [--slo-p99 毫秒] [--slo-ttfa 毫秒] [--mix 短,中,长] [-c 语料文件]
+// 逐级提高负载，每级运行固定时长，统计吞吐（请求/秒、音频秒/秒）、延迟和首包延迟的分位数，
+// 给出 p99 延迟和 p99 首包延迟都不超过目标时可持续的最大吞吐，用于容量规划。
+//   closed:  闭环，各级为并发数；每个客户端发出请求、等待完成、按指数分布的思考时间停顿后再发下一个
+//   poisson: 开环，各级为到达率（请求/秒）；请求按泊松过程到达，由固定数量的工作线程处理，
+//            延迟从计划到达时刻算起（含排队），过载时不会因客户端变慢而低估延迟
+// 每个并发的工作线程使用各自的 MeloTTS 实例（同一模型文件的权重在实例间共用）。
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "melotts.h"
+#include "MeloTTSConfig.h"
+#include "SlowRequestLog.h"
+
+using Clock = std::chrono::steady_clock;
+
+// 语料文件不存在时使用的内置语料，按长度分为短句、中等长度和长句
+static const char* kDefaultCorpusZh[] = {
+    "你好。",
+    "好的，马上为您处理。",
+    "今天天气不错，我们一起去公园散步吧。",
+    "您的订单已经发货，预计明天下午送达，请保持电话畅通。",
+    "欢迎致电客户服务中心，查询账户余额请按一，办理业务请按二，人工服务请按零。",
+    "语音合成系统把输入的文本转换为音素序列，再由声学模型预测每个音素的时长和声学特征，"
+    "最后由声码器生成波形，整个过程需要在很短的时间内完成，才能满足实时交互的要求。",
+};
+
+static const char* kDefaultCorpusEn[] = {
+    "Hello.",
+    "Sure, one moment please.",
+    "The weather is nice today, let us take a walk in the park.",
+    "Your order has shipped and should arrive tomorrow afternoon.",
+    "Thank you for calling customer service, press one for your balance or zero for an operator.",
+    "A text to speech system converts the input text into phonemes, predicts their durations and acoustic "
+    "features, and finally generates the waveform with a vocoder in a fraction of real time.",
+};
+
+// 按字符数（UTF-8）划分长度档：短句不超过 kShortChars，长句超过 kLongChars
+static const size_t kShortChars = 15;
+static const size_t kLongChars = 50;
+
+static size_t utf8_length(const std::string& text) {
+    size_t n = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) n++;
+    }
+    return n;
+}
+
+// 一次请求的结果
+struct Sample {
+    double latency_ms = 0.0;   // 从到达到合成完成
+    double ttfa_ms = 0.0;      // 从到达到首个音频块
+    double audio_sec = 0.0;
+    double cpu_ms = 0.0;       // 合成线程消耗的CPU时间（各阶段之和）
+    bool ok = false;
+};
+
+// 一级负载的统计
+struct LevelResult {
+    double level = 0.0;
+    size_t completed = 0;
+    size_t errors = 0;          // 合成失败和过载时未处理的请求
+    double elapsed_sec = 0.0;
+    double rps = 0.0;
+    double audio_per_sec = 0.0;
+    double cpu_ms = 0.0;        // 平均每个请求合成线程消耗的CPU时间
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double ttfa_p50_ms = 0.0;
+    double ttfa_p99_ms = 0.0;
+    bool within_slo = false;
+};
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[std::min(idx, values.size() - 1)];
+}
+
+static double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 按长度档权重抽取语料中的句子
+class TextPicker {
+public:
+    TextPicker(const std::vector<std::string>& corpus, const std::vector<double>& mix) {
+        for (const auto& text : corpus) {
+            size_t n = utf8_length(text);
+            buckets_[n <= kShortChars ? 0 : (n > kLongChars ? 2 : 1)].push_back(text);
+        }
+        std::vector<double> weights(3, 0.0);
+        for (int b = 0; b < 3; b++) {
+            // 语料中没有的长度档不参与抽取
+            weights[b] = buckets_[b].empty() ? 0.0 : (b < static_cast<int>(mix.size()) ? mix[b] : 0.0);
+        }
+        if (weights[0] + weights[1] + weights[2] <= 0.0) {
+            for (int b = 0; b < 3; b++) weights[b] = buckets_[b].empty() ? 0.0 : 1.0;
+        }
+        bucket_dist_ = std::discrete_distribution<int>(weights.begin(), weights.end());
+    }
+
+    const std::string& Pick(std::mt19937& rng) {
+        const auto& bucket = buckets_[bucket_dist_(rng)];
+        return bucket[std::uniform_int_distribution<size_t>(0, bucket.size() - 1)(rng)];
+    }
+
+private:
+    std::vector<std::string> buckets_[3];
+    std::discrete_distribution<int> bucket_dist_;
+};
+
+// 合成一句，time 从 arrival 算起
+static Sample run_request(melotts::MeloTTS& tts, const std::string& text, const std::string& language,
+                          int sample_rate, Clock::time_point arrival) {
+    Sample s;
+    double first = -1.0;
+    size_t samples = 0;
+    try {
+        tts.set_queue_wait(ms_since(arrival));
+        tts.synthesize_stream(text, [&](const melotts::AudioChunk& chunk) {
+            if (first < 0.0) first = ms_since(arrival);
+            samples += chunk.audio.size();
+        }, language);
+        s.latency_ms = ms_since(arrival);
+        s.ttfa_ms = first < 0.0 ? s.latency_ms : first;
+        s.audio_sec = static_cast<double>(samples) / sample_rate;
+        for (const auto& stage : tts.last_stage_stats()) {
+            s.cpu_ms += stage.cpu_ms;
+        }
+        s.ok = true;
+    } catch (const std::exception& e) {
+        std::cerr << "合成失败: " << e.what() << std::endl;
+    }
+    return s;
+}
+
+struct Options {
+    std::string language = "zh";
+    int sample_rate = 24000;
+    double duration_sec = 10.0;
+    double think_ms = 0.0;
+    int workers = 0;            // poisson 的工作线程数
+    double drain_ms = 1000.0;   // poisson 时长结束后等待排队请求的时间，取 p99 延迟目标
+    unsigned seed = 42;
+};
+
+// 闭环：concurrency 个客户端各自循环发请求，直到时长用完
+static std::vector<Sample> run_closed(std::vector<std::unique_ptr<melotts::MeloTTS>>& instances, int concurrency,
+                                      TextPicker& picker, const Options& options) {
+    std::vector<std::vector<Sample>> per_client(concurrency);
+    Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                                std::chrono::duration<double>(options.duration_sec));
+    std::mutex picker_mutex;
+    std::vector<std::thread> clients;
+    for (int c = 0; c < concurrency; c++) {
+        clients.emplace_back([&, c]() {
+            std::mt19937 rng(options.seed + c);
+            std::exponential_distribution<double> think(options.think_ms > 0.0 ? 1.0 / options.think_ms : 1.0);
+            while (Clock::now() < end) {
+                std::string text;
+                {
+                    std::lock_guard<std::mutex> lock(picker_mutex);
+                    text = picker.Pick(rng);
+                }
+                per_client[c].push_back(run_request(*instances[c], text, options.language, options.sample_rate,
+                                                    Clock::now()));
+                if (options.think_ms > 0.0) {
+                    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(think(rng)));
+                }
+            }
+        });
+    }
+    for (auto& t : clients) t.join();
+
+    std::vector<Sample> samples;
+    for (auto& client : per_client) samples.insert(samples.end(), client.begin(), client.end());
+    return samples;
+}
+
+// 开环：按到达率 rate 的泊松过程生成请求，工作线程处理；
+// 时长结束后继续处理排队的请求 drain_ms，之后仍在排队的（必然超出延迟目标）记为失败
+static std::vector<Sample> run_poisson(std::vector<std::unique_ptr<melotts::MeloTTS>>& instances, double rate,
+                                       TextPicker& picker, const Options& options, size_t& dropped) {
+    struct Request {
+        std::string text;
+        Clock::time_point arrival;
+    };
+    std::deque<Request> queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool closed = false;
+    std::vector<std::vector<Sample>> per_worker(options.workers);
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < options.workers; w++) {
+        workers.emplace_back([&, w]() {
+            while (true) {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]() { return closed || !queue.empty(); });
+                    if (queue.empty()) return;
+                    request = std::move(queue.front());
+                    queue.pop_front();
+                }
+                per_worker[w].push_back(run_request(*instances[w], request.text, options.language,
+                                                    options.sample_rate, request.arrival));
+            }
+        });
+    }
+
+    // 按计划时刻投递请求；生成线程落后时立即补投，到达时刻仍按计划记录
+    std::mt19937 rng(options.seed);
+    std::exponential_distribution<double> gap(rate);
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(options.duration_sec));
+    Clock::time_point next = start;
+    while (true) {
+        next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap(rng)));
+        if (next >= end) break;
+        std::this_thread::sleep_until(next);
+        Request request{picker.Pick(rng), next};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(request));
+        }
+        cv.notify_one();
+    }
+    Clock::time_point drain_end = end + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double, std::milli>(options.drain_ms));
+    while (Clock::now() < drain_end) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.empty()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        dropped = queue.size();
+        queue.clear();
+        closed = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers) t.join();
+
+    std::vector<Sample> samples;
+    for (auto& worker : per_worker) samples.insert(samples.end(), worker.begin(), worker.end());
+    return samples;
+}
+
+static LevelResult summarize(double level, const std::vector<Sample>& samples, size_t dropped, double elapsed_sec,
+                             double slo_p99_ms, double slo_ttfa_ms) {
+    LevelResult r;
+    r.level = level;
+    r.elapsed_sec = elapsed_sec;
+    r.errors = dropped;
+    std::vector<double> latencies, ttfas;
+    double audio = 0.0;
+    double cpu = 0.0;
+    for (const auto& s : samples) {
+        if (!s.ok) {
+            r.errors++;
+            continue;
+        }
+        r.completed++;
+        latencies.push_back(s.latency_ms);
+        ttfas.push_back(s.ttfa_ms);
+        audio += s.audio_sec;
+        cpu += s.cpu_ms;
+    }
+    r.rps = elapsed_sec > 0.0 ? r.completed / elapsed_sec : 0.0;
+    r.audio_per_sec = elapsed_sec > 0.0 ? audio / elapsed_sec : 0.0;
+    r.cpu_ms = r.completed > 0 ? cpu / r.completed : 0.0;
+    r.p50_ms = percentile(latencies, 0.50);
+    r.p99_ms = percentile(latencies, 0.99);
+    r.ttfa_p50_ms = percentile(ttfas, 0.50);
+    r.ttfa_p99_ms = percentile(ttfas, 0.99);
+    r.within_slo = r.completed > 0 && r.errors == 0 && r.p99_ms <= slo_p99_ms && r.ttfa_p99_ms <= slo_ttfa_ms;
+    return r;
+}
+
+static std::vector<double> parse_list(const std::string& text) {
+    std::vector<double> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(std::stod(item));
+    }
+    return values;
+}
+
+static void print_usage(const char* program_name) {
+    std::cout << "用法: " << program_name << " [选项]" << std::endl;
+    std::cout << "选项:" << std::endl;
+    std::cout << "  -m, --model-dir DIR    模型目录 (默认: ./models)" << std::endl;
+    std::cout << "  -c, --corpus FILE      语料，每行一句 (默认: 内置语料)" << std::endl;
+    std::cout << "  -l, --language LANG    语言代码: zh 或 en (默认: zh)" << std::endl;
+    std::cout << "  --arrival MODE         到达过程: closed (闭环，按并发数) 或 poisson (开环，按到达率) (默认: closed)" << std::endl;
+    std::cout << "  --levels LIST          各级负载，逗号分隔: 并发数或请求/秒 (默认: 1,2,4,... 至CPU线程数)" << std::endl;
+    std::cout << "  --duration SEC         每级运行时长 (默认: 10)" << std::endl;
+    std::cout << "  --think MS             闭环客户端的平均思考时间，指数分布 (默认: 0)" << std::endl;
+    std::cout << "  --workers N            开环的工作线程数 (默认: CPU线程数)" << std::endl;
+    std::cout << "  --mix S,M,L            短句/中等/长句的抽取比例 (默认: 1,1,1)" << std::endl;
+    std::cout << "  --slo-p99 MS           p99 延迟目标 (默认: 1000)" << std::endl;
+    std::cout << "  --slo-ttfa MS          p99 首包延迟目标 (默认: 300)" << std::endl;
+    std::cout << "  --set KEY=VALUE        设置 MeloTTSConfig 字段 (如 decoder_backend=native)，可重复" << std::endl;
+    std::cout << "  --all-levels           超出目标后继续运行更高的负载级别 (默认: 停止)" << std::endl;
+    std::cout << "  --seed N               随机种子 (默认: 42)" << std::endl;
+    std::cout << "  -h, --help             显示此帮助信息" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    melotts::MeloTTSConfig config;
+    config.model_dir = "./models";
+    config.verbose = false;
+    std::string corpus_file;
+    std::string arrival = "closed";
+    std::vector<double> levels;
+    std::vector<double> mix = {1.0, 1.0, 1.0};
+    double slo_p99_ms = 1000.0;
+    double slo_ttfa_ms = 300.0;
+    bool all_levels = false;
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-m" || arg == "--model-dir") {
+            if (i + 1 < argc) config.model_dir = argv[++i];
+        } else if (arg == "-c" || arg == "--corpus") {
+            if (i + 1 < argc) corpus_file = argv[++i];
+        } else if (arg == "-l" || arg == "--language") {
+            if (i + 1 < argc) options.language = argv[++i];
+        } else if (arg == "--arrival") {
+            if (i + 1 < argc) arrival = argv[++i];
+        } else if (arg == "--levels") {
+            if (i + 1 < argc) levels = parse_list(argv[++i]);
+        } else if (arg == "--duration") {
+            if (i + 1 < argc) options.duration_sec = std::stod(argv[++i]);
+        } else if (arg == "--think") {
+            if (i + 1 < argc) options.think_ms = std::stod(argv[++i]);
+        } else if (arg == "--workers") {
+            if (i + 1 < argc) options.workers = std::stoi(argv[++i]);
+        } else if (arg == "--mix") {
+            if (i + 1 < argc) mix = parse_list(argv[++i]);
+        } else if (arg == "--slo-p99") {
+            if (i + 1 < argc) slo_p99_ms = std::stod(argv[++i]);
+        } else if (arg == "--slo-ttfa") {
+            if (i + 1 < argc) slo_ttfa_ms = std::stod(argv[++i]);
+        } else if (arg == "--set") {
+            if (i + 1 < argc) {
+                std::string kv = argv[++i];
+                size_t eq = kv.find('=');
+                if (eq == std::string::npos || !config.set(kv.substr(0, eq), kv.substr(eq + 1))) {
+                    std::cerr << "无效的配置项: " << kv << std::endl;
+                    return 1;
+                }
+            }
+        } else if (arg == "--all-levels") {
+            all_levels = true;
+        } else if (arg == "--seed") {
+            if (i + 1 < argc) options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "未知选项: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (arrival != "closed" && arrival != "poisson") {
+        std::cerr << "未知的到达过程: " << arrival << std::endl;
+        return 1;
+    }
+    config.language = options.language;
+    options.sample_rate = config.sample_rate;
+    options.drain_ms = slo_p99_ms;
+
+    std::vector<std::string> corpus;
+    if (!corpus_file.empty()) {
+        std::ifstream in(corpus_file);
+        if (!in) {
+            std::cerr << "无法打开语料文件: " << corpus_file << std::endl;
+            return 1;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty()) corpus.push_back(line);
+        }
+    } else if (options.language == "en") {
+        corpus.assign(std::begin(kDefaultCorpusEn), std::end(kDefaultCorpusEn));
+    } else {
+        corpus.assign(std::begin(kDefaultCorpusZh), std::end(kDefaultCorpusZh));
+    }
+    if (corpus.empty()) {
+        std::cerr << "语料为空" << std::endl;
+        return 1;
+    }
+    TextPicker picker(corpus, mix);
+
+    int hw_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (options.workers <= 0) options.workers = hw_threads;
+    if (levels.empty()) {
+        for (int c = 1; c < hw_threads; c *= 2) levels.push_back(c);
+        levels.push_back(hw_threads);
+    }
+
+    // 实例数：闭环为最大并发数，开环为工作线程数；每个实例预热一句
+    size_t instance_count = arrival == "closed"
+                                ? static_cast<size_t>(*std::max_element(levels.begin(), levels.end()))
+                                : static_cast<size_t>(options.workers);
+    std::vector<std::unique_ptr<melotts::MeloTTS>> instances;
+    try {
+        for (size_t i = 0; i < instance_count; i++) {
+            instances.emplace_back(new melotts::MeloTTS(config));
+            instances.back()->synthesize(corpus[0], options.language);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "加载模型失败: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<LevelResult> results;
+    for (double level : levels) {
+        if (level <= 0.0) continue;
+        std::vector<Sample> samples;
+        size_t dropped = 0;
+        Clock::time_point start = Clock::now();
+        if (arrival == "closed") {
+            samples = run_closed(instances, static_cast<int>(level), picker, options);
+        } else {
+            samples = run_poisson(instances, level, picker, options, dropped);
+        }
+        double elapsed = ms_since(start) / 1000.0;
+        results.push_back(summarize(level, samples, dropped, elapsed, slo_p99_ms, slo_ttfa_ms));
+        const LevelResult& r = results.back();
+        std::cerr << (arrival == "closed" ? "并发 " : "到达率 ") << level << ": " << r.completed << " 个请求, "
+                  << std::fixed << std::setprecision(2) << r.rps << " 请求/秒, p99 " << r.p99_ms << " ms, 首包 p99 "
+                  << r.ttfa_p99_ms << " ms" << (r.within_slo ? "" : " [超出目标]") << std::endl;
+        std::cerr.unsetf(std::ios::fixed);
+        std::cerr.precision(6);
+        if (!r.within_slo && !all_levels) break;
+    }
+
+    std::cout << (arrival == "closed" ? "并发数" : "到达率(请求/秒)")
+              << "\t完成\t失败\t请求/秒\t音频秒/秒\tCPU(ms)/请求\tp50(ms)\tp99(ms)\t首包p50(ms)\t首包p99(ms)\t目标" << std::endl;
+    const LevelResult* best = nullptr;
+    for (const auto& r : results) {
+        std::cout << r.level << "\t" << r.completed << "\t" << r.errors << "\t" << std::fixed << std::setprecision(2)
+                  << r.rps << "\t" << r.audio_per_sec << "\t" << r.cpu_ms << "\t" << r.p50_ms << "\t" << r.p99_ms << "\t"
+                  << r.ttfa_p50_ms << "\t" << r.ttfa_p99_ms << "\t" << (r.within_slo ? "满足" : "超出") << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout.precision(6);
+        if (r.within_slo && (!best || r.rps > best->rps)) best = &r;
+    }
+    if (best) {
+        std::cout << "可持续吞吐 (p99 <= " << slo_p99_ms << " ms, 首包 p99 <= " << slo_ttfa_ms << " ms, "
+                  << (arrival == "closed" ? "并发 " : "到达率 ") << best->level << "): " << std::fixed
+                  << std::setprecision(2) << best->rps << " 请求/秒, " << best->audio_per_sec << " 音频秒/秒"
+                  << std::endl;
+    } else {
+        std::cout << "没有满足目标的负载级别" << std::endl;
+    }
+
+    // --set slow_request_ms=N 时输出超出阈值的请求（含排队时间）及其分阶段明细
+    const melotts::SlowRequestLog& slow_log = melotts::GlobalSlowRequestLog();
+    if (slow_log.Recorded() > 0) {
+        std::cerr << "慢请求: 共 " << slow_log.Recorded() << " 条 (保留最近 " << slow_log.Capacity() << " 条)"
+                  << std::endl;
+        slow_log.Dump(std::cerr);
+    }
+    return 0;
+}
@@ -2,10 +2,15 @@
 
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <iomanip>
 #include <sys/time.h>
 #include <algorithm>
 #include "melotts.h"
 #include "MeloTTSConfig.h"
+#include "Prefork.h"
+#include "SlowRequestLog.h"
+#include <csignal>
 
 // 获取当前时间（毫秒）
 static double get_current_time() {
@@ -14,6 +19,14 @@ static double get_current_time() {
     return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
 }
 
+// 输出慢请求日志（--slow-ms），没有记录时不输出
+static void dump_slow_requests() {
+    const melotts::SlowRequestLog& log = melotts::GlobalSlowRequestLog();
+    if (log.Recorded() == 0) return;
+    std::cerr << "慢请求: 共 " << log.Recorded() << " 条 (保留最近 " << log.Capacity() << " 条)" << std::endl;
+    log.Dump(std::cerr);
+}
+
 // 打印帮助信息
 void print_usage(const char* program_name) {
     std::cout << "用法: " << program_name << " [选项]" << std::endl;
@@ -25,6 +38,20 @@ void print_usage(const char* program_name) {
     std::cout << "  -s, --speed SPEED      语速 (默认: 1.0)" << std::endl;
     std::cout << "  -sp, --speaker ID      说话人ID (默认: 0)" << std::endl;
     std::cout << "  -r, --sample-rate RATE 采样率 (默认: 24000)" << std::endl;
+    std::cout << "  -ts, --timestamps FILE 输出音素/词级时间戳到文件 (TSV格式)" << std::endl;
+    std::cout << "  -p, --precision P      模型精度: fp32 或 int8 (默认: fp32)" << std::endl;
+    std::cout << "  --calib-dir DIR        采集量化校准数据到目录" << std::endl;
+    std::cout << "  --ops-lib FILE         注册融合算子库 (libmelotts_ops.so)" << std::endl;
+    std::cout << "  --encoder-backend B    声学模型后端: onnxruntime 或 native (默认: 调优配置中的取值或 onnxruntime)" << std::endl;
+    std::cout << "  --decoder-backend B    声码器后端: onnxruntime 或 native (默认: 同上)" << std::endl;
+    std::cout << "  --variant NAME         使用变体清单 (variants.txt) 中的指定模型变体" << std::endl;
+    std::cout << "  --latency-budget MS    按首包延迟预算 (毫秒) 选择模型变体" << std::endl;
+    std::cout << "  --quality-tier TIER    按质量等级选择模型变体" << std::endl;
+    std::cout << "  -tf, --text-file FILE  逐行合成文本文件 (用于采集校准数据，不保存音频)" << std::endl;
+    std::cout << "  --lazy-load            词典按语言、声码器在首次合成时才加载 (单语言或小型服务启动更快)" << std::endl;
+    std::cout << "  --workers N            与 -tf 同用：父进程加载并预热后 fork 出N个工作进程分担各行 (prefork)" << std::endl;
+    std::cout << "  --slow-ms MS           记录耗时超过MS毫秒的请求及其分阶段明细，结束时输出；运行中可发送 SIGUSR2 输出" << std::endl;
+    std::cout << "  --stats                输出初始化各组件和合成各阶段的耗时、CPU时间、堆分配和内存占用 (分配计数需以 MELOTTS_ALLOC_STATS 编译)" << std::endl;
     std::cout << "  -v, --verbose          显示详细信息" << std::endl;
     std::cout << "  -h, --help             显示此帮助信息" << std::endl;
 }
@@ -82,6 +109,20 @@ int main(int argc, char* argv[]) {
     int sample_rate = 24000;
     bool verbose = true;
     bool diagnose_mode = false;
+    std::string timestamps_file;
+    std::string precision = "fp32";
+    std::string calib_dir;
+    std::string ops_lib;
+    std::string encoder_backend;
+    std::string decoder_backend;
+    std::string text_file;
+    std::string variant;
+    double latency_budget_ms = 0.0;
+    std::string quality_tier;
+    bool print_stats = false;
+    bool lazy_load = false;
+    int workers = 0;
+    double slow_ms = 0.0;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -100,6 +141,34 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc) speaker_id = std::stoi(argv[++i]);
         } else if (arg == "-r" || arg == "--sample-rate") {
             if (i + 1 < argc) sample_rate = std::stoi(argv[++i]);
+        } else if (arg == "-ts" || arg == "--timestamps") {
+            if (i + 1 < argc) timestamps_file = argv[++i];
+        } else if (arg == "-p" || arg == "--precision") {
+            if (i + 1 < argc) precision = argv[++i];
+        } else if (arg == "--calib-dir") {
+            if (i + 1 < argc) calib_dir = argv[++i];
+        } else if (arg == "--ops-lib") {
+            if (i + 1 < argc) ops_lib = argv[++i];
+        } else if (arg == "--encoder-backend") {
+            if (i + 1 < argc) encoder_backend = argv[++i];
+        } else if (arg == "--decoder-backend") {
+            if (i + 1 < argc) decoder_backend = argv[++i];
+        } else if (arg == "--variant") {
+            if (i + 1 < argc) variant = argv[++i];
+        } else if (arg == "--latency-budget") {
+            if (i + 1 < argc) latency_budget_ms = std::stod(argv[++i]);
+        } else if (arg == "--quality-tier") {
+            if (i + 1 < argc) quality_tier = argv[++i];
+        } else if (arg == "-tf" || arg == "--text-file") {
+            if (i + 1 < argc) text_file = argv[++i];
+        } else if (arg == "--lazy-load") {
+            lazy_load = true;
+        } else if (arg == "--workers") {
+            if (i + 1 < argc) workers = std::stoi(argv[++i]);
+        } else if (arg == "--slow-ms") {
+            if (i + 1 < argc) slow_ms = std::stod(argv[++i]);
+        } else if (arg == "--stats") {
+            print_stats = true;
         } else if (arg == "-v" || arg == "--verbose") {
             verbose = true;
         } else if (arg == "-d" || arg == "--diagnose") {
@@ -123,6 +192,19 @@ int main(int argc, char* argv[]) {
         config.speaker_id = speaker_id;
         config.sample_rate = sample_rate;
         config.verbose = verbose;
+        config.encoder_precision = precision;
+        config.decoder_precision = precision;
+        config.calibration_dir = calib_dir;
+        config.custom_ops_library = ops_lib;
+        // 显式指定的后端优先于调优配置
+        if (!encoder_backend.empty()) config.set("encoder_backend", encoder_backend);
+        if (!decoder_backend.empty()) config.set("decoder_backend", decoder_backend);
+        config.model_variant = variant;
+        config.latency_budget_ms = latency_budget_ms;
+        config.quality_tier = quality_tier;
+        config.lazy_lexicon = lazy_load;
+        config.defer_decoder = lazy_load;
+        config.slow_request_ms = slow_ms;
         
         if (verbose) {
             std::cout << "MeloTTS 命令行工具" << std::endl;
@@ -131,10 +213,61 @@ int main(int argc, char* argv[]) {
         
         double start_time, end_time;
         
+        // prefork 批量模式：父进程加载并预热，各工作进程按行号分担文本文件
+        if (workers > 0) {
+            if (text_file.empty()) {
+                std::cerr << "--workers 需要与 --text-file 同用" << std::endl;
+                return 1;
+            }
+            if (!calib_dir.empty()) {
+                std::cerr << "--workers 不能与 --calib-dir 同用" << std::endl;
+                return 1;
+            }
+            std::ifstream in(text_file);
+            if (!in) {
+                std::cerr << "无法打开文本文件: " << text_file << std::endl;
+                return 1;
+            }
+            std::vector<std::string> lines;
+            std::string line;
+            while (std::getline(in, line)) {
+                if (!line.empty()) lines.push_back(line);
+            }
+            
+            melotts::PreforkOptions prefork_options;
+            prefork_options.workers = workers;
+            start_time = get_current_time();
+            int result = melotts::RunPrefork(config, prefork_options, [&](melotts::MeloTTS& worker_tts, int index) {
+                int count = 0, failed = 0;
+                double worker_start = get_current_time();
+                for (size_t k = static_cast<size_t>(index); k < lines.size(); k += static_cast<size_t>(workers)) {
+                    try {
+                        worker_tts.synthesize(lines[k], language);
+                        count++;
+                    } catch (const std::exception& e) {
+                        std::cerr << "合成失败: " << lines[k] << ": " << e.what() << std::endl;
+                        failed++;
+                    }
+                }
+                std::cout << "工作进程 " << index << ": " << count << " 句成功, " << failed << " 句失败, 耗时 "
+                          << (get_current_time() - worker_start) << " ms" << std::endl;
+                dump_slow_requests();
+                return failed == 0 ? 0 : 1;
+            });
+            end_time = get_current_time();
+            std::cout << "批量合成完成 (" << workers << " 个工作进程), 总耗时 " << (end_time - start_time) << " ms"
+                      << std::endl;
+            return result;
+        }
+        
+        // 单进程运行时可随时发送 SIGUSR2 查看慢请求（prefork 的工作进程在结束时各自输出）
+        if (slow_ms > 0.0) {
+            melotts::InstallSlowRequestDumpSignal(SIGUSR2);
+        }
+        
         // 初始化 MeloTTS
         start_time = get_current_time();
-        melotts::MeloTTS tts(model_dir);
-        tts.set_config(config);
+        melotts::MeloTTS tts(config);
         end_time = get_current_time();
         
         if (verbose) {
@@ -171,9 +304,64 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         
+        // 批量模式：逐行合成，用于采集校准数据
+        if (!text_file.empty()) {
+            std::ifstream in(text_file);
+            if (!in) {
+                std::cerr << "无法打开文本文件: " << text_file << std::endl;
+                return 1;
+            }
+            
+            std::string line;
+            int count = 0, failed = 0;
+            start_time = get_current_time();
+            while (std::getline(in, line)) {
+                if (line.empty()) continue;
+                try {
+                    tts.synthesize(line, language);
+                    count++;
+                } catch (const std::exception& e) {
+                    std::cerr << "合成失败: " << line << ": " << e.what() << std::endl;
+                    failed++;
+                }
+            }
+            end_time = get_current_time();
+            
+            std::cout << "批量合成完成: " << count << " 句成功, " << failed << " 句失败, 耗时 "
+                      << (end_time - start_time) << " ms" << std::endl;
+            dump_slow_requests();
+            if (!calib_dir.empty()) {
+                std::cout << "校准数据已保存到: " << calib_dir << std::endl;
+            }
+            return 0;
+        }
+        
         // 合成语音
         start_time = get_current_time();
-        std::vector<float> audio = tts.synthesize(text, language);
+        std::vector<float> audio;
+        if (timestamps_file.empty()) {
+            audio = tts.synthesize(text, language);
+        } else {
+            melotts::SynthesisResult result = tts.synthesize_with_timestamps(text, language);
+            audio.swap(result.audio);
+            
+            // 写出时间戳：类型、标签、起止时间（秒）
+            std::ofstream ts_out(timestamps_file);
+            if (!ts_out) {
+                std::cerr << "无法写入时间戳文件: " << timestamps_file << std::endl;
+                return 1;
+            }
+            ts_out << "type\tlabel\tstart\tend" << std::endl;
+            for (const auto& w : result.words) {
+                ts_out << "word\t" << w.word << "\t" << w.start << "\t" << w.end << std::endl;
+            }
+            for (const auto& p : result.phonemes) {
+                ts_out << "phoneme\t" << p.phoneme << "\t" << p.start << "\t" << p.end << std::endl;
+            }
+            if (verbose) {
+                std::cout << "时间戳已保存到: " << timestamps_file << std::endl;
+            }
+        }
         end_time = get_current_time();
         
         if (verbose) {
@@ -182,6 +370,22 @@ int main(int argc, char* argv[]) {
             std::cout << "音频时长: " << audio.size() * 1.0 / sample_rate << " 秒" << std::endl;
         }
         
+        if (print_stats) {
+            std::cout << "初始化组件\t耗时(ms)\t分配次数\t分配字节\t峰值RSS(KB)" << std::endl;
+            for (const auto& component : tts.init_stats()) {
+                std::cout << component.name << "\t" << std::fixed << std::setprecision(2) << component.ms << "\t"
+                          << component.allocs << "\t" << component.alloc_bytes << "\t" << component.peak_rss_kb
+                          << std::endl;
+            }
+            std::cout << "阶段\t耗时(ms)\tCPU(ms)\t进程CPU(ms)\t分配次数\t分配字节\t峰值RSS(KB)\t内存池(字节)" << std::endl;
+            for (const auto& stage : tts.last_stage_stats()) {
+                std::cout << stage.name << "\t" << std::fixed << std::setprecision(2) << stage.ms << "\t"
+                          << stage.cpu_ms << "\t" << stage.process_cpu_ms << "\t" << stage.allocs << "\t"
+                          << stage.alloc_bytes << "\t" << stage.peak_rss_kb << "\t" << stage.arena_bytes << std::endl;
+            }
+            std::cout.unsetf(std::ios::fixed);
+        }
+        
         // 保存为WAV文件
         start_time = get_current_time();
         if (!tts.save_wav(audio, output_file, sample_rate)) {
@@ -195,6 +399,7 @@ int main(int argc, char* argv[]) {
         }
         
         std::cout << "合成完成! 音频已保存到: " << output_file << std::endl;
+        dump_slow_requests();
         
     } catch (const std::exception& e) {
         std::cerr << "错误: " << e.what() << std::endl;
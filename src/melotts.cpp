@@ -4,21 +4,35 @@
 #include <fstream>
 #include <iostream>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <memory>
 #include <chrono>
 #include <future>
+#include <functional>
+#include <map>
 #include <stdexcept>
 #include <sys/time.h>
 
 // 项目头文件
 #include "melotts.h"
 #include "MeloTTSConfig.h"
+#include "AllocStats.h"
 #include "Lexicon.hpp"
-#include "OnnxWrapper.hpp"
+#include "InferenceBackend.h"
 #include "AudioFile.h"
+#include "CalibrationRecorder.hpp"
+#include "PipelineUtils.hpp"
+#include "ModelVariants.hpp"
+#include "TuningProfile.hpp"
+#include "RequestArena.hpp"
+#include "Probes.hpp"
+#include "SlowRequestLog.h"
 
 namespace melotts {
 
@@ -29,95 +43,174 @@ static double get_current_time() {
     return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
 }
 
-// 在音素序列中插入空白
-static std::vector<int> intersperse(const std::vector<int>& lst, int item) {
-    std::vector<int> result(lst.size() * 2 + 1, item);
-    for (size_t i = 1; i < result.size(); i += 2) {
-        result[i] = lst[i / 2];
-    }
-    return result;
+// 进程内的合成请求序号，供 USDT 探针关联同一请求的各阶段
+static std::atomic<uint64_t> g_next_request_id(0);
+
+// 汇总一个阶段（或初始化组件）的耗时、当前线程的堆分配、峰值RSS和后端内存池占用
+static StageStats makeStageStats(const std::string& name, double ms, const AllocScope& allocs, const CpuScope& cpu,
+                                 size_t arena_bytes) {
+    StageStats stats;
+    stats.name = name;
+    stats.ms = ms;
+    stats.cpu_ms = cpu.ThreadMs();
+    stats.process_cpu_ms = cpu.ProcessMs();
+    AllocCounters delta = allocs.Delta();
+    stats.allocs = delta.count;
+    stats.alloc_bytes = delta.bytes;
+    stats.peak_rss_kb = PeakRssKb();
+    stats.arena_bytes = arena_bytes;
+    return stats;
 }
 
-// 新增：特征重排序函数，正确处理特征维度转换
-static std::vector<float> reshapeFeatures(const std::vector<float>& features, 
-                                         int feature_frames, int zp_channels, int dec_len) {
-    // 创建结果缓冲区
-    std::vector<float> reshaped(zp_channels * dec_len, 0.0f);
-    
-    // 计算需要处理的帧数
-    int frames_to_process = std::min(dec_len, feature_frames);
-    
-    // 重要：理解原始特征的内存布局
-    for (int c = 0; c < zp_channels; c++) {
-        for (int f = 0; f < frames_to_process; f++) {
-            // 源索引 - 通道优先布局
-            int src_idx = c * feature_frames + f;
-            
-            // 目标索引 - [channels, frames]格式
-            int dst_idx = c * dec_len + f;
-            
-            if (src_idx < static_cast<int>(features.size())) {
-                reshaped[dst_idx] = features[src_idx];
-            }
+// 复制字符串到定长缓冲区，超长时截断，结果总以'\0'结尾
+static void copyTruncated(const std::string& src, char* dst, size_t size) {
+    size_t n = std::min(src.size(), size - 1);
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+// 模型文件的标识：文件名、大小和按固定间隔抽样的内容摘要（FNV-1a），不含目录和修改时间，
+// 文件复制到其他目录或机器后不变。只读取约64个4KB块，其中总包含末尾一块（ONNX的图结构和元数据通常在此），
+// 大模型也只需几毫秒
+static std::string fileIdentity(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("无法读取模型文件: " + path);
+    }
+    const uint64_t size = static_cast<uint64_t>(file.tellg());
+    const uint64_t block = 4096, blocks = 64;
+    std::vector<uint64_t> offsets;
+    uint64_t stride = std::max<uint64_t>(block, size / blocks);
+    for (uint64_t offset = 0; offset + block < size; offset += stride) {
+        offsets.push_back(offset);
+    }
+    offsets.push_back(size > block ? size - block : 0);
+    uint64_t hash = 1469598103934665603ULL;
+    char buffer[4096];
+    for (uint64_t offset : offsets) {
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(buffer, static_cast<std::streamsize>(std::min(block, size - offset)));
+        for (std::streamsize i = 0; i < file.gcount(); i++) {
+            hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211ULL;
         }
     }
-    
-    return reshaped;
+    char digest[17];
+    snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(hash));
+    size_t slash = path.find_last_of('/');
+    return (slash == std::string::npos ? path : path.substr(slash + 1)) + ":" + std::to_string(size) + ":" + digest;
 }
 
-// 新增：音频后处理函数，提高音质和清晰度
-static std::vector<float> postProcessAudio(const std::vector<float>& audio, int target_len, bool enhance = true) {
-    // 1. 裁剪到目标长度
-    std::vector<float> result = audio;
-    if (result.size() > static_cast<size_t>(target_len)) {
-        result.resize(target_len);
-    } else if (result.size() < static_cast<size_t>(target_len)) {
-        result.resize(target_len, 0.0f);
+// 初始化组件的运行结果，失败时error非空
+struct ComponentResult {
+    StageStats stats;
+    std::string error;
+};
+
+// 运行一个初始化组件（可在任意线程），记录耗时与分配，异常转为带组件名的错误信息
+template <typename Fn>
+static ComponentResult runComponent(const std::string& name, Fn fn) {
+    ComponentResult result;
+    double start = get_current_time();
+    AllocScope allocs;
+    CpuScope cpu;
+    try {
+        fn();
+    } catch (const std::exception& e) {
+        result.error = name + ": " + e.what();
     }
+    result.stats = makeStageStats(name, get_current_time() - start, allocs, cpu, 0);
+    return result;
+}
+
+// 根据音素时长计算音素级和词级时间戳
+// durations与插入空白后的音素序列一一对应（单位：帧），word_spans为插入空白前的音素区间。
+// 与Python版word2ph的约定一致：第一个词额外包含开头的空白，其余每个音素包含其后的空白。
+template <typename IntVector>
+static void buildTimestamps(const IntVector& phones,
+                            const std::vector<float>& durations,
+                            const std::vector<Lexicon::WordSpan>& word_spans,
+                            int audio_len, int sample_rate, const Lexicon& lexicon,
+                            std::vector<PhonemeTimestamp>& phoneme_stamps,
+                            std::vector<WordTimestamp>& word_stamps) {
+    phoneme_stamps.clear();
+    word_stamps.clear();
     
-    if (!enhance) return result;
+    if (phones.empty() || durations.size() != phones.size() || sample_rate <= 0) {
+        return;
+    }
     
-    // 2. 音频归一化 - 提高音量并减少失真
-    float max_amp = 0.0f;
-    for (const auto& sample : result) {
-        max_amp = std::max(max_amp, std::abs(sample));
+    double total_frames = 0.0;
+    for (float d : durations) {
+        total_frames += std::max(0.0f, d);
+    }
+    if (total_frames <= 0.0) {
+        return;
     }
     
-    // 避免除以零
-    if (max_amp > 0.001f) {
-        // 设置目标振幅为0.85（提高音量但避免削波）
-        float target_amp = 0.85f;
-        float scale = target_amp / max_amp;
-        
-        for (auto& sample : result) {
-            sample *= scale;
-            
-            // 软削波以避免失真
-            if (sample > 0.95f) {
-                sample = 0.95f + 0.05f * tanh((sample - 0.95f) / 0.05f);
-            } else if (sample < -0.95f) {
-                sample = -0.95f + 0.05f * tanh((sample + 0.95f) / 0.05f);
-            }
+    // 每帧对应的秒数，由audio_len反推，避免依赖声码器的hop长度
+    double sec_per_frame = static_cast<double>(audio_len) / total_frames / sample_rate;
+    
+    // 插入空白后的下标 -> 词下标
+    std::vector<int> word_of(phones.size(), -1);
+    std::vector<std::pair<size_t, size_t>> word_ranges;
+    word_ranges.reserve(word_spans.size());
+    for (size_t w = 0; w < word_spans.size(); w++) {
+        size_t begin = (w == 0) ? 0 : 2 * word_spans[w].phone_start + 1;
+        size_t end = std::min(phones.size(), 2 * (word_spans[w].phone_start + word_spans[w].phone_count) + 1);
+        for (size_t i = begin; i < end; i++) {
+            word_of[i] = static_cast<int>(w);
         }
+        word_ranges.push_back(std::make_pair(begin, end));
     }
     
-    // 3. 简单去噪 - 移除低振幅噪声
-    const float noise_gate = 0.01f;
-    for (auto& sample : result) {
-        if (std::abs(sample) < noise_gate) {
-            sample = 0.0f;
-        }
+    // 音素级时间戳：按时长累加
+    phoneme_stamps.resize(phones.size());
+    double t = 0.0;
+    for (size_t i = 0; i < phones.size(); i++) {
+        PhonemeTimestamp& ps = phoneme_stamps[i];
+        ps.phone_id = phones[i];
+        ps.phoneme = lexicon.getToken(phones[i]);
+        ps.word_index = word_of[i];
+        ps.start = static_cast<float>(t);
+        t += std::max(0.0f, durations[i]) * sec_per_frame;
+        ps.end = static_cast<float>(t);
     }
     
-    return result;
+    // 词级时间戳：取所覆盖音素的首尾
+    word_stamps.reserve(word_spans.size());
+    for (size_t w = 0; w < word_spans.size(); w++) {
+        size_t begin = word_ranges[w].first;
+        size_t end = word_ranges[w].second;
+        if (begin >= end) continue;
+        
+        WordTimestamp ws;
+        ws.word = word_spans[w].word;
+        ws.start = phoneme_stamps[begin].start;
+        ws.end = phoneme_stamps[end - 1].end;
+        word_stamps.push_back(ws);
+    }
 }
 
 class MeloTTSImpl {
 public:
+    // 每段解码结果的回调：(本段音频, 起始采样点, 是否最后一段)
+    using SliceCallback = std::function<void(std::vector<float>&, size_t, bool)>;
+    
     MeloTTSImpl(const std::string& model_dir) : config_() {
         config_.model_dir = model_dir;
         config_.enhance_audio = true; // 默认开启音频增强
+        apply_tuning_profile();
+        initialize();
+    }
+    
+    // 按完整配置初始化（模型精度、校准数据目录等在加载模型时即生效）
+    explicit MeloTTSImpl(const MeloTTSConfig& config) : config_(config) {
+        if (!config_.validate()) {
+            throw std::invalid_argument("MeloTTS配置无效");
+        }
+        apply_tuning_profile();
         initialize();
+        update_calibration();
     }
     
     ~MeloTTSImpl() {
@@ -174,14 +267,62 @@ public:
     }
     
     void set_config(const MeloTTSConfig& config) {
+        MeloTTSConfig old_config = config_;
         config_ = config;
         if (!config_.validate()) {
             std::cerr << "警告: 配置验证失败，使用默认配置" << std::endl;
             config_ = MeloTTSConfig();
         }
+        apply_tuning_profile();
         if (config_.verbose) {
             config_.print();
         }
+        
+        // 模型目录或精度变化时重新加载模型
+        if (config_.model_dir != old_config.model_dir ||
+            config_.encoder_precision != old_config.encoder_precision ||
+            config_.decoder_precision != old_config.decoder_precision ||
+            config_.custom_ops_library != old_config.custom_ops_library ||
+            config_.encoder_backend != old_config.encoder_backend ||
+            config_.decoder_backend != old_config.decoder_backend ||
+            config_.variant_manifest != old_config.variant_manifest ||
+            config_.intra_op_num_threads != old_config.intra_op_num_threads ||
+            config_.encoder_threads != old_config.encoder_threads ||
+            config_.decoder_threads != old_config.decoder_threads ||
+            config_.shared_thread_pool != old_config.shared_thread_pool ||
+            config_.share_weights != old_config.share_weights) {
+            initialize();
+        } else {
+            // 变体选择和分段设置可能变化，已加载的模型直接复用
+            select_variant(config_variant_request());
+        }
+        update_calibration();
+    }
+    
+    // 切换模型变体：先按请求选择，加载失败的变体标记为不可用后继续选择，都不可用时使用默认模型
+    std::string select_variant(const VariantRequest& request) {
+        bool wants_variant = !request.variant.empty() || request.latency_budget_ms > 0.0 ||
+                             !request.quality_tier.empty();
+        if (wants_variant && variants_.empty()) {
+            std::cerr << "警告: 未找到模型变体清单，使用默认模型" << std::endl;
+        }
+        while (wants_variant && !variants_.empty()) {
+            const ModelVariant* variant = variants_.Select(request.variant, request.quality_tier,
+                                                           request.latency_budget_ms);
+            if (!variant) {
+                std::cerr << "警告: 没有可用的模型变体，使用默认模型" << std::endl;
+                break;
+            }
+            try {
+                activate_models(variant);
+                return active_variant_;
+            } catch (const std::exception& e) {
+                std::cerr << "警告: 模型变体 " << variant->name << " 加载失败，尝试其他变体 (" << e.what() << ")" << std::endl;
+                variants_.MarkUnavailable(variant->name);
+            }
+        }
+        activate_models(nullptr);
+        return active_variant_;
     }
     
     // 设置音频增强开关
@@ -194,6 +335,28 @@ public:
     
     // 主要TTS合成函数
     std::vector<float> synthesize(const std::string& text, const std::string& language) {
+        return synthesize_internal(text, language, nullptr, ChunkCallback());
+    }
+    
+    // 合成并返回时间戳
+    SynthesisResult synthesize_with_timestamps(const std::string& text, const std::string& language) {
+        SynthesisResult result;
+        result.audio = synthesize_internal(text, language, &result, ChunkCallback());
+        return result;
+    }
+    
+    // 流式合成
+    void synthesize_stream(const std::string& text, const ChunkCallback& on_chunk, const std::string& language) {
+        if (!on_chunk) {
+            throw std::invalid_argument("流式合成回调不能为空");
+        }
+        synthesize_internal(text, language, nullptr, on_chunk);
+    }
+    
+    // 合成流程：timestamps非空时填充时间戳，on_chunk非空时按段回调。
+    // 成功或失败都结束本次请求：恢复噪声参数、清零调用方告知的排队时间，超出阈值时记入慢请求日志
+    std::vector<float> synthesize_internal(const std::string& text, const std::string& language,
+                                           SynthesisResult* timestamps, const ChunkCallback& on_chunk) {
         if (text.empty()) {
             throw std::invalid_argument("输入文本不能为空");
         }
@@ -206,24 +369,65 @@ public:
         float original_noise_scale = config_.noise_scale;
         float original_noise_scale_w = config_.noise_scale_w;
         
-        // 优化参数 - 降低噪声以提高清晰度
-        config_.noise_scale = 0.1f;      // 降低噪声比例，提高清晰度
-        config_.noise_scale_w = 0.3f;    // 降低音素持续时间噪声
+        // 优化参数 - 降低噪声以提高清晰度（只降低不提高，配置为0时输出确定）
+        config_.noise_scale = std::min(config_.noise_scale, 0.1f);      // 降低噪声比例，提高清晰度
+        config_.noise_scale_w = std::min(config_.noise_scale_w, 0.3f);  // 降低音素持续时间噪声
+        
+        double request_start = get_current_time();
+        double queue_wait_ms = queue_wait_ms_;
+        queue_wait_ms_ = 0.0;
+        stage_stats_.clear();
+        request_id_ = ++g_next_request_id;
+        request_phones_ = 0;
+        decoded_slices_ = 0;
+        MELOTTS_PROBE2(request_start, request_id_, text.size());
+        
+        std::vector<float> audio;
+        try {
+            audio = run_synthesis(text, language, timestamps, on_chunk);
+        } catch (...) {
+            config_.noise_scale = original_noise_scale;
+            config_.noise_scale_w = original_noise_scale_w;
+            finish_request(text, language, 0, get_current_time() - request_start, queue_wait_ms, true);
+            MELOTTS_PROBE2(request_failed, request_id_, decoded_slices_);
+            throw;
+        }
+        
+        // 恢复原始参数
+        config_.noise_scale = original_noise_scale;
+        config_.noise_scale_w = original_noise_scale_w;
         
+        finish_request(text, language, audio.size(), get_current_time() - request_start, queue_wait_ms, false);
+        MELOTTS_PROBE2(request_done, request_id_, audio.size());
+        return audio;
+    }
+    
+    // 合成的各个阶段，由 synthesize_internal 调用
+    std::vector<float> run_synthesis(const std::string& text, const std::string& language,
+                                     SynthesisResult* timestamps, const ChunkCallback& on_chunk) {
         double start, end;
         
+        // 本次请求的中间缓冲区都从内存区分配，请求结束时整体归还
+        ArenaLease lease;
+        
         // 步骤1: 文本转音素
         start = get_current_time();
+        AllocScope text_allocs;
+        CpuScope text_cpu;
         if (config_.verbose) {
             std::cout << "转换文本为音素..." << std::endl;
         }
         
-        // 获取音素和声调序列
-        auto phonemes_result = text_to_phonemes(text, language);
-        auto phones = phonemes_result.first;
-        auto tones = phonemes_result.second;
+        // 获取音素和声调序列，需要时间戳时同时记录分词区间
+        bool need_timestamps = timestamps != nullptr || static_cast<bool>(on_chunk);
+        std::vector<Lexicon::WordSpan> word_spans;
+        ArenaVector<int> phones = lease.Vector<int>();
+        ArenaVector<int> tones = lease.Vector<int>();
+        convert_text(text, language, phones, tones, need_timestamps ? &word_spans : nullptr);
+        request_phones_ = phones.size();
         
         end = get_current_time();
+        record_stage("文本处理", end - start, text_allocs, text_cpu, 0);
         if (config_.verbose) {
             std::cout << "文本处理耗时: " << (end - start) << " ms" << std::endl;
             std::cout << "音素序列长度: " << phones.size() << std::endl;
@@ -231,37 +435,103 @@ public:
         
         // 步骤2: 音素到声学特征
         start = get_current_time();
+        AllocScope encoder_allocs;
+        CpuScope encoder_cpu;
         if (config_.verbose) {
             std::cout << "生成声学特征..." << std::endl;
         }
         
-        auto features = phonemes_to_features(phones, tones);
+        std::vector<float> durations;
+        ArenaVector<float> features = lease.Vector<float>();
+        int audio_len = phonemes_to_features(lease, phones, tones, features, need_timestamps ? &durations : nullptr);
         
         end = get_current_time();
+        record_stage("声学模型", end - start, encoder_allocs, encoder_cpu, encoder_->ArenaBytes());
         if (config_.verbose) {
             std::cout << "声学模型推理耗时: " << (end - start) << " ms" << std::endl;
-            std::cout << "特征向量大小: " << features.first.size() << std::endl;
-            std::cout << "预期音频长度: " << features.second << " 采样点" << std::endl;
+            std::cout << "特征向量大小: " << features.size() << std::endl;
+            std::cout << "预期音频长度: " << audio_len << " 采样点" << std::endl;
+        }
+        
+        // 由音素时长换算时间戳，不需要额外推理
+        std::vector<PhonemeTimestamp> phoneme_stamps;
+        std::vector<WordTimestamp> word_stamps;
+        if (need_timestamps) {
+            buildTimestamps(phones, durations, word_spans, audio_len, config_.sample_rate,
+                            lexicon_for(language), phoneme_stamps, word_stamps);
+            
+            if (config_.verbose) {
+                std::cout << "时间戳: " << phoneme_stamps.size() << " 个音素, "
+                          << word_stamps.size() << " 个词" << std::endl;
+            }
+        }
+        
+        // 流式输出：将落在本段内的时间戳随音频块一起回调
+        SliceCallback on_slice;
+        if (on_chunk) {
+            on_slice = [&](std::vector<float>& slice, size_t offset, bool is_last) {
+                AudioChunk chunk;
+                chunk.offset = offset;
+                chunk.is_last = is_last;
+                
+                double chunk_begin = static_cast<double>(offset) / config_.sample_rate;
+                double chunk_end = static_cast<double>(offset + slice.size()) / config_.sample_rate;
+                for (const auto& ps : phoneme_stamps) {
+                    if (ps.start >= chunk_begin && (ps.start < chunk_end || is_last)) {
+                        chunk.phonemes.push_back(ps);
+                    }
+                }
+                for (const auto& ws : word_stamps) {
+                    if (ws.start >= chunk_begin && (ws.start < chunk_end || is_last)) {
+                        chunk.words.push_back(ws);
+                    }
+                }
+                
+                chunk.audio.swap(slice);
+                on_chunk(chunk);
+            };
         }
         
-        // 步骤3: 声学特征到波形
+        // 步骤3: 声学特征到波形（流式合成时包含回调中的分配）
         start = get_current_time();
+        AllocScope decoder_allocs;
+        CpuScope decoder_cpu;
         if (config_.verbose) {
             std::cout << "生成波形..." << std::endl;
         }
         
-        auto audio = features_to_waveform(features.first, features.second);
+        auto audio = features_to_waveform(lease, features, audio_len, on_slice);
         
         end = get_current_time();
+        record_stage("声码器", end - start, decoder_allocs, decoder_cpu, decoder_->ArenaBytes());
         if (config_.verbose) {
             std::cout << "声码器推理耗时: " << (end - start) << " ms" << std::endl;
             std::cout << "生成音频长度: " << audio.size() << " 采样点" << std::endl;
             std::cout << "音频时长: " << audio.size() * 1.0 / config_.sample_rate << " 秒" << std::endl;
         }
         
-        // 恢复原始参数
-        config_.noise_scale = original_noise_scale;
-        config_.noise_scale_w = original_noise_scale_w;
+        // 步骤4: 后处理并整理输出
+        start = get_current_time();
+        AllocScope output_allocs;
+        CpuScope output_cpu;
+        
+        MELOTTS_PROBE2(postprocess_start, request_id_, audio.size());
+        if (config_.enhance_audio) {
+            enhanceAudio(audio.data(), audio.data() + audio.size());
+        }
+        MELOTTS_PROBE2(postprocess_done, request_id_, audio.size());
+        
+        if (timestamps) {
+            timestamps->phonemes.swap(phoneme_stamps);
+            timestamps->words.swap(word_stamps);
+        }
+        
+        end = get_current_time();
+        record_stage("输出", end - start, output_allocs, output_cpu, 0);
+        accumulate_stage_totals();
+        if (timestamps) {
+            timestamps->stages = stage_stats_;
+        }
         
         return audio;
     }
@@ -340,49 +610,56 @@ public:
     }
     
     // 中间API：文本到音素
-    std::pair<std::vector<int>, std::vector<int>> text_to_phonemes(const std::string& text, const std::string& language) {
-        if (!lexicon_) {
-            throw std::runtime_error("词典未初始化");
-        }
+    std::pair<std::vector<int>, std::vector<int>> text_to_phonemes(const std::string& text, const std::string& language,
+                                                                   std::vector<Lexicon::WordSpan>* word_spans = nullptr) {
+        std::vector<int> phones, tones;
+        convert_text(text, language, phones, tones, word_spans);
+        return std::make_pair(phones, tones);
+    }
+    
+    // 文本到插入空白后的音素和声调，写入调用方的容器（合成时为请求内存区中的容器）。
+    // 词典的输出缓冲区由实例保留，稳态下不再申请内存
+    template <typename IntVector>
+    void convert_text(const std::string& text, const std::string& language,
+                      IntVector& phones, IntVector& tones, std::vector<Lexicon::WordSpan>* word_spans) {
+        Lexicon& lexicon = lexicon_for(language);
         
         if (config_.verbose) {
             std::cout << "处理文本: '" << text << "' (语言: " << language << ")" << std::endl;
         }
         
-        std::vector<int> phones, tones;
-        
         try {
             // 使用词典转换文本
-            lexicon_->convert(text, phones, tones);
+            MELOTTS_PROBE2(lexicon_start, request_id_, text.size());
+            lexicon.convert(text, lexicon_phones_, lexicon_tones_, word_spans);
+            MELOTTS_PROBE2(lexicon_done, request_id_, lexicon_phones_.size());
             
-            if (phones.empty()) {
+            if (lexicon_phones_.empty()) {
                 throw std::runtime_error("文本转换为音素失败: 未能生成音素序列");
             }
             
-            if (phones.size() != tones.size()) {
+            if (lexicon_phones_.size() != lexicon_tones_.size()) {
                 throw std::runtime_error("音素和声调序列长度不匹配");
             }
             
             // 对原始音素序列进行处理（加入空白）
-            phones = intersperse(phones, 0);
-            tones = intersperse(tones, 0);
+            intersperseInto(lexicon_phones_, 0, phones);
+            intersperseInto(lexicon_tones_, 0, tones);
             
             if (config_.verbose) {
                 std::cout << "音素转换完成，序列长度: " << phones.size() << std::endl;
             }
-            
-            return std::make_pair(phones, tones);
         } catch (const std::exception& e) {
             std::cerr << "文本转音素过程中出错: " << e.what() << std::endl;
             throw;
         }
     }
     
-    // 中间API：音素到声学特征
-    std::pair<std::vector<float>, int> phonemes_to_features(const std::vector<int>& phones, const std::vector<int>& tones) {
-        if (!encoder_) {
-            throw std::runtime_error("声学模型未初始化");
-        }
+    // 中间API：音素到声学特征，特征写入features，返回预期的音频长度（采样点）
+    // durations非空时输出每个音素的时长（单位：帧，与插入空白后的音素一一对应）
+    int phonemes_to_features(ArenaLease& lease, const ArenaVector<int>& phones, const ArenaVector<int>& tones,
+                             ArenaVector<float>& features, std::vector<float>* durations = nullptr) {
+        ensure_encoder();
         
         // 检查输入
         if (phones.empty() || tones.empty() || phones.size() != tones.size()) {
@@ -391,68 +668,231 @@ public:
         
         // 准备语言ID
         int lang_id = (config_.language == "zh") ? 3 : 0;  // 3 for Chinese, 0 for English
-        std::vector<int> langids(phones.size(), lang_id);
+        ArenaVector<int> langids = lease.Vector<int>(phones.size(), lang_id);
         
         // 准备说话人嵌入
-        std::vector<float> g = load_speaker_embedding(config_.speaker_id);
+        const std::vector<float>& g = load_speaker_embedding(config_.speaker_id);
         
         // 推理参数
         float length_scale = 1.0f / config_.speed;
         
         try {
-            // 运行声学模型
-            auto output = encoder_->Run(phones, tones, langids, g,
-                                     config_.noise_scale, 
-                                     config_.noise_scale_w, 
-                                     length_scale, 
-                                     config_.sdp_ratio);
+            // 运行声学模型，采集量化校准数据时保存实际送入模型的输入
+            const float scalars[4] = {config_.noise_scale, config_.noise_scale_w, length_scale, config_.sdp_ratio};
+            TensorView inputs[8];
+            bind_encoder_inputs(phones, tones, langids, g, scalars, inputs);
+            if (calib_) {
+                capture_inputs("encoder", *encoder_, inputs, 8);
+            }
+            MELOTTS_PROBE2(encoder_start, request_id_, phones.size());
+            encoder_->Run(inputs, 8);
             
             // 解析输出
             // 检查输出是否有效
-            if (output.size() < 3) {
+            if (encoder_->OutputCount() < 3) {
                 throw std::runtime_error("声学模型输出不足，预期至少3个输出");
             }
             
-            float* zp_data = output.at(0).GetTensorMutableData<float>();
-            int* audio_len_data = output.at(2).GetTensorMutableData<int>();
-            int audio_len = audio_len_data[0];
-            
-            // 获取形状信息
-            auto zp_info = output.at(0).GetTensorTypeAndShapeInfo();
-            auto zp_shape = zp_info.GetShape();
+            if (encoder_->Output(2).count() != 1) {
+                throw std::runtime_error("声学模型输出的音频长度无效");
+            }
+            float audio_len_value = 0.0f;
+            encoder_->CopyOutput(2, &audio_len_value);
+            int audio_len = static_cast<int>(audio_len_value);
+            MELOTTS_PROBE2(encoder_done, request_id_, audio_len);
             
             if (config_.verbose) {
+                TensorView zp = encoder_->Output(0);
                 std::cout << "z_p 形状: [";
-                for (size_t i = 0; i < zp_shape.size(); i++) {
-                    std::cout << zp_shape[i];
-                    if (i < zp_shape.size() - 1) std::cout << ", ";
+                for (size_t i = 0; i < zp.rank(); i++) {
+                    std::cout << zp.dim(i);
+                    if (i < zp.rank() - 1) std::cout << ", ";
                 }
                 std::cout << "]" << std::endl;
             }
             
-            // 提取声学特征并考虑其维度
-            size_t feature_size = zp_info.GetElementCount();
-            std::vector<float> features(zp_data, zp_data + feature_size);
+            // 提取声学特征
+            encoder_->CopyOutput(0, features);
+            
+            // 提取音素时长（输出1），整数类型的时长按数值转换
+            if (durations) {
+                encoder_->CopyOutput(1, *durations);
+                check_durations(*durations, phones.size());
+            }
             
-            return std::make_pair(features, audio_len);
-        } catch (const Ort::Exception& e) {
+            return audio_len;
+        } catch (const std::exception& e) {
             std::cerr << "声学模型推理错误: " << e.what() << std::endl;
             throw std::runtime_error(std::string("声学模型推理失败: ") + e.what());
         }
     }
     
     // 中间API：声学特征到波形 - 优化版
-    std::vector<float> features_to_waveform(const std::vector<float>& features, int audio_len) {
-        if (!decoder_) {
-            throw std::runtime_error("声码器未初始化");
+    // on_slice非空时每解码完一段即回调（未经后处理的原始波形）
+    std::vector<float> features_to_waveform(ArenaLease& lease, const ArenaVector<float>& features, int audio_len,
+                                            const SliceCallback& on_slice = nullptr) {
+        ensure_decoder();
+        return decode_waveform(lease, features, audio_len, on_slice);
+    }
+    
+    const std::vector<StageStats>& last_stage_stats() const {
+        return stage_stats_;
+    }
+    
+    const std::vector<StageStats>& total_stage_stats() const {
+        return stage_totals_;
+    }
+    
+    void set_queue_wait(double ms) {
+        queue_wait_ms_ = ms;
+    }
+    
+    const std::vector<StageStats>& init_stats() const {
+        return init_stats_;
+    }
+    
+    std::string model_identity() const {
+        return "variant=" + (active_variant_.empty() ? std::string("default") : active_variant_) +
+               " encoder=" + fileIdentity(active_encoder_file_) + " decoder=" + fileIdentity(active_decoder_file_) +
+               " g=" + fileIdentity(config_.model_dir + "/g.bin");
+    }
+    
+    // 提前加载按需加载的组件：所列语言的词典模块和延迟创建的声学模型、声码器
+    void preload(const std::vector<std::string>& languages) {
+        for (const auto& language : languages) {
+            lexicon_for(language);
         }
-        
+        ensure_encoder();
+        ensure_decoder();
+    }
+    
+private:
+    // 记录一个阶段的耗时、CPU时间、本线程堆分配、峰值RSS和后端内存池占用
+    void record_stage(const char* name, double ms, const AllocScope& allocs, const CpuScope& cpu, size_t arena_bytes) {
+        stage_stats_.push_back(makeStageStats(name, ms, allocs, cpu, arena_bytes));
+    }
+    
+    // 合成耗时加排队时间超出阈值时，把本次请求（包括失败的）记入进程级慢请求日志：
+    // 文本和音素规模、分段数、已完成阶段的耗时、排队时间和线程设置
+    void finish_request(const std::string& text, const std::string& language, size_t samples,
+                        double total_ms, double queue_wait_ms, bool failed) {
+        if (config_.slow_request_ms <= 0.0 || total_ms + queue_wait_ms < config_.slow_request_ms) {
+            return;
+        }
+        SlowRequestRecord record;
+        record.request_id = request_id_;
+        record.failed = failed;
+        record.finished_at = static_cast<double>(std::time(nullptr));
+        record.total_ms = total_ms;
+        record.queue_wait_ms = queue_wait_ms;
+        record.text_bytes = static_cast<uint32_t>(text.size());
+        for (unsigned char c : text) {
+            if ((c & 0xC0) != 0x80) record.text_chars++;
+        }
+        record.phone_count = static_cast<uint32_t>(request_phones_);
+        record.slice_count = static_cast<uint32_t>(decoded_slices_);
+        record.samples = static_cast<uint32_t>(samples);
+        if (!config_.shared_thread_pool) {
+            record.encoder_threads = config_.encoder_threads > 0 ? config_.encoder_threads : config_.intra_op_num_threads;
+            record.decoder_threads = config_.decoder_threads > 0 ? config_.decoder_threads : config_.intra_op_num_threads;
+        }
+        copyTruncated(language, record.language, sizeof(record.language));
+        copyTruncated(encoder_ ? encoder_->Name() : config_.encoder_backend, record.encoder_backend,
+                      sizeof(record.encoder_backend));
+        copyTruncated(decoder_ ? decoder_->Name() : config_.decoder_backend, record.decoder_backend,
+                      sizeof(record.decoder_backend));
+        for (const auto& stage : stage_stats_) {
+            if (record.stage_count >= SlowRequestRecord::kMaxStages) break;
+            SlowRequestStage& out = record.stages[record.stage_count++];
+            copyTruncated(stage.name, out.name, sizeof(out.name));
+            out.ms = stage.ms;
+            out.cpu_ms = stage.cpu_ms;
+        }
+        GlobalSlowRequestLog().Record(record);
+    }
+    
+    // 把本次合成的分阶段统计累加到 stage_totals_（只在合成成功时调用，阶段按名称对应）
+    void accumulate_stage_totals() {
+        for (const auto& stage : stage_stats_) {
+            auto it = std::find_if(stage_totals_.begin(), stage_totals_.end(),
+                                   [&stage](const StageStats& total) { return total.name == stage.name; });
+            if (it == stage_totals_.end()) {
+                stage_totals_.push_back(stage);
+                continue;
+            }
+            it->ms += stage.ms;
+            it->cpu_ms += stage.cpu_ms;
+            it->process_cpu_ms += stage.process_cpu_ms;
+            it->allocs += stage.allocs;
+            it->alloc_bytes += stage.alloc_bytes;
+            it->peak_rss_kb = std::max(it->peak_rss_kb, stage.peak_rss_kb);
+            it->arena_bytes = std::max(it->arena_bytes, stage.arena_bytes);
+            it->count += stage.count;
+        }
+    }
+    
+    // 收集已完成的组件：统计追加到 init_stats_，错误追加到 errors
+    void collect_component(const ComponentResult& result, std::vector<std::string>& errors) {
+        init_stats_.push_back(result.stats);
+        if (!result.error.empty()) {
+            errors.push_back(result.error);
+        }
+    }
+    
+    static std::string join_errors(const std::vector<std::string>& errors) {
+        std::string message;
+        for (size_t i = 0; i < errors.size(); i++) {
+            message += (i > 0 ? "; " : "") + errors[i];
+        }
+        return message;
+    }
+    
+    // 音素时长须与音素一一对应，否则丢弃（不生成时间戳）
+    static void check_durations(std::vector<float>& durations, size_t phone_count) {
+        if (!durations.empty() && durations.size() != phone_count) {
+            std::cerr << "警告: 音素时长数量(" << durations.size() << ")与音素数量("
+                      << phone_count << ")不一致，无法生成时间戳" << std::endl;
+            durations.clear();
+        }
+    }
+    
+    // 绑定声学模型的输入，依次为音素、声调、语言ID、说话人嵌入和4个标量参数
+    // 整数序列按模型声明的类型（int32 或 int64）传入
+    template <typename IntVector>
+    void bind_encoder_inputs(const IntVector& phones, const IntVector& tones,
+                             const IntVector& langids, const std::vector<float>& g,
+                             const float (&scalars)[4], TensorView (&inputs)[8]) {
+        const auto& infos = encoder_->Inputs();
+        if (infos.size() != 8) {
+            throw std::runtime_error("声学模型需要8个输入，实际为" + std::to_string(infos.size()));
+        }
+        int64_t n = static_cast<int64_t>(phones.size());
+        const IntVector* seqs[3] = {&phones, &tones, &langids};
+        for (int k = 0; k < 3; k++) {
+            if (infos[k].type == DataType::Int64) {
+                encoder_seq_buffers_[k].assign(seqs[k]->begin(), seqs[k]->end());
+                inputs[k] = TensorView(encoder_seq_buffers_[k].data(), {n});
+            } else {
+                inputs[k] = TensorView(reinterpret_cast<const int32_t*>(seqs[k]->data()), {n});
+            }
+        }
+        inputs[3] = TensorView(g.data(), {1, static_cast<int64_t>(g.size()), 1});
+        static const int64_t kOnes[TensorView::kMaxRank] = {1, 1, 1, 1, 1, 1, 1, 1};
+        for (int k = 0; k < 4; k++) {
+            inputs[4 + k] = TensorView(&scalars[k], DataType::Float, kOnes, infos[4 + k].shape.size());
+        }
+    }
+    
+    // 分段解码：中间缓冲区从请求内存区分配，只有返回的整段音频和流式回调的音频块使用普通堆内存
+    std::vector<float> decode_waveform(ArenaLease& lease, const ArenaVector<float>& features, int audio_len,
+                                       const SliceCallback& on_slice) {
         try {
             // 获取说话人嵌入
-            std::vector<float> g = load_speaker_embedding(config_.speaker_id);
+            const std::vector<float>& g = load_speaker_embedding(config_.speaker_id);
             
             // 获取声码器输入形状
-            auto zp_shape = decoder_->GetInputShape(0);
+            const auto& dec_inputs = decoder_->Inputs();
+            const auto& zp_shape = dec_inputs.at(0).shape;
             
             if (config_.verbose) {
                 std::cout << "声码器输入形状: [";
@@ -467,70 +907,154 @@ public:
                 throw std::runtime_error("声码器输入需要至少3个维度");
             }
             
-            // 提取维度信息
+            // 提取维度信息，时间轴为动态维度时按需选择每段长度
             int zp_batch = (zp_shape[0] > 0) ? zp_shape[0] : 1;
             int zp_channels = (zp_shape[1] > 0) ? zp_shape[1] : 192;
-            int dec_len = (zp_shape[2] > 0) ? zp_shape[2] : 128;
+            bool dynamic_len = zp_shape[2] <= 0;
+            int dec_len = dynamic_len ? dec_max_slice_frames_ : static_cast<int>(zp_shape[2]);
             
             if (config_.verbose) {
                 std::cout << "声码器输入 - 批次: " << zp_batch 
                          << ", 通道数: " << zp_channels 
-                         << ", 帧长度: " << dec_len << std::endl;
+                         << ", 帧长度: " << (dynamic_len ? "动态" : std::to_string(dec_len)) << std::endl;
             }
             
-            // 计算特征帧数
+            // 有状态流式声码器：输出相对输入延迟delay_samples个采样点，
+            // 末尾追加若干零帧把延迟部分冲刷出来（stream_valid 中标为0），开头的延迟部分丢弃
             int feature_frames = features.size() / zp_channels;
-            int dec_slice_num = (feature_frames + dec_len - 1) / dec_len;  // 向上取整
+            int flush_frames = 0;
+            int skip_samples = 0;
+            // 流式缓存依次存放在同一块缓冲区中
+            size_t num_states = 0;
+            ArenaVector<size_t> state_offsets = lease.Vector<size_t>(1, 0);
+            ArenaVector<float> states = lease.Vector<float>();
+            if (stream_info_.enabled) {
+                if (!dynamic_len) {
+                    throw std::runtime_error("有状态流式声码器的时间轴必须为动态维度");
+                }
+                flush_frames = (stream_info_.delay_samples + stream_info_.hop - 1) / stream_info_.hop;
+                skip_samples = stream_info_.delay_samples;
+                num_states = stream_info_.caches.size();
+                state_offsets.reserve(num_states + 1);
+                for (size_t k = 0; k < num_states; k++) {
+                    state_offsets.push_back(state_offsets.back() + stream_info_.cache_sizes[k]);
+                }
+                states.assign(state_offsets.back(), 0.0f);
+            }
+            
+            // 规划分段
+            int total_frames = feature_frames + flush_frames;
+            ArenaVector<int> slice_lens = lease.Vector<int>();
+            if (dynamic_len) {
+                slice_lens.reserve(32);
+                planDecoderSlicesInto(total_frames, dec_first_slice_frames_, dec_max_slice_frames_, slice_lens);
+            } else {
+                slice_lens.assign((total_frames + dec_len - 1) / dec_len, dec_len);  // 向上取整
+            }
+            int dec_slice_num = static_cast<int>(slice_lens.size());
             
             if (config_.verbose) {
                 std::cout << "特征总帧数: " << feature_frames 
                          << ", 需要分段数: " << dec_slice_num << std::endl;
+                if (stream_info_.enabled) {
+                    std::cout << "流式声码器: " << num_states << " 个缓存, 延迟 "
+                              << stream_info_.delay_samples << " 采样点, 冲刷 " << flush_frames << " 帧" << std::endl;
+                }
             }
             
-            // 获取输出大小信息
-            int audio_slice_len = decoder_->GetOutputSize(0) / sizeof(float);
+            // 声码器输入：z_p分段、说话人嵌入及流式缓存
+            ArenaVector<TensorView> inputs = lease.Vector<TensorView>(dec_inputs.size());
+            int64_t g_dims[TensorView::kMaxRank];
+            size_t g_rank = resolve_dims(dec_inputs[1], g_dims);
+            inputs.at(1) = TensorView(g.data(), DataType::Float, g_dims, g_rank);
             
-            std::vector<float> wavlist;
+            // 每段的重排特征和输出按最长一段一次分配
+            int max_slice_len = slice_lens.empty() ? 1 : *std::max_element(slice_lens.begin(), slice_lens.end());
+            ArenaVector<float> zp_slice = lease.Vector<float>(static_cast<size_t>(zp_channels) * max_slice_len);
+            ArenaVector<float> valid_slice = lease.Vector<float>(stream_info_.valid_input >= 0 ? max_slice_len : 0);
+            ArenaVector<float> current_audio = lease.Vector<float>();
+            current_audio.reserve(static_cast<size_t>(max_slice_len) * stream_info_.hop);
+            ArenaVector<float> wavlist = lease.Vector<float>();
             wavlist.reserve(audio_len);  // 预分配内存
+            bool last_emitted = false;
+            int start_frame = 0;
             
             // 逐段处理特征
             for (int i = 0; i < dec_slice_num; i++) {
                 // 当前段的起始帧和处理帧数
-                int start_frame = i * dec_len;
-                int frames_to_process = std::min(dec_len, feature_frames - start_frame);
+                int slice_len = slice_lens[i];
+                int frames_to_process = std::min(slice_len, total_frames - start_frame);
                 
                 if (frames_to_process <= 0) break;
                 
-                // 使用专用函数重整特征
-                std::vector<float> zp_slice = reshapeFeatures(
-                    features, 
-                    feature_frames, 
-                    zp_channels, 
-                    dec_len
-                );
+                // 使用专用函数重整特征，固定长度模型的最后一段及冲刷帧补零
+                reshapeFeaturesInto(features.data(), features.size(), feature_frames, zp_channels,
+                                    slice_len, start_frame, zp_slice.data());
+                if (stream_info_.valid_input >= 0) {
+                    int valid_frames = std::max(0, std::min(slice_len, feature_frames - start_frame));
+                    std::fill(valid_slice.begin(), valid_slice.begin() + valid_frames, 1.0f);
+                    std::fill(valid_slice.begin() + valid_frames, valid_slice.begin() + slice_len, 0.0f);
+                    inputs.at(stream_info_.valid_input) = TensorView(valid_slice.data(), {1, 1, slice_len});
+                }
+                start_frame += slice_len;
                 
                 // 设置声码器输入
-                decoder_->SetInput(zp_slice.data(), 0);
-                decoder_->SetInput(g.data(), 1);
+                inputs[0] = TensorView(zp_slice.data(), {zp_batch, zp_channels, slice_len});
+                for (size_t k = 0; k < num_states; k++) {
+                    inputs.at(stream_info_.caches[k].first) =
+                        TensorView(states.data() + state_offsets[k], stream_info_.cache_shapes[k]);
+                }
                 
-                // 运行推理
-                if (0 != decoder_->RunSync()) {
-                    throw std::runtime_error("声码器推理失败");
+                // 采集量化校准数据
+                if (calib_) {
+                    capture_inputs("decoder", *decoder_, inputs.data(), inputs.size());
                 }
                 
-                // 获取输出 - 预分配内存
-                std::vector<float> current_audio(audio_slice_len);
-                decoder_->GetOutput(current_audio.data(), 0);
+                // 运行推理
+                MELOTTS_PROBE3(decoder_slice_start, request_id_, i, slice_len);
+                decoder_->Run(inputs.data(), inputs.size());
+                decoded_slices_++;
                 
-                // 计算当前段实际输出样本数
-                int output_samples = std::min(audio_slice_len, audio_len - static_cast<int>(wavlist.size()));
+                // 获取输出 - 按实际输出长度
+                int audio_slice_len = static_cast<int>(decoder_->CopyOutput(stream_info_.audio_output, current_audio));
+                MELOTTS_PROBE3(decoder_slice_done, request_id_, i, audio_slice_len);
                 
-                if (output_samples <= 0) break;
+                // 更新卷积缓存，供下一段使用
+                for (size_t k = 0; k < num_states; k++) {
+                    int out_idx = stream_info_.caches[k].second;
+                    if (decoder_->Output(out_idx).count() != stream_info_.cache_sizes[k]) {
+                        throw std::runtime_error("流式声码器缓存输出的大小与输入不一致");
+                    }
+                    decoder_->CopyOutput(out_idx, states.data() + state_offsets[k]);
+                }
+                
+                // 跳过流式延迟部分，计算当前段实际输出样本数
+                int begin = std::min(skip_samples, audio_slice_len);
+                skip_samples -= begin;
+                int output_samples = std::min(audio_slice_len - begin, audio_len - static_cast<int>(wavlist.size()));
+                
+                if (output_samples <= 0) {
+                    if (wavlist.size() >= static_cast<size_t>(audio_len)) break;
+                    continue;  // 本段输出全部属于流式延迟
+                }
                 
                 // 将当前段添加到结果
+                size_t offset = wavlist.size();
                 wavlist.insert(wavlist.end(), 
-                              current_audio.begin(), 
-                              current_audio.begin() + output_samples);
+                              current_audio.begin() + begin, 
+                              current_audio.begin() + begin + output_samples);
+                
+                // 流式回调，最后一段补齐到预期长度；音频块交给调用方，使用普通堆内存
+                if (on_slice) {
+                    bool is_last = wavlist.size() >= static_cast<size_t>(audio_len) || i == dec_slice_num - 1;
+                    std::vector<float> chunk_audio(current_audio.begin() + begin,
+                                                   current_audio.begin() + begin + output_samples);
+                    if (is_last) {
+                        chunk_audio.resize(audio_len - offset, 0.0f);
+                    }
+                    on_slice(chunk_audio, offset, is_last);
+                    last_emitted = is_last;
+                }
                 
                 // 检查是否已生成足够的样本
                 if (wavlist.size() >= static_cast<size_t>(audio_len)) {
@@ -539,21 +1063,28 @@ public:
             }
             
             // 裁剪或填充到预期长度
+            size_t decoded = wavlist.size();
             if (wavlist.size() > static_cast<size_t>(audio_len)) {
                 wavlist.resize(audio_len);
             } else if (wavlist.size() < static_cast<size_t>(audio_len)) {
                 wavlist.resize(audio_len, 0.0f);  // 填充静音
             }
             
-            // 对生成的波形进行后处理
-            std::vector<float> processed_audio = postProcessAudio(wavlist, audio_len, config_.enhance_audio);
+            // 确保流式调用方总能收到结束标记
+            if (on_slice && !last_emitted) {
+                std::vector<float> tail(wavlist.size() - std::min(decoded, wavlist.size()), 0.0f);
+                on_slice(tail, std::min(decoded, wavlist.size()), true);
+            }
             
-            return processed_audio;
+            // 复制出返回给调用方的唯一一份音频，后处理在输出阶段原地进行
+            return std::vector<float>(wavlist.begin(), wavlist.end());
         } catch (const std::exception& e) {
             std::cerr << "声码器推理错误: " << e.what() << std::endl;
             throw std::runtime_error(std::string("声码器推理失败: ") + e.what());
         }
     }
+
+public:
     
     // 模型诊断功能
     void diagnoseModels() {
@@ -592,44 +1123,40 @@ public:
         try {
             std::cout << "\n诊断声学模型..." << std::endl;
             if (encoder_) {
-                std::cout << "声学模型已加载，输入输出信息:" << std::endl;
-                std::cout << "  - 输入数量: " << encoder_->GetInputCount() << std::endl;
-                std::cout << "  - 输出数量: " << encoder_->GetOutputCount() << std::endl;
-                
-                for (size_t i = 0; i < encoder_->GetInputCount(); i++) {
-                    auto shape = encoder_->GetInputShape(i);
-                    std::cout << "  - 输入 #" << i << " 形状: [";
-                    for (size_t j = 0; j < shape.size(); j++) {
-                        std::cout << shape[j];
-                        if (j < shape.size() - 1) std::cout << ", ";
-                    }
-                    std::cout << "]" << std::endl;
-                }
+                print_backend_info("声学模型", *encoder_);
+            } else if (!pending_encoder_.key.empty()) {
+                std::cout << "声学模型尚未创建（首次合成时加载）" << std::endl;
             } else {
                 std::cerr << "声学模型未初始化!" << std::endl;
             }
             
             std::cout << "\n诊断声码器..." << std::endl;
             if (decoder_) {
-                std::cout << "声码器已加载，输入输出信息:" << std::endl;
-                std::cout << "  - 输入数量: " << decoder_->GetInputCount() << std::endl;
-                std::cout << "  - 输出数量: " << decoder_->GetOutputCount() << std::endl;
-                
-                for (size_t i = 0; i < decoder_->GetInputCount(); i++) {
-                    auto shape = decoder_->GetInputShape(i);
-                    std::cout << "  - 输入 #" << i << " 形状: [";
-                    for (size_t j = 0; j < shape.size(); j++) {
-                        std::cout << shape[j];
-                        if (j < shape.size() - 1) std::cout << ", ";
-                    }
-                    std::cout << "]" << std::endl;
-                }
+                print_backend_info("声码器", *decoder_);
+            } else if (!pending_decoder_.key.empty()) {
+                std::cout << "声码器尚未创建（首次合成时加载）" << std::endl;
             } else {
                 std::cerr << "声码器未初始化!" << std::endl;
             }
             
+            if (!variants_.empty()) {
+                std::cout << "\n模型变体 (当前: " << (active_variant_.empty() ? "默认模型" : active_variant_) << "):" << std::endl;
+                for (const auto& v : variants_.all()) {
+                    std::cout << "  - " << v.name << ": 延迟 " << v.latency_ms << " ms, 实时率 " << v.rtf
+                              << ", 质量 " << v.quality << (v.tier.empty() ? "" : ", 等级 " + v.tier)
+                              << (v.available ? "" : " [不可用]") << std::endl;
+                }
+            }
+            
             std::cout << "\n词典和说话人嵌入状态:" << std::endl;
-            std::cout << "  - 词典: " << (lexicon_ ? "已加载" : "未加载") << std::endl;
+            std::cout << "  - 词典: ";
+            if (lexicons_.empty()) {
+                std::cout << "未加载";
+            }
+            for (const auto& module : lexicons_) {
+                std::cout << module.first << (module.first == "zh" ? "(完整) " : "(英文) ");
+            }
+            std::cout << std::endl;
             std::cout << "  - 说话人嵌入: " << (speaker_embeddings_.empty() ? "未加载" : "已加载") << std::endl;
             std::cout << "  - 说话人数量: " << speaker_embeddings_.size() << std::endl;
             
@@ -677,35 +1204,545 @@ public:
     
 private:
     // 初始化组件
+    // 词典、说话人嵌入和模型互不依赖，并行加载（两个模型之间也并行），启动耗时取决于最慢的组件。
+    // 各组件都结束后再汇总错误，任一失败时抛出包含全部失败组件的异常
     void initialize() {
+        double start = get_current_time();
+        init_stats_.clear();
+        std::vector<std::string> errors;
+        
+        // 按需加载时词典留到各语言首次合成
+        lexicons_.clear();
+        std::unique_ptr<Lexicon> lexicon;
+        std::future<ComponentResult> lexicon_task;
+        if (!config_.lazy_lexicon) {
+            lexicon_task = std::async(std::launch::async, [this, &lexicon]() {
+                return runComponent("词典", [&]() { lexicon = load_lexicon("zh"); });
+            });
+        }
+        std::future<ComponentResult> speaker_task = std::async(std::launch::async, [this]() {
+            return runComponent("说话人嵌入", [this]() { load_speaker_embeddings(); });
+        });
+        
+        // 默认模型按配置的精度选择，模型变体清单存在时按配置选择变体
         try {
-            // 加载词典
-            std::string lexicon_file = config_.model_dir + "/lexicon.txt";
-            std::string token_file = config_.model_dir + "/tokens.txt";
-            lexicon_ = std::make_unique<Lexicon>(lexicon_file, token_file, config_.verbose);
-            
-            // 加载声学模型
-            std::string encoder_file = config_.model_dir + "/encoder.onnx";
-            encoder_ = std::make_unique<OnnxWrapper>();
-            if (0 != encoder_->Init(encoder_file)) {
-                throw std::runtime_error("声学模型初始化失败: " + encoder_file);
+            encoder_.reset();
+            decoder_.reset();
+            backends_.clear();
+            default_encoder_file_ = resolve_model_file("encoder", config_.encoder_precision);
+            default_decoder_file_ = resolve_model_file("decoder", config_.decoder_precision);
+            variants_ = config_.variant_manifest.empty()
+                            ? ModelVariants()
+                            : ModelVariants::Load(config_.model_dir + "/" + config_.variant_manifest,
+                                                  config_.model_dir, config_.verbose);
+            select_variant(config_variant_request());
+        } catch (const std::exception& e) {
+            errors.push_back(e.what());
+        }
+        
+        if (lexicon_task.valid()) collect_component(lexicon_task.get(), errors);
+        collect_component(speaker_task.get(), errors);
+        if (lexicon) lexicons_["zh"] = std::move(lexicon);
+        if (!errors.empty()) {
+            throw std::runtime_error("MeloTTS初始化失败: " + join_errors(errors));
+        }
+        
+        StageStats total;
+        total.name = "总计";
+        total.ms = get_current_time() - start;
+        total.peak_rss_kb = PeakRssKb();
+        init_stats_.push_back(total);
+        
+        if (config_.verbose) {
+            std::cout << "MeloTTS初始化成功，耗时:";
+            for (const auto& stats : init_stats_) {
+                std::cout << " " << stats.name << " " << stats.ms << " ms";
             }
-            
-            // 加载声码器
-            std::string decoder_file = config_.model_dir + "/decoder.onnx";
-            decoder_ = std::make_unique<OnnxWrapper>();
-            if (0 != decoder_->Init(decoder_file)) {
-                throw std::runtime_error("声码器初始化失败: " + decoder_file);
+            std::cout << std::endl;
+        }
+    }
+    
+    // 读取调优配置，填充后端、线程数和声码器分段中调用方未设置的项；文件内容无效或生成于其他主机时忽略
+    void apply_tuning_profile() {
+        if (config_.tuning_profile.empty()) {
+            return;
+        }
+        std::string path = config_.model_dir + "/" + config_.tuning_profile;
+        TuningProfile profile;
+        try {
+            if (!TuningProfile::Load(path, profile)) {
+                return;
             }
+        } catch (const std::exception& e) {
+            std::cerr << "警告: 调优配置 " << path << " 无效，已忽略 (" << e.what() << ")" << std::endl;
+            return;
+        }
+        HostInfo host = HostInfo::Probe();
+        if (!profile.MatchesHost(host)) {
+            std::cerr << "警告: 调优配置 " << path << " 生成于其他主机 (" << profile.host_cpu << ", "
+                      << profile.host_cores << " 核)，已忽略，请在本机重新运行 melotts_autotune" << std::endl;
+            return;
+        }
+        std::vector<std::string> kept;
+        if (!profile.ApplyTo(config_, &kept)) {
+            std::cerr << "警告: 调优配置 " << path << " 中的取值无效，已忽略" << std::endl;
+            return;
+        }
+        for (const auto& item : kept) {
+            std::cerr << "提示: 调优配置 " << path << " 中的取值未生效，保留已设置的 " << item << std::endl;
+        }
+        if (config_.verbose) {
+            std::cout << "已加载调优配置: " << path << std::endl;
+        }
+    }
+    
+    // 按精度选择模型文件：int8 对应 <name>.int8.onnx，不存在时回退到 <name>.onnx
+    std::string resolve_model_file(const std::string& name, const std::string& precision) const {
+        std::string fp32_file = config_.model_dir + "/" + name + ".onnx";
+        if (precision == "fp32") {
+            return fp32_file;
+        }
+        
+        std::string file = config_.model_dir + "/" + name + "." + precision + ".onnx";
+        if (!std::ifstream(file).good()) {
+            std::cerr << "警告: 未找到" << precision << "模型 " << file << "，回退到 " << fp32_file << std::endl;
+            return fp32_file;
+        }
+        if (config_.verbose) {
+            std::cout << "使用" << precision << "模型: " << file << std::endl;
+        }
+        return file;
+    }
+    
+    // 根据配置创建或关闭校准数据采集
+    void update_calibration() {
+        if (config_.calibration_dir.empty()) {
+            calib_.reset();
+        } else if (!calib_ || calib_dir_ != config_.calibration_dir) {
+            calib_ = std::make_unique<CalibrationRecorder>(config_.calibration_dir);
+            calib_dir_ = config_.calibration_dir;
+        }
+    }
+    
+    // 保存一组模型输入，文件名与模型输入名一致，类型和形状与实际送入模型的张量相同
+    void capture_inputs(const std::string& model, const InferenceBackend& backend,
+                        const TensorView* inputs, size_t count) {
+        std::string dir = calib_->NewSample(model);
+        for (size_t i = 0; i < count; i++) {
+            std::string path = dir + "/" + backend.Inputs().at(i).name + ".npy";
+            switch (inputs[i].type()) {
+            case DataType::Float:
+                CalibrationRecorder::SaveNpy(path, inputs[i].data<float>(), inputs[i].shape());
+                break;
+            case DataType::Int32:
+                CalibrationRecorder::SaveNpy(path, inputs[i].data<int32_t>(), inputs[i].shape());
+                break;
+            case DataType::Int64:
+                CalibrationRecorder::SaveNpy(path, inputs[i].data<int64_t>(), inputs[i].shape());
+                break;
+            default:
+                throw std::runtime_error(std::string("校准数据不支持的输入类型: ") + DataTypeName(inputs[i].type()));
+            }
+        }
+    }
+    
+    // 识别有状态流式声码器：输入cache_in_<k>与输出cache_out_<k>成对出现，
+    // 延迟和每帧采样点数由导出脚本写入模型元数据；stream_valid 输入标记真实帧（旧版导出的模型没有）
+    void detect_streaming_decoder() {
+        stream_info_ = StreamingDecoderInfo();
+        const InferenceBackend& decoder = *decoder_;
+        
+        const std::string in_prefix = "cache_in_";
+        const std::string out_prefix = "cache_out_";
+        for (size_t i = 0; i < decoder.Inputs().size(); i++) {
+            const std::string& name = decoder.Inputs()[i].name;
+            if (name.compare(0, in_prefix.size(), in_prefix) != 0) continue;
             
-            // 加载说话人嵌入
-            load_speaker_embeddings();
+            std::string out_name = out_prefix + name.substr(in_prefix.size());
+            int out_idx = decoder.FindOutput(out_name);
+            if (out_idx < 0) {
+                throw std::runtime_error("流式声码器缺少缓存输出: " + out_name);
+            }
             
-            if (config_.verbose) {
-                std::cout << "MeloTTS初始化成功" << std::endl;
+            std::vector<int64_t> shape = resolve_shape(decoder.Inputs()[i]);
+            size_t size = 1;
+            for (int64_t d : shape) size *= static_cast<size_t>(d);
+            stream_info_.caches.push_back(std::make_pair(static_cast<int>(i), out_idx));
+            stream_info_.cache_shapes.push_back(shape);
+            stream_info_.cache_sizes.push_back(size);
+        }
+        
+        if (stream_info_.caches.empty()) {
+            return;
+        }
+        
+        // 音频输出为第一个非缓存输出
+        for (size_t j = 0; j < decoder.Outputs().size(); j++) {
+            if (decoder.Outputs()[j].name.compare(0, out_prefix.size(), out_prefix) != 0) {
+                stream_info_.audio_output = static_cast<int>(j);
+                break;
+            }
+        }
+        
+        std::string delay = decoder.GetCustomMetadata("stream_delay_samples");
+        std::string hop = decoder.GetCustomMetadata("stream_hop");
+        stream_info_.delay_samples = delay.empty() ? 0 : std::stoi(delay);
+        stream_info_.hop = hop.empty() ? 512 : std::stoi(hop);
+        if (stream_info_.hop <= 0 || stream_info_.delay_samples < 0) {
+            throw std::runtime_error("流式声码器元数据无效");
+        }
+        stream_info_.valid_input = decoder.FindInput("stream_valid");
+        stream_info_.enabled = true;
+        
+        if (config_.verbose) {
+            std::cout << "检测到有状态流式声码器: " << stream_info_.caches.size() << " 个缓存, 延迟 "
+                      << stream_info_.delay_samples << " 采样点" << std::endl;
+        }
+    }
+    
+    // 按最大音素数运行一次空输入（无噪声、原速），使原生引擎的内存池一次分配到位
+    void warmup_encoder() {
+        std::vector<int> seq(config_.enc_max_phonemes, 0);
+        std::vector<float> g(256, 0.0f);
+        const float scalars[4] = {0.0f, 0.0f, 1.0f, 0.0f};
+        TensorView inputs[8];
+        bind_encoder_inputs(seq, seq, seq, g, scalars, inputs);
+        encoder_->Run(inputs, 8);
+        if (config_.verbose) {
+            std::cout << "原生声学模型内存池: " << encoder_->ArenaBytes() / 1024 << " KB" << std::endl;
+        }
+    }
+    
+    // 按最大分段长度运行一次全零输入，使原生引擎的内存池一次分配到位
+    void warmup_decoder() {
+        const auto& infos = decoder_->Inputs();
+        std::vector<std::vector<float>> buffers(infos.size());
+        std::vector<TensorView> inputs(infos.size());
+        for (size_t i = 0; i < infos.size(); i++) {
+            std::vector<int64_t> shape = resolve_shape(infos[i]);
+            if (i == 0 && shape.size() >= 3 && infos[i].shape[2] <= 0) {
+                shape[1] = infos[i].shape[1] > 0 ? shape[1] : 192;
+                shape[2] = dec_max_slice_frames_;
+            } else if (static_cast<int>(i) == stream_info_.valid_input && shape.size() == 3) {
+                shape[2] = dec_max_slice_frames_;
+            }
+            size_t count = 1;
+            for (int64_t d : shape) count *= static_cast<size_t>(d);
+            buffers[i].assign(count, 0.0f);
+            inputs[i] = TensorView(buffers[i].data(), shape);
+        }
+        decoder_->Run(inputs);
+        if (config_.verbose) {
+            std::cout << "原生声码器内存池: " << decoder_->ArenaBytes() / 1024 << " KB" << std::endl;
+        }
+    }
+    
+    VariantRequest config_variant_request() const {
+        VariantRequest request;
+        request.variant = config_.model_variant;
+        request.latency_budget_ms = config_.latency_budget_ms;
+        request.quality_tier = config_.quality_tier;
+        return request;
+    }
+    
+    // 切换当前使用的声学模型和声码器（variant为空时使用默认模型），加载过的后端直接复用。
+    // 新加载的原生引擎按当前分段设置预热；加载失败时抛出异常，当前模型保持不变
+    void activate_models(const ModelVariant* variant) {
+        auto pick = [variant](const std::string ModelVariant::*field, const std::string& fallback) {
+            return (variant && !(variant->*field).empty()) ? variant->*field : fallback;
+        };
+        std::string encoder_file = pick(&ModelVariant::encoder_file, default_encoder_file_);
+        std::string decoder_file = pick(&ModelVariant::decoder_file, default_decoder_file_);
+        std::string encoder_kind = pick(&ModelVariant::encoder_backend, config_.encoder_backend);
+        std::string decoder_kind = pick(&ModelVariant::decoder_backend, config_.decoder_backend);
+        
+        BackendOptions encoder_options;
+        if (variant) {
+            encoder_options.graph_optimization = variant->optimization;
+        }
+        BackendOptions decoder_options = encoder_options;
+        decoder_options.custom_ops_library = config_.custom_ops_library;
+        encoder_options.intra_op_threads = config_.encoder_threads > 0 ? config_.encoder_threads
+                                                                        : config_.intra_op_num_threads;
+        decoder_options.intra_op_threads = config_.decoder_threads > 0 ? config_.decoder_threads
+                                                                        : config_.intra_op_num_threads;
+        encoder_options.shared_thread_pool = config_.shared_thread_pool;
+        decoder_options.shared_thread_pool = config_.shared_thread_pool;
+        encoder_options.share_weights = config_.share_weights;
+        decoder_options.share_weights = config_.share_weights;
+        
+        // 未加载过的后端并行创建，原生引擎不支持该模型时回退到 ONNX Runtime；
+        // 两个都结束后再报告错误，成功加载的一个照常缓存。
+        // prefork 时 ONNX Runtime 会话（及其线程池）推迟到子进程中创建，父进程只预读共用的权重
+        std::string encoder_key = backend_key(encoder_kind, encoder_file, encoder_options);
+        std::string decoder_key = backend_key(decoder_kind, decoder_file, decoder_options);
+        bool encoder_new = backends_.count(encoder_key) == 0;
+        bool decoder_new = backends_.count(decoder_key) == 0;
+        bool encoder_deferred = encoder_new && config_.prefork && encoder_kind != "native";
+        bool decoder_deferred = decoder_new && (config_.defer_decoder || (config_.prefork && decoder_kind != "native"));
+        bool encoder_loaded = encoder_new && !encoder_deferred;
+        bool decoder_loaded = decoder_new && !decoder_deferred;
+        bool onnxruntime_allowed = !config_.prefork;
+        std::unique_ptr<InferenceBackend> new_encoder, new_decoder;
+        std::future<ComponentResult> encoder_task, decoder_task;
+        if (encoder_loaded) {
+            encoder_task = std::async(std::launch::async, [&]() {
+                return runComponent("声学模型", [&]() {
+                    new_encoder = create_backend("声学模型", encoder_kind, encoder_file, encoder_options,
+                                                 onnxruntime_allowed);
+                });
+            });
+        }
+        if (decoder_loaded) {
+            decoder_task = std::async(std::launch::async, [&]() {
+                return runComponent("声码器", [&]() {
+                    new_decoder = create_backend("声码器", decoder_kind, decoder_file, decoder_options,
+                                                 onnxruntime_allowed);
+                });
+            });
+        }
+        std::vector<std::string> errors;
+        if (encoder_task.valid()) collect_component(encoder_task.get(), errors);
+        if (decoder_task.valid()) collect_component(decoder_task.get(), errors);
+        if (new_encoder) backends_[encoder_key] = std::move(new_encoder);
+        if (new_decoder) backends_[decoder_key] = std::move(new_decoder);
+        if (!errors.empty()) {
+            throw std::runtime_error(join_errors(errors));
+        }
+        // prefork 时原生引擎无法加载的模型同样推迟，到子进程中直接用 ONNX Runtime 创建
+        if (encoder_loaded && backends_.count(encoder_key) == 0) {
+            encoder_loaded = false;
+            encoder_deferred = true;
+            encoder_kind = "onnxruntime";
+        }
+        if (decoder_loaded && backends_.count(decoder_key) == 0) {
+            decoder_loaded = false;
+            decoder_deferred = true;
+            decoder_kind = "onnxruntime";
+        }
+        if (encoder_deferred) {
+            encoder_.reset();
+            pending_encoder_ = make_pending(encoder_key, encoder_kind, encoder_file, encoder_options);
+        } else {
+            encoder_ = backends_[encoder_key];
+            pending_encoder_ = PendingBackend();
+        }
+        if (decoder_deferred) {
+            decoder_.reset();
+            pending_decoder_ = make_pending(decoder_key, decoder_kind, decoder_file, decoder_options);
+        } else {
+            decoder_ = backends_[decoder_key];
+            pending_decoder_ = PendingBackend();
+        }
+        dec_first_slice_frames_ = (variant && variant->first_slice_frames > 0) ? variant->first_slice_frames
+                                                                                : config_.dec_first_slice_frames;
+        dec_max_slice_frames_ = (variant && variant->max_slice_frames > 0) ? variant->max_slice_frames
+                                                                            : config_.dec_max_slice_frames;
+        dec_max_slice_frames_ = std::max(dec_max_slice_frames_, dec_first_slice_frames_);
+        active_variant_ = variant ? variant->name : "";
+        active_encoder_file_ = encoder_file;
+        active_decoder_file_ = decoder_file;
+        
+        // 识别有状态流式声码器，之后两个原生引擎的预热互不依赖，同样并行
+        if (decoder_) {
+            detect_streaming_decoder();
+        } else {
+            stream_info_ = StreamingDecoderInfo();
+        }
+        std::future<ComponentResult> encoder_warmup, decoder_warmup;
+        if (encoder_loaded && std::string(encoder_->Name()) == "native") {
+            encoder_warmup = std::async(std::launch::async, [this]() {
+                return runComponent("声学模型预热", [this]() { warmup_encoder(); });
+            });
+        }
+        if (decoder_loaded && std::string(decoder_->Name()) == "native") {
+            decoder_warmup = std::async(std::launch::async, [this]() {
+                return runComponent("声码器预热", [this]() { warmup_decoder(); });
+            });
+        }
+        if (encoder_warmup.valid()) collect_component(encoder_warmup.get(), errors);
+        if (decoder_warmup.valid()) collect_component(decoder_warmup.get(), errors);
+        if (!errors.empty()) {
+            throw std::runtime_error(join_errors(errors));
+        }
+        
+        if (config_.verbose && variant) {
+            std::cout << "使用模型变体: " << variant->name << " (延迟 " << variant->latency_ms << " ms, 质量 "
+                      << variant->quality << ", 声码器分段 " << dec_first_slice_frames_ << "/"
+                      << dec_max_slice_frames_ << ")" << std::endl;
+        }
+    }
+    
+    // 延迟创建的推理后端
+    struct PendingBackend {
+        std::string key;
+        std::string kind;
+        std::string model_file;
+        BackendOptions options;
+        std::shared_ptr<const void> weights;   // 预读的共用权重（prefork），创建会话前保持
+    };
+    
+    // 延迟创建的推理后端；prefork 时预读 ONNX Runtime 会话共用的权重，子进程写时复制共用
+    PendingBackend make_pending(const std::string& key, const std::string& kind, const std::string& model_file,
+                                const BackendOptions& options) const {
+        PendingBackend pending{key, kind, model_file, options, nullptr};
+        if (config_.prefork && kind != "native" && options.share_weights) {
+            pending.weights = PreloadSharedWeights(model_file);
+        }
+        return pending;
+    }
+    
+    // 创建延迟的推理后端并放入缓存
+    std::shared_ptr<InferenceBackend> create_pending(const std::string& label, PendingBackend& pending) {
+        const PendingBackend spec = pending;
+        std::unique_ptr<InferenceBackend> backend;
+        std::vector<std::string> errors;
+        collect_component(runComponent(label, [&]() {
+            backend = create_backend(label, spec.kind, spec.model_file, spec.options);
+        }), errors);
+        if (!errors.empty()) {
+            throw std::runtime_error(join_errors(errors));
+        }
+        backends_[spec.key] = std::move(backend);
+        pending = PendingBackend();
+        return backends_[spec.key];
+    }
+    
+    // 创建延迟的声学模型（prefork 的子进程中首次合成或 preload 时）
+    void ensure_encoder() {
+        if (encoder_) {
+            return;
+        }
+        if (pending_encoder_.key.empty()) {
+            throw std::runtime_error("声学模型未初始化");
+        }
+        encoder_ = create_pending("声学模型", pending_encoder_);
+        warmup_if_native("声学模型预热", *encoder_, &MeloTTSImpl::warmup_encoder);
+    }
+    
+    // 创建延迟加载的声码器（首次合成或 preload 时），随后识别流式声码器并预热
+    void ensure_decoder() {
+        if (decoder_) {
+            return;
+        }
+        if (pending_decoder_.key.empty()) {
+            throw std::runtime_error("声码器未初始化");
+        }
+        decoder_ = create_pending("声码器", pending_decoder_);
+        detect_streaming_decoder();
+        warmup_if_native("声码器预热", *decoder_, &MeloTTSImpl::warmup_decoder);
+    }
+    
+    // 原生引擎按当前设置预热，ONNX Runtime 后端不需要
+    void warmup_if_native(const std::string& label, const InferenceBackend& backend, void (MeloTTSImpl::*warmup)()) {
+        if (std::string(backend.Name()) != "native") {
+            return;
+        }
+        std::vector<std::string> errors;
+        collect_component(runComponent(label, [this, warmup]() { (this->*warmup)(); }), errors);
+        if (!errors.empty()) {
+            throw std::runtime_error(join_errors(errors));
+        }
+    }
+    
+    // 语言对应的词典模块：en 只含英文词条，其余语言使用完整词典（zh）
+    static std::string lexicon_module(const std::string& language) {
+        return language == "en" ? "en" : "zh";
+    }
+    
+    std::unique_ptr<Lexicon> load_lexicon(const std::string& module) const {
+        return std::make_unique<Lexicon>(config_.model_dir + "/lexicon.txt", config_.model_dir + "/tokens.txt",
+                                         config_.verbose, module == "en");
+    }
+    
+    // 取语言对应的词典，未加载时加载并记入初始化统计；完整词典已加载时英文直接复用
+    Lexicon& lexicon_for(const std::string& language) {
+        std::string module = lexicon_module(language);
+        auto it = lexicons_.find(module);
+        if (it == lexicons_.end() && module == "en") {
+            it = lexicons_.find("zh");
+        }
+        if (it != lexicons_.end()) {
+            return *it->second;
+        }
+        std::unique_ptr<Lexicon> lexicon;
+        std::vector<std::string> errors;
+        collect_component(runComponent("词典(" + module + ")", [&]() { lexicon = load_lexicon(module); }), errors);
+        if (!errors.empty()) {
+            throw std::runtime_error(join_errors(errors));
+        }
+        Lexicon& loaded = *lexicon;
+        lexicons_[module] = std::move(lexicon);
+        return loaded;
+    }
+    
+    // 已加载后端的缓存键
+    static std::string backend_key(const std::string& kind, const std::string& model_file,
+                                   const BackendOptions& options) {
+        return kind + "|" + options.graph_optimization + "|" +
+               (options.shared_thread_pool ? std::string("shared") : std::to_string(options.intra_op_threads)) +
+               "|" + model_file;
+    }
+    
+    // 按配置创建推理后端，原生引擎无法加载时回退到 ONNX Runtime
+    // onnxruntime_allowed 为 false 时（prefork 的父进程）不创建 ONNX Runtime 会话，原生引擎无法加载时返回空
+    std::unique_ptr<InferenceBackend> create_backend(const std::string& label, const std::string& kind,
+                                                     const std::string& model_file, const BackendOptions& options,
+                                                     bool onnxruntime_allowed = true) {
+        if (kind == "native") {
+            try {
+                return CreateInferenceBackend("native", model_file, options);
+            } catch (const std::exception& e) {
+                std::cerr << "警告: 原生引擎无法加载" << label << "，回退到 ONNX Runtime (" << e.what() << ")" << std::endl;
             }
+        }
+        if (!onnxruntime_allowed) {
+            return nullptr;
+        }
+        try {
+            return CreateInferenceBackend("onnxruntime", model_file, options);
         } catch (const std::exception& e) {
-            throw std::runtime_error("MeloTTS初始化失败: " + std::string(e.what()));
+            throw std::runtime_error(label + "初始化失败: " + model_file + " (" + e.what() + ")");
+        }
+    }
+    
+    // 模型声明的形状，动态维度按1计
+    static std::vector<int64_t> resolve_shape(const TensorInfo& info) {
+        std::vector<int64_t> shape = info.shape;
+        for (auto& d : shape) {
+            if (d <= 0) d = 1;
+        }
+        return shape;
+    }
+    
+    // 同上，写入定长数组（至少 TensorView::kMaxRank 个元素），返回维数
+    static size_t resolve_dims(const TensorInfo& info, int64_t* dims) {
+        if (info.shape.size() > TensorView::kMaxRank) {
+            throw std::runtime_error("输入 " + info.name + " 的维数超出上限");
+        }
+        for (size_t i = 0; i < info.shape.size(); i++) {
+            dims[i] = info.shape[i] > 0 ? info.shape[i] : 1;
+        }
+        return info.shape.size();
+    }
+    
+    // 打印后端及模型输入输出信息
+    static void print_backend_info(const std::string& label, const InferenceBackend& backend) {
+        std::cout << label << "已加载 (后端: " << backend.Name() << ")，输入输出信息:" << std::endl;
+        std::cout << "  - 输入数量: " << backend.Inputs().size() << std::endl;
+        std::cout << "  - 输出数量: " << backend.Outputs().size() << std::endl;
+        auto print = [](const char* kind, size_t i, const TensorInfo& info) {
+            std::cout << "  - " << kind << " #" << i << " " << info.name << " (" << DataTypeName(info.type) << ") 形状: [";
+            for (size_t j = 0; j < info.shape.size(); j++) {
+                std::cout << info.shape[j];
+                if (j < info.shape.size() - 1) std::cout << ", ";
+            }
+            std::cout << "]" << std::endl;
+        };
+        for (size_t i = 0; i < backend.Inputs().size(); i++) print("输入", i, backend.Inputs()[i]);
+        for (size_t i = 0; i < backend.Outputs().size(); i++) print("输出", i, backend.Outputs()[i]);
+        if (backend.ArenaBytes() > 0) {
+            std::cout << "  - 内存池: " << backend.ArenaBytes() / 1024 << " KB" << std::endl;
         }
     }
     
@@ -754,7 +1791,7 @@ private:
     }
     
     // 获取特定说话人的嵌入向量
-    std::vector<float> load_speaker_embedding(int speaker_id) {
+    const std::vector<float>& load_speaker_embedding(int speaker_id) {
         // 如果说话人ID超出范围，使用默认说话人
         if (speaker_id < 0 || speaker_id >= static_cast<int>(speaker_embeddings_.size())) {
             std::cerr << "警告: 说话人ID " << speaker_id << " 超出范围，使用默认说话人 (0)" << std::endl;
@@ -765,23 +1802,70 @@ private:
     }
     
 private:
+    // 有状态流式声码器信息
+    struct StreamingDecoderInfo {
+        bool enabled = false;
+        std::vector<std::pair<int, int>> caches;   // (缓存输入下标, 缓存输出下标)
+        std::vector<std::vector<int64_t>> cache_shapes;   // 每个缓存的形状
+        std::vector<size_t> cache_sizes;           // 每个缓存的元素数量
+        int audio_output = 0;                      // 音频输出下标
+        int delay_samples = 0;                     // 输出相对输入的延迟（采样点）
+        int hop = 512;                             // 每帧对应的采样点数
+        int valid_input = -1;                      // stream_valid 输入下标，没有时为-1
+    };
+    
     MeloTTSConfig config_;
-    std::unique_ptr<Lexicon> lexicon_;
-    std::unique_ptr<OnnxWrapper> encoder_;
-    std::unique_ptr<OnnxWrapper> decoder_;
+    std::map<std::string, std::unique_ptr<Lexicon>> lexicons_;   // 词典模块：zh 为完整词典，en 只含英文词条
+    std::shared_ptr<InferenceBackend> encoder_;    // 当前使用的声学模型
+    std::shared_ptr<InferenceBackend> decoder_;    // 当前使用的声码器，延迟创建时首次合成前为空
+    PendingBackend pending_encoder_;               // 延迟创建的声学模型（prefork），key为空表示没有
+    PendingBackend pending_decoder_;               // 延迟创建的声码器，key为空表示没有待创建的声码器
+    std::map<std::string, std::shared_ptr<InferenceBackend>> backends_;   // 已加载的后端，键为 后端|优化级别|线程数|文件
+    ModelVariants variants_;
+    std::string active_variant_;                   // 当前变体名，空为默认模型
+    std::string default_encoder_file_;
+    std::string default_decoder_file_;
+    std::string active_encoder_file_;              // 当前使用的声学模型、声码器文件
+    std::string active_decoder_file_;
+    int dec_first_slice_frames_ = 32;              // 当前生效的声码器分段设置
+    int dec_max_slice_frames_ = 256;
+    std::vector<int64_t> encoder_seq_buffers_[3];   // 声学模型int64输入的转换缓冲
+    std::vector<int> lexicon_phones_;              // 词典输出缓冲，容量跨请求保留
+    std::vector<int> lexicon_tones_;
     std::vector<std::vector<float>> speaker_embeddings_;
+    StreamingDecoderInfo stream_info_;
+    std::unique_ptr<CalibrationRecorder> calib_;
+    std::string calib_dir_;
+    std::vector<StageStats> stage_stats_;          // 上一次合成的分阶段统计
+    std::vector<StageStats> stage_totals_;         // 全部合成按阶段累计的统计
+    uint64_t request_id_ = 0;                      // 当前（或上一次）合成请求的序号，用于 USDT 探针
+    size_t request_phones_ = 0;                    // 本次合成插入空白后的音素数
+    size_t decoded_slices_ = 0;                    // 本次合成声码器实际运行的分段数
+    double queue_wait_ms_ = 0.0;                   // 调用方告知的下一次合成的排队时间
+    std::vector<StageStats> init_stats_;           // 初始化及之后加载模型变体时各组件的耗时
 };
 
 // MeloTTS 公共接口实现
 MeloTTS::MeloTTS(const std::string& model_dir) 
     : pimpl_(std::make_unique<MeloTTSImpl>(model_dir)) {}
 
+MeloTTS::MeloTTS(const MeloTTSConfig& config) 
+    : pimpl_(std::make_unique<MeloTTSImpl>(config)) {}
+
 MeloTTS::~MeloTTS() = default;
 
 std::vector<float> MeloTTS::synthesize(const std::string& text, const std::string& language) {
     return pimpl_->synthesize(text, language);
 }
 
+SynthesisResult MeloTTS::synthesize_with_timestamps(const std::string& text, const std::string& language) {
+    return pimpl_->synthesize_with_timestamps(text, language);
+}
+
+void MeloTTS::synthesize_stream(const std::string& text, const ChunkCallback& on_chunk, const std::string& language) {
+    pimpl_->synthesize_stream(text, on_chunk, language);
+}
+
 bool MeloTTS::save_wav(const std::vector<float>& audio, const std::string& output_path, int sample_rate) {
     return pimpl_->save_wav(audio, output_path, sample_rate);
 }
@@ -802,6 +1886,34 @@ void MeloTTS::set_config(const MeloTTSConfig& config) {
     pimpl_->set_config(config);
 }
 
+std::string MeloTTS::select_variant(const VariantRequest& request) {
+    return pimpl_->select_variant(request);
+}
+
+std::vector<StageStats> MeloTTS::last_stage_stats() const {
+    return pimpl_->last_stage_stats();
+}
+
+std::vector<StageStats> MeloTTS::total_stage_stats() const {
+    return pimpl_->total_stage_stats();
+}
+
+void MeloTTS::set_queue_wait(double ms) {
+    pimpl_->set_queue_wait(ms);
+}
+
+std::vector<StageStats> MeloTTS::init_stats() const {
+    return pimpl_->init_stats();
+}
+
+std::string MeloTTS::model_identity() const {
+    return pimpl_->model_identity();
+}
+
+void MeloTTS::preload(const std::vector<std::string>& languages) {
+    pimpl_->preload(languages);
+}
+
 void MeloTTS::diagnoseModels() {
     pimpl_->diagnoseModels();
 }
@@ -0,0 +1,200 @@
+// melotts_ops.cpp - 声码器融合算子（ONNX Runtime 自定义算子库）
+//
+// 编译为 libmelotts_ops.so，运行时通过 MeloTTSConfig::custom_ops_library 注册。
+// 算子域为 "melotts.ops"，由 scripts/export_onnx.py --fuse_decoder 改写声码器图后使用：
+//   LeakyReluConv(X, W, B[, R])        = Conv(LeakyRelu(X), W, B) [+ R]
+//   LeakyReluConvTranspose(X, W, B[, R]) = ConvTranspose(LeakyRelu(X), W, B) [+ R]
+// 只支持一维、group为1的情形，计算见 FusedKernels.hpp。
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <stdexcept>
+
+#include <onnxruntime_cxx_api.h>
+
+#include "FusedKernels.hpp"
+
+namespace {
+
+const char* kDomain = "melotts.ops";
+
+// 读取卷积参数并检查输入形状
+struct FusedConvParams {
+    float alpha = 1.0f;
+    int64_t stride = 1;       // 卷积时为空洞率，转置卷积时为步长
+    int64_t pad_left = 0;
+    int64_t pad_right = 0;
+    int64_t output_padding = 0;
+
+    void Load(const OrtKernelInfo* info, const char* stride_attr, bool transpose) {
+        Ort::ConstKernelInfo ki(info);
+        alpha = ki.GetAttribute<float>("alpha");
+        stride = ki.GetAttribute<int64_t>(stride_attr);
+        std::vector<int64_t> pads = ki.GetAttributes<int64_t>("pads");
+        if (pads.size() != 2) {
+            throw std::runtime_error("融合卷积的pads必须为2个元素");
+        }
+        pad_left = pads[0];
+        pad_right = pads[1];
+        if (transpose) {
+            output_padding = ki.GetAttribute<int64_t>("output_padding");
+        }
+        if (stride <= 0) {
+            throw std::runtime_error("融合卷积的步长/空洞率无效");
+        }
+    }
+};
+
+// 两个融合算子共用的计算流程，Transpose区分卷积与转置卷积
+template <bool Transpose>
+struct FusedConvKernel {
+    FusedConvKernel(const OrtApi& /*api*/, const OrtKernelInfo* info) {
+        params_.Load(info, Transpose ? "stride" : "dilation", Transpose);
+    }
+
+    void Compute(OrtKernelContext* context) {
+        Ort::KernelContext ctx(context);
+
+        auto x = ctx.GetInput(0);
+        auto w = ctx.GetInput(1);
+        auto b = ctx.GetInput(2);
+        std::vector<int64_t> x_shape = x.GetTensorTypeAndShapeInfo().GetShape();
+        std::vector<int64_t> w_shape = w.GetTensorTypeAndShapeInfo().GetShape();
+        if (x_shape.size() != 3 || w_shape.size() != 3) {
+            throw std::runtime_error("融合卷积只支持一维卷积 [N, C, T]");
+        }
+
+        int batch = static_cast<int>(x_shape[0]);
+        int in_channels = static_cast<int>(x_shape[1]);
+        int len = static_cast<int>(x_shape[2]);
+        int out_channels = static_cast<int>(Transpose ? w_shape[1] : w_shape[0]);
+        int kernel = static_cast<int>(w_shape[2]);
+        if ((Transpose ? w_shape[0] : w_shape[1]) != in_channels) {
+            throw std::runtime_error("融合卷积的权重与输入通道数不匹配");
+        }
+
+        int out_len = Transpose
+            ? melotts::kernels::ConvTransposeOutputLength(len, kernel, static_cast<int>(params_.stride),
+                                                          static_cast<int>(params_.pad_left),
+                                                          static_cast<int>(params_.pad_right),
+                                                          static_cast<int>(params_.output_padding))
+            : melotts::kernels::ConvOutputLength(len, kernel, static_cast<int>(params_.stride),
+                                                 static_cast<int>(params_.pad_left),
+                                                 static_cast<int>(params_.pad_right));
+        std::vector<int64_t> y_shape = {batch, out_channels, out_len};
+        auto y = ctx.GetOutput(0, y_shape);
+
+        // 可选残差输入：[N或1, M, T_out或1]
+        const float* res_data = nullptr;
+        int res_batch = 0;
+        int res_time = 0;
+        if (ctx.GetInputCount() > 3) {
+            auto r = ctx.GetInput(3);
+            std::vector<int64_t> r_shape = r.GetTensorTypeAndShapeInfo().GetShape();
+            if (r_shape.size() != 3 || r_shape[1] != out_channels ||
+                (r_shape[0] != batch && r_shape[0] != 1) ||
+                (r_shape[2] != out_len && r_shape[2] != 1)) {
+                throw std::runtime_error("融合卷积的残差形状与输出不匹配");
+            }
+            res_data = r.GetTensorData<float>();
+            res_batch = static_cast<int>(r_shape[0]);
+            res_time = static_cast<int>(r_shape[2]);
+        }
+
+        const float* x_data = x.GetTensorData<float>();
+        const float* w_data = w.GetTensorData<float>();
+        const float* b_data = b.GetTensorData<float>();
+        float* y_data = y.GetTensorMutableData<float>();
+
+        // 工作区按线程复用：ONNX Runtime 允许多个线程同时在同一会话上 Run，内核对象在这些调用间共享，
+        // 不能持有可变的缓冲区
+        static thread_local std::vector<float> work;    // 激活后的输入
+        static thread_local std::vector<float> phase;   // 转置卷积的相位缓冲
+
+        for (int n = 0; n < batch; n++) {
+            melotts::kernels::Residual res;
+            if (res_data) {
+                res.data = res_data + static_cast<size_t>(res_batch == 1 ? 0 : n) * out_channels * res_time;
+                res.time = res_time;
+            }
+            const float* xn = x_data + static_cast<size_t>(n) * in_channels * len;
+            float* yn = y_data + static_cast<size_t>(n) * out_channels * out_len;
+
+            if (Transpose) {
+                melotts::kernels::LeakyReluConvTranspose1d(
+                    xn, in_channels, len, w_data, out_channels, kernel, b_data, res,
+                    params_.alpha, static_cast<int>(params_.stride),
+                    static_cast<int>(params_.pad_left), static_cast<int>(params_.pad_right),
+                    static_cast<int>(params_.output_padding), yn, work, phase);
+            } else {
+                melotts::kernels::LeakyReluConv1d(
+                    xn, in_channels, len, w_data, out_channels, kernel, b_data, res,
+                    params_.alpha, static_cast<int>(params_.stride),
+                    static_cast<int>(params_.pad_left), static_cast<int>(params_.pad_right),
+                    yn, work);
+            }
+        }
+    }
+
+private:
+    FusedConvParams params_;   // 创建后只读
+};
+
+template <bool Transpose>
+struct FusedConvOp : Ort::CustomOpBase<FusedConvOp<Transpose>, FusedConvKernel<Transpose>> {
+    void* CreateKernel(const OrtApi& api, const OrtKernelInfo* info) const {
+        return new FusedConvKernel<Transpose>(api, info);
+    }
+
+    const char* GetName() const {
+        return Transpose ? "LeakyReluConvTranspose" : "LeakyReluConv";
+    }
+
+    const char* GetExecutionProviderType() const {
+        return "CPUExecutionProvider";
+    }
+
+    size_t GetInputTypeCount() const { return 4; }
+    ONNXTensorElementDataType GetInputType(size_t /*index*/) const {
+        return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    }
+    OrtCustomOpInputOutputCharacteristic GetInputCharacteristic(size_t index) const {
+        return index == 3 ? OrtCustomOpInputOutputCharacteristic::INPUT_OUTPUT_OPTIONAL
+                          : OrtCustomOpInputOutputCharacteristic::INPUT_OUTPUT_REQUIRED;
+    }
+
+    size_t GetOutputTypeCount() const { return 1; }
+    ONNXTensorElementDataType GetOutputType(size_t /*index*/) const {
+        return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    }
+};
+
+} // namespace
+
+// ONNX Runtime 加载自定义算子库的入口
+extern "C" OrtStatus* ORT_API_CALL RegisterCustomOps(OrtSessionOptions* options, const OrtApiBase* api) {
+    Ort::InitApi(api->GetApi(ORT_API_VERSION));
+
+    static const FusedConvOp<false> conv_op;
+    static const FusedConvOp<true> conv_transpose_op;
+
+    // 算子域需在所有会话结束前保持有效
+    static std::vector<Ort::CustomOpDomain> domains;
+    static std::mutex mutex;
+
+    try {
+        Ort::CustomOpDomain domain{kDomain};
+        domain.Add(&conv_op);
+        domain.Add(&conv_transpose_op);
+
+        Ort::UnownedSessionOptions session_options(options);
+        session_options.Add(domain);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        domains.push_back(std::move(domain));
+    } catch (const std::exception& e) {
+        return Ort::GetApi().CreateStatus(ORT_FAIL, e.what());
+    }
+    return nullptr;
+}
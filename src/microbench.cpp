@@ -0,0 +1,559 @@
+// microbench.cpp - 前端文本处理与音频处理热点函数的微基准测试
+//
+// 用法: melotts_microbench [--filter 子串] [--min-time 秒] [-m 模型目录] [--native-model 模型目录]
+// 不需要 ONNX 模型：未指定 -m 时在临时目录生成覆盖语料全部字符的合成词典和音素表。
+// 每项自动加倍迭代次数直到耗时超过 min-time，输出单次耗时、吞吐量（字符/秒或采样点/秒）
+// 以及每次调用的内存分配次数和字节数（alloc_stats.cpp 替换全局 operator new 统计）。
+// 被测函数输出的日志在计时期间丢弃，日志格式化本身的开销计入耗时。
+// --native-model 目录（默认 models/tiny）中有 encoder.onnx / decoder.onnx 时同时测量原生引擎和 ONNX Runtime 后端。
+// 标记为无分配的项（预热后的原生引擎推理）稳态下出现堆分配时返回2，可作为回归检查。
+// ONNX Runtime 的 Session::Run 自身会分配，OrtBackend 的各项以直接调用会话的基线项为上限，超出同样返回2。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "AllocStats.h"
+#include "AudioFile.h"
+#include "InferenceBackend.h"
+#include "Lexicon.hpp"
+#include "NativeEngine.h"
+#include "PipelineUtils.hpp"
+
+#include <onnxruntime_cxx_api.h>
+
+namespace {
+
+// 丢弃写入内容的流缓冲区
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// 计时期间屏蔽 std::cout / std::cerr
+class ScopedSilence {
+public:
+    ScopedSilence() : out_(std::cout.rdbuf(&null_)), err_(std::cerr.rdbuf(&null_)) {}
+    ~ScopedSilence() {
+        std::cout.rdbuf(out_);
+        std::cerr.rdbuf(err_);
+    }
+
+private:
+    NullBuffer null_;
+    std::streambuf* out_;
+    std::streambuf* err_;
+};
+
+// 阻止编译器把结果未被使用的调用优化掉
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(&value) : "memory");
+}
+
+struct Benchmark {
+    std::string name;
+    std::function<void()> body;
+    double items;        // 每次调用处理的字符数或采样点数
+    const char* unit;    // 吞吐量单位
+    bool alloc_free;     // 声明为稳态无堆分配
+    std::string alloc_baseline = "";  // 非空时每次分配不得多于该基准（须排在本项之前）
+};
+
+struct Result {
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+    double bytes_per_op = 0.0;
+    size_t iterations = 0;
+};
+
+Result run_benchmark(const Benchmark& bench, double min_time) {
+    ScopedSilence silence;
+    bench.body();  // 预热
+
+    Result result;
+    for (size_t iterations = 1;; iterations *= 2) {
+        melotts::AllocScope allocs;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            bench.body();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= min_time || iterations >= (size_t(1) << 30)) {
+            result.iterations = iterations;
+            result.ns_per_op = elapsed * 1e9 / iterations;
+            melotts::AllocCounters delta = allocs.Delta();
+            result.allocs_per_op = static_cast<double>(delta.count) / iterations;
+            result.bytes_per_op = static_cast<double>(delta.bytes) / iterations;
+            return result;
+        }
+    }
+}
+
+std::string format_time(double ns) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    if (ns < 1e3) oss << ns << " ns";
+    else if (ns < 1e6) oss << ns / 1e3 << " us";
+    else oss << ns / 1e6 << " ms";
+    return oss.str();
+}
+
+std::string format_rate(double per_second, const char* unit) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    if (per_second >= 1e9) oss << per_second / 1e9 << " G";
+    else if (per_second >= 1e6) oss << per_second / 1e6 << " M";
+    else if (per_second >= 1e3) oss << per_second / 1e3 << " K";
+    else oss << per_second << " ";
+    oss << unit << "/s";
+    return oss.str();
+}
+
+std::string format_bytes(double bytes) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (bytes >= 1024.0 * 1024.0) oss << bytes / (1024.0 * 1024.0) << " MB";
+    else if (bytes >= 1024.0) oss << bytes / 1024.0 << " KB";
+    else oss << bytes << " B";
+    return oss.str();
+}
+
+// 按显示宽度补齐（汉字占两列），std::setw 按字节计数，中文列会错位
+std::string pad(const std::string& text, size_t width) {
+    size_t display = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if ((c & 0xC0) == 0x80) continue;
+        display += c >= 0xE0 ? 2 : 1;
+    }
+    return text + std::string(display < width ? width - display : 1, ' ');
+}
+
+// UTF-8 字符数
+size_t utf8_length(const std::string& text) {
+    size_t n = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) n++;
+    }
+    return n;
+}
+
+// 固定语料：每种语言若干基础句子，按目标字符数循环拼接出不同长度
+const std::vector<std::string> kZhSentences = {
+    "今天天气不错，我们一起去公园散步吧。",
+    "欢迎致电客户服务中心，查询账户余额请按一，人工服务请按零。",
+    "语音合成系统把输入的文本转换为音素序列，再由声学模型预测每个音素的时长。",
+    "这家餐厅的菜很好吃，价格也不贵，周末经常需要排队！",
+};
+
+const std::vector<std::string> kEnSentences = {
+    "The weather is nice today, let us take a walk in the park.",
+    "Thank you for calling customer service, please press zero for an operator.",
+    "A text to speech system converts the input text into phonemes and predicts their durations.",
+    "This restaurant is great, and the prices are quite reasonable!",
+};
+
+const std::vector<std::string> kMixedSentences = {
+    "我今天用iPhone打开Google地图，导航到Starbucks买咖啡。",
+    "请把这份report发到我的email邮箱，谢谢。",
+    "周末我们去看了一场NBA比赛，现场气氛非常好！",
+    "这个API的latency太高了，需要优化一下。",
+};
+
+std::string build_text(const std::vector<std::string>& sentences, size_t min_chars) {
+    std::string text;
+    for (size_t i = 0; utf8_length(text) < min_chars; i++) {
+        text += sentences[i % sentences.size()];
+        if (sentences == kEnSentences) text += " ";
+    }
+    return text;
+}
+
+// 生成覆盖语料中全部汉字和英文单词的合成词典与音素表
+void write_synthetic_lexicon(const std::string& dir, const std::vector<std::string>& corpora) {
+    const std::vector<std::string> initials = {"b", "p", "m", "f", "d", "t", "n", "l", "g", "k", "h",
+                                               "j", "q", "x", "zh", "ch", "sh", "r", "z", "c", "s"};
+    const std::vector<std::string> finals = {"a", "o", "e", "i", "u", "v", "ai", "ei", "ao",
+                                             "ou", "an", "en", "ang", "eng", "ong"};
+    const std::vector<std::string> puncts = {",", ".", "!", "?", "…", "'", "-"};
+
+    std::ofstream tokens(dir + "/tokens.txt");
+    int id = 0;
+    tokens << "_ " << id++ << "\n";
+    tokens << "UNK " << id++ << "\n";
+    std::set<std::string> written;
+    for (const auto& list : {initials, finals, puncts}) {
+        for (const auto& t : list) {
+            if (written.insert(t).second) tokens << t << " " << id++ << "\n";
+        }
+    }
+    for (char c = 'a'; c <= 'z'; c++) {
+        std::string t(1, c);
+        if (written.insert(t).second) tokens << t << " " << id++ << "\n";
+    }
+
+    std::ofstream lexicon(dir + "/lexicon.txt");
+    std::set<std::string> words;
+    for (const auto& text : corpora) {
+        for (size_t i = 0; i < text.size();) {
+            unsigned char c = text[i];
+            if (c >= 0xE0 && c < 0xF0 && i + 3 <= text.size()) {
+                words.insert(text.substr(i, 3));
+                i += 3;
+            } else if (std::isalpha(c)) {
+                size_t end = i;
+                while (end < text.size() && std::isalpha(static_cast<unsigned char>(text[end]))) end++;
+                words.insert(text.substr(i, end - i));
+                i = end;
+            } else {
+                i++;
+            }
+        }
+    }
+    size_t k = 0;
+    for (const auto& w : words) {
+        lexicon << w;
+        if (std::isalpha(static_cast<unsigned char>(w[0]))) {
+            for (char c : w) lexicon << " " << static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        } else {
+            lexicon << " " << initials[k % initials.size()] << " " << finals[k % finals.size()] << (k % 5 + 1);
+        }
+        lexicon << "\n";
+        k++;
+    }
+}
+
+// 直接调用 ONNX Runtime 会话作为 OrtBackend 的分配基线：输入、输出张量在循环外建好并一直复用，
+// 每次运行的分配只来自 Session::Run 本身
+class OrtSessionBaseline {
+public:
+    OrtSessionBaseline(const std::string& model_file, const melotts::InferenceBackend& backend,
+                       const std::vector<melotts::TensorView>& inputs)
+        : env_(ORT_LOGGING_LEVEL_WARNING, "melotts_microbench"), session_(nullptr),
+          memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
+        Ort::SessionOptions options;
+        options.SetIntraOpNumThreads(1);
+        session_ = Ort::Session(env_, model_file.c_str(), options);
+        for (const auto& info : backend.Inputs()) input_names_.push_back(info.name.c_str());
+        for (const auto& info : backend.Outputs()) output_names_.push_back(info.name.c_str());
+        for (const auto& view : inputs) {
+            void* data = const_cast<void*>(view.raw());
+            switch (view.type()) {
+                case melotts::DataType::Int32:
+                    inputs_.push_back(Ort::Value::CreateTensor<int32_t>(memory_info_, static_cast<int32_t*>(data),
+                                                                        view.count(), view.dims(), view.rank()));
+                    break;
+                case melotts::DataType::Int64:
+                    inputs_.push_back(Ort::Value::CreateTensor<int64_t>(memory_info_, static_cast<int64_t*>(data),
+                                                                        view.count(), view.dims(), view.rank()));
+                    break;
+                default:
+                    inputs_.push_back(Ort::Value::CreateTensor<float>(memory_info_, static_cast<float*>(data),
+                                                                      view.count(), view.dims(), view.rank()));
+                    break;
+            }
+        }
+        outputs_ = session_.Run(Ort::RunOptions{nullptr}, input_names_.data(), inputs_.data(), inputs_.size(),
+                                output_names_.data(), output_names_.size());
+    }
+
+    void Run() {
+        session_.Run(Ort::RunOptions{nullptr}, input_names_.data(), inputs_.data(), inputs_.size(),
+                     output_names_.data(), outputs_.data(), outputs_.size());
+    }
+
+private:
+    Ort::Env env_;
+    Ort::Session session_;
+    Ort::MemoryInfo memory_info_;
+    std::vector<const char*> input_names_;
+    std::vector<const char*> output_names_;
+    std::vector<Ort::Value> inputs_;
+    std::vector<Ort::Value> outputs_;
+};
+
+// 同一模型的 OrtBackend 项及其基线项：输入每次原样传入，OrtBackend 应复用包装好的输入和上一次的输出
+void add_ort_benchmarks(std::vector<Benchmark>& benchmarks, const std::string& name, const std::string& model_file,
+                        const std::vector<melotts::TensorView>& inputs, double items, const char* unit) {
+    std::shared_ptr<melotts::InferenceBackend> backend;
+    std::shared_ptr<OrtSessionBaseline> baseline;
+    try {
+        ScopedSilence silence;
+        melotts::BackendOptions options;
+        options.intra_op_threads = 1;
+        options.share_weights = false;
+        backend = melotts::CreateInferenceBackend("onnxruntime", model_file, options);
+        baseline = std::make_shared<OrtSessionBaseline>(model_file, *backend, inputs);
+    } catch (const std::exception& e) {
+        std::cerr << "跳过 ONNX Runtime 基准 " << name << ": " << e.what() << std::endl;
+        return;
+    }
+    const std::string baseline_name = "Ort::Session::Run/" + name;
+    benchmarks.push_back({baseline_name, [baseline]() { baseline->Run(); }, items, unit, false});
+    benchmarks.push_back({"OrtBackend::" + name,
+                          [backend, inputs]() {
+                              backend->Run(inputs);
+                              DoNotOptimize(backend->Output(0).raw());
+                          },
+                          items, unit, false, baseline_name});
+}
+
+void print_usage(const char* program_name) {
+    std::cout << "用法: " << program_name << " [选项]" << std::endl;
+    std::cout << "选项:" << std::endl;
+    std::cout << "  --filter TEXT          只运行名称包含TEXT的项" << std::endl;
+    std::cout << "  --min-time SEC         每项最少运行时间 (默认: 0.2)" << std::endl;
+    std::cout << "  -m, --model-dir DIR    使用模型目录中的 lexicon.txt / tokens.txt (默认: 生成合成词典)" << std::endl;
+    std::cout << "  --native-model DIR     用原生引擎和 ONNX Runtime 测量其中的 encoder.onnx / decoder.onnx (默认: models/tiny)" << std::endl;
+    std::cout << "  -h, --help             显示此帮助信息" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string model_dir;
+    std::string native_model_dir = "models/tiny";
+    double min_time = 0.2;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter") {
+            if (i + 1 < argc) filter = argv[++i];
+        } else if (arg == "--min-time") {
+            if (i + 1 < argc) min_time = std::stod(argv[++i]);
+        } else if (arg == "-m" || arg == "--model-dir") {
+            if (i + 1 < argc) model_dir = argv[++i];
+        } else if (arg == "--native-model") {
+            if (i + 1 < argc) native_model_dir = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "未知选项: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    struct Corpus {
+        std::string name;
+        std::string text;
+    };
+    std::vector<Corpus> corpora;
+    const std::pair<const char*, const std::vector<std::string>*> languages[] = {
+        {"zh", &kZhSentences}, {"en", &kEnSentences}, {"mixed", &kMixedSentences}};
+    const std::pair<const char*, size_t> sizes[] = {{"short", 1}, {"medium", 100}, {"long", 1000}};
+    for (const auto& lang : languages) {
+        for (const auto& size : sizes) {
+            corpora.push_back({std::string(lang.first) + "/" + size.first, build_text(*lang.second, size.second)});
+        }
+    }
+
+    // 词典与音素表
+    std::string temp_dir;
+    if (model_dir.empty()) {
+        char pattern[] = "/tmp/melotts_microbench_XXXXXX";
+        if (!mkdtemp(pattern)) {
+            std::cerr << "无法创建临时目录" << std::endl;
+            return 1;
+        }
+        temp_dir = model_dir = pattern;
+        std::vector<std::string> texts;
+        for (const auto& c : corpora) texts.push_back(c.text);
+        write_synthetic_lexicon(temp_dir, texts);
+    }
+
+    std::unique_ptr<Lexicon> lexicon;
+    try {
+        ScopedSilence silence;
+        lexicon.reset(new Lexicon(model_dir + "/lexicon.txt", model_dir + "/tokens.txt", false));
+    } catch (const std::exception& e) {
+        std::cerr << "加载词典失败: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<Benchmark> benchmarks;
+    std::vector<int> phones, tones;
+    for (const auto& corpus : corpora) {
+        const std::string text = corpus.text;
+        const double chars = static_cast<double>(utf8_length(text));
+        std::string normalized = lexicon->normalizeText(text);
+        Lexicon* lex = lexicon.get();
+        benchmarks.push_back({"Lexicon::convert/" + corpus.name,
+                              [lex, text, &phones, &tones]() {
+                                  lex->convert(text, phones, tones);
+                                  DoNotOptimize(phones);
+                              }, chars, "字符", false});
+        benchmarks.push_back({"Lexicon::normalizeText/" + corpus.name,
+                              [lex, text]() { DoNotOptimize(lex->normalizeText(text)); }, chars, "字符", false});
+        benchmarks.push_back({"Lexicon::splitSentence/" + corpus.name,
+                              [lex, normalized]() { DoNotOptimize(lex->splitSentence(normalized)); }, chars, "字符", false});
+        benchmarks.push_back({"Lexicon::segment/" + corpus.name,
+                              [lex, normalized]() { DoNotOptimize(lex->segment(normalized)); }, chars, "字符", false});
+    }
+
+    // 音频处理：固定随机数据
+    std::mt19937 rng(42);
+    std::normal_distribution<float> dist(0.0f, 0.3f);
+    const int sample_rate = 24000;
+    const int zp_channels = 192;
+    const int feature_frames = 1000;
+    std::vector<float> features(static_cast<size_t>(zp_channels) * feature_frames);
+    for (auto& v : features) v = dist(rng);
+    std::vector<float> audio_1s(sample_rate), audio_10s(sample_rate * 10);
+    for (auto& v : audio_1s) v = dist(rng);
+    for (auto& v : audio_10s) v = dist(rng);
+    const std::string wav_file = (temp_dir.empty() ? std::string("/tmp") : temp_dir) + "/microbench.wav";
+
+    for (int n : {64, 512}) {
+        std::vector<int> seq(n, 7);
+        benchmarks.push_back({"intersperse/" + std::to_string(n),
+                              [seq]() { DoNotOptimize(melotts::intersperse(seq, 0)); }, static_cast<double>(n), "音素", false});
+    }
+    for (int dec_len : {32, 256}) {
+        benchmarks.push_back({"reshapeFeatures/" + std::to_string(zp_channels) + "x" + std::to_string(dec_len),
+                              [&features, dec_len]() {
+                                  DoNotOptimize(melotts::reshapeFeatures(features, feature_frames, zp_channels, dec_len, 100));
+                              },
+                              static_cast<double>(zp_channels) * dec_len, "元素", false});
+    }
+    const std::pair<const char*, const std::vector<float>*> clips[] = {{"1s", &audio_1s}, {"10s", &audio_10s}};
+    for (const auto& clip : clips) {
+        const std::vector<float>* audio = clip.second;
+        benchmarks.push_back({std::string("postProcessAudio/") + clip.first,
+                              [audio]() {
+                                  DoNotOptimize(melotts::postProcessAudio(*audio, static_cast<int>(audio->size()), true));
+                              },
+                              static_cast<double>(audio->size()), "采样点", false});
+        benchmarks.push_back({std::string("AudioFile::save/") + clip.first,
+                              [audio, &wav_file]() {
+                                  AudioFile<float> file;
+                                  file.setAudioBuffer(std::vector<std::vector<float>>{*audio});
+                                  file.setSampleRate(sample_rate);
+                                  file.save(wav_file);
+                              },
+                              static_cast<double>(audio->size()), "采样点", false});
+    }
+
+    // 原生引擎：预热后的推理应当不再分配（输入形状和输出缓冲区在循环外准备好）
+    std::unique_ptr<melotts::NativeEngine> native_decoder, native_encoder;
+    std::vector<float> native_speaker(256, 0.1f), native_audio;
+    std::vector<std::vector<int64_t>> decoder_shapes;
+    std::ifstream decoder_probe(native_model_dir + "/decoder.onnx");
+    if (decoder_probe.good()) {
+        native_decoder.reset(new melotts::NativeEngine());
+        native_encoder.reset(new melotts::NativeEngine());
+        ScopedSilence silence;
+        if (native_decoder->Init(native_model_dir + "/decoder.onnx") != 0) native_decoder.reset();
+        if (native_encoder->Init(native_model_dir + "/encoder.onnx") != 0) native_encoder.reset();
+    }
+    if (native_decoder) {
+        melotts::NativeEngine* engine = native_decoder.get();
+        const int64_t channels = engine->GetInputShape(0).size() > 1 ? engine->GetInputShape(0)[1] : zp_channels;
+        for (int64_t frames : {32, 256}) {
+            decoder_shapes.push_back({1, channels, frames});
+        }
+        for (const auto& shape : decoder_shapes) {
+            const std::vector<int64_t>* zp_shape = &shape;
+            const double samples = static_cast<double>(shape[2]) * 512;
+            native_audio.resize(std::max(native_audio.size(), static_cast<size_t>(samples)));
+            benchmarks.push_back({"NativeEngine::decoder/" + std::to_string(shape[2]),
+                                  [engine, zp_shape, &features, &native_speaker, &native_audio]() {
+                                      engine->SetInput(features.data(), 0, *zp_shape);
+                                      engine->SetInput(native_speaker.data(), 1);
+                                      engine->RunSync();
+                                      engine->GetOutput(native_audio.data(), 0);
+                                      DoNotOptimize(native_audio);
+                                  },
+                                  samples, "采样点", true});
+            add_ort_benchmarks(benchmarks, "decoder/" + std::to_string(shape[2]), native_model_dir + "/decoder.onnx",
+                               {melotts::TensorView(features.data(), shape),
+                                melotts::TensorView(native_speaker.data(), {1, 256, 1})},
+                               samples, "采样点");
+        }
+    }
+    std::vector<int32_t> native_phones(64, 5), native_tones(64, 1), native_langs(64, 3);
+    const std::vector<int64_t> native_phone_shape = {static_cast<int64_t>(native_phones.size())};
+    const float native_scales[4] = {0.0f, 0.0f, 1.0f, 0.2f};
+    std::vector<int64_t> native_seqs64[3];
+    if (native_encoder && native_encoder->GetInputCount() == 8) {
+        melotts::NativeEngine* engine = native_encoder.get();
+        benchmarks.push_back({"NativeEngine::encoder/" + std::to_string(native_phones.size()),
+                              [engine, &native_phones, &native_tones, &native_langs, &native_phone_shape,
+                               &native_speaker, &native_scales]() {
+                                  engine->SetInput(native_phones.data(), 0, native_phone_shape);
+                                  engine->SetInput(native_tones.data(), 1, native_phone_shape);
+                                  engine->SetInput(native_langs.data(), 2, native_phone_shape);
+                                  engine->SetInput(native_speaker.data(), 3);
+                                  for (int k = 0; k < 4; ++k) engine->SetInput(&native_scales[k], 4 + k);
+                                  engine->RunSync();
+                                  DoNotOptimize(engine->GetOutputShape(0));
+                              },
+                              static_cast<double>(native_phones.size()), "音素", true});
+
+        // 按模型声明的类型传入音素序列（与 MeloTTS::run_encoder 相同）
+        std::vector<melotts::TensorView> ort_inputs;
+        const std::vector<int32_t>* seqs[3] = {&native_phones, &native_tones, &native_langs};
+        for (int k = 0; k < 3; ++k) {
+            if (engine->GetInputType(k) == static_cast<int>(melotts::DataType::Int64)) {
+                native_seqs64[k].assign(seqs[k]->begin(), seqs[k]->end());
+                ort_inputs.emplace_back(native_seqs64[k].data(), native_phone_shape);
+            } else {
+                ort_inputs.emplace_back(seqs[k]->data(), native_phone_shape);
+            }
+        }
+        ort_inputs.emplace_back(native_speaker.data(), std::vector<int64_t>{1, 256, 1});
+        for (int k = 0; k < 4; ++k) ort_inputs.emplace_back(&native_scales[k], std::vector<int64_t>{1});
+        add_ort_benchmarks(benchmarks, "encoder/" + std::to_string(native_phones.size()),
+                           native_model_dir + "/encoder.onnx", ort_inputs,
+                           static_cast<double>(native_phones.size()), "音素");
+    }
+
+    std::cout << pad("基准", 40) << pad("耗时/次", 14) << pad("吞吐量", 20) << pad("分配次数/次", 14)
+              << "分配字节/次" << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+    int alloc_failures = 0;
+    std::map<std::string, double> measured_allocs;
+    for (const auto& bench : benchmarks) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        Result r = run_benchmark(bench, min_time);
+        measured_allocs[bench.name] = r.allocs_per_op;
+        std::ostringstream allocs;
+        allocs << std::fixed << std::setprecision(1) << r.allocs_per_op;
+        bool violated = bench.alloc_free && r.allocs_per_op > 0.0;
+        auto baseline = measured_allocs.find(bench.alloc_baseline);
+        bool above_baseline = !bench.alloc_baseline.empty() && baseline != measured_allocs.end() &&
+                              r.allocs_per_op > baseline->second;
+        alloc_failures += (violated || above_baseline) ? 1 : 0;
+        std::cout << pad(bench.name, 40) << pad(format_time(r.ns_per_op), 14)
+                  << pad(format_rate(bench.items * 1e9 / r.ns_per_op, bench.unit), 20)
+                  << pad(allocs.str(), 14) << format_bytes(r.bytes_per_op)
+                  << (violated ? "  [应无分配]" : "") << (above_baseline ? "  [多于会话基线]" : "") << std::endl;
+    }
+    if (alloc_failures > 0) {
+        std::cerr << alloc_failures << " 项基准在稳态下的堆分配超出声明（无分配或不多于会话基线）" << std::endl;
+    }
+
+    std::remove(wav_file.c_str());
+    if (!temp_dir.empty()) {
+        std::remove((temp_dir + "/lexicon.txt").c_str());
+        std::remove((temp_dir + "/tokens.txt").c_str());
+        rmdir(temp_dir.c_str());
+    }
+    return alloc_failures > 0 ? 2 : 0;
+}
@@ -0,0 +1,219 @@
+// model_registry.cpp - 多模型集注册表实现
+
+#include "ModelRegistry.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "AllocStats.h"
+#include "InferenceBackend.h"
+
+namespace melotts {
+
+struct ModelRegistry::Entry {
+    std::string name;
+    MeloTTSConfig config;
+    size_t declared_kb = 0;
+    std::shared_ptr<MeloTTS> tts;    // 未加载时为空
+    bool loading = false;
+    int active = 0;                  // 未释放（含等待中）的 Handle 数
+    uint64_t uses = 0;
+    bool used = false;
+    Clock::time_point last_used;
+    double load_ms = 0.0;
+    size_t resident_kb = 0;
+    std::mutex use_mutex;            // 串行化同一模型集上的合成
+};
+
+ModelRegistry::Handle::Handle(ModelRegistry* registry, std::shared_ptr<Entry> entry, std::shared_ptr<MeloTTS> tts)
+    : registry_(registry), entry_(std::move(entry)), tts_(std::move(tts)), use_lock_(entry_->use_mutex) {}
+
+ModelRegistry::Handle::Handle(Handle&& other)
+    : registry_(other.registry_), entry_(std::move(other.entry_)), tts_(std::move(other.tts_)),
+      use_lock_(std::move(other.use_lock_)) {
+    other.registry_ = nullptr;
+}
+
+ModelRegistry::Handle::~Handle() {
+    if (!registry_) return;
+    use_lock_.unlock();
+    tts_.reset();
+    registry_->Release(*entry_);
+}
+
+ModelRegistry::ModelRegistry(const ModelRegistryOptions& options) : options_(options) {
+    if (options_.shared_threads > 0) {
+        shared_thread_pool_ = EnableSharedThreadPool(options_.shared_threads);
+        if (!shared_thread_pool_) {
+            std::cerr << "警告: ONNX Runtime 环境已按其他线程设置创建，模型集改用各自的线程池" << std::endl;
+        }
+    }
+}
+
+ModelRegistry::~ModelRegistry() = default;
+
+void ModelRegistry::Register(const std::string& name, const MeloTTSConfig& config, size_t resident_kb) {
+    if (!config.validate()) {
+        throw std::runtime_error("模型集 " + name + " 的配置无效");
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->name = name;
+    entry->config = config;
+    entry->config.shared_thread_pool = shared_thread_pool_;
+    entry->declared_kb = resident_kb;
+    entry->resident_kb = resident_kb;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!entries_.emplace(name, std::move(entry)).second) {
+        throw std::runtime_error("模型集重复注册: " + name);
+    }
+}
+
+bool ModelRegistry::Contains(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.count(name) > 0;
+}
+
+ModelRegistry::Handle ModelRegistry::Acquire(const std::string& name) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        throw std::runtime_error("未注册的模型集: " + name);
+    }
+    std::shared_ptr<Entry> entry = it->second;
+    loaded_cv_.wait(lock, [&entry]() { return !entry->loading; });
+
+    std::vector<std::shared_ptr<MeloTTS>> evicted;
+    if (!entry->tts) {
+        // 在锁外加载，其他模型集照常使用；同一模型集的其他请求等待加载结束
+        entry->loading = true;
+        lock.unlock();
+        std::shared_ptr<MeloTTS> tts;
+        size_t rss_before = CurrentRssKb();
+        auto start = Clock::now();
+        try {
+            tts = std::make_shared<MeloTTS>(entry->config);
+        } catch (...) {
+            lock.lock();
+            entry->loading = false;
+            loaded_cv_.notify_all();
+            throw;
+        }
+        double load_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        size_t rss_after = CurrentRssKb();
+
+        lock.lock();
+        entry->tts = std::move(tts);
+        entry->loading = false;
+        entry->load_ms = load_ms;
+        if (entry->declared_kb == 0) {
+            // 并发加载其他模型集时估算值偏大，只用于决定卸载顺序和预算
+            entry->resident_kb = rss_after > rss_before ? rss_after - rss_before : 0;
+        }
+        loaded_cv_.notify_all();
+        EvictLocked(entry.get(), evicted);
+    }
+    entry->active++;
+    entry->uses++;
+    entry->used = true;
+    entry->last_used = Clock::now();
+    std::shared_ptr<MeloTTS> tts = entry->tts;
+    lock.unlock();
+
+    evicted.clear();
+    return Handle(this, std::move(entry), std::move(tts));
+}
+
+void ModelRegistry::Release(Entry& entry) {
+    std::vector<std::shared_ptr<MeloTTS>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry.active--;
+        entry.last_used = Clock::now();
+        // 加载时因模型集都被占用而没能回到预算内的，在释放时补上；刚用完的模型集最后卸载，
+        // 单个模型集超出预算时仍保留，避免每次请求都重新加载
+        EvictLocked(&entry, evicted);
+    }
+}
+
+bool ModelRegistry::Unload(const std::string& name) {
+    std::shared_ptr<MeloTTS> tts;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(name);
+        if (it == entries_.end() || !it->second->tts || it->second->active > 0) {
+            return false;
+        }
+        tts = std::move(it->second->tts);
+    }
+    return true;
+}
+
+size_t ModelRegistry::UnloadIdle(double idle_seconds) {
+    std::vector<std::shared_ptr<MeloTTS>> unloaded;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = Clock::now();
+        for (auto& item : entries_) {
+            Entry& entry = *item.second;
+            if (!entry.tts || entry.active > 0) continue;
+            double idle = std::chrono::duration<double>(now - entry.last_used).count();
+            if (idle >= idle_seconds) {
+                unloaded.push_back(std::move(entry.tts));
+            }
+        }
+    }
+    return unloaded.size();
+}
+
+std::vector<ModelSetInfo> ModelRegistry::List() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    std::vector<ModelSetInfo> infos;
+    for (const auto& item : entries_) {
+        const Entry& entry = *item.second;
+        ModelSetInfo info;
+        info.name = entry.name;
+        info.model_dir = entry.config.model_dir;
+        info.loaded = entry.tts != nullptr;
+        info.in_use = entry.active > 0;
+        info.uses = entry.uses;
+        info.idle_seconds = entry.used ? std::chrono::duration<double>(now - entry.last_used).count() : 0.0;
+        info.load_ms = entry.load_ms;
+        info.resident_kb = entry.resident_kb;
+        infos.push_back(std::move(info));
+    }
+    return infos;
+}
+
+size_t ModelRegistry::ResidentKb() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ResidentKbLocked();
+}
+
+size_t ModelRegistry::ResidentKbLocked() const {
+    size_t total = 0;
+    for (const auto& item : entries_) {
+        if (item.second->tts) total += item.second->resident_kb;
+    }
+    return total;
+}
+
+void ModelRegistry::EvictLocked(const Entry* keep, std::vector<std::shared_ptr<MeloTTS>>& evicted) {
+    if (options_.memory_budget_kb == 0) return;
+    size_t resident = ResidentKbLocked();
+    while (resident > options_.memory_budget_kb) {
+        Entry* victim = nullptr;
+        for (auto& item : entries_) {
+            Entry& entry = *item.second;
+            if (&entry == keep || !entry.tts || entry.active > 0) continue;
+            if (!victim || entry.last_used < victim->last_used) victim = &entry;
+        }
+        if (!victim) break;
+        resident -= victim->resident_kb;
+        evicted.push_back(std::move(victim->tts));
+    }
+}
+
+} // namespace melotts
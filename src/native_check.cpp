@@ -0,0 +1,150 @@
+// native_check.cpp - 原生引擎与 ONNX Runtime 的一致性检查
+//
+// 用法: melotts_native_check <model.onnx> [长度] [运行次数] [融合算子库]
+// 声码器按长度（帧数）生成随机 z_p；声学模型（8个输入、首个输入为整数序列）按长度（音素数）
+// 生成随机音素/声调序列，噪声比例取0使两个后端的输出可直接比较。
+// 两个后端通过 InferenceBackend 接口以相同的输入运行，输出各输出的最大绝对误差和平均耗时
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "InferenceBackend.h"
+
+using melotts::DataType;
+using melotts::InferenceBackend;
+using melotts::TensorInfo;
+using melotts::TensorView;
+
+// 输入数据，按类型存放在对应的缓冲区
+struct InputSet {
+    std::vector<std::vector<float>> floats;
+    std::vector<std::vector<int32_t>> ints32;
+    std::vector<std::vector<int64_t>> ints64;
+    std::vector<TensorView> views;
+};
+
+// 为每个输入生成随机数据，动态维度用length代替。
+// 声学模型的前3个整数输入为音素/声调/语言ID，之后为说话人嵌入和 noise_scale、noise_scale_w、length_scale、sdp_ratio
+static void make_inputs(const std::vector<TensorInfo>& infos, int length, bool is_encoder, InputSet& set) {
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    const int int_ranges[3] = {40, 8, 1};
+    const float scalars[4] = {0.0f, 0.0f, 1.0f, 0.5f};
+
+    set.floats.resize(infos.size());
+    set.ints32.resize(infos.size());
+    set.ints64.resize(infos.size());
+    set.views.resize(infos.size());
+    for (size_t i = 0; i < infos.size(); i++) {
+        std::vector<int64_t> shape = infos[i].shape;
+        size_t count = 1;
+        for (auto& d : shape) {
+            if (d <= 0) d = length;
+            count *= static_cast<size_t>(d);
+        }
+        if (infos[i].type == DataType::Float) {
+            std::vector<float>& data = set.floats[i];
+            data.resize(count);
+            for (auto& v : data) v = dist(rng);
+            if (is_encoder && i >= 4 && i < 8) {
+                std::fill(data.begin(), data.end(), scalars[i - 4]);
+            }
+            set.views[i] = TensorView(data.data(), shape);
+            continue;
+        }
+        int range = (is_encoder && i < 3) ? int_ranges[i] : 2;
+        int offset = (is_encoder && i == 2) ? 3 : 0;   // 语言ID固定为中文
+        std::uniform_int_distribution<int> ids(0, range - 1);
+        if (infos[i].type == DataType::Int32) {
+            set.ints32[i].resize(count);
+            for (auto& v : set.ints32[i]) v = ids(rng) + offset;
+            set.views[i] = TensorView(set.ints32[i].data(), shape);
+        } else if (infos[i].type == DataType::Int64) {
+            set.ints64[i].resize(count);
+            for (auto& v : set.ints64[i]) v = ids(rng) + offset;
+            set.views[i] = TensorView(set.ints64[i].data(), shape);
+        } else {
+            throw std::runtime_error("不支持的输入类型: " + infos[i].name);
+        }
+    }
+}
+
+static double run_timed(InferenceBackend& backend, const std::vector<TensorView>& inputs, int runs) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < runs; r++) {
+        backend.Run(inputs);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / runs;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "用法: " << argv[0] << " <model.onnx> [长度] [运行次数] [融合算子库]" << std::endl;
+        return 1;
+    }
+    std::string model_file = argv[1];
+    int length = argc > 2 ? std::stoi(argv[2]) : 64;
+    int runs = argc > 3 ? std::stoi(argv[3]) : 10;
+    melotts::BackendOptions options;
+    options.custom_ops_library = argc > 4 ? argv[4] : "";
+
+    try {
+        std::unique_ptr<InferenceBackend> native, ort;
+        try {
+            native = melotts::CreateInferenceBackend("native", model_file, options);
+        } catch (const std::exception& e) {
+            std::cerr << "原生引擎不支持该模型: " << e.what() << std::endl;
+            return 1;
+        }
+        ort = melotts::CreateInferenceBackend("onnxruntime", model_file, options);
+
+        const auto& infos = native->Inputs();
+        bool is_encoder = infos.size() == 8 && infos[0].type != DataType::Float;
+        InputSet inputs;
+        make_inputs(infos, length, is_encoder, inputs);
+
+        // 各运行一次作为预热
+        double native_ms = run_timed(*native, inputs.views, 1);
+        double ort_ms = run_timed(*ort, inputs.views, 1);
+        native_ms = run_timed(*native, inputs.views, runs);
+        ort_ms = run_timed(*ort, inputs.views, runs);
+
+        bool ok = true;
+        std::vector<float> a, b;
+        for (size_t o = 0; o < native->OutputCount(); o++) {
+            const std::string& name = native->Outputs()[o].name;
+            native->CopyOutput(o, a);
+            ort->CopyOutput(o, b);
+            if (a.size() != b.size()) {
+                std::cerr << "输出 " << name << " 长度不一致: " << a.size() << " vs " << b.size() << std::endl;
+                ok = false;
+                continue;
+            }
+
+            float max_err = 0.0f, max_ref = 0.0f;
+            for (size_t k = 0; k < a.size(); k++) {
+                max_err = std::max(max_err, std::fabs(a[k] - b[k]));
+                max_ref = std::max(max_ref, std::fabs(b[k]));
+            }
+            bool pass = max_err <= 1e-4f * std::max(1.0f, max_ref);
+            ok = ok && pass;
+            std::cout << "输出 " << name << ": 元素数 " << a.size()
+                      << ", 最大绝对误差 " << max_err << (pass ? " [通过]" : " [超出容差]") << std::endl;
+        }
+
+        std::cout << "平均耗时 (" << length << (is_encoder ? " 个音素" : " 帧") << "): 原生 " << native_ms
+                  << " ms, ONNX Runtime " << ort_ms << " ms" << std::endl;
+        std::cout << "原生引擎内存池: " << native->ArenaBytes() / 1024 << " KB" << std::endl;
+        return ok ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "检查失败: " << e.what() << std::endl;
+        return 1;
+    }
+}
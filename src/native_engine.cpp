@@ -0,0 +1,2300 @@
+// native_engine.cpp - 原生推理引擎实现
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "NativeEngine.h"
+#include "OnnxProto.hpp"
+#include "FusedKernels.hpp"
+
+namespace melotts {
+
+namespace {
+
+using onnx_proto::kFloat;
+using onnx_proto::kInt64;
+
+// ==================== 内存池 ====================
+
+// 激活张量的内存池：按容量最佳匹配复用空闲块，块地址按64字节对齐
+class ActivationPool {
+public:
+    float* Acquire(size_t count) {
+        int best = -1;
+        for (size_t i = 0; i < blocks_.size(); i++) {
+            const Block& b = blocks_[i];
+            if (!b.in_use && b.capacity >= count &&
+                (best < 0 || b.capacity < blocks_[best].capacity)) {
+                best = static_cast<int>(i);
+            }
+        }
+        if (best < 0) {
+            size_t capacity = std::max<size_t>(count, 16);
+            void* p = nullptr;
+            if (posix_memalign(&p, 64, capacity * sizeof(float)) != 0) {
+                throw std::bad_alloc();
+            }
+            blocks_.emplace_back();
+            blocks_.back().data.reset(static_cast<float*>(p));
+            blocks_.back().capacity = capacity;
+            best = static_cast<int>(blocks_.size()) - 1;
+        }
+        blocks_[best].in_use = true;
+        return blocks_[best].data.get();
+    }
+
+    // int64 张量与 float 共用内存池，按字节数折算
+    int64_t* AcquireInts(size_t count) {
+        return reinterpret_cast<int64_t*>(Acquire(count * (sizeof(int64_t) / sizeof(float))));
+    }
+
+    void Release(const void* p) {
+        for (auto& b : blocks_) {
+            if (b.data.get() == p) {
+                b.in_use = false;
+                return;
+            }
+        }
+    }
+
+    void ReleaseAll() {
+        for (auto& b : blocks_) b.in_use = false;
+    }
+
+    size_t Bytes() const {
+        size_t bytes = 0;
+        for (const auto& b : blocks_) bytes += b.capacity * sizeof(float);
+        return bytes;
+    }
+
+private:
+    struct AlignedFree {
+        void operator()(float* p) const { std::free(p); }
+    };
+    struct Block {
+        std::unique_ptr<float, AlignedFree> data;
+        size_t capacity = 0;
+        bool in_use = false;
+    };
+    std::vector<Block> blocks_;
+};
+
+// ==================== 张量 ====================
+
+// 支持的最大秩
+const size_t kMaxRank = 8;
+
+// 定长的小数组：形状、步长、轴等元数据放在栈上或 Value 内，推理时不申请内存。超出容量时抛出异常
+template <typename T, size_t N>
+class SmallVector {
+public:
+    SmallVector() = default;
+    SmallVector(size_t n, T value) { assign(n, value); }
+    SmallVector(std::initializer_list<T> list) { assign(list.begin(), list.end()); }
+    SmallVector(const std::vector<T>& v) { assign(v.begin(), v.end()); }
+    template <typename It>
+    SmallVector(It first, It last) { assign(first, last); }
+
+    template <typename It>
+    void assign(It first, It last) {
+        size_ = 0;
+        for (; first != last; ++first) push_back(static_cast<T>(*first));
+    }
+    void assign(size_t n, T value) {
+        size_ = 0;
+        resize(n, value);
+    }
+    void resize(size_t n, T value = T()) {
+        Reserve(n);
+        for (size_t k = size_; k < n; k++) data_[k] = value;
+        size_ = n;
+    }
+    void push_back(T value) {
+        Reserve(size_ + 1);
+        data_[size_++] = value;
+    }
+    void insert(T* pos, T value) {
+        size_t at = static_cast<size_t>(pos - data_);
+        Reserve(size_ + 1);
+        for (size_t k = size_; k > at; k--) data_[k] = data_[k - 1];
+        data_[at] = value;
+        size_++;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    T& operator[](size_t k) { return data_[k]; }
+    const T& operator[](size_t k) const { return data_[k]; }
+    const T& at(size_t k) const {
+        if (k >= size_) throw std::out_of_range("维度下标越界: " + std::to_string(k));
+        return data_[k];
+    }
+    T& back() { return data_[size_ - 1]; }
+
+private:
+    void Reserve(size_t n) const {
+        if (n > N) throw std::runtime_error("元素数超过上限 " + std::to_string(N) + "（张量秩过大）");
+    }
+
+    T data_[N] = {};
+    size_t size_ = 0;
+};
+
+using Dims = SmallVector<int64_t, kMaxRank>;
+using Strides = SmallVector<size_t, kMaxRank>;
+
+// float 和 int64 张量的数据都在内存池、初始化器或调用方的输入缓冲中（int32/bool 输入转换到内存池）
+struct Value {
+    int type = kFloat;
+    Dims shape;
+    const float* f = nullptr;       // float 初始化器或输入
+    const int64_t* i = nullptr;     // int64 初始化器
+    float* pooled = nullptr;        // 内存池中的数据，int64 张量按 int64_t 读写
+    bool is_constant = false;
+    bool is_input = false;
+
+    size_t Count() const {
+        size_t n = 1;
+        for (auto d : shape) n *= static_cast<size_t>(d);
+        return n;
+    }
+    const float* F() const { return pooled ? pooled : f; }
+    const int64_t* I() const { return pooled ? reinterpret_cast<const int64_t*>(pooled) : i; }
+    bool HasData() const { return type == kFloat ? F() != nullptr : I() != nullptr; }
+};
+
+template <typename Shape>
+size_t ShapeCount(const Shape& shape) {
+    size_t n = 1;
+    for (auto d : shape) n *= static_cast<size_t>(d);
+    return n;
+}
+
+// shape[begin, end) 的元素数
+size_t ShapeCount(const Dims& shape, size_t begin, size_t end) {
+    size_t n = 1;
+    for (size_t d = begin; d < end; d++) n *= static_cast<size_t>(shape[d]);
+    return n;
+}
+
+template <typename Shape>
+std::string ShapeString(const Shape& shape) {
+    std::string s = "[";
+    for (size_t i = 0; i < shape.size(); i++) {
+        s += std::to_string(shape[i]);
+        if (i + 1 < shape.size()) s += ", ";
+    }
+    return s + "]";
+}
+
+int64_t NormalizeAxis(int64_t axis, size_t rank) {
+    if (axis < 0) axis += static_cast<int64_t>(rank);
+    if (axis < 0 || axis >= static_cast<int64_t>(rank)) {
+        throw std::runtime_error("轴超出范围: " + std::to_string(axis));
+    }
+    return axis;
+}
+
+Dims BroadcastShape(const Dims& a, const Dims& b) {
+    size_t rank = std::max(a.size(), b.size());
+    Dims out(rank, 1);
+    for (const Dims* s : {&a, &b}) {
+        size_t offset = rank - s->size();
+        for (size_t d = 0; d < s->size(); d++) {
+            int64_t& o = out[offset + d];
+            int64_t v = (*s)[d];
+            if (v == o || v == 1) continue;
+            if (o == 1) {
+                o = v;
+            } else {
+                throw std::runtime_error("形状无法广播: " + ShapeString(*s));
+            }
+        }
+    }
+    return out;
+}
+
+// 输入在输出坐标系下的步长，广播的维度步长为0
+Strides BroadcastStrides(const Dims& in, const Dims& out) {
+    Strides strides(out.size(), 0);
+    size_t offset = out.size() - in.size();
+    size_t stride = 1;
+    for (size_t d = in.size(); d-- > 0;) {
+        strides[offset + d] = in[d] == 1 ? 0 : stride;
+        stride *= static_cast<size_t>(in[d]);
+    }
+    return strides;
+}
+
+// 按输出的最内层维度遍历广播：fn(输出偏移, 各输入偏移, 内层长度, 各输入内层步长)
+template <size_t N, typename Fn>
+void ForEachBroadcast(const Dims& out_shape, const Strides (&strides)[N], Fn fn) {
+    size_t rank = out_shape.size();
+    size_t offs[N] = {0}, inner_strides[N] = {0};
+    if (rank == 0) {
+        fn(0, offs, 1, inner_strides);
+        return;
+    }
+
+    size_t inner = static_cast<size_t>(out_shape[rank - 1]);
+    for (size_t k = 0; k < N; k++) inner_strides[k] = strides[k][rank - 1];
+    size_t total = ShapeCount(out_shape);
+    if (total == 0) return;
+
+    int64_t idx[kMaxRank] = {0};
+    for (size_t out_off = 0; out_off < total; out_off += inner) {
+        fn(out_off, offs, inner, inner_strides);
+        // 外层下标进位，同时更新各输入偏移
+        for (size_t d = rank - 1; d-- > 0;) {
+            idx[d]++;
+            for (size_t k = 0; k < N; k++) offs[k] += strides[k][d];
+            if (idx[d] < out_shape[d]) break;
+            for (size_t k = 0; k < N; k++) offs[k] -= strides[k][d] * static_cast<size_t>(idx[d]);
+            idx[d] = 0;
+        }
+    }
+}
+
+// 行主序张量各维的步长
+Dims RowMajorStrides(const Dims& shape) {
+    Dims strides(shape.size(), 1);
+    for (size_t d = shape.size(); d-- > 1;) strides[d - 1] = strides[d] * shape[d];
+    return strides;
+}
+
+// ==================== 算子 ====================
+
+enum class Op {
+    Conv, ConvTranspose, FusedConv, FusedConvTranspose,
+    MatMul, Gemm, Softmax, LayerNormalization,
+    Add, Sub, Mul, Div, Pow, Max, Min, Mod,
+    Equal, Less, Greater, LessOrEqual, GreaterOrEqual, Not, And, Or, Where,
+    Relu, LeakyRelu, Tanh, Sigmoid, Exp, Log, Neg, Abs, Sqrt, Softplus, Erf, Clip, Identity,
+    Ceil, Floor, Round, Reciprocal, Sign,
+    ReduceSum, ReduceMean, ReduceMax, ReduceMin, CumSum,
+    RandomNormalLike, RandomUniformLike,
+    Shape, Size, Gather, GatherElements, Unsqueeze, Squeeze, Concat, Reshape, ConstantOfShape,
+    Cast, Expand, Tile, Pad, Slice, Split, Transpose, Range,
+};
+
+const std::map<std::string, Op>& OpTable() {
+    static const std::map<std::string, Op> table = {
+        {"Conv", Op::Conv}, {"ConvTranspose", Op::ConvTranspose},
+        {"LeakyReluConv", Op::FusedConv}, {"LeakyReluConvTranspose", Op::FusedConvTranspose},
+        {"MatMul", Op::MatMul}, {"Gemm", Op::Gemm}, {"Softmax", Op::Softmax},
+        {"LayerNormalization", Op::LayerNormalization},
+        {"Add", Op::Add}, {"Sub", Op::Sub}, {"Mul", Op::Mul}, {"Div", Op::Div}, {"Pow", Op::Pow},
+        {"Max", Op::Max}, {"Min", Op::Min}, {"Mod", Op::Mod},
+        {"Equal", Op::Equal}, {"Less", Op::Less}, {"Greater", Op::Greater},
+        {"LessOrEqual", Op::LessOrEqual}, {"GreaterOrEqual", Op::GreaterOrEqual},
+        {"Not", Op::Not}, {"And", Op::And}, {"Or", Op::Or}, {"Where", Op::Where},
+        {"Relu", Op::Relu}, {"LeakyRelu", Op::LeakyRelu}, {"Tanh", Op::Tanh}, {"Sigmoid", Op::Sigmoid},
+        {"Exp", Op::Exp}, {"Log", Op::Log}, {"Neg", Op::Neg}, {"Abs", Op::Abs}, {"Sqrt", Op::Sqrt},
+        {"Softplus", Op::Softplus}, {"Erf", Op::Erf}, {"Clip", Op::Clip},
+        {"Identity", Op::Identity}, {"Dropout", Op::Identity},
+        {"Ceil", Op::Ceil}, {"Floor", Op::Floor}, {"Round", Op::Round},
+        {"Reciprocal", Op::Reciprocal}, {"Sign", Op::Sign},
+        {"ReduceSum", Op::ReduceSum}, {"ReduceMean", Op::ReduceMean},
+        {"ReduceMax", Op::ReduceMax}, {"ReduceMin", Op::ReduceMin}, {"CumSum", Op::CumSum},
+        {"RandomNormalLike", Op::RandomNormalLike}, {"RandomUniformLike", Op::RandomUniformLike},
+        {"Shape", Op::Shape}, {"Size", Op::Size}, {"Gather", Op::Gather},
+        {"GatherElements", Op::GatherElements}, {"Unsqueeze", Op::Unsqueeze},
+        {"Squeeze", Op::Squeeze}, {"Concat", Op::Concat}, {"Reshape", Op::Reshape},
+        {"ConstantOfShape", Op::ConstantOfShape}, {"Cast", Op::Cast}, {"Expand", Op::Expand},
+        {"Tile", Op::Tile}, {"Pad", Op::Pad}, {"Slice", Op::Slice}, {"Split", Op::Split},
+        {"Transpose", Op::Transpose}, {"Range", Op::Range},
+    };
+    return table;
+}
+
+// 编译后的节点：属性在加载时解析好，推理时不再查找字符串
+struct Step {
+    Op op;
+    std::string name;
+    std::vector<int> in;        // 缺省的可选输入为-1
+    std::vector<int> out;
+    std::vector<int> release;   // 本节点之后不再使用的值
+
+    float alpha = 0.0f;
+    float beta = 0.0f;
+    int64_t axis = 0;
+    int64_t group = 1;
+    int64_t stride = 1;         // 卷积的空洞率 / 转置卷积的步长
+    int64_t output_padding = 0;
+    int64_t to_type = kFloat;
+    bool keep_dims = true;      // Reduce*
+    bool flag = false;          // CumSum exclusive / Gemm transA / Mod fmod
+    bool flag2 = false;         // CumSum reverse / Gemm transB
+    bool post_relu = false;     // 卷积后接的Relu已融合
+    int mode = 0;               // Pad: 0 constant, 1 reflect, 2 edge
+    bool has_ints = false;      // ints来自属性（旧版opset）
+    std::vector<int64_t> ints;  // pads / perm / axes / split
+    std::shared_ptr<onnx_proto::Tensor> tensor;  // ConstantOfShape 的值
+};
+
+// ==================== 共享模型 ====================
+
+// 解析后的模型（含权重），同一模型文件的多个引擎共用一份，常量直接指向其中的数据
+struct SharedModel {
+    onnx_proto::Model model;
+    size_t weight_bytes = 0;
+};
+
+struct SharedModelCache {
+    std::mutex mutex;
+    std::map<std::string, std::weak_ptr<const SharedModel>> models;
+};
+
+SharedModelCache& ModelCache() {
+    static SharedModelCache cache;
+    return cache;
+}
+
+size_t TensorBytes(const onnx_proto::Tensor& t) {
+    return t.float_data.size() * sizeof(float) + t.int64_data.size() * sizeof(int64_t);
+}
+
+std::shared_ptr<const SharedModel> AcquireSharedModel(const std::string& model_file) {
+    SharedModelCache& cache = ModelCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.models.find(model_file);
+        if (it != cache.models.end()) {
+            if (auto model = it->second.lock()) return model;
+        }
+    }
+
+    // 在锁外解析，其他模型照常加载
+    auto loaded = std::make_shared<SharedModel>();
+    loaded->model = onnx_proto::LoadModel(model_file);
+    for (const auto& init : loaded->model.initializers) loaded->weight_bytes += TensorBytes(init);
+    for (const auto& node : loaded->model.nodes) {
+        const onnx_proto::Attribute* a = node.op_type == "Constant" ? node.Find("value") : nullptr;
+        if (a && a->t) loaded->weight_bytes += TensorBytes(*a->t);
+    }
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    std::weak_ptr<const SharedModel>& slot = cache.models[model_file];
+    // 并发加载同一文件时用先完成的一份
+    if (auto existing = slot.lock()) return existing;
+    slot = loaded;
+    return loaded;
+}
+
+} // namespace
+
+std::vector<NativeSharedModel> NativeSharedModels() {
+    SharedModelCache& cache = ModelCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    std::vector<NativeSharedModel> models;
+    for (auto it = cache.models.begin(); it != cache.models.end();) {
+        auto model = it->second.lock();
+        if (!model) {
+            it = cache.models.erase(it);
+            continue;
+        }
+        NativeSharedModel info;
+        info.model_file = it->first;
+        info.engines = static_cast<size_t>(it->second.use_count()) - 1;   // 不计这里临时持有的一份
+        info.weight_bytes = model->weight_bytes;
+        models.push_back(std::move(info));
+        ++it;
+    }
+    return models;
+}
+
+// ==================== 引擎实现 ====================
+
+class NativeEngineImpl {
+public:
+    void Load(const std::string& model_file) {
+        shared_model_ = AcquireSharedModel(model_file);
+        const onnx_proto::Model& model = shared_model_->model;
+        for (const auto& kv : model.opsets) {
+            if (kv.first.empty() || kv.first == "ai.onnx") opset_ = kv.second;
+        }
+
+        auto value_id = [this](const std::string& name) {
+            auto it = ids_.find(name);
+            if (it != ids_.end()) return it->second;
+            int id = static_cast<int>(values_.size());
+            ids_[name] = id;
+            values_.emplace_back();
+            return id;
+        };
+
+        // 初始化器
+        for (const auto& init : model.initializers) {
+            Value& v = values_[value_id(init.name)];
+            SetConstant(v, init);
+        }
+
+        // 输入
+        for (const auto& in : model.inputs) {
+            if (in.elem_type != kFloat && in.elem_type != onnx_proto::kInt32 &&
+                in.elem_type != kInt64 && in.elem_type != onnx_proto::kBool) {
+                throw std::runtime_error("原生引擎不支持的输入类型: " + in.name);
+            }
+            int id = value_id(in.name);
+            values_[id].is_input = true;
+            input_ids_.push_back(id);
+            input_names_.push_back(in.name);
+            input_shapes_.push_back(in.dims);
+            input_run_shapes_.push_back(in.dims);
+            input_data_.push_back(nullptr);
+            input_types_.push_back(in.elem_type);
+        }
+
+        // 节点
+        for (const auto& node : model.nodes) {
+            if (node.op_type == "Constant") {
+                const onnx_proto::Attribute* a = node.Find("value");
+                if (!a || !a->t) {
+                    throw std::runtime_error("不支持的Constant节点: " + node.name);
+                }
+                SetConstant(values_[value_id(node.outputs[0])], *a->t);
+                continue;
+            }
+            if (!node.domain.empty() && node.domain != "ai.onnx" && node.domain != "melotts.ops") {
+                throw std::runtime_error("不支持的算子域: " + node.domain + " (" + node.op_type + ")");
+            }
+            auto it = OpTable().find(node.op_type);
+            if (it == OpTable().end()) {
+                throw std::runtime_error("不支持的算子: " + node.op_type + " (" + node.name + ")");
+            }
+
+            Step step;
+            step.op = it->second;
+            step.name = node.name.empty() ? node.op_type : node.name;
+            for (const auto& name : node.inputs) {
+                step.in.push_back(name.empty() ? -1 : value_id(name));
+            }
+            for (const auto& name : node.outputs) {
+                step.out.push_back(name.empty() ? -1 : value_id(name));
+            }
+            ParseAttributes(node, step);
+            steps_.push_back(std::move(step));
+        }
+
+        for (const auto& out : model.outputs) {
+            auto it = ids_.find(out.name);
+            if (it == ids_.end()) {
+                throw std::runtime_error("找不到模型输出: " + out.name);
+            }
+            output_ids_.push_back(it->second);
+            output_names_.push_back(out.name);
+            output_types_.push_back(out.elem_type);
+            output_shapes_.emplace_back();
+        }
+
+        FuseSteps();
+        PlanLifetimes();
+    }
+
+    // 节点融合：
+    //   MatMul -> Mul/Div(常量标量)   缩放并入矩阵乘输出
+    //   Conv/ConvTranspose/MatMul/Gemm -> Relu   激活在输出写回时完成（前馈层的卷积+ReLU）
+    // 只在中间结果只有这一个使用者且不是模型输出时融合
+    void FuseSteps() {
+        std::vector<std::vector<int>> consumers(values_.size());
+        for (size_t s = 0; s < steps_.size(); s++) {
+            for (int id : steps_[s].in) {
+                if (id >= 0) consumers[id].push_back(static_cast<int>(s));
+            }
+        }
+        std::vector<bool> is_output(values_.size(), false);
+        for (int id : output_ids_) is_output[id] = true;
+
+        std::vector<bool> removed(steps_.size(), false);
+        auto single_consumer = [&](const Step& step) -> int {
+            int id = step.out[0];
+            if (id < 0 || is_output[id] || consumers[id].size() != 1) return -1;
+            return consumers[id][0];
+        };
+        // 把后继节点并入当前节点，当前节点改写后继节点的输出
+        auto absorb = [&](Step& step, int next) {
+            step.out[0] = steps_[next].out[0];
+            removed[next] = true;
+        };
+        auto scalar_constant = [&](int id, float& value) {
+            if (id < 0 || !values_[id].is_constant || values_[id].Count() != 1) return false;
+            const Value& v = values_[id];
+            value = v.type == kFloat ? v.f[0] : static_cast<float>(v.i[0]);
+            return true;
+        };
+
+        for (size_t s = 0; s < steps_.size(); s++) {
+            if (removed[s]) continue;
+            Step& step = steps_[s];
+
+            if (step.op == Op::MatMul) {
+                int next = single_consumer(step);
+                float c = 0.0f;
+                if (next >= 0 && !removed[next]) {
+                    const Step& n = steps_[next];
+                    if (n.op == Op::Mul && n.in.size() == 2) {
+                        int other = n.in[0] == step.out[0] ? n.in[1] : n.in[0];
+                        if (scalar_constant(other, c)) {
+                            step.alpha *= c;
+                            absorb(step, next);
+                        }
+                    } else if (n.op == Op::Div && n.in.size() == 2 && n.in[0] == step.out[0] &&
+                               scalar_constant(n.in[1], c) && c != 0.0f) {
+                        step.alpha /= c;
+                        absorb(step, next);
+                    }
+                }
+            }
+
+            if (step.op == Op::Conv || step.op == Op::ConvTranspose || step.op == Op::FusedConv ||
+                step.op == Op::FusedConvTranspose || step.op == Op::MatMul || step.op == Op::Gemm) {
+                int next = single_consumer(step);
+                if (next >= 0 && !removed[next] && steps_[next].op == Op::Relu) {
+                    step.post_relu = true;
+                    absorb(step, next);
+                }
+            }
+        }
+
+        std::vector<Step> kept;
+        for (size_t s = 0; s < steps_.size(); s++) {
+            if (!removed[s]) kept.push_back(std::move(steps_[s]));
+        }
+        steps_ = std::move(kept);
+    }
+
+    // 每个值在最后一次被使用的节点之后归还内存池
+    void PlanLifetimes() {
+        std::vector<int> last_use(values_.size(), -1);
+        for (size_t s = 0; s < steps_.size(); s++) {
+            for (int id : steps_[s].in) {
+                if (id >= 0) last_use[id] = static_cast<int>(s);
+            }
+            // 没有使用者的输出在产生后立即归还
+            for (int id : steps_[s].out) {
+                if (id >= 0 && last_use[id] < static_cast<int>(s)) last_use[id] = static_cast<int>(s);
+            }
+        }
+        for (int id : output_ids_) last_use[id] = -1;
+        for (size_t id = 0; id < values_.size(); id++) {
+            if (last_use[id] >= 0 && !values_[id].is_constant && !values_[id].is_input) {
+                steps_[last_use[id]].release.push_back(static_cast<int>(id));
+            }
+        }
+    }
+
+    void Run() {
+        pool_.ReleaseAll();
+        for (auto& v : values_) v.pooled = nullptr;
+        for (size_t k = 0; k < input_ids_.size(); k++) {
+            if (!input_data_[k]) {
+                throw std::runtime_error("输入数据未设置: " + std::to_string(k));
+            }
+            for (auto d : input_run_shapes_[k]) {
+                if (d <= 0) {
+                    throw std::runtime_error("输入 #" + std::to_string(k) + " 含动态维度，需通过SetInput指定形状");
+                }
+            }
+            Value& v = values_[input_ids_[k]];
+            v.shape = input_run_shapes_[k];
+            size_t count = v.Count();
+            if (input_types_[k] == kFloat) {
+                v.type = kFloat;
+                v.f = static_cast<const float*>(input_data_[k]);
+                continue;
+            }
+            // 整数输入统一转换为 int64，放在内存池中（输入在整次推理中都不归还）
+            v.type = kInt64;
+            int64_t* dst = pool_.AcquireInts(count);
+            v.pooled = reinterpret_cast<float*>(dst);
+            switch (input_types_[k]) {
+                case onnx_proto::kInt32: {
+                    const int32_t* src = static_cast<const int32_t*>(input_data_[k]);
+                    std::copy(src, src + count, dst);
+                    break;
+                }
+                case onnx_proto::kBool: {
+                    const uint8_t* src = static_cast<const uint8_t*>(input_data_[k]);
+                    std::copy(src, src + count, dst);
+                    break;
+                }
+                default: {
+                    const int64_t* src = static_cast<const int64_t*>(input_data_[k]);
+                    std::copy(src, src + count, dst);
+                    break;
+                }
+            }
+        }
+
+        for (auto& step : steps_) {
+            try {
+                Execute(step);
+            } catch (const std::exception& e) {
+                throw std::runtime_error("节点 " + step.name + " 执行失败: " + e.what());
+            }
+            for (int id : step.release) {
+                Value& v = values_[id];
+                if (v.pooled) {
+                    pool_.Release(v.pooled);
+                    v.pooled = nullptr;
+                }
+            }
+        }
+        // GetOutputShape 返回 vector，复用已有容量
+        for (size_t k = 0; k < output_ids_.size(); k++) {
+            const Dims& shape = values_[output_ids_[k]].shape;
+            output_shapes_[k].assign(shape.begin(), shape.end());
+        }
+    }
+
+    // ---------- 对外接口用到的数据 ----------
+    std::vector<std::string> input_names_, output_names_;
+    std::vector<std::vector<int64_t>> input_shapes_, input_run_shapes_, output_shapes_;
+    std::vector<const void*> input_data_;
+    std::vector<int> input_types_, output_types_;
+    std::vector<int> input_ids_, output_ids_;
+    std::vector<Value> values_;
+    std::shared_ptr<const SharedModel> shared_model_;
+    ActivationPool pool_;
+
+private:
+    void SetConstant(Value& v, const onnx_proto::Tensor& t) {
+        v.is_constant = true;
+        v.shape = t.dims;
+        if (t.data_type == kFloat) {
+            v.type = kFloat;
+            if (t.float_data.size() != t.ElementCount()) {
+                throw std::runtime_error("初始化器数据不完整: " + t.name);
+            }
+            // 指向共享模型中的数据，引擎持有模型的引用
+            v.f = t.float_data.data();
+        } else if (t.data_type == onnx_proto::kInt64 || t.data_type == onnx_proto::kInt32 ||
+                   t.data_type == onnx_proto::kBool) {
+            v.type = kInt64;
+            v.i = t.int64_data.data();
+        } else {
+            throw std::runtime_error("不支持的初始化器类型: " + t.name);
+        }
+    }
+
+    void ParseAttributes(const onnx_proto::Node& node, Step& step) {
+        switch (step.op) {
+            case Op::Conv:
+            case Op::ConvTranspose: {
+                if (node.GetString("auto_pad", "NOTSET") != "NOTSET") {
+                    throw std::runtime_error("原生引擎不支持auto_pad: " + node.name);
+                }
+                std::vector<int64_t> pads = node.GetInts("pads", {0, 0});
+                std::vector<int64_t> strides = node.GetInts("strides", {1});
+                std::vector<int64_t> dilations = node.GetInts("dilations", {1});
+                if (pads.size() != 2 || strides.size() != 1 || dilations.size() != 1) {
+                    throw std::runtime_error("原生引擎只支持一维卷积: " + node.name);
+                }
+                step.ints = pads;
+                step.group = node.GetInt("group", 1);
+                step.alpha = 1.0f;
+                if (step.op == Op::Conv) {
+                    if (strides[0] != 1) throw std::runtime_error("原生引擎不支持步长大于1的卷积: " + node.name);
+                    step.stride = dilations[0];
+                } else {
+                    if (dilations[0] != 1 || step.group != 1 || node.Find("output_shape")) {
+                        throw std::runtime_error("原生引擎不支持该转置卷积: " + node.name);
+                    }
+                    step.stride = strides[0];
+                    std::vector<int64_t> op = node.GetInts("output_padding", {0});
+                    step.output_padding = op.empty() ? 0 : op[0];
+                }
+                break;
+            }
+            case Op::FusedConv:
+                step.alpha = node.GetFloat("alpha", 0.01f);
+                step.stride = node.GetInt("dilation", 1);
+                step.ints = node.GetInts("pads", {0, 0});
+                break;
+            case Op::FusedConvTranspose:
+                step.alpha = node.GetFloat("alpha", 0.01f);
+                step.stride = node.GetInt("stride", 1);
+                step.ints = node.GetInts("pads", {0, 0});
+                step.output_padding = node.GetInt("output_padding", 0);
+                break;
+            case Op::MatMul:
+                step.alpha = 1.0f;
+                break;
+            case Op::Gemm:
+                step.alpha = node.GetFloat("alpha", 1.0f);
+                step.beta = node.GetFloat("beta", 1.0f);
+                step.flag = node.GetInt("transA", 0) != 0;
+                step.flag2 = node.GetInt("transB", 0) != 0;
+                break;
+            case Op::Softmax:
+                // opset 13 之前按axis把输入展平成二维后计算
+                step.axis = node.GetInt("axis", opset_ < 13 ? 1 : -1);
+                step.flag = opset_ < 13;
+                break;
+            case Op::LayerNormalization:
+                step.axis = node.GetInt("axis", -1);
+                step.alpha = node.GetFloat("epsilon", 1e-5f);
+                for (size_t k = 1; k < node.outputs.size(); k++) {
+                    if (!node.outputs[k].empty()) {
+                        throw std::runtime_error("原生引擎不支持LayerNormalization的统计量输出: " + node.name);
+                    }
+                }
+                break;
+            case Op::ReduceSum:
+            case Op::ReduceMean:
+            case Op::ReduceMax:
+            case Op::ReduceMin:
+                step.keep_dims = node.GetInt("keepdims", 1) != 0;
+                step.flag = node.GetInt("noop_with_empty_axes", 0) != 0;
+                step.has_ints = node.Find("axes") != nullptr;
+                step.ints = node.GetInts("axes");
+                break;
+            case Op::CumSum:
+                step.flag = node.GetInt("exclusive", 0) != 0;
+                step.flag2 = node.GetInt("reverse", 0) != 0;
+                break;
+            case Op::Mod:
+                step.flag = node.GetInt("fmod", 0) != 0;
+                break;
+            case Op::RandomNormalLike:
+                step.alpha = node.GetFloat("mean", 0.0f);
+                step.beta = node.GetFloat("scale", 1.0f);
+                break;
+            case Op::RandomUniformLike:
+                step.alpha = node.GetFloat("low", 0.0f);
+                step.beta = node.GetFloat("high", 1.0f);
+                break;
+            case Op::Pad: {
+                std::string mode = node.GetString("mode", "constant");
+                if (mode == "constant") {
+                    step.mode = 0;
+                } else if (mode == "reflect") {
+                    step.mode = 1;
+                } else if (mode == "edge") {
+                    step.mode = 2;
+                } else {
+                    throw std::runtime_error("原生引擎不支持的Pad模式: " + mode);
+                }
+                // opset 11 之前以属性给出 pads 和填充值
+                step.has_ints = node.Find("pads") != nullptr;
+                step.ints = node.GetInts("pads");
+                step.alpha = node.GetFloat("value", 0.0f);
+                break;
+            }
+            case Op::GatherElements:
+                step.axis = node.GetInt("axis", 0);
+                break;
+            case Op::LeakyRelu:
+                step.alpha = node.GetFloat("alpha", 0.01f);
+                break;
+            case Op::Clip:
+                // opset 6 以属性给出上下限
+                step.alpha = node.GetFloat("min", -std::numeric_limits<float>::infinity());
+                step.beta = node.GetFloat("max", std::numeric_limits<float>::infinity());
+                break;
+            case Op::Gather:
+            case Op::Concat:
+                step.axis = node.GetInt("axis", 0);
+                break;
+            case Op::Split:
+                step.axis = node.GetInt("axis", 0);
+                step.has_ints = node.Find("split") != nullptr;
+                step.ints = node.GetInts("split");
+                break;
+            case Op::Unsqueeze:
+            case Op::Squeeze:
+                step.has_ints = node.Find("axes") != nullptr;
+                step.ints = node.GetInts("axes");
+                break;
+            case Op::Slice:
+                // opset 1-9 以属性给出 starts/ends/axes
+                if (node.Find("starts")) {
+                    step.has_ints = true;
+                    std::vector<int64_t> starts = node.GetInts("starts");
+                    std::vector<int64_t> ends = node.GetInts("ends");
+                    std::vector<int64_t> axes = node.GetInts("axes");
+                    if (axes.empty()) {
+                        axes.resize(starts.size());
+                        std::iota(axes.begin(), axes.end(), 0);
+                    }
+                    step.ints = starts;
+                    step.ints.insert(step.ints.end(), ends.begin(), ends.end());
+                    step.ints.insert(step.ints.end(), axes.begin(), axes.end());
+                }
+                break;
+            case Op::Transpose:
+                step.has_ints = node.Find("perm") != nullptr;
+                step.ints = node.GetInts("perm");
+                break;
+            case Op::Cast:
+                step.to_type = node.GetInt("to", kFloat);
+                if (step.to_type != kFloat && step.to_type != onnx_proto::kInt64 &&
+                    step.to_type != onnx_proto::kInt32 && step.to_type != onnx_proto::kBool) {
+                    throw std::runtime_error("原生引擎不支持的Cast类型: " + std::to_string(step.to_type));
+                }
+                break;
+            case Op::ConstantOfShape: {
+                const onnx_proto::Attribute* a = node.Find("value");
+                if (a && a->t) step.tensor = a->t;
+                break;
+            }
+            case Op::Shape:
+                step.axis = node.GetInt("start", 0);
+                step.group = node.Find("end") ? node.GetInt("end", 0) : std::numeric_limits<int64_t>::max();
+                break;
+            default:
+                break;
+        }
+    }
+
+    // ---------- 张量工具 ----------
+    const Value& In(const Step& s, size_t k) const {
+        if (k >= s.in.size() || s.in[k] < 0) {
+            throw std::runtime_error("缺少输入 #" + std::to_string(k));
+        }
+        const Value& v = values_[s.in[k]];
+        if (!v.HasData() && v.Count() > 0) {
+            throw std::runtime_error("输入 #" + std::to_string(k) + " 尚未计算");
+        }
+        return v;
+    }
+    bool HasIn(const Step& s, size_t k) const { return k < s.in.size() && s.in[k] >= 0; }
+
+    // 分配float输出
+    float* OutF(const Step& s, size_t k, const Dims& shape) {
+        Value& v = values_[s.out[k]];
+        if (v.pooled) pool_.Release(v.pooled);
+        v.type = kFloat;
+        v.shape = shape;
+        v.pooled = pool_.Acquire(ShapeCount(shape));
+        v.f = nullptr;
+        return v.pooled;
+    }
+
+    // 分配int64输出，同样来自内存池
+    int64_t* OutI(const Step& s, size_t k, const Dims& shape) {
+        Value& v = values_[s.out[k]];
+        if (v.pooled) pool_.Release(v.pooled);
+        v.type = kInt64;
+        v.shape = shape;
+        int64_t* data = pool_.AcquireInts(ShapeCount(shape));
+        v.pooled = reinterpret_cast<float*>(data);
+        v.f = nullptr;
+        v.i = nullptr;
+        return data;
+    }
+
+    // 第k个元素按int64读取（float张量截断取整）
+    static int64_t IntAt(const Value& v, size_t k) {
+        return v.type == kInt64 ? v.I()[k] : static_cast<int64_t>(v.F()[k]);
+    }
+
+    // 形状、轴、pads等小的整数输入复制到定长数组
+    template <size_t N = kMaxRank>
+    static SmallVector<int64_t, N> Ints(const Value& v) {
+        size_t n = v.Count();
+        SmallVector<int64_t, N> r(n, 0);
+        for (size_t k = 0; k < n; k++) r[k] = IntAt(v, k);
+        return r;
+    }
+
+    static double Scalar(const Value& v) {
+        if (v.Count() != 1) throw std::runtime_error("需要标量输入");
+        return v.type == kInt64 ? static_cast<double>(v.I()[0]) : static_cast<double>(v.F()[0]);
+    }
+
+    // 推理中临时使用的内存池缓冲（索引表、行偏移等），离开作用域时归还
+    class PoolScratch {
+    public:
+        PoolScratch(ActivationPool& pool, size_t count) : pool_(pool), data_(pool.AcquireInts(count)) {}
+        ~PoolScratch() { pool_.Release(data_); }
+        PoolScratch(const PoolScratch&) = delete;
+        PoolScratch& operator=(const PoolScratch&) = delete;
+        int64_t* data() { return data_; }
+
+    private:
+        ActivationPool& pool_;
+        int64_t* data_;
+    };
+
+    // ---------- 执行 ----------
+    void Execute(const Step& s) {
+        switch (s.op) {
+            case Op::Conv:
+            case Op::FusedConv: RunConv(s); break;
+            case Op::ConvTranspose:
+            case Op::FusedConvTranspose: RunConvTranspose(s); break;
+            case Op::Add: RunBinary(s, [](auto a, auto b) { return a + b; }); break;
+            case Op::Sub: RunBinary(s, [](auto a, auto b) { return a - b; }); break;
+            case Op::Mul: RunBinary(s, [](auto a, auto b) { return a * b; }); break;
+            case Op::Div: RunBinary(s, [](auto a, auto b) { return a / b; }); break;
+            case Op::Pow: RunBinary(s, [](auto a, auto b) { return std::pow(a, b); }); break;
+            case Op::Max:
+            case Op::Min: RunMinMax(s); break;
+            case Op::Mod:
+                if (s.flag) {
+                    RunBinary(s, [](auto a, auto b) { return std::fmod(a, b); });
+                } else {
+                    // 整数取模，结果符号与除数一致
+                    RunBinary(s, [](auto a, auto b) {
+                        auto r = std::fmod(a, b);
+                        return (r != 0 && ((r < 0) != (b < 0))) ? r + b : r;
+                    });
+                }
+                break;
+            case Op::And: RunCompare(s, [](double a, double b) { return a != 0 && b != 0; }); break;
+            case Op::Or: RunCompare(s, [](double a, double b) { return a != 0 || b != 0; }); break;
+            case Op::MatMul: RunMatMul(s); break;
+            case Op::Gemm: RunGemm(s); break;
+            case Op::Softmax: RunSoftmax(s); break;
+            case Op::LayerNormalization: RunLayerNorm(s); break;
+            case Op::ReduceSum:
+            case Op::ReduceMean:
+            case Op::ReduceMax:
+            case Op::ReduceMin: RunReduce(s); break;
+            case Op::CumSum: RunCumSum(s); break;
+            case Op::RandomNormalLike:
+            case Op::RandomUniformLike: RunRandom(s); break;
+            case Op::Ceil: RunUnary(s, [](float v) { return std::ceil(v); }); break;
+            case Op::Floor: RunUnary(s, [](float v) { return std::floor(v); }); break;
+            case Op::Round: RunUnary(s, [](float v) { return std::nearbyint(v); }); break;
+            case Op::Reciprocal: RunUnary(s, [](float v) { return 1.0f / v; }); break;
+            case Op::Sign: RunUnary(s, [](float v) { return static_cast<float>((v > 0.0f) - (v < 0.0f)); }); break;
+            case Op::Size: OutI(s, 0, {})[0] = static_cast<int64_t>(In(s, 0).Count()); break;
+            case Op::GatherElements: RunGatherElements(s); break;
+            case Op::Tile: RunTile(s); break;
+            case Op::Pad: RunPad(s); break;
+            case Op::Equal: RunCompare(s, [](double a, double b) { return a == b; }); break;
+            case Op::Less: RunCompare(s, [](double a, double b) { return a < b; }); break;
+            case Op::Greater: RunCompare(s, [](double a, double b) { return a > b; }); break;
+            case Op::LessOrEqual: RunCompare(s, [](double a, double b) { return a <= b; }); break;
+            case Op::GreaterOrEqual: RunCompare(s, [](double a, double b) { return a >= b; }); break;
+            case Op::Not: {
+                const Value& x = In(s, 0);
+                size_t n = x.Count();
+                int64_t* y = OutI(s, 0, x.shape);
+                for (size_t k = 0; k < n; k++) y[k] = IntAt(x, k) == 0;
+                break;
+            }
+            case Op::Where: RunWhere(s); break;
+            case Op::Relu: RunUnary(s, [](float v) { return v > 0.0f ? v : 0.0f; }); break;
+            case Op::LeakyRelu: {
+                const Value& x = In(s, 0);
+                float* y = OutF(s, 0, x.shape);
+                kernels::LeakyRelu(y, x.F(), s.alpha, static_cast<int>(x.Count()));
+                break;
+            }
+            case Op::Tanh: RunVector(s, kernels::Tanh); break;
+            case Op::Sigmoid: RunVector(s, kernels::Sigmoid); break;
+            case Op::Exp: RunVector(s, kernels::Exp); break;
+            case Op::Log: RunUnary(s, [](float v) { return std::log(v); }); break;
+            case Op::Abs: RunUnary(s, [](float v) { return std::fabs(v); }); break;
+            case Op::Sqrt: RunUnary(s, [](float v) { return std::sqrt(v); }); break;
+            case Op::Erf: RunUnary(s, [](float v) { return std::erf(v); }); break;
+            case Op::Softplus: RunUnary(s, [](float v) { return v > 20.0f ? v : std::log1p(std::exp(v)); }); break;
+            case Op::Neg:
+                if (In(s, 0).type == kInt64) {
+                    const Value& x = In(s, 0);
+                    size_t n = x.Count();
+                    const int64_t* xi = x.I();
+                    int64_t* y = OutI(s, 0, x.shape);
+                    for (size_t k = 0; k < n; k++) y[k] = -xi[k];
+                } else {
+                    RunUnary(s, [](float v) { return -v; });
+                }
+                break;
+            case Op::Clip: {
+                float lo = HasIn(s, 1) ? static_cast<float>(Scalar(In(s, 1))) : s.alpha;
+                float hi = HasIn(s, 2) ? static_cast<float>(Scalar(In(s, 2))) : s.beta;
+                RunUnary(s, [lo, hi](float v) { return std::min(std::max(v, lo), hi); });
+                break;
+            }
+            case Op::Identity: Copy(In(s, 0), s, 0, In(s, 0).shape); break;
+            case Op::Shape: {
+                const Value& x = In(s, 0);
+                int64_t rank = static_cast<int64_t>(x.shape.size());
+                int64_t start = s.axis < 0 ? s.axis + rank : s.axis;
+                int64_t end = s.group < 0 ? s.group + rank : std::min(s.group, rank);
+                start = std::max<int64_t>(0, std::min(start, rank));
+                end = std::max(start, end);
+                int64_t* y = OutI(s, 0, {end - start});
+                std::copy(x.shape.begin() + start, x.shape.begin() + end, y);
+                break;
+            }
+            case Op::Gather: RunGather(s); break;
+            case Op::Unsqueeze: RunUnsqueeze(s); break;
+            case Op::Squeeze: RunSqueeze(s); break;
+            case Op::Concat: RunConcat(s); break;
+            case Op::Reshape: RunReshape(s); break;
+            case Op::ConstantOfShape: RunConstantOfShape(s); break;
+            case Op::Cast: RunCast(s); break;
+            case Op::Expand: {
+                const Value& x = In(s, 0);
+                Dims shape = BroadcastShape(x.shape, Ints(In(s, 1)));
+                BroadcastCopy(x, s, shape);
+                break;
+            }
+            case Op::Slice: RunSlice(s); break;
+            case Op::Split: RunSplit(s); break;
+            case Op::Transpose: RunTranspose(s); break;
+            case Op::Range: RunRange(s); break;
+        }
+    }
+
+    // 复制到新形状（Identity、Reshape、Squeeze等）
+    void Copy(const Value& x, const Step& s, size_t k, const Dims& shape) {
+        if (ShapeCount(shape) != x.Count()) {
+            throw std::runtime_error("元素数量不匹配: " + ShapeString(x.shape) + " -> " + ShapeString(shape));
+        }
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* dst = OutI(s, k, shape);
+            std::memcpy(dst, src, x.Count() * sizeof(int64_t));
+        } else {
+            const float* src = x.F();
+            float* dst = OutF(s, k, shape);
+            std::memcpy(dst, src, x.Count() * sizeof(float));
+        }
+    }
+
+    // 逐元素的SIMD内核
+    void RunVector(const Step& s, void (*kernel)(float*, const float*, int)) {
+        const Value& x = In(s, 0);
+        if (x.type != kFloat) throw std::runtime_error("需要float输入");
+        const float* src = x.F();
+        float* y = OutF(s, 0, x.shape);
+        kernel(y, src, static_cast<int>(x.Count()));
+    }
+
+    template <typename F>
+    void RunUnary(const Step& s, F fn) {
+        const Value& x = In(s, 0);
+        if (x.type != kFloat) throw std::runtime_error("需要float输入");
+        const float* src = x.F();
+        size_t n = x.Count();
+        float* y = OutF(s, 0, x.shape);
+        for (size_t k = 0; k < n; k++) y[k] = fn(src[k]);
+    }
+
+    // 同秩float张量的逐元素运算，输出形状与其中一个输入相同（声码器的残差相加、按通道加偏置等）。
+    // 形状和步长放在栈上，稳态下不申请内存；不满足条件时返回 false，由通用的广播路径处理
+    template <typename F>
+    bool RunBinarySameRank(const Step& s, const Value& a, const Value& b, F fn) {
+        const size_t rank = a.shape.size();
+        if (a.type != kFloat || b.type != kFloat || rank != b.shape.size() || rank == 0 || rank > kMaxRank) {
+            return false;
+        }
+        int64_t out[kMaxRank];
+        bool out_is_a = true, out_is_b = true;
+        for (size_t d = 0; d < rank; d++) {
+            int64_t da = a.shape[d], db = b.shape[d];
+            if (da != db && da != 1 && db != 1) return false;
+            out[d] = da == 1 ? db : da;
+            out_is_a = out_is_a && out[d] == da;
+            out_is_b = out_is_b && out[d] == db;
+        }
+        if (!out_is_a && !out_is_b) return false;
+
+        size_t sa[kMaxRank], sb[kMaxRank], idx[kMaxRank] = {0};
+        size_t stride_a = 1, stride_b = 1;
+        for (size_t d = rank; d-- > 0;) {
+            sa[d] = a.shape[d] == out[d] ? stride_a : 0;
+            sb[d] = b.shape[d] == out[d] ? stride_b : 0;
+            stride_a *= static_cast<size_t>(a.shape[d]);
+            stride_b *= static_cast<size_t>(b.shape[d]);
+        }
+        const float* pa = a.F();
+        const float* pb = b.F();
+        float* y = OutF(s, 0, out_is_a ? a.shape : b.shape);
+        const size_t inner = static_cast<size_t>(out[rank - 1]);
+        const size_t total = out_is_a ? a.Count() : b.Count();
+        if (total == 0) return true;
+        size_t oa = 0, ob = 0;
+        for (size_t o = 0; o < total; o += inner) {
+            const float* xa = pa + oa;
+            const float* xb = pb + ob;
+            float* yo = y + o;
+            if (sa[rank - 1] && sb[rank - 1]) {
+                for (size_t t = 0; t < inner; t++) yo[t] = static_cast<float>(fn(xa[t], xb[t]));
+            } else if (sa[rank - 1]) {
+                float vb = xb[0];
+                for (size_t t = 0; t < inner; t++) yo[t] = static_cast<float>(fn(xa[t], vb));
+            } else if (sb[rank - 1]) {
+                float va = xa[0];
+                for (size_t t = 0; t < inner; t++) yo[t] = static_cast<float>(fn(va, xb[t]));
+            } else {
+                float v = static_cast<float>(fn(xa[0], xb[0]));
+                for (size_t t = 0; t < inner; t++) yo[t] = v;
+            }
+            // 外层下标进位
+            for (size_t d = rank - 1; d-- > 0;) {
+                idx[d]++;
+                oa += sa[d];
+                ob += sb[d];
+                if (idx[d] < static_cast<size_t>(out[d])) break;
+                oa -= sa[d] * idx[d];
+                ob -= sb[d] * idx[d];
+                idx[d] = 0;
+            }
+        }
+        return true;
+    }
+
+    template <typename F>
+    void RunBinary(const Step& s, F fn) {
+        const Value& a = In(s, 0);
+        const Value& b = In(s, 1);
+        if (RunBinarySameRank(s, a, b, fn)) {
+            return;
+        }
+        Dims shape = BroadcastShape(a.shape, b.shape);
+        Strides strides[2] = {BroadcastStrides(a.shape, shape), BroadcastStrides(b.shape, shape)};
+        if (a.type == kInt64 && b.type == kInt64) {
+            const int64_t* ai = a.I();
+            const int64_t* bi = b.I();
+            int64_t* y = OutI(s, 0, shape);
+            ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t n, const size_t* st) {
+                for (size_t t = 0; t < n; t++) {
+                    y[o + t] = static_cast<int64_t>(fn(ai[offs[0] + t * st[0]], bi[offs[1] + t * st[1]]));
+                }
+            });
+            return;
+        }
+        if (a.type != kFloat || b.type != kFloat) throw std::runtime_error("输入类型不一致");
+
+        const float* pa = a.F();
+        const float* pb = b.F();
+        float* y = OutF(s, 0, shape);
+        ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t n, const size_t* st) {
+            const float* xa = pa + offs[0];
+            const float* xb = pb + offs[1];
+            float* yo = y + o;
+            if (st[0] == 1 && st[1] == 1) {
+                for (size_t t = 0; t < n; t++) yo[t] = static_cast<float>(fn(xa[t], xb[t]));
+            } else if (st[0] == 1) {
+                float vb = xb[0];
+                for (size_t t = 0; t < n; t++) yo[t] = static_cast<float>(fn(xa[t], vb));
+            } else if (st[1] == 1) {
+                float va = xa[0];
+                for (size_t t = 0; t < n; t++) yo[t] = static_cast<float>(fn(va, xb[t]));
+            } else {
+                float v = static_cast<float>(fn(xa[0], xb[0]));
+                for (size_t t = 0; t < n; t++) yo[t] = v;
+            }
+        });
+    }
+
+    template <typename F>
+    void RunCompare(const Step& s, F fn) {
+        const Value& a = In(s, 0);
+        const Value& b = In(s, 1);
+        Dims shape = BroadcastShape(a.shape, b.shape);
+        Strides strides[2] = {BroadcastStrides(a.shape, shape), BroadcastStrides(b.shape, shape)};
+        auto get = [](const Value& v, size_t k) {
+            return v.type == kInt64 ? static_cast<double>(v.I()[k]) : static_cast<double>(v.F()[k]);
+        };
+        int64_t* y = OutI(s, 0, shape);
+        ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t n, const size_t* st) {
+            for (size_t t = 0; t < n; t++) {
+                y[o + t] = fn(get(a, offs[0] + t * st[0]), get(b, offs[1] + t * st[1])) ? 1 : 0;
+            }
+        });
+    }
+
+    void RunWhere(const Step& s) {
+        const Value& c = In(s, 0);
+        const Value& a = In(s, 1);
+        const Value& b = In(s, 2);
+        Dims shape = BroadcastShape(BroadcastShape(c.shape, a.shape), b.shape);
+        Strides strides[3] = {BroadcastStrides(c.shape, shape), BroadcastStrides(a.shape, shape),
+                              BroadcastStrides(b.shape, shape)};
+        if (a.type == kInt64 && b.type == kInt64) {
+            const int64_t* ai = a.I();
+            const int64_t* bi = b.I();
+            int64_t* y = OutI(s, 0, shape);
+            ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t n, const size_t* st) {
+                for (size_t t = 0; t < n; t++) {
+                    y[o + t] = IntAt(c, offs[0] + t * st[0]) ? ai[offs[1] + t * st[1]] : bi[offs[2] + t * st[2]];
+                }
+            });
+            return;
+        }
+        const float* pa = a.F();
+        const float* pb = b.F();
+        float* y = OutF(s, 0, shape);
+        ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t n, const size_t* st) {
+            for (size_t t = 0; t < n; t++) {
+                y[o + t] = IntAt(c, offs[0] + t * st[0]) ? pa[offs[1] + t * st[1]] : pb[offs[2] + t * st[2]];
+            }
+        });
+    }
+
+    void RunConv(const Step& s) {
+        const Value& x = In(s, 0);
+        const Value& w = In(s, 1);
+        if (x.shape.size() != 3 || w.shape.size() != 3) {
+            throw std::runtime_error("只支持一维卷积，输入形状 " + ShapeString(x.shape));
+        }
+        int batch = static_cast<int>(x.shape[0]);
+        int in_ch = static_cast<int>(x.shape[1]);
+        int len = static_cast<int>(x.shape[2]);
+        int out_ch = static_cast<int>(w.shape[0]);
+        int kernel = static_cast<int>(w.shape[2]);
+        int group = static_cast<int>(s.group);
+        if (w.shape[1] * group != in_ch) {
+            throw std::runtime_error("卷积权重与输入通道数不匹配");
+        }
+        int pad_l = static_cast<int>(s.ints[0]);
+        int pad_r = static_cast<int>(s.ints[1]);
+        int dilation = static_cast<int>(s.stride);
+        int out_len = kernels::ConvOutputLength(len, kernel, dilation, pad_l, pad_r);
+
+        const float* bias = HasIn(s, 2) ? In(s, 2).F() : nullptr;
+        const Value* res = HasIn(s, 3) ? &In(s, 3) : nullptr;
+        const float* xd = x.F();
+        float* y = OutF(s, 0, {batch, out_ch, out_len});
+        for (int n = 0; n < batch; n++) {
+            kernels::LeakyReluConv1d(xd + static_cast<size_t>(n) * in_ch * len, in_ch, len,
+                                     w.F(), out_ch, kernel, bias, ResidualFor(res, n, out_ch, out_len),
+                                     s.alpha, dilation, pad_l, pad_r,
+                                     y + static_cast<size_t>(n) * out_ch * out_len, work_, group);
+        }
+        PostActivate(s, y, static_cast<size_t>(batch) * out_ch * out_len);
+    }
+
+    void PostActivate(const Step& s, float* y, size_t count) {
+        if (s.post_relu) {
+            kernels::LeakyRelu(y, y, 0.0f, static_cast<int>(count));
+        }
+    }
+
+    void RunConvTranspose(const Step& s) {
+        const Value& x = In(s, 0);
+        const Value& w = In(s, 1);
+        if (x.shape.size() != 3 || w.shape.size() != 3) {
+            throw std::runtime_error("只支持一维转置卷积，输入形状 " + ShapeString(x.shape));
+        }
+        int batch = static_cast<int>(x.shape[0]);
+        int in_ch = static_cast<int>(x.shape[1]);
+        int len = static_cast<int>(x.shape[2]);
+        int out_ch = static_cast<int>(w.shape[1]);
+        int kernel = static_cast<int>(w.shape[2]);
+        if (w.shape[0] != in_ch) {
+            throw std::runtime_error("转置卷积权重与输入通道数不匹配");
+        }
+        int stride = static_cast<int>(s.stride);
+        int pad_l = static_cast<int>(s.ints[0]);
+        int pad_r = static_cast<int>(s.ints[1]);
+        int out_pad = static_cast<int>(s.output_padding);
+        int out_len = kernels::ConvTransposeOutputLength(len, kernel, stride, pad_l, pad_r, out_pad);
+
+        const float* bias = HasIn(s, 2) ? In(s, 2).F() : nullptr;
+        const Value* res = HasIn(s, 3) ? &In(s, 3) : nullptr;
+        const float* xd = x.F();
+        float* y = OutF(s, 0, {batch, out_ch, out_len});
+        for (int n = 0; n < batch; n++) {
+            kernels::LeakyReluConvTranspose1d(xd + static_cast<size_t>(n) * in_ch * len, in_ch, len,
+                                              w.F(), out_ch, kernel, bias,
+                                              ResidualFor(res, n, out_ch, out_len),
+                                              s.alpha, stride, pad_l, pad_r, out_pad,
+                                              y + static_cast<size_t>(n) * out_ch * out_len, work_, phase_);
+        }
+        PostActivate(s, y, static_cast<size_t>(batch) * out_ch * out_len);
+    }
+
+    // 融合算子的残差输入：[N或1, M, T_out或1]
+    static kernels::Residual ResidualFor(const Value* r, int n, int out_ch, int out_len) {
+        kernels::Residual res;
+        if (!r) return res;
+        if (r->shape.size() != 3 || r->shape[1] != out_ch ||
+            (r->shape[2] != out_len && r->shape[2] != 1)) {
+            throw std::runtime_error("残差形状与输出不匹配: " + ShapeString(r->shape));
+        }
+        int time = static_cast<int>(r->shape[2]);
+        int rn = r->shape[0] == 1 ? 0 : n;
+        res.data = r->F() + static_cast<size_t>(rn) * out_ch * time;
+        res.time = time;
+        return res;
+    }
+
+    void RunGather(const Step& s) {
+        const Value& x = In(s, 0);
+        const Value& idx = In(s, 1);
+        size_t axis = static_cast<size_t>(NormalizeAxis(s.axis, x.shape.size()));
+        size_t n_idx = idx.Count();
+        int64_t dim = x.shape[axis];
+
+        Dims shape(x.shape.begin(), x.shape.begin() + axis);
+        for (auto d : idx.shape) shape.push_back(d);
+        for (size_t d = axis + 1; d < x.shape.size(); d++) shape.push_back(x.shape[d]);
+
+        size_t outer = ShapeCount(x.shape, 0, axis);
+        size_t inner = ShapeCount(x.shape, axis + 1, x.shape.size());
+        auto index_at = [&](size_t j) {
+            int64_t v = IntAt(idx, j);
+            if (v < 0) v += dim;
+            if (v < 0 || v >= dim) throw std::runtime_error("Gather索引越界");
+            return static_cast<size_t>(v);
+        };
+
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, 0, shape);
+            for (size_t a = 0; a < outer; a++) {
+                for (size_t j = 0; j < n_idx; j++) {
+                    const int64_t* p = src + (a * dim + index_at(j)) * inner;
+                    y = std::copy(p, p + inner, y);
+                }
+            }
+        } else {
+            const float* src = x.F();
+            float* y = OutF(s, 0, shape);
+            for (size_t a = 0; a < outer; a++) {
+                for (size_t j = 0; j < n_idx; j++) {
+                    std::memcpy(y, src + (a * dim + index_at(j)) * inner, inner * sizeof(float));
+                    y += inner;
+                }
+            }
+        }
+    }
+
+    Dims AxesOf(const Step& s, size_t input_idx) const {
+        if (s.has_ints) return s.ints;
+        if (HasIn(s, input_idx)) return Ints(In(s, input_idx));
+        return {};
+    }
+
+    void RunUnsqueeze(const Step& s) {
+        const Value& x = In(s, 0);
+        Dims axes = AxesOf(s, 1);
+        size_t rank = x.shape.size() + axes.size();
+        if (rank > kMaxRank) throw std::runtime_error("Unsqueeze后的秩超过上限");
+        bool inserted[kMaxRank] = {false};
+        for (auto a : axes) inserted[NormalizeAxis(a, rank)] = true;
+        Dims shape;
+        size_t k = 0;
+        for (size_t d = 0; d < rank; d++) {
+            shape.push_back(inserted[d] ? 1 : x.shape[k++]);
+        }
+        Copy(x, s, 0, shape);
+    }
+
+    void RunSqueeze(const Step& s) {
+        const Value& x = In(s, 0);
+        Dims axes = AxesOf(s, 1);
+        bool removed[kMaxRank] = {false};
+        if (axes.empty()) {
+            for (size_t d = 0; d < x.shape.size(); d++) removed[d] = x.shape[d] == 1;
+        } else {
+            for (auto a : axes) removed[NormalizeAxis(a, x.shape.size())] = true;
+        }
+        Dims shape;
+        for (size_t d = 0; d < x.shape.size(); d++) {
+            if (!removed[d]) shape.push_back(x.shape[d]);
+        }
+        Copy(x, s, 0, shape);
+    }
+
+    void RunConcat(const Step& s) {
+        const Value& first = In(s, 0);
+        size_t axis = static_cast<size_t>(NormalizeAxis(s.axis, first.shape.size()));
+        Dims shape = first.shape;
+        shape[axis] = 0;
+        for (size_t k = 0; k < s.in.size(); k++) {
+            const Value& v = In(s, k);
+            if (v.shape.size() != shape.size() || v.type != first.type) {
+                throw std::runtime_error("Concat输入形状或类型不一致");
+            }
+            shape[axis] += v.shape[axis];
+        }
+        size_t outer = ShapeCount(shape, 0, axis);
+        size_t inner = ShapeCount(shape, axis + 1, shape.size());
+        size_t out_row = static_cast<size_t>(shape[axis]) * inner;
+
+        if (first.type == kInt64) {
+            int64_t* y = OutI(s, 0, shape);
+            size_t offset = 0;
+            for (size_t k = 0; k < s.in.size(); k++) {
+                const Value& v = In(s, k);
+                size_t row = static_cast<size_t>(v.shape[axis]) * inner;
+                const int64_t* src = v.I();
+                for (size_t a = 0; a < outer; a++) {
+                    std::copy(src + a * row, src + (a + 1) * row, y + a * out_row + offset);
+                }
+                offset += row;
+            }
+            return;
+        }
+
+        float* y = OutF(s, 0, shape);
+        size_t offset = 0;
+        for (size_t k = 0; k < s.in.size(); k++) {
+            const Value& v = In(s, k);
+            size_t row = static_cast<size_t>(v.shape[axis]) * inner;
+            const float* src = v.F();
+            for (size_t a = 0; a < outer; a++) {
+                std::memcpy(y + a * out_row + offset, src + a * row, row * sizeof(float));
+            }
+            offset += row;
+        }
+    }
+
+    void RunReshape(const Step& s) {
+        const Value& x = In(s, 0);
+        Dims shape = Ints(In(s, 1));
+        int infer = -1;
+        size_t known = 1;
+        for (size_t d = 0; d < shape.size(); d++) {
+            if (shape[d] == 0) shape[d] = x.shape.at(d);
+            if (shape[d] == -1) {
+                infer = static_cast<int>(d);
+            } else {
+                known *= static_cast<size_t>(shape[d]);
+            }
+        }
+        if (infer >= 0) {
+            shape[infer] = known == 0 ? 0 : static_cast<int64_t>(x.Count() / known);
+        }
+        Copy(x, s, 0, shape);
+    }
+
+    void RunConstantOfShape(const Step& s) {
+        Dims shape = Ints(In(s, 0));
+        if (s.tensor && s.tensor->data_type != kFloat) {
+            int64_t v = s.tensor->int64_data.empty() ? 0 : s.tensor->int64_data[0];
+            int64_t* y = OutI(s, 0, shape);
+            std::fill(y, y + ShapeCount(shape), v);
+        } else {
+            float v = (s.tensor && !s.tensor->float_data.empty()) ? s.tensor->float_data[0] : 0.0f;
+            float* y = OutF(s, 0, shape);
+            std::fill(y, y + ShapeCount(shape), v);
+        }
+    }
+
+    void RunCast(const Step& s) {
+        const Value& x = In(s, 0);
+        if (s.to_type == kFloat) {
+            if (x.type == kFloat) {
+                Copy(x, s, 0, x.shape);
+                return;
+            }
+            const int64_t* src = x.I();
+            size_t n = x.Count();
+            float* y = OutF(s, 0, x.shape);
+            for (size_t k = 0; k < n; k++) y[k] = static_cast<float>(src[k]);
+            return;
+        }
+
+        size_t n = x.Count();
+        int64_t* y = OutI(s, 0, x.shape);
+        bool to_bool = s.to_type == onnx_proto::kBool;
+        if (x.type == kFloat) {
+            // float -> bool 按是否非零判断，避免截断小数
+            const float* src = x.F();
+            for (size_t k = 0; k < n; k++) y[k] = to_bool ? src[k] != 0.0f : static_cast<int64_t>(src[k]);
+        } else {
+            const int64_t* src = x.I();
+            for (size_t k = 0; k < n; k++) y[k] = to_bool ? src[k] != 0 : src[k];
+        }
+    }
+
+    void BroadcastCopy(const Value& x, const Step& s, const Dims& shape) {
+        Strides strides[1] = {BroadcastStrides(x.shape, shape)};
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, 0, shape);
+            ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t n, const size_t* st) {
+                for (size_t t = 0; t < n; t++) y[o + t] = src[offs[0] + t * st[0]];
+            });
+            return;
+        }
+        const float* src = x.F();
+        float* y = OutF(s, 0, shape);
+        ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t n, const size_t* st) {
+            for (size_t t = 0; t < n; t++) y[o + t] = src[offs[0] + t * st[0]];
+        });
+    }
+
+    // 通用的跨步复制：out[idx] = x[start + idx * step]（逐维）
+    void StridedCopy(const Value& x, const Step& s, size_t k, const Dims& starts,
+                     const Dims& steps, const Dims& shape) {
+        size_t rank = x.shape.size();
+        Dims in_strides = RowMajorStrides(x.shape);
+
+        int64_t base = 0;
+        for (size_t d = 0; d < rank; d++) base += starts[d] * in_strides[d];
+        size_t total = ShapeCount(shape);
+
+        Dims idx(rank, 0);
+        auto offset_of = [&]() {
+            int64_t off = base;
+            for (size_t d = 0; d < rank; d++) off += idx[d] * steps[d] * in_strides[d];
+            return off;
+        };
+        auto next = [&]() {
+            for (size_t d = rank; d-- > 0;) {
+                if (++idx[d] < shape[d]) return;
+                idx[d] = 0;
+            }
+        };
+
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, k, shape);
+            for (size_t o = 0; o < total; o++, next()) y[o] = src[offset_of()];
+            return;
+        }
+        const float* src = x.F();
+        float* y = OutF(s, k, shape);
+        if (rank == 0) {
+            y[0] = src[0];
+            return;
+        }
+        // 最内层步长为1时整行复制
+        int64_t inner = shape[rank - 1];
+        if (steps[rank - 1] == 1 && inner > 0) {
+            for (size_t o = 0; o < total; o += inner) {
+                idx[rank - 1] = 0;
+                std::memcpy(y + o, src + offset_of(), inner * sizeof(float));
+                idx[rank - 1] = inner - 1;
+                next();
+            }
+        } else {
+            for (size_t o = 0; o < total; o++, next()) y[o] = src[offset_of()];
+        }
+    }
+
+    void RunSlice(const Step& s) {
+        const Value& x = In(s, 0);
+        size_t rank = x.shape.size();
+        Dims starts, ends, axes, steps;
+        if (s.has_ints) {
+            size_t n = s.ints.size() / 3;
+            starts.assign(s.ints.begin(), s.ints.begin() + n);
+            ends.assign(s.ints.begin() + n, s.ints.begin() + 2 * n);
+            axes.assign(s.ints.begin() + 2 * n, s.ints.end());
+        } else {
+            starts = Ints(In(s, 1));
+            ends = Ints(In(s, 2));
+            if (HasIn(s, 3)) axes = Ints(In(s, 3));
+            if (HasIn(s, 4)) steps = Ints(In(s, 4));
+        }
+        if (axes.empty()) {
+            axes.resize(starts.size());
+            std::iota(axes.begin(), axes.end(), 0);
+        }
+        if (steps.empty()) steps.assign(starts.size(), 1);
+
+        Dims full_starts(rank, 0), full_steps(rank, 1), shape = x.shape;
+        for (size_t k = 0; k < starts.size(); k++) {
+            size_t a = static_cast<size_t>(NormalizeAxis(axes[k], rank));
+            int64_t dim = x.shape[a];
+            int64_t step = steps[k];
+            if (step == 0) throw std::runtime_error("Slice步长不能为0");
+            int64_t start = starts[k] < 0 ? starts[k] + dim : starts[k];
+            int64_t end = ends[k] < 0 ? ends[k] + dim : ends[k];
+            // 按ONNX规则截断到有效范围
+            if (step > 0) {
+                start = std::max<int64_t>(0, std::min(start, dim));
+                end = std::max<int64_t>(0, std::min(end, dim));
+                shape[a] = end > start ? (end - start + step - 1) / step : 0;
+            } else {
+                start = std::max<int64_t>(-1, std::min(start, dim - 1));
+                end = std::max<int64_t>(-1, std::min(end, dim - 1));
+                shape[a] = start > end ? (start - end - step - 1) / (-step) : 0;
+            }
+            full_starts[a] = start;
+            full_steps[a] = step;
+        }
+        StridedCopy(x, s, 0, full_starts, full_steps, shape);
+    }
+
+    void RunSplit(const Step& s) {
+        const Value& x = In(s, 0);
+        size_t axis = static_cast<size_t>(NormalizeAxis(s.axis, x.shape.size()));
+        // 各段长度：属性、输入，或按输出数均分（最后一段可能较短）
+        const Value* sizes_in = !s.has_ints && HasIn(s, 1) && In(s, 1).Count() > 0 ? &In(s, 1) : nullptr;
+        bool from_attr = s.has_ints && !s.ints.empty();
+        size_t n_out = s.out.size();
+        int64_t dim = x.shape[axis];
+        int64_t chunk = (dim + static_cast<int64_t>(n_out) - 1) / static_cast<int64_t>(n_out);
+        auto size_of = [&](size_t k) {
+            if (from_attr) return s.ints[k];
+            if (sizes_in) return IntAt(*sizes_in, k);
+            return std::max<int64_t>(0, std::min(chunk, dim - chunk * static_cast<int64_t>(k)));
+        };
+        size_t n_sizes = from_attr ? s.ints.size() : (sizes_in ? sizes_in->Count() : n_out);
+        if (n_sizes != n_out) throw std::runtime_error("Split输出数量不匹配");
+
+        Dims starts(x.shape.size(), 0), steps(x.shape.size(), 1);
+        for (size_t k = 0; k < n_out; k++) {
+            Dims shape = x.shape;
+            shape[axis] = size_of(k);
+            if (s.out[k] >= 0) StridedCopy(x, s, k, starts, steps, shape);
+            starts[axis] += shape[axis];
+        }
+    }
+
+    void RunTranspose(const Step& s) {
+        const Value& x = In(s, 0);
+        size_t rank = x.shape.size();
+        Dims perm;
+        if (s.has_ints) {
+            perm = s.ints;
+        } else {
+            perm.resize(rank);
+            for (size_t d = 0; d < rank; d++) perm[d] = static_cast<int64_t>(rank - 1 - d);
+        }
+        Dims in_strides = RowMajorStrides(x.shape);
+
+        // 转置即以置换后的步长遍历输入
+        Dims shape(rank, 0), strides(rank, 0);
+        for (size_t d = 0; d < rank; d++) {
+            shape[d] = x.shape[perm[d]];
+            strides[d] = in_strides[perm[d]];
+        }
+        // 最内层按固定步长读取、连续写出，外层坐标逐行推进
+        size_t total = ShapeCount(shape);
+        size_t inner = rank > 0 ? static_cast<size_t>(shape[rank - 1]) : 1;
+        int64_t inner_stride = rank > 0 ? strides[rank - 1] : 0;
+        size_t rows = inner > 0 ? total / inner : 0;
+        Dims idx(rank, 0);
+        auto copy = [&](auto* y, const auto* src) {
+            for (size_t r = 0; r < rows; r++) {
+                int64_t off = 0;
+                for (size_t d = 0; d + 1 < rank; d++) off += idx[d] * strides[d];
+                const auto* xr = src + off;
+                auto* yr = y + r * inner;
+                for (size_t k = 0; k < inner; k++) yr[k] = xr[static_cast<int64_t>(k) * inner_stride];
+                for (size_t d = rank > 0 ? rank - 1 : 0; d-- > 0;) {
+                    if (++idx[d] < shape[d]) break;
+                    idx[d] = 0;
+                }
+            }
+        };
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, 0, shape);
+            copy(y, src);
+        } else {
+            const float* src = x.F();
+            float* y = OutF(s, 0, shape);
+            copy(y, src);
+        }
+    }
+
+    void RunRange(const Step& s) {
+        const Value& start_v = In(s, 0);
+        double start = Scalar(start_v);
+        double limit = Scalar(In(s, 1));
+        double delta = Scalar(In(s, 2));
+        int64_t n = std::max<int64_t>(0, static_cast<int64_t>(std::ceil((limit - start) / delta)));
+        if (start_v.type == kInt64) {
+            int64_t* y = OutI(s, 0, {n});
+            for (int64_t k = 0; k < n; k++) y[k] = static_cast<int64_t>(start + k * delta);
+        } else {
+            float* y = OutF(s, 0, {n});
+            for (int64_t k = 0; k < n; k++) y[k] = static_cast<float>(start + k * delta);
+        }
+    }
+
+
+    // ---------- 声学模型用到的算子 ----------
+    void RunMinMax(const Step& s) {
+        if (s.in.size() == 1) {
+            Copy(In(s, 0), s, 0, In(s, 0).shape);
+            return;
+        }
+        if (s.in.size() != 2) throw std::runtime_error("只支持两个输入的Max/Min");
+        if (s.op == Op::Max) {
+            RunBinary(s, [](auto a, auto b) { return a > b ? a : b; });
+        } else {
+            RunBinary(s, [](auto a, auto b) { return a < b ? a : b; });
+        }
+    }
+
+    // [..., M, K] x [..., K, N]，批次维度可广播；B没有批次维度时（线性层权重）整体作为一次矩阵乘
+    void RunMatMul(const Step& s) {
+        const Value& a = In(s, 0);
+        const Value& b = In(s, 1);
+        if (a.type != kFloat || b.type != kFloat) throw std::runtime_error("MatMul需要float输入");
+        Dims sa = a.shape, sb = b.shape;
+        bool a_vec = sa.size() == 1, b_vec = sb.size() == 1;
+        if (a_vec) sa.insert(sa.begin(), 1);
+        if (b_vec) sb.push_back(1);
+        if (sa.size() < 2 || sb.size() < 2) throw std::runtime_error("MatMul输入维度无效");
+
+        int m = static_cast<int>(sa[sa.size() - 2]);
+        int k = static_cast<int>(sa[sa.size() - 1]);
+        int n = static_cast<int>(sb[sb.size() - 1]);
+        if (sb[sb.size() - 2] != k) {
+            throw std::runtime_error("MatMul形状不匹配: " + ShapeString(a.shape) + " x " + ShapeString(b.shape));
+        }
+        Dims batch_a(sa.begin(), sa.end() - 2), batch_b(sb.begin(), sb.end() - 2);
+        Dims batch = BroadcastShape(batch_a, batch_b);
+
+        Dims shape = batch;
+        if (!a_vec) shape.push_back(m);
+        if (!b_vec) shape.push_back(n);
+
+        const float* pa = a.F();
+        const float* pb = b.F();
+        float* y = OutF(s, 0, shape);
+        size_t mat_a = static_cast<size_t>(m) * k, mat_b = static_cast<size_t>(k) * n;
+        size_t mat_y = static_cast<size_t>(m) * n;
+
+        if (ShapeCount(batch_b) == 1 && ShapeCount(batch_a) == ShapeCount(batch)) {
+            kernels::Gemm(y, n, pa, k, pb, n, static_cast<int>(ShapeCount(batch)) * m, n, k);
+        } else {
+            Strides strides[2] = {BroadcastStrides(batch_a, batch), BroadcastStrides(batch_b, batch)};
+            ForEachBroadcast(batch, strides, [&](size_t o, const size_t* offs, size_t count, const size_t* st) {
+                for (size_t t = 0; t < count; t++) {
+                    kernels::Gemm(y + (o + t) * mat_y, n, pa + (offs[0] + t * st[0]) * mat_a, k,
+                                  pb + (offs[1] + t * st[1]) * mat_b, n, m, n, k);
+                }
+            });
+        }
+
+        size_t total = ShapeCount(shape);
+        if (s.alpha != 1.0f) {
+            for (size_t i = 0; i < total; i++) y[i] *= s.alpha;
+        }
+        PostActivate(s, y, total);
+    }
+
+    // 二维矩阵转置到工作区
+    static const float* Transposed(const float* x, int rows, int cols, std::vector<float>& buf) {
+        buf.resize(static_cast<size_t>(rows) * cols);
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                buf[static_cast<size_t>(c) * rows + r] = x[static_cast<size_t>(r) * cols + c];
+            }
+        }
+        return buf.data();
+    }
+
+    void RunGemm(const Step& s) {
+        const Value& a = In(s, 0);
+        const Value& b = In(s, 1);
+        if (a.shape.size() != 2 || b.shape.size() != 2) throw std::runtime_error("Gemm需要二维输入");
+        int m = static_cast<int>(s.flag ? a.shape[1] : a.shape[0]);
+        int k = static_cast<int>(s.flag ? a.shape[0] : a.shape[1]);
+        int n = static_cast<int>(s.flag2 ? b.shape[0] : b.shape[1]);
+        const float* pa = s.flag ? Transposed(a.F(), k, m, work_) : a.F();
+        const float* pb = s.flag2 ? Transposed(b.F(), n, k, phase_) : b.F();
+
+        float* y = OutF(s, 0, {m, n});
+        kernels::Gemm(y, n, pa, k, pb, n, m, n, k);
+        size_t total = static_cast<size_t>(m) * n;
+        if (s.alpha != 1.0f) {
+            for (size_t i = 0; i < total; i++) y[i] *= s.alpha;
+        }
+        if (HasIn(s, 2)) {
+            const Value& c = In(s, 2);
+            Dims shape = {m, n};
+            Strides strides[1] = {BroadcastStrides(c.shape, shape)};
+            const float* pc = c.F();
+            float beta = s.beta;
+            ForEachBroadcast(shape, strides, [&](size_t o, const size_t* offs, size_t count, const size_t* st) {
+                for (size_t t = 0; t < count; t++) y[o + t] += beta * pc[offs[0] + t * st[0]];
+            });
+        }
+        PostActivate(s, y, total);
+    }
+
+    void RunSoftmax(const Step& s) {
+        const Value& x = In(s, 0);
+        size_t axis = static_cast<size_t>(NormalizeAxis(s.axis, x.shape.size()));
+        size_t outer = ShapeCount(x.shape, 0, axis);
+        size_t dim = static_cast<size_t>(x.shape[axis]);
+        size_t inner = ShapeCount(x.shape, axis + 1, x.shape.size());
+        const float* src = x.F();
+        float* y = OutF(s, 0, x.shape);
+
+        if (s.flag || inner == 1) {
+            // 归一化的元素在内存中连续
+            size_t n = s.flag ? dim * inner : dim;
+            kernels::SoftmaxRows(y, src, static_cast<int>(x.Count() / std::max<size_t>(n, 1)), static_cast<int>(n));
+            return;
+        }
+        // 非最内层的轴：逐列取出计算后写回
+        work_.resize(dim * 2);
+        float* col = work_.data();
+        float* out = work_.data() + dim;
+        for (size_t o = 0; o < outer; o++) {
+            for (size_t i = 0; i < inner; i++) {
+                size_t base = o * dim * inner + i;
+                for (size_t d = 0; d < dim; d++) col[d] = src[base + d * inner];
+                kernels::SoftmaxRows(out, col, 1, static_cast<int>(dim));
+                for (size_t d = 0; d < dim; d++) y[base + d * inner] = out[d];
+            }
+        }
+    }
+
+    void RunLayerNorm(const Step& s) {
+        const Value& x = In(s, 0);
+        size_t axis = static_cast<size_t>(NormalizeAxis(s.axis, x.shape.size()));
+        size_t n = ShapeCount(x.shape, axis, x.shape.size());
+        const float* gamma = In(s, 1).F();
+        const float* beta = HasIn(s, 2) ? In(s, 2).F() : nullptr;
+        if (In(s, 1).Count() != n || (beta && In(s, 2).Count() != n)) {
+            throw std::runtime_error("LayerNormalization的scale/bias形状不支持广播");
+        }
+        const float* src = x.F();
+        float* y = OutF(s, 0, x.shape);
+        kernels::LayerNormRows(y, src, static_cast<int>(x.Count() / std::max<size_t>(n, 1)),
+                               static_cast<int>(n), gamma, beta, s.alpha);
+    }
+
+    // 归约：按输入顺序遍历，累加到广播步长对应的输出位置
+    template <typename T>
+    void Reduce(const Step& s, const T* src, T* dst, const Dims& in_shape, const Dims& keep_shape) {
+        size_t out_count = ShapeCount(keep_shape);
+        T init = 0;
+        if (s.op == Op::ReduceMax) init = std::numeric_limits<T>::lowest();
+        if (s.op == Op::ReduceMin) init = std::numeric_limits<T>::max();
+        std::fill(dst, dst + out_count, init);
+
+        Strides strides[1] = {BroadcastStrides(keep_shape, in_shape)};
+        Op op = s.op;
+        ForEachBroadcast(in_shape, strides, [&](size_t o, const size_t* offs, size_t count, const size_t* st) {
+            const T* x = src + o;
+            if (st[0] == 0) {
+                T& acc = dst[offs[0]];
+                for (size_t t = 0; t < count; t++) {
+                    if (op == Op::ReduceMax) acc = std::max(acc, x[t]);
+                    else if (op == Op::ReduceMin) acc = std::min(acc, x[t]);
+                    else acc += x[t];
+                }
+            } else {
+                T* acc = dst + offs[0];
+                for (size_t t = 0; t < count; t++) {
+                    if (op == Op::ReduceMax) acc[t] = std::max(acc[t], x[t]);
+                    else if (op == Op::ReduceMin) acc[t] = std::min(acc[t], x[t]);
+                    else acc[t] += x[t];
+                }
+            }
+        });
+
+        if (op == Op::ReduceMean) {
+            size_t group = out_count ? ShapeCount(in_shape) / out_count : 0;
+            for (size_t i = 0; i < out_count; i++) dst[i] /= static_cast<T>(group);
+        }
+    }
+
+    void RunReduce(const Step& s) {
+        const Value& x = In(s, 0);
+        Dims axes = AxesOf(s, 1);
+        if (axes.empty() && s.flag) {
+            Copy(x, s, 0, x.shape);
+            return;
+        }
+        bool reduced[kMaxRank];
+        std::fill(reduced, reduced + kMaxRank, axes.empty());
+        for (auto a : axes) reduced[NormalizeAxis(a, x.shape.size())] = true;
+
+        Dims keep_shape = x.shape, shape;
+        for (size_t d = 0; d < x.shape.size(); d++) {
+            if (reduced[d]) keep_shape[d] = 1;
+            if (!reduced[d] || s.keep_dims) shape.push_back(keep_shape[d]);
+        }
+
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, 0, shape);
+            Reduce<int64_t>(s, src, y, x.shape, keep_shape);
+        } else {
+            const float* src = x.F();
+            float* y = OutF(s, 0, shape);
+            Reduce<float>(s, src, y, x.shape, keep_shape);
+        }
+    }
+
+    template <typename T>
+    static void CumSum(const T* x, T* y, size_t outer, size_t dim, size_t inner, bool exclusive, bool reverse) {
+        for (size_t o = 0; o < outer; o++) {
+            for (size_t i = 0; i < inner; i++) {
+                T acc = 0;
+                for (size_t k = 0; k < dim; k++) {
+                    size_t d = reverse ? dim - 1 - k : k;
+                    size_t idx = (o * dim + d) * inner + i;
+                    if (exclusive) {
+                        y[idx] = acc;
+                        acc += x[idx];
+                    } else {
+                        acc += x[idx];
+                        y[idx] = acc;
+                    }
+                }
+            }
+        }
+    }
+
+    void RunCumSum(const Step& s) {
+        const Value& x = In(s, 0);
+        size_t axis = static_cast<size_t>(NormalizeAxis(static_cast<int64_t>(Scalar(In(s, 1))), x.shape.size()));
+        size_t outer = ShapeCount(x.shape, 0, axis);
+        size_t dim = static_cast<size_t>(x.shape[axis]);
+        size_t inner = ShapeCount(x.shape, axis + 1, x.shape.size());
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, 0, x.shape);
+            CumSum(src, y, outer, dim, inner, s.flag, s.flag2);
+        } else {
+            const float* src = x.F();
+            float* y = OutF(s, 0, x.shape);
+            CumSum(src, y, outer, dim, inner, s.flag, s.flag2);
+        }
+    }
+
+    void RunRandom(const Step& s) {
+        Dims shape = In(s, 0).shape;
+        float* y = OutF(s, 0, shape);
+        size_t count = ShapeCount(shape);
+        if (s.op == Op::RandomNormalLike) {
+            std::normal_distribution<float> dist(s.alpha, s.beta);
+            for (size_t i = 0; i < count; i++) y[i] = dist(rng_);
+        } else {
+            std::uniform_real_distribution<float> dist(s.alpha, s.beta);
+            for (size_t i = 0; i < count; i++) y[i] = dist(rng_);
+        }
+    }
+
+    void RunGatherElements(const Step& s) {
+        const Value& x = In(s, 0);
+        const Value& idx = In(s, 1);
+        size_t rank = x.shape.size();
+        size_t axis = static_cast<size_t>(NormalizeAxis(s.axis, rank));
+        size_t n_idx = idx.Count();
+        Dims in_strides = RowMajorStrides(x.shape);
+
+        // 输出坐标与输入一致，只有axis维替换为索引值
+        Dims pos(rank, 0);
+        PoolScratch offsets(pool_, n_idx);
+        int64_t* off_data = offsets.data();
+        for (size_t o = 0; o < n_idx; o++) {
+            int64_t v = IntAt(idx, o);
+            if (v < 0) v += x.shape[axis];
+            if (v < 0 || v >= x.shape[axis]) throw std::runtime_error("GatherElements索引越界");
+            int64_t off = 0;
+            for (size_t d = 0; d < rank; d++) off += (d == axis ? v : pos[d]) * in_strides[d];
+            off_data[o] = off;
+            for (size_t d = rank; d-- > 0;) {
+                if (++pos[d] < idx.shape[d]) break;
+                pos[d] = 0;
+            }
+        }
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, 0, idx.shape);
+            for (size_t o = 0; o < n_idx; o++) y[o] = src[off_data[o]];
+        } else {
+            const float* src = x.F();
+            float* y = OutF(s, 0, idx.shape);
+            for (size_t o = 0; o < n_idx; o++) y[o] = src[off_data[o]];
+        }
+    }
+
+    // 按输出坐标映射回输入坐标的通用复制（Tile、Pad），映射返回-1表示填充值。
+    // 最内层维度的映射只算一次，外层按行求出输入行的起点后逐行复制
+    template <typename MapFn>
+    void MappedCopy(const Value& x, const Step& s, const Dims& shape, float fill, MapFn map) {
+        size_t rank = shape.size();
+        Dims in_strides = RowMajorStrides(x.shape);
+        size_t total = ShapeCount(shape);
+        size_t inner = rank > 0 ? static_cast<size_t>(shape[rank - 1]) : 1;
+        PoolScratch inner_scratch(pool_, inner);
+        int64_t* inner_map = inner_scratch.data();
+        std::fill(inner_map, inner_map + inner, 0);
+        for (size_t k = 0; k < inner && rank > 0; k++) inner_map[k] = map(rank - 1, static_cast<int64_t>(k));
+
+        size_t rows = inner > 0 ? total / inner : 0;
+        PoolScratch row_scratch(pool_, rows);
+        int64_t* row_offsets = row_scratch.data();
+        Dims pos(rank, 0);
+        for (size_t r = 0; r < rows; r++) {
+            int64_t off = 0;
+            for (size_t d = 0; d + 1 < rank && off >= 0; d++) {
+                int64_t p = map(d, pos[d]);
+                off = p < 0 ? -1 : off + p * in_strides[d];
+            }
+            row_offsets[r] = off;
+            for (size_t d = rank > 0 ? rank - 1 : 0; d-- > 0;) {
+                if (++pos[d] < shape[d]) break;
+                pos[d] = 0;
+            }
+        }
+        auto copy = [&](auto* y, const auto* src, auto fill_value) {
+            for (size_t r = 0; r < rows; r++) {
+                auto* yr = y + r * inner;
+                if (row_offsets[r] < 0) {
+                    std::fill(yr, yr + inner, fill_value);
+                    continue;
+                }
+                const auto* xr = src + row_offsets[r];
+                for (size_t k = 0; k < inner; k++) yr[k] = inner_map[k] < 0 ? fill_value : xr[inner_map[k]];
+            }
+        };
+        if (x.type == kInt64) {
+            const int64_t* src = x.I();
+            int64_t* y = OutI(s, 0, shape);
+            copy(y, src, static_cast<int64_t>(fill));
+        } else {
+            const float* src = x.F();
+            float* y = OutF(s, 0, shape);
+            copy(y, src, fill);
+        }
+    }
+
+    void RunTile(const Step& s) {
+        const Value& x = In(s, 0);
+        Dims repeats = Ints(In(s, 1));
+        if (repeats.size() != x.shape.size()) throw std::runtime_error("Tile重复次数与维度不一致");
+        Dims shape = x.shape;
+        for (size_t d = 0; d < shape.size(); d++) shape[d] *= repeats[d];
+        MappedCopy(x, s, shape, 0.0f, [&x](size_t d, int64_t p) { return p % x.shape[d]; });
+    }
+
+    void RunPad(const Step& s) {
+        const Value& x = In(s, 0);
+        size_t rank = x.shape.size();
+        SmallVector<int64_t, 2 * kMaxRank> pads;
+        if (s.has_ints) {
+            pads = s.ints;
+        } else {
+            pads = Ints<2 * kMaxRank>(In(s, 1));
+        }
+        float fill = s.alpha;
+        if (!s.has_ints && HasIn(s, 2) && In(s, 2).Count() > 0) fill = static_cast<float>(Scalar(In(s, 2)));
+
+        // opset 18 的axes输入：pads只给出部分轴
+        Dims begin(rank, 0), end(rank, 0);
+        if (HasIn(s, 3)) {
+            Dims axes = Ints(In(s, 3));
+            for (size_t k = 0; k < axes.size(); k++) {
+                size_t a = static_cast<size_t>(NormalizeAxis(axes[k], rank));
+                begin[a] = pads[k];
+                end[a] = pads[k + axes.size()];
+            }
+        } else {
+            if (pads.size() != 2 * rank) throw std::runtime_error("Pad参数长度无效");
+            for (size_t d = 0; d < rank; d++) {
+                begin[d] = pads[d];
+                end[d] = pads[d + rank];
+            }
+        }
+
+        Dims shape(rank, 0);
+        for (size_t d = 0; d < rank; d++) shape[d] = x.shape[d] + begin[d] + end[d];
+        int mode = s.mode;
+        MappedCopy(x, s, shape, fill, [&](size_t d, int64_t p) -> int64_t {
+            int64_t n = x.shape[d];
+            int64_t q = p - begin[d];
+            if (q >= 0 && q < n) return q;
+            if (mode == 0 || n == 0) return -1;
+            if (mode == 2) return q < 0 ? 0 : n - 1;
+            // reflect：不重复边界元素
+            if (n == 1) return 0;
+            int64_t period = 2 * (n - 1);
+            q = ((q % period) + period) % period;
+            return q < n ? q : period - q;
+        });
+    }
+
+    std::map<std::string, int> ids_;
+    std::vector<Step> steps_;
+    std::vector<float> work_;   // 卷积工作区，跨节点复用
+    std::vector<float> phase_;  // 转置卷积相位缓冲
+    std::mt19937 rng_{std::random_device{}()};
+    int64_t opset_ = 13;
+};
+
+// ==================== 对外接口 ====================
+
+NativeEngine::NativeEngine() = default;
+NativeEngine::~NativeEngine() = default;
+
+int NativeEngine::Init(const std::string& model_file) {
+    try {
+        std::unique_ptr<NativeEngineImpl> impl(new NativeEngineImpl());
+        impl->Load(model_file);
+        impl_ = std::move(impl);
+        std::cout << "原生引擎加载模型: " << model_file << " (" << kernels::SimdLevel() << ")" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "原生引擎无法加载 " << model_file << ": " << e.what() << std::endl;
+        impl_.reset();
+        return -1;
+    }
+}
+
+static NativeEngineImpl& Checked(const std::unique_ptr<NativeEngineImpl>& impl) {
+    if (!impl) throw std::runtime_error("原生引擎未初始化");
+    return *impl;
+}
+
+size_t NativeEngine::GetInputCount() const {
+    return impl_ ? impl_->input_names_.size() : 0;
+}
+
+size_t NativeEngine::GetOutputCount() const {
+    return impl_ ? impl_->output_names_.size() : 0;
+}
+
+const std::string& NativeEngine::GetInputName(int input_idx) const {
+    return Checked(impl_).input_names_.at(input_idx);
+}
+
+const std::string& NativeEngine::GetOutputName(int output_idx) const {
+    return Checked(impl_).output_names_.at(output_idx);
+}
+
+const std::vector<int64_t>& NativeEngine::GetInputShape(int input_idx) const {
+    return Checked(impl_).input_shapes_.at(input_idx);
+}
+
+size_t NativeEngine::GetInputSize(int input_idx) const {
+    size_t count = 1;
+    for (auto d : GetInputShape(input_idx)) count *= static_cast<size_t>(d > 0 ? d : 1);
+    switch (GetInputType(input_idx)) {
+        case onnx_proto::kInt64: return count * sizeof(int64_t);
+        case onnx_proto::kBool: return count;
+        default: return count * sizeof(float);
+    }
+}
+
+bool NativeEngine::IsInputDynamic(int input_idx) const {
+    const auto& shape = GetInputShape(input_idx);
+    return std::any_of(shape.begin(), shape.end(), [](int64_t d) { return d <= 0; });
+}
+
+int NativeEngine::GetInputType(int input_idx) const {
+    return Checked(impl_).input_types_.at(input_idx);
+}
+
+int NativeEngine::GetOutputType(int output_idx) const {
+    int type = Checked(impl_).output_types_.at(output_idx);
+    return type == onnx_proto::kUndefined ? kFloat : type;
+}
+
+std::string NativeEngine::GetCustomMetadata(const std::string& key) const {
+    const auto& metadata = Checked(impl_).shared_model_->model.metadata;
+    auto it = metadata.find(key);
+    return it == metadata.end() ? std::string() : it->second;
+}
+
+void NativeEngine::SetInput(const void* data, int input_idx) {
+    Checked(impl_).input_data_.at(input_idx) = data;
+}
+
+void NativeEngine::SetInput(const void* data, int input_idx, const std::vector<int64_t>& shape) {
+    SetInput(data, input_idx);
+    impl_->input_run_shapes_.at(input_idx) = shape;
+}
+
+const void* NativeEngine::GetInputData(int input_idx) const {
+    return Checked(impl_).input_data_.at(input_idx);
+}
+
+const std::vector<int64_t>& NativeEngine::GetInputRunShape(int input_idx) const {
+    return Checked(impl_).input_run_shapes_.at(input_idx);
+}
+
+int NativeEngine::RunSync() {
+    try {
+        Checked(impl_).Run();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error in NativeEngine::RunSync: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+size_t NativeEngine::GetOutputElementCount(int output_idx) const {
+    return ShapeCount(GetOutputShape(output_idx));
+}
+
+const std::vector<int64_t>& NativeEngine::GetOutputShape(int output_idx) const {
+    return Checked(impl_).output_shapes_.at(output_idx);
+}
+
+void NativeEngine::GetOutput(void* dst, int output_idx) {
+    NativeEngineImpl& impl = Checked(impl_);
+    const Value& v = impl.values_.at(impl.output_ids_.at(output_idx));
+    if (!v.HasData()) {
+        throw std::runtime_error("输出张量未生成");
+    }
+    size_t count = v.Count();
+    auto element = [&v](size_t k) {
+        return v.type == kInt64 ? static_cast<double>(v.I()[k]) : static_cast<double>(v.F()[k]);
+    };
+
+    switch (GetOutputType(output_idx)) {
+        case onnx_proto::kInt32: {
+            int32_t* out = static_cast<int32_t*>(dst);
+            for (size_t k = 0; k < count; k++) out[k] = static_cast<int32_t>(element(k));
+            break;
+        }
+        case onnx_proto::kInt64: {
+            int64_t* out = static_cast<int64_t*>(dst);
+            for (size_t k = 0; k < count; k++) out[k] = static_cast<int64_t>(element(k));
+            break;
+        }
+        case onnx_proto::kBool: {
+            uint8_t* out = static_cast<uint8_t*>(dst);
+            for (size_t k = 0; k < count; k++) out[k] = element(k) != 0.0;
+            break;
+        }
+        default: {
+            float* out = static_cast<float*>(dst);
+            if (v.type == kFloat) {
+                std::memcpy(out, v.F(), count * sizeof(float));
+            } else {
+                const int64_t* src = v.I();
+                for (size_t k = 0; k < count; k++) out[k] = static_cast<float>(src[k]);
+            }
+            break;
+        }
+    }
+}
+
+int NativeEngine::Warmup() {
+    NativeEngineImpl& impl = Checked(impl_);
+    // 按最宽的int64分配，全零的位模式对各种类型都表示0
+    std::vector<std::vector<int64_t>> zeros;
+    std::vector<const void*> saved = impl.input_data_;
+    for (size_t k = 0; k < impl.input_run_shapes_.size(); k++) {
+        size_t count = 1;
+        for (auto d : impl.input_run_shapes_[k]) count *= static_cast<size_t>(d > 0 ? d : 1);
+        zeros.emplace_back(count, 0);
+        impl.input_data_[k] = zeros.back().data();
+    }
+    int ret = RunSync();
+    impl.input_data_ = saved;
+    return ret;
+}
+
+size_t NativeEngine::GetArenaBytes() const {
+    return impl_ ? impl_->pool_.Bytes() : 0;
+}
+
+} // namespace melotts
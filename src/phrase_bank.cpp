@@ -0,0 +1,360 @@
+// phrase_bank.cpp - IVR 提示音模板：片段预渲染、槽位合成与交叉淡化拼接
+
+#include "PhraseBank.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace melotts {
+
+namespace {
+
+const char* const kDigits[] = {"零", "一", "二", "三", "四", "五", "六", "七", "八", "九"};
+const char* const kGroupUnits[] = {"", "万", "亿"};
+const char* const kNumberUnits[] = {"零", "一", "二", "三", "四", "五", "六", "七", "八", "九",
+                                    "十", "百", "千", "万", "亿", "点", "负"};
+
+// 读一个四位组（1..9999），组内中间的零读一次，末尾的零不读
+std::string ReadGroup(int value) {
+    static const char* const kPlaceUnits[] = {"千", "百", "十", ""};
+    std::string out;
+    bool started = false;
+    bool zero = false;
+    int divisor = 1000;
+    for (int i = 0; i < 4; i++, divisor /= 10) {
+        int d = value / divisor % 10;
+        if (d == 0) {
+            if (started) zero = true;
+            continue;
+        }
+        if (zero) {
+            out += kDigits[0];
+            zero = false;
+        }
+        out += kDigits[d];
+        out += kPlaceUnits[i];
+        started = true;
+    }
+    return out;
+}
+
+std::vector<PhrasePart> ParsePattern(const std::string& name, const std::string& pattern) {
+    std::vector<PhrasePart> parts;
+    std::string text;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        char c = pattern[i];
+        if (c == '}') {
+            throw std::runtime_error("模板 " + name + " 的花括号不配对: " + pattern);
+        }
+        if (c != '{') {
+            text += c;
+            i++;
+            continue;
+        }
+        size_t close = pattern.find('}', i + 1);
+        if (close == std::string::npos || pattern.find('{', i + 1) < close) {
+            throw std::runtime_error("模板 " + name + " 的花括号不配对: " + pattern);
+        }
+        std::string slot = pattern.substr(i + 1, close - i - 1);
+        if (slot.empty()) {
+            throw std::runtime_error("模板 " + name + " 的槽位名为空: " + pattern);
+        }
+        if (!text.empty()) {
+            parts.push_back(PhrasePart{false, text});
+            text.clear();
+        }
+        parts.push_back(PhrasePart{true, slot});
+        i = close + 1;
+    }
+    if (!text.empty()) {
+        parts.push_back(PhrasePart{false, text});
+    }
+    if (parts.empty()) {
+        throw std::runtime_error("模板 " + name + " 为空");
+    }
+    return parts;
+}
+
+// 裁去首尾低于峰值 -40 dB 的静音，两端各保留 pad 个采样点
+std::vector<float> TrimSilence(const std::vector<float>& audio, size_t pad) {
+    float peak = 0.0f;
+    for (float x : audio) peak = std::max(peak, std::abs(x));
+    if (peak <= 0.0f) return audio;
+    float threshold = peak * 0.01f;
+    size_t first = 0;
+    while (first < audio.size() && std::abs(audio[first]) < threshold) first++;
+    size_t last = audio.size();
+    while (last > first && std::abs(audio[last - 1]) < threshold) last--;
+    first = first > pad ? first - pad : 0;
+    last = std::min(audio.size(), last + pad);
+    return std::vector<float>(audio.begin() + first, audio.begin() + last);
+}
+
+double Rms(const std::vector<float>& audio) {
+    if (audio.empty()) return 0.0;
+    double sum = 0.0;
+    for (float x : audio) sum += static_cast<double>(x) * x;
+    return std::sqrt(sum / audio.size());
+}
+
+// 把 piece 接到 out 末尾，重叠部分线性交叉淡化
+void Splice(std::vector<float>& out, const std::vector<float>& piece, size_t crossfade) {
+    size_t n = std::min(crossfade, std::min(out.size(), piece.size()));
+    size_t base = out.size() - n;
+    for (size_t i = 0; i < n; i++) {
+        float w = static_cast<float>(i + 1) / static_cast<float>(n + 1);
+        out[base + i] = out[base + i] * (1.0f - w) + piece[i] * w;
+    }
+    out.insert(out.end(), piece.begin() + n, piece.end());
+}
+
+// 按 UTF-8 字符拆分
+std::vector<std::string> SplitUtf8(const std::string& text) {
+    std::vector<std::string> chars;
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        size_t len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : 4;
+        chars.push_back(text.substr(i, len));
+        i += len;
+    }
+    return chars;
+}
+
+} // namespace
+
+std::string NumberToChinese(const std::string& number) {
+    std::string s = number;
+    bool negative = !s.empty() && s[0] == '-';
+    if (negative) s.erase(0, 1);
+    size_t dot = s.find('.');
+    std::string integer = s.substr(0, dot);
+    std::string fraction = dot == std::string::npos ? "" : s.substr(dot + 1);
+    auto all_digits = [](const std::string& t) {
+        return !t.empty() && std::all_of(t.begin(), t.end(), [](char c) { return c >= '0' && c <= '9'; });
+    };
+    if (!all_digits(integer) || (dot != std::string::npos && !all_digits(fraction))) {
+        return "";
+    }
+
+    std::string out = negative ? "负" : "";
+    if ((integer.size() > 1 && integer[0] == '0') || integer.size() > 12) {
+        for (char c : integer) out += kDigits[c - '0'];
+    } else if (integer == "0") {
+        out += kDigits[0];
+    } else {
+        // 从高到低按万、亿分组；跳过的组或不足千的组前补一个零
+        std::string reading;
+        int groups = static_cast<int>((integer.size() + 3) / 4);
+        bool pending_zero = false;
+        for (int g = groups - 1; g >= 0; g--) {
+            size_t end = integer.size() - static_cast<size_t>(g) * 4;
+            size_t begin = end >= 4 ? end - 4 : 0;
+            int value = std::stoi(integer.substr(begin, end - begin));
+            if (value == 0) {
+                pending_zero = !reading.empty();
+                continue;
+            }
+            if (!reading.empty() && (pending_zero || value < 1000)) {
+                reading += kDigits[0];
+            }
+            reading += ReadGroup(value);
+            reading += kGroupUnits[g];
+            pending_zero = false;
+        }
+        // 10～19 读作"十…"
+        const std::string yi_shi = std::string(kDigits[1]) + "十";
+        if (reading.compare(0, yi_shi.size(), yi_shi) == 0) {
+            reading.erase(0, std::strlen(kDigits[1]));
+        }
+        out += reading;
+    }
+    if (!fraction.empty()) {
+        out += "点";
+        for (char c : fraction) out += kDigits[c - '0'];
+    }
+    return out;
+}
+
+PhraseBank::PhraseBank(MeloTTS& tts, const MeloTTSConfig& config, const PhraseBankOptions& options)
+    : tts_(tts), config_(config), options_(options) {}
+
+void PhraseBank::AddTemplate(const std::string& name, const std::string& pattern) {
+    if (templates_.count(name)) {
+        throw std::runtime_error("模板重复添加: " + name);
+    }
+    templates_[name] = ParsePattern(name, pattern);
+    patterns_[name] = pattern;
+}
+
+bool PhraseBank::HasTemplate(const std::string& name) const {
+    return templates_.count(name) > 0;
+}
+
+std::vector<std::string> PhraseBank::TemplateNames() const {
+    std::vector<std::string> names;
+    for (const auto& item : templates_) names.push_back(item.first);
+    return names;
+}
+
+const std::vector<PhrasePart>& PhraseBank::Parts(const std::string& name) const {
+    auto it = templates_.find(name);
+    if (it == templates_.end()) {
+        throw std::runtime_error("模板不存在: " + name);
+    }
+    return it->second;
+}
+
+size_t PhraseBank::Prerender() {
+    size_t before = fragments_.size();
+    for (const auto& item : templates_) {
+        for (const auto& part : item.second) {
+            if (!part.is_slot) Fragment(part.text);
+        }
+    }
+    if (options_.prerendered_numbers) {
+        for (const char* unit : kNumberUnits) Fragment(unit);
+    }
+    return fragments_.size() - before;
+}
+
+std::string PhraseBank::Fingerprint() const {
+    std::ostringstream out;
+    out << "sample_rate=" << config_.sample_rate << " speaker_id=" << config_.speaker_id << " speed=" << config_.speed
+        << " language=" << options_.language << " " << tts_.model_identity();
+    return out.str();
+}
+
+void PhraseBank::Save(const std::string& dir) const {
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("无法创建片段目录 " + dir + ": " + std::strerror(errno));
+    }
+    std::ofstream templates(dir + "/templates.txt");
+    std::ofstream index(dir + "/fragments.txt");
+    std::ofstream audio(dir + "/fragments.f32", std::ios::binary);
+    if (!templates || !index || !audio) {
+        throw std::runtime_error("无法写入片段目录: " + dir);
+    }
+    for (const auto& item : patterns_) {
+        templates << item.first << "\t" << item.second << "\n";
+    }
+    // 索引首行记录渲染时的配置，之后每行为采样点数和固定文本，音频按相同顺序连续存放
+    index << "# " << Fingerprint() << "\n";
+    for (const auto& item : fragments_) {
+        index << item.second.size() << "\t" << item.first << "\n";
+        audio.write(reinterpret_cast<const char*>(item.second.data()),
+                    static_cast<std::streamsize>(item.second.size() * sizeof(float)));
+    }
+    if (!templates || !index || !audio) {
+        throw std::runtime_error("写入片段目录失败: " + dir);
+    }
+}
+
+void PhraseBank::Load(const std::string& dir) {
+    std::ifstream templates(dir + "/templates.txt");
+    std::ifstream index(dir + "/fragments.txt");
+    std::ifstream audio(dir + "/fragments.f32", std::ios::binary);
+    if (!templates || !index || !audio) {
+        throw std::runtime_error("无法读取片段目录: " + dir);
+    }
+
+    std::string line;
+    if (!std::getline(index, line) || line != "# " + Fingerprint()) {
+        throw std::runtime_error("片段目录 " + dir + " 的渲染配置与当前配置不一致 (" + line + ", 当前 " +
+                                 Fingerprint() + ")");
+    }
+    while (std::getline(index, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        size_t samples = std::stoul(line.substr(0, tab));
+        std::vector<float> clip(samples);
+        if (!audio.read(reinterpret_cast<char*>(clip.data()), static_cast<std::streamsize>(samples * sizeof(float)))) {
+            throw std::runtime_error("片段音频不完整: " + dir + "/fragments.f32");
+        }
+        AddFragment(line.substr(tab + 1), std::move(clip));
+    }
+
+    while (std::getline(templates, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) continue;
+        std::string name = line.substr(0, tab);
+        std::string pattern = line.substr(tab + 1);
+        auto it = patterns_.find(name);
+        if (it != patterns_.end() && it->second == pattern) continue;
+        AddTemplate(name, pattern);
+    }
+}
+
+std::vector<float> PhraseBank::Render(const std::string& name, const std::map<std::string, std::string>& slots) {
+    const std::vector<PhrasePart>& parts = Parts(name);
+    size_t crossfade = static_cast<size_t>(options_.crossfade_ms * config_.sample_rate / 1000.0);
+    double reference_rms = fragments_.empty() ? 0.0 : rms_sum_ / fragments_.size();
+
+    std::vector<float> out;
+    for (const auto& part : parts) {
+        if (!part.is_slot) {
+            Splice(out, Fragment(part.text), crossfade);
+            continue;
+        }
+        auto it = slots.find(part.text);
+        if (it == slots.end()) {
+            throw std::runtime_error("模板 " + name + " 缺少槽位值: " + part.text);
+        }
+        if (it->second.empty()) continue;
+        std::vector<float> piece = RenderSlot(it->second);
+
+        // 槽位单独合成，增强时的归一化使其电平与模板片段不同，按平均电平缩放（限制在 ±6 dB）
+        double rms = Rms(piece);
+        if (options_.match_level && reference_rms > 0.0 && rms > 0.0) {
+            float gain = static_cast<float>(std::min(2.0, std::max(0.5, reference_rms / rms)));
+            for (float& x : piece) x = std::max(-1.0f, std::min(1.0f, x * gain));
+        }
+        Splice(out, piece, crossfade);
+    }
+    return out;
+}
+
+std::vector<float> PhraseBank::RenderSlot(const std::string& value) {
+    std::string reading = options_.language == "zh" ? NumberToChinese(value) : "";
+    if (reading.empty() || !options_.prerendered_numbers) {
+        return Synthesize(reading.empty() ? value : reading);
+    }
+
+    // 数字和单位逐字拼接，字之间只保留交叉淡化的长度
+    size_t crossfade = static_cast<size_t>(options_.crossfade_ms * config_.sample_rate / 1000.0);
+    std::vector<float> out;
+    for (const auto& unit : SplitUtf8(reading)) {
+        Splice(out, TrimSilence(Fragment(unit), crossfade), crossfade);
+    }
+    return out;
+}
+
+const std::vector<float>& PhraseBank::Fragment(const std::string& text) {
+    auto it = fragments_.find(text);
+    if (it != fragments_.end()) return it->second;
+    AddFragment(text, Synthesize(text));
+    return fragments_[text];
+}
+
+void PhraseBank::AddFragment(const std::string& text, std::vector<float> audio) {
+    auto it = fragments_.find(text);
+    if (it != fragments_.end()) {
+        rms_sum_ -= Rms(it->second);
+    }
+    rms_sum_ += Rms(audio);
+    fragments_[text] = std::move(audio);
+}
+
+std::vector<float> PhraseBank::Synthesize(const std::string& text) {
+    size_t pad = static_cast<size_t>(options_.edge_pad_ms * config_.sample_rate / 1000.0);
+    return TrimSilence(tts_.synthesize(text, options_.language), pad);
+}
+
+} // namespace melotts
@@ -0,0 +1,169 @@
+// phrasebank_tool.cpp - IVR 提示音模板的构建与渲染工具
+//
+// 构建: melotts_phrasebank -m <模型目录> -T <模板文件> -b <片段目录> [--numbers]
+//   模板文件每行 "模板名<TAB>模板"，如 "balance	您的余额是{amount}元"；预渲染全部固定片段后保存到片段目录
+// 渲染: melotts_phrasebank -m <模型目录> -b <片段目录> -n <模板名> -s 槽位=值 [-s ...] -o <输出WAV> [--compare]
+//   加载片段目录，只合成槽位并拼接；--compare 同时整句合成，对比耗时
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "melotts.h"
+#include "MeloTTSConfig.h"
+#include "PhraseBank.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void print_usage(const char* program_name) {
+    std::cout << "用法: " << program_name << " [选项]" << std::endl;
+    std::cout << "选项:" << std::endl;
+    std::cout << "  -m, --model-dir DIR    模型目录 (默认: ./models)" << std::endl;
+    std::cout << "  -b, --bank DIR         片段目录 (必需)" << std::endl;
+    std::cout << "  -T, --templates FILE   构建：模板文件，每行 \"模板名<TAB>模板\"" << std::endl;
+    std::cout << "  -n, --name NAME        渲染：模板名" << std::endl;
+    std::cout << "  -s, --slot KEY=VALUE   渲染：槽位值，可重复" << std::endl;
+    std::cout << "  -o, --output FILE      渲染：输出WAV文件 (默认: prompt.wav)" << std::endl;
+    std::cout << "  -l, --language LANG    语言代码: zh 或 en (默认: zh)" << std::endl;
+    std::cout << "  --numbers              数字槽位用预渲染的数字和单位拼接 (构建和渲染时都需指定)" << std::endl;
+    std::cout << "  --crossfade MS         片段之间的交叉淡化时长 (默认: 10)" << std::endl;
+    std::cout << "  --compare              渲染时同时整句合成，对比耗时" << std::endl;
+    std::cout << "  --set KEY=VALUE        设置 MeloTTSConfig 字段，可重复" << std::endl;
+    std::cout << "  -h, --help             显示此帮助信息" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    melotts::MeloTTSConfig config;
+    config.model_dir = "./models";
+    config.verbose = false;
+    melotts::PhraseBankOptions options;
+    std::string bank_dir;
+    std::string templates_file;
+    std::string name;
+    std::string output_file = "prompt.wav";
+    std::map<std::string, std::string> slots;
+    bool compare = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-m" || arg == "--model-dir") {
+            if (i + 1 < argc) config.model_dir = argv[++i];
+        } else if (arg == "-b" || arg == "--bank") {
+            if (i + 1 < argc) bank_dir = argv[++i];
+        } else if (arg == "-T" || arg == "--templates") {
+            if (i + 1 < argc) templates_file = argv[++i];
+        } else if (arg == "-n" || arg == "--name") {
+            if (i + 1 < argc) name = argv[++i];
+        } else if (arg == "-s" || arg == "--slot") {
+            if (i + 1 < argc) {
+                std::string kv = argv[++i];
+                size_t eq = kv.find('=');
+                if (eq == std::string::npos) {
+                    std::cerr << "无效的槽位值: " << kv << std::endl;
+                    return 1;
+                }
+                slots[kv.substr(0, eq)] = kv.substr(eq + 1);
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            if (i + 1 < argc) output_file = argv[++i];
+        } else if (arg == "-l" || arg == "--language") {
+            if (i + 1 < argc) options.language = argv[++i];
+        } else if (arg == "--numbers") {
+            options.prerendered_numbers = true;
+        } else if (arg == "--crossfade") {
+            if (i + 1 < argc) options.crossfade_ms = std::stod(argv[++i]);
+        } else if (arg == "--compare") {
+            compare = true;
+        } else if (arg == "--set") {
+            if (i + 1 < argc) {
+                std::string kv = argv[++i];
+                size_t eq = kv.find('=');
+                if (eq == std::string::npos || !config.set(kv.substr(0, eq), kv.substr(eq + 1))) {
+                    std::cerr << "无效的配置项: " << kv << std::endl;
+                    return 1;
+                }
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "未知选项: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (bank_dir.empty() || (templates_file.empty() == name.empty())) {
+        std::cerr << "需要指定片段目录，以及模板文件（构建）或模板名（渲染）之一" << std::endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+    config.language = options.language;
+
+    try {
+        melotts::MeloTTS tts(config);
+        melotts::PhraseBank bank(tts, config, options);
+
+        // 构建：读取模板，预渲染固定片段并保存
+        if (!templates_file.empty()) {
+            std::ifstream in(templates_file);
+            if (!in) {
+                std::cerr << "无法打开模板文件: " << templates_file << std::endl;
+                return 1;
+            }
+            std::string line;
+            while (std::getline(in, line)) {
+                size_t tab = line.find('\t');
+                if (line.empty() || line[0] == '#' || tab == std::string::npos) continue;
+                bank.AddTemplate(line.substr(0, tab), line.substr(tab + 1));
+            }
+            Clock::time_point start = Clock::now();
+            size_t rendered = bank.Prerender();
+            bank.Save(bank_dir);
+            std::cout << "已预渲染 " << bank.TemplateNames().size() << " 个模板的 " << rendered << " 个片段, 耗时 "
+                      << std::fixed << std::setprecision(2) << ms_since(start) << " ms, 保存到 " << bank_dir
+                      << std::endl;
+            return 0;
+        }
+
+        // 渲染：加载片段，只合成槽位
+        bank.Load(bank_dir);
+        tts.synthesize(options.language == "en" ? "Hello." : "你好", options.language);   // 预热，排除首次推理的开销
+        Clock::time_point start = Clock::now();
+        std::vector<float> audio = bank.Render(name, slots);
+        double render_ms = ms_since(start);
+        if (!tts.save_wav(audio, output_file, config.sample_rate)) {
+            std::cerr << "保存WAV文件失败!" << std::endl;
+            return 1;
+        }
+        std::cout << "渲染耗时 " << std::fixed << std::setprecision(2) << render_ms << " ms, 音频 "
+                  << audio.size() * 1.0 / config.sample_rate << " 秒, 已保存到: " << output_file << std::endl;
+
+        if (compare) {
+            // 整句合成时数字同样按读法转换
+            std::string text;
+            for (const auto& part : bank.Parts(name)) {
+                if (!part.is_slot) {
+                    text += part.text;
+                    continue;
+                }
+                std::string reading = options.language == "zh" ? melotts::NumberToChinese(slots[part.text]) : "";
+                text += reading.empty() ? slots[part.text] : reading;
+            }
+            start = Clock::now();
+            tts.synthesize(text, options.language);
+            std::cout << "整句合成耗时 " << ms_since(start) << " ms (" << text << ")" << std::endl;
+        }
+        std::cout.unsetf(std::ios::fixed);
+    } catch (const std::exception& e) {
+        std::cerr << "错误: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
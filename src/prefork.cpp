@@ -0,0 +1,105 @@
+// prefork.cpp - prefork 工作进程管理
+
+#include "Prefork.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace melotts {
+
+namespace {
+
+// 在子进程中运行 worker，不返回。用 _exit 退出，不执行父进程注册的析构和 atexit 处理
+[[noreturn]] void RunWorker(MeloTTS& tts, int index, const PreforkWorker& worker) {
+    int code = 1;
+    try {
+        // 创建推迟的 ONNX Runtime 会话及其线程池（词典已在父进程中加载）
+        tts.preload({});
+        code = worker(tts, index);
+    } catch (const std::exception& e) {
+        std::cerr << "工作进程 " << index << " 出错: " << e.what() << std::endl;
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    _exit(code);
+}
+
+pid_t ForkWorker(MeloTTS& tts, int index, const PreforkWorker& worker) {
+    // 缓冲区中未输出的内容会被子进程复制一份
+    std::cout.flush();
+    std::fflush(nullptr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error(std::string("fork 失败: ") + std::strerror(errno));
+    }
+    if (pid == 0) {
+        RunWorker(tts, index, worker);
+    }
+    return pid;
+}
+
+} // namespace
+
+int RunPrefork(const MeloTTSConfig& config, const PreforkOptions& options, const PreforkWorker& worker) {
+    if (options.workers <= 0) {
+        throw std::runtime_error("工作进程数须大于0: " + std::to_string(options.workers));
+    }
+
+    // 父进程加载全部 fork 安全的状态，按需加载的组件也在这里加载，子进程不再各自加载
+    MeloTTSConfig parent_config = config;
+    parent_config.prefork = true;
+    parent_config.lazy_lexicon = false;
+    parent_config.defer_decoder = false;
+    auto start = std::chrono::steady_clock::now();
+    MeloTTS tts(parent_config);
+    double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (config.verbose) {
+        std::cout << "prefork: 父进程加载耗时 " << load_ms << " ms，启动 " << options.workers << " 个工作进程"
+                  << std::endl;
+    }
+
+    std::map<pid_t, int> running;   // pid -> 进程序号
+    for (int i = 0; i < options.workers; i++) {
+        running[ForkWorker(tts, i, worker)] = i;
+    }
+
+    int result = 0;
+    while (!running.empty()) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("等待工作进程失败: ") + std::strerror(errno));
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) continue;
+        int index = it->second;
+        running.erase(it);
+
+        bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (ok) continue;
+        if (WIFSIGNALED(status)) {
+            std::cerr << "工作进程 " << index << " 被信号 " << WTERMSIG(status) << " 终止" << std::endl;
+        } else {
+            std::cerr << "工作进程 " << index << " 退出码 " << WEXITSTATUS(status) << std::endl;
+        }
+        if (options.restart_crashed && WIFSIGNALED(status)) {
+            running[ForkWorker(tts, index, worker)] = index;
+        } else {
+            result = 1;
+        }
+    }
+    return result;
+}
+
+} // namespace melotts
@@ -0,0 +1,168 @@
+// slow_request_log.cpp - 慢请求环形缓冲区与信号触发的输出
+
+#include "SlowRequestLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace melotts {
+
+static_assert(std::is_trivially_copyable<SlowRequestRecord>::value, "慢请求记录须可按字节复制");
+
+// 版本号为奇数时槽位正在写入，为偶数时内容完整；0 表示从未写入
+struct SlowRequestLog::Slot {
+    std::atomic<uint64_t> version{0};
+    SlowRequestRecord record;
+};
+
+SlowRequestLog::SlowRequestLog(size_t capacity)
+    : slots_(new Slot[capacity > 0 ? capacity : 1]), capacity_(capacity > 0 ? capacity : 1), next_(0) {}
+
+SlowRequestLog::~SlowRequestLog() = default;
+
+void SlowRequestLog::Record(const SlowRequestRecord& record) {
+    uint64_t sequence = next_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[sequence % capacity_];
+
+    // 占用槽位：版本号由偶数改为奇数。只有写入速度超过整圈时才会有两个写入方争用同一槽位
+    uint64_t version = slot.version.load(std::memory_order_relaxed);
+    do {
+        while (version & 1) {
+            std::this_thread::yield();
+            version = slot.version.load(std::memory_order_relaxed);
+        }
+    } while (!slot.version.compare_exchange_weak(version, version + 1, std::memory_order_acquire,
+                                                 std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&slot.record, &record, sizeof(record));
+    slot.record.sequence = sequence;
+    slot.version.store(version + 2, std::memory_order_release);
+}
+
+std::vector<SlowRequestRecord> SlowRequestLog::Snapshot() const {
+    std::vector<SlowRequestRecord> records;
+    records.reserve(capacity_);
+    for (size_t i = 0; i < capacity_; i++) {
+        const Slot& slot = slots_[i];
+        uint64_t before = slot.version.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1)) continue;
+        SlowRequestRecord record;
+        std::memcpy(&record, &slot.record, sizeof(record));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != before) continue;   // 读取期间被改写
+        records.push_back(record);
+    }
+    std::sort(records.begin(), records.end(), [](const SlowRequestRecord& a, const SlowRequestRecord& b) {
+        return a.sequence < b.sequence;
+    });
+    return records;
+}
+
+void SlowRequestLog::Dump(std::ostream& out) const {
+    std::vector<SlowRequestRecord> records = Snapshot();
+    out << "序号\t请求\t完成时间\t结果\t耗时(ms)\t排队(ms)\t字节\t字符\t音素\t分段\t采样点\t语言\t后端\t线程\t"
+           "各阶段 耗时/CPU(ms)" << std::endl;
+    for (const auto& r : records) {
+        char when[32] = "";
+        time_t seconds = static_cast<time_t>(r.finished_at);
+        struct tm local;
+        if (localtime_r(&seconds, &local)) {
+            std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+        }
+        out << r.sequence << "\t" << r.request_id << "\t" << when << "\t" << (r.failed ? "失败" : "成功") << "\t" << std::fixed << std::setprecision(2)
+            << r.total_ms << "\t" << r.queue_wait_ms << "\t" << r.text_bytes << "\t" << r.text_chars << "\t"
+            << r.phone_count << "\t" << r.slice_count << "\t" << r.samples << "\t" << r.language << "\t"
+            << r.encoder_backend << "/" << r.decoder_backend << "\t";
+        if (r.encoder_threads == 0 && r.decoder_threads == 0) {
+            out << "共享";
+        } else {
+            out << r.encoder_threads << "/" << r.decoder_threads;
+        }
+        out << "\t";
+        uint32_t stage_count = std::min<uint32_t>(r.stage_count, SlowRequestRecord::kMaxStages);
+        for (uint32_t k = 0; k < stage_count; k++) {
+            out << (k > 0 ? " " : "") << r.stages[k].name << "=" << r.stages[k].ms << "/" << r.stages[k].cpu_ms;
+        }
+        out << std::endl;
+        out.unsetf(std::ios::fixed);
+        out.precision(6);
+    }
+}
+
+SlowRequestLog& GlobalSlowRequestLog() {
+    static SlowRequestLog log;
+    return log;
+}
+
+namespace {
+
+int g_dump_pipe[2] = {-1, -1};
+std::atomic<bool> g_dump_installed(false);
+
+void DumpSignalHandler(int) {
+    int saved_errno = errno;
+    char byte = 1;
+    ssize_t written = write(g_dump_pipe[1], &byte, 1);   // 管道满时丢弃，已有待处理的输出请求
+    (void)written;
+    errno = saved_errno;
+}
+
+void DumpLoop(std::string path) {
+    char byte;
+    while (true) {
+        ssize_t n = read(g_dump_pipe[0], &byte, 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        if (path.empty()) {
+            GlobalSlowRequestLog().Dump(std::cerr);
+            continue;
+        }
+        std::ofstream out(path, std::ios::app);
+        if (!out) {
+            std::cerr << "无法写入慢请求日志: " << path << std::endl;
+            continue;
+        }
+        GlobalSlowRequestLog().Dump(out);
+    }
+}
+
+} // namespace
+
+bool InstallSlowRequestDumpSignal(int signo, const std::string& path) {
+    if (g_dump_installed.exchange(true)) {
+        return false;
+    }
+    if (pipe(g_dump_pipe) != 0) {
+        std::cerr << "创建慢请求日志管道失败: " << std::strerror(errno) << std::endl;
+        g_dump_installed = false;
+        return false;
+    }
+    fcntl(g_dump_pipe[1], F_SETFL, fcntl(g_dump_pipe[1], F_GETFL) | O_NONBLOCK);
+
+    // 后台线程在整个进程生命周期内等待输出请求
+    std::thread(DumpLoop, path).detach();
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = DumpSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (sigaction(signo, &action, nullptr) != 0) {
+        std::cerr << "安装慢请求日志信号处理失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace melotts